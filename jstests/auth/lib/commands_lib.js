@@ -4893,6 +4893,60 @@ var authCommandsLib = {
               },
           ]
         },
+        {
+          testname: "planCacheSnapshot",
+          command: {planCacheSnapshot: "x"},
+          skipSharded: true,
+          setup: function(db) {
+              assert.writeOK(db.x.save({}));
+          },
+          teardown: function(db) {
+              db.x.drop();
+          },
+          testcases: [
+              {
+                runOnDb: firstDbName,
+                roles: roles_dbAdmin,
+                privileges:
+                    [{resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"]}],
+              },
+              {
+                runOnDb: secondDbName,
+                roles: roles_dbAdminAny,
+                privileges:
+                    [{resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"]}],
+              },
+          ]
+        },
+        {
+          testname: "analyze",
+          command: {analyze: "x", fields: ["a"]},
+          skipSharded: true,
+          setup: function(db) {
+              assert.writeOK(db.x.save({a: 1}));
+          },
+          teardown: function(db) {
+              db.x.drop();
+          },
+          testcases: [
+              {
+                runOnDb: firstDbName,
+                roles: {dbOwner: 1, root: 1, __system: 1},
+                privileges: [{
+                    resource: {db: firstDbName, collection: "x"},
+                    actions: ["find", "planCacheWrite"]
+                }],
+              },
+              {
+                runOnDb: secondDbName,
+                roles: {root: 1, __system: 1},
+                privileges: [{
+                    resource: {db: secondDbName, collection: "x"},
+                    actions: ["find", "planCacheWrite"]
+                }],
+              },
+          ]
+        },
         {
           testname: "ping",
           command: {ping: 1},
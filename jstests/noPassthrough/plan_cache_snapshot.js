@@ -0,0 +1,83 @@
+/**
+ * Tests restoring a plan cache from the snapshot taken with the planCacheSnapshot command after a
+ * restart, and that a snapshot written by another version is not restored.
+ *
+ * @tags: [requires_persistence]
+ */
+(function() {
+"use strict";
+
+const dbpath = MongoRunner.dataPath + "plan_cache_snapshot";
+resetDbpath(dbpath);
+
+let conn = MongoRunner.runMongod({dbpath: dbpath});
+assert.neq(null, conn, "mongod was unable to start up");
+let testDB = conn.getDB("plan_cache_snapshot");
+let coll = testDB.coll;
+
+const docs = [];
+for (let i = 0; i < 200; ++i) {
+    docs.push({a: i % 10, b: i % 20, c: i});
+}
+assert.commandWorked(coll.insert(docs));
+for (const keyPattern of [{a: 1}, {b: 1}, {a: 1, b: 1}]) {
+    assert.commandWorked(coll.createIndex(keyPattern));
+}
+
+const filters = [{a: 1, b: 1}, {a: {$gt: 5}, b: 3}, {a: 2, c: {$lt: 50}}];
+
+function runQueries() {
+    for (const filter of filters) {
+        for (let i = 0; i < 2; ++i) {
+            coll.find(filter).itcount();
+        }
+    }
+}
+
+function planCacheEntries() {
+    return coll.aggregate([{$planCacheStats: {}}, {$sort: {planCacheKey: 1}}])
+        .toArray()
+        .map(entry => entry.planCacheKey);
+}
+
+runQueries();
+const entries = planCacheEntries();
+assert.gte(entries.length, filters.length, entries);
+const res = assert.commandWorked(testDB.runCommand({planCacheSnapshot: coll.getName()}));
+assert.eq(res.numEntries, entries.length, res);
+
+function restart() {
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod({
+        dbpath: dbpath,
+        noCleanData: true,
+        setParameter: {
+            internalQueryPlanCacheRestoreFromSnapshot: true,
+            logComponentVerbosity: tojsononeline({query: 1})
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to restart");
+    testDB = conn.getDB("plan_cache_snapshot");
+    coll = testDB.coll;
+}
+
+// The first query of the collection which consults its plan cache restores the snapshot in the
+// background.
+restart();
+assert.eq(planCacheEntries(), []);
+coll.find({a: 1, b: 1}).itcount();
+assert.soon(() => planCacheEntries().length === entries.length, () => tojson(planCacheEntries()));
+assert.eq(planCacheEntries(), entries);
+
+// A snapshot of another format version is skipped.
+assert.commandWorked(conn.getDB("config").planCacheSnapshots.update({}, {$set: {version: -1}}));
+restart();
+coll.find({a: 1, b: 1}).itcount();
+coll.find({a: 1, b: 1}).itcount();
+// Wait for the restore to skip the snapshot. Only the entry planned since the restart must be in
+// the cache.
+checkLog.containsJson(conn, 5999210);
+assert.eq(planCacheEntries().length, 1, planCacheEntries());
+
+MongoRunner.stopMongod(conn);
+})();
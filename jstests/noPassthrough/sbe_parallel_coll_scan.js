@@ -0,0 +1,71 @@
+/**
+ * Tests running SBE collection scans on parallel workers. The workers must return the same
+ * documents as a serial scan while yielding on their own, and must give up when the query they
+ * work for runs out of time.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/sbe_util.js");  // For checkSBEEnabled.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB("sbe_parallel_coll_scan");
+
+if (!checkSBEEnabled(testDB)) {
+    jsTestLog("Skipping test because SBE is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDB.coll;
+coll.drop();
+
+// Enough documents for the collection to be split into several RecordId ranges.
+const docs = [];
+for (let i = 0; i < 50000; ++i) {
+    docs.push({_id: i, a: i % 13, b: i % 101, c: "x".repeat(i % 5)});
+}
+assert.commandWorked(coll.insert(docs));
+
+function setParameter(name, value) {
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, [name]: value}));
+}
+
+const filters = [
+    {},
+    {a: 3},
+    {a: {$gte: 5}, b: {$lt: 20}},
+    {$or: [{b: 7}, {c: "xx"}]},
+    {c: {$exists: false}},
+];
+
+// Returns the _id of every document each query returns, in ascending order.
+function runQueries() {
+    return filters.map(filter => coll.find(filter, {_id: 1})
+                                     .toArray()
+                                     .map(doc => doc._id)
+                                     .sort((lhs, rhs) => lhs - rhs));
+}
+
+setParameter("internalQuerySlotBasedExecutionMaxDegreeOfParallelism", 1);
+const serial = runQueries();
+
+// Make the workers yield after every document they scan.
+setParameter("internalQuerySlotBasedExecutionMaxDegreeOfParallelism", 4);
+setParameter("internalQueryExecYieldIterations", 1);
+const parallel = runQueries();
+for (let i = 0; i < filters.length; ++i) {
+    assert.eq(serial[i], parallel[i], filters[i]);
+}
+
+// The workers share the deadline of their query.
+assert.commandFailedWithCode(testDB.runCommand({
+    find: coll.getName(),
+    filter: {$where: "sleep(10); return true;"},
+    maxTimeMS: 100
+}),
+                             ErrorCodes.MaxTimeMSExpired);
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,112 @@
+/**
+ * Tests running the trial periods of the slot-based multi-planner on parallel workers. The workers
+ * must pick the same plans as a trial period run on the query's own thread, and must give up when
+ * the query they work for runs out of time or is killed.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");     // For getWinningPlan.
+load("jstests/libs/fail_point_util.js");  // For configureFailPoint.
+load("jstests/libs/sbe_util.js");         // For checkSBEEnabled.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB("sbe_parallel_trials");
+
+if (!checkSBEEnabled(testDB)) {
+    jsTestLog("Skipping test because SBE is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDB.coll;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({a: i % 10, b: i % 100, c: i, d: i % 7});
+}
+assert.commandWorked(coll.insert(docs));
+for (const keyPattern of [{a: 1}, {b: 1}, {c: 1}, {d: 1}, {a: 1, b: 1}]) {
+    assert.commandWorked(coll.createIndex(keyPattern));
+}
+
+const filters = [
+    {a: 3, b: 13},
+    {a: {$gte: 5}, b: {$lt: 20}, d: 2},
+    {c: {$gt: 500}, a: 1, d: {$ne: 3}},
+    {b: {$in: [1, 2, 3]}, c: {$lt: 900}},
+];
+
+function setMaxParallelTrials(value) {
+    assert.commandWorked(testDB.adminCommand(
+        {setParameter: 1, internalQueryPlanEvaluationMaxParallelTrials: value}));
+}
+
+// Returns the results and the winning plan of every query, planning each of them from scratch.
+function runQueries() {
+    return filters.map(filter => {
+        coll.getPlanCache().clear();
+        const explain = coll.find(filter).sort({c: 1}).explain();
+        coll.getPlanCache().clear();
+        return {
+            results: coll.find(filter).sort({c: 1}).toArray(),
+            winningPlan: getWinningPlan(explain.queryPlanner)
+        };
+    });
+}
+
+setMaxParallelTrials(1);
+const serial = runQueries();
+setMaxParallelTrials(4);
+const parallel = runQueries();
+for (let i = 0; i < filters.length; ++i) {
+    assert.eq(serial[i].results, parallel[i].results, filters[i]);
+    assert.docEq(serial[i].winningPlan, parallel[i].winningPlan, filters[i]);
+}
+
+// Queries with a collation run their trial periods on their own thread.
+coll.getPlanCache().clear();
+assert.eq(coll.find({a: 3, b: 13}).collation({locale: "fr"}).itcount(),
+          coll.find({a: 3, b: 13}).itcount());
+
+// A worker stuck in its trial period does not outlive the deadline of its query.
+let fp = configureFailPoint(conn, "hangInSBETrialWorker");
+coll.getPlanCache().clear();
+assert.commandFailedWithCode(
+    testDB.runCommand({find: coll.getName(), filter: {a: 3, b: 13}, maxTimeMS: 1000}),
+    ErrorCodes.MaxTimeMSExpired);
+fp.off();
+
+// Killing the query interrupts its workers. The fail point stays enabled until the query returns,
+// so the query only returns if its workers were interrupted.
+fp = configureFailPoint(conn, "hangInSBETrialWorker");
+coll.getPlanCache().clear();
+const awaitShell = startParallelShell(
+    funWithArgs(function(dbName, collName) {
+        assert.commandFailedWithCode(db.getSiblingDB(dbName).runCommand({
+            find: collName,
+            filter: {a: 3, b: 13},
+            comment: "sbe_parallel_trials_killop"
+        }),
+                                     ErrorCodes.Interrupted);
+    }, testDB.getName(), coll.getName()), conn.port);
+fp.wait();
+
+const curOpFilter = {"command.comment": "sbe_parallel_trials_killop"};
+let opId;
+assert.soon(() => {
+    const inprog = assert.commandWorked(testDB.currentOp(curOpFilter)).inprog;
+    if (inprog.length !== 1) {
+        return false;
+    }
+    opId = inprog[0].opid;
+    return true;
+});
+assert.commandWorked(testDB.killOp(opId));
+awaitShell();
+fp.off();
+
+MongoRunner.stopMongod(conn);
+})();
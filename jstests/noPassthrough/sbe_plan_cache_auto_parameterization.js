@@ -0,0 +1,60 @@
+/**
+ * Tests that an SBE plan tree stored with a plan cache entry is rebound to the constants of later
+ * queries of the same shape, and that the rebound tree returns the same results as a collection
+ * scan.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/sbe_util.js");  // For checkSBEEnabled.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB("sbe_plan_cache_auto_parameterization");
+
+if (!checkSBEEnabled(testDB)) {
+    jsTestLog("Skipping test because SBE is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = testDB.coll;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 500; ++i) {
+    docs.push({_id: i, a: i % 10, b: i % 50});
+}
+docs.push({_id: 500, a: "3", b: 20});
+docs.push({_id: 501, a: 3.5, b: 20});
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+function assertSameResultsAsCollScan(filter) {
+    const expected = coll.find(filter).sort({_id: 1}).hint({$natural: 1}).toArray();
+    assert.eq(coll.find(filter).sort({_id: 1}).toArray(), expected, filter);
+}
+
+function executablePlanHits() {
+    const stats = coll.aggregate([{$planCacheStats: {}}]).toArray();
+    return stats.reduce((hits, entry) => hits + (entry.executablePlanHits || 0), 0);
+}
+
+coll.getPlanCache().clear();
+for (let i = 0; i < 10; ++i) {
+    assertSameResultsAsCollScan({a: i, b: {$gt: i * 3}});
+}
+assert.gte(executablePlanHits(), 1, coll.aggregate([{$planCacheStats: {}}]).toArray());
+
+// Constants of another type than the one the tree was built for are still answered correctly.
+assertSameResultsAsCollScan({a: "3", b: {$gt: 10}});
+assertSameResultsAsCollScan({a: 3.5, b: {$gt: 10}});
+assertSameResultsAsCollScan({a: 3, b: {$gt: 10.5}});
+
+// So are constants for which the tree cannot be rebound.
+assertSameResultsAsCollScan({a: null, b: {$gt: 10}});
+assertSameResultsAsCollScan({a: 3, b: {$gt: MinKey}});
+
+MongoRunner.stopMongod(conn);
+})();
@@ -95,6 +95,7 @@ const allCommands = {
         expectFailure: true,
         expectedErrorCode: ErrorCodes.NotPrimaryOrSecondary,
     },
+    analyze: {skip: isPrimaryOnly},
     appendOplogNote: {skip: isPrimaryOnly},
     applyOps: {skip: isPrimaryOnly},
     authenticate: {skip: isNotAUserDataRead},
@@ -259,6 +260,7 @@ const allCommands = {
     planCacheClearFilters: {skip: isNotAUserDataRead},
     planCacheListFilters: {skip: isNotAUserDataRead},
     planCacheSetFilter: {skip: isNotAUserDataRead},
+    planCacheSnapshot: {skip: isNotAUserDataRead},
     prepareTransaction: {skip: isPrimaryOnly},
     profile: {skip: isPrimaryOnly},
     reapLogicalSessionCacheNow: {skip: isNotAUserDataRead},
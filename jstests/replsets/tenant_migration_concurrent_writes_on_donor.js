@@ -516,6 +516,7 @@ const testCases = {
             assert(!collectionExists(db, collName + "Out"));
         }
     },
+    analyze: {skip: isNotWriteCommand},
     appendOplogNote: {skip: isNotRunOnUserDatabase},
     applyOps: {skip: isNotSupportedInServerless},
     authenticate: {skip: isAuthCommand},
@@ -840,6 +841,7 @@ const testCases = {
     planCacheClearFilters: {skip: isNotWriteCommand},
     planCacheListFilters: {skip: isNotWriteCommand},
     planCacheSetFilter: {skip: isNotWriteCommand},
+    planCacheSnapshot: {skip: isNotWriteCommand},
     prepareTransaction: {skip: isOnlySupportedOnShardedCluster},
     profile: {skip: isNotRunOnUserDatabase},
     reIndex: {skip: isOnlySupportedOnStandalone},
@@ -174,6 +174,7 @@ let testCases = {
         checkReadConcern: true,
         checkWriteConcern: true,
     },
+    analyze: {skip: "does not accept read or write concern"},
     appendOplogNote: {
         command: {appendOplogNote: 1, data: {foo: 1}},
         checkReadConcern: false,
@@ -515,6 +516,7 @@ let testCases = {
     planCacheClearFilters: {skip: "does not accept read or write concern"},
     planCacheListFilters: {skip: "does not accept read or write concern"},
     planCacheSetFilter: {skip: "does not accept read or write concern"},
+    planCacheSnapshot: {skip: "does not accept read or write concern"},
     prepareTransaction: {skip: "internal command"},
     profile: {skip: "does not accept read or write concern"},
     reIndex: {skip: "does not accept read or write concern"},
@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/collection_statistics_store.h"
+
+namespace mongo {
+namespace {
+
+constexpr long long kDefaultSampleSize = 10000;
+constexpr long long kMaxSampleSize = 1000 * 1000;
+constexpr long long kMaxNumBuckets = 1000;
+
+/**
+ * The 'analyze' command builds statistics of some fields of a collection from a random sample of
+ * its documents, for the planner to estimate the cost of candidate plans, see
+ * collection_statistics_store.h:
+ *
+ *    {
+ *        analyze: <collection>,
+ *        fields: [<path>, ...],
+ *        sampleSize: <number of documents, optional>,
+ *        numBuckets: <number of histogram buckets per field, optional>
+ *    }
+ */
+class AnalyzeCommand final : public BasicCommand {
+public:
+    AnalyzeCommand() : BasicCommand("analyze") {}
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+
+        const auto fieldsElem = cmdObj["fields"];
+        uassert(ErrorCodes::TypeMismatch,
+                "'fields' must be a non-empty array of field paths",
+                fieldsElem.type() == BSONType::Array && !fieldsElem.Obj().isEmpty());
+        std::vector<std::string> paths;
+        for (auto&& field : fieldsElem.Obj()) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "'fields' must be a non-empty array of field paths",
+                    field.type() == BSONType::String && !field.valueStringData().empty());
+            paths.push_back(field.str());
+        }
+
+        long long sampleSize = kDefaultSampleSize;
+        if (const auto elem = cmdObj["sampleSize"]) {
+            sampleSize = elem.safeNumberLong();
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << "'sampleSize' must be between 1 and " << kMaxSampleSize,
+                    elem.isNumber() && sampleSize > 0 && sampleSize <= kMaxSampleSize);
+        }
+
+        long long numBuckets = CollectionStatistics::kDefaultNumBuckets;
+        if (const auto elem = cmdObj["numBuckets"]) {
+            numBuckets = elem.safeNumberLong();
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << "'numBuckets' must be between 1 and " << kMaxNumBuckets,
+                    elem.isNumber() && numBuckets > 0 && numBuckets <= kMaxNumBuckets);
+        }
+
+        const auto stats = collection_statistics_store::analyze(
+            opCtx, nss, std::move(paths), sampleSize, static_cast<size_t>(numBuckets));
+        result.appendNumber("numDocs", stats.getNumDocs());
+        result.appendNumber("numSampledDocs", stats.getNumSampledDocs());
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    // The statistics are written on the primary and replicated to the secondaries.
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) const override {
+        AuthorizationSession* authzSession = AuthorizationSession::get(client);
+        ResourcePattern pattern = parseResourcePattern(dbname, cmdObj);
+
+        // The statistics expose values of the collection, so building them requires reading it.
+        if (authzSession->isAuthorizedForActionsOnResource(pattern, ActionType::find) &&
+            authzSession->isAuthorizedForActionsOnResource(pattern, ActionType::planCacheWrite)) {
+            return Status::OK();
+        }
+
+        return Status(ErrorCodes::Unauthorized, "unauthorized");
+    }
+
+    std::string help() const override {
+        return "Builds statistics of fields of a collection for the query planner.";
+    }
+} analyzeCommand;
+
+}  // namespace
+}  // namespace mongo
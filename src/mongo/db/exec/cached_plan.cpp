@@ -50,6 +50,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/stage_builder_util.h"
 #include "mongo/logv2/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 #include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
 
@@ -74,6 +75,7 @@ CachedPlanStage::CachedPlanStage(ExpressionContext* expCtx,
 }
 
 Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
+    _yieldPolicy = yieldPolicy;
     // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
     // execution work that happens here, so this is needed for the time accounting to
     // make sense.
@@ -89,13 +91,12 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
 
     // If we work this many times during the trial period, then we will replan the
     // query from scratch.
-    size_t maxWorksBeforeReplan =
-        static_cast<size_t>(internalQueryCacheEvictionRatio * _decisionWorks);
+    _maxWorksBeforeReplan = static_cast<size_t>(internalQueryCacheEvictionRatio * _decisionWorks);
 
     // The trial period ends without replanning if the cached plan produces this many results.
-    size_t numResults = trial_period::getTrialPeriodNumToReturn(*_canonicalQuery);
+    _numResults = trial_period::getTrialPeriodNumToReturn(*_canonicalQuery);
 
-    for (size_t i = 0; i < maxWorksBeforeReplan; ++i) {
+    for (size_t i = 0; i < _maxWorksBeforeReplan; ++i) {
         // Might need to yield between calls to work due to the timer elapsing.
         Status yieldStatus = tryYield(yieldPolicy);
         if (!yieldStatus.isOK()) {
@@ -132,8 +133,11 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
             member->makeObjOwnedIfNeeded();
             _results.push(id);
 
-            if (_results.size() >= numResults) {
-                // Once a plan returns enough results, stop working. There is no need to replan.
+            if (_results.size() >= _numResults) {
+                // Once a plan returns enough results, stop working. There is no need to replan,
+                // but keep comparing the plan against the cached estimate while it runs.
+                _monitorMidExecution =
+                    internalQueryEnableMidExecutionReplanning.load() && canReplanMidExecution();
                 return Status::OK();
             }
         } else if (PlanStage::IS_EOF == state) {
@@ -164,7 +168,7 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     LOGV2_DEBUG(20580,
                 1,
                 "Evicting cache entry and replanning query",
-                "maxWorksBeforeReplan"_attr = maxWorksBeforeReplan,
+                "maxWorksBeforeReplan"_attr = _maxWorksBeforeReplan,
                 "decisionWorks"_attr = _decisionWorks,
                 "query"_attr = redact(_canonicalQuery->toStringShort()),
                 "planSummary"_attr = explainer->getPlanSummary());
@@ -175,7 +179,7 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         shouldCache,
         str::stream()
             << "cached plan was less efficient than expected: expected trial execution to take "
-            << _decisionWorks << " works but it took at least " << maxWorksBeforeReplan
+            << _decisionWorks << " works but it took at least " << _maxWorksBeforeReplan
             << " works");
 }
 
@@ -272,6 +276,134 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache, s
     return Status::OK();
 }
 
+bool CachedPlanStage::canReplanMidExecution() const {
+    // The trial period replanned already, so there is no cached estimate to compare against.
+    if (_specificStats.replanReason || _maxWorksBeforeReplan == 0) {
+        return false;
+    }
+
+    // A sort, skip or limit makes the output depend on which results were produced first.
+    const auto& findCommand = _canonicalQuery->getFindCommandRequest();
+    return findCommand.getSort().isEmpty() && !findCommand.getSkip() && !findCommand.getLimit() &&
+        !findCommand.getNtoreturn() && !findCommand.getTailable();
+}
+
+void CachedPlanStage::trackReturnedResult(WorkingSetID id) {
+    if (!_monitorMidExecution) {
+        return;
+    }
+
+    WorkingSetMember* member = _ws->get(id);
+    if (!member->hasRecordId() ||
+        _returnedRecordIds.size() >=
+            static_cast<size_t>(internalQueryMidExecutionReplanMaxTrackedResults.load())) {
+        // Duplicates could no longer be detected after switching plans.
+        _monitorMidExecution = false;
+        stdx::unordered_set<RecordId, RecordId::Hasher>().swap(_returnedRecordIds);
+        return;
+    }
+    _returnedRecordIds.insert(member->recordId);
+}
+
+PlanStage::StageState CachedPlanStage::replanMidExecution(WorkingSetID* out) {
+    // Whatever happens, the query is replanned at most once during execution.
+    _monitorMidExecution = false;
+
+    // Indices may have been dropped since the trial period, in which case we cannot plan with
+    // '_plannerParams' any longer.
+    const auto indexCatalog = collection()->getIndexCatalog();
+    for (auto&& entry : _plannerParams.indices) {
+        if (!indexCatalog->findIndexByName(expCtx()->opCtx, entry.identifier.catalogName)) {
+            return PlanStage::NEED_TIME;
+        }
+    }
+
+    auto statusWithSolutions = QueryPlanner::plan(*_canonicalQuery, _plannerParams);
+    if (!statusWithSolutions.isOK()) {
+        return PlanStage::NEED_TIME;
+    }
+    auto solutions = std::move(statusWithSolutions.getValue());
+
+    // The candidate plans share the working set with the cached plan, which is only discarded
+    // once a new winner has been picked. The winner is not written to the plan cache: if the cached
+    // plan wins again its entry must stay as it is, and otherwise the entry is deactivated below so
+    // that the next execution of the query multi-plans and caches a fresh winner.
+    std::unique_ptr<PlanStage> newRoot;
+    std::unique_ptr<QuerySolution> newQs;
+    if (1 == solutions.size()) {
+        newRoot = stage_builder::buildClassicExecutableTree(
+            expCtx()->opCtx, collection(), *_canonicalQuery, *solutions[0], _ws);
+        newQs = std::move(solutions[0]);
+    } else {
+        auto multiPlanStage = std::make_unique<MultiPlanStage>(
+            expCtx(), collection(), _canonicalQuery, PlanCachingMode::NeverCache);
+        for (auto&& solution : solutions) {
+            if (solution->cacheData.get()) {
+                solution->cacheData->indexFilterApplied = _plannerParams.indexFiltersApplied;
+            }
+            auto&& nextPlanRoot = stage_builder::buildClassicExecutableTree(
+                expCtx()->opCtx, collection(), *_canonicalQuery, *solution, _ws);
+            multiPlanStage->addPlan(std::move(solution), std::move(nextPlanRoot), _ws);
+        }
+
+        // The trial yields according to the policy of the enclosing executor. This stage is the
+        // root of the executor's tree, so the candidates are attached as a second child while they
+        // run, which makes the executor's save and restore reach them as well as the cached plan.
+        _children.emplace_back(std::move(multiPlanStage));
+        ON_BLOCK_EXIT([&] {
+            if (_children.size() > 1) {
+                _children.pop_back();
+            }
+        });
+        try {
+            uassertStatusOK(
+                static_cast<MultiPlanStage*>(_children.back().get())->pickBestPlan(_yieldPolicy));
+        } catch (const WriteConflictException&) {
+            // Keep running the cached plan.
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+        newRoot = std::move(_children.back());
+        _children.pop_back();
+    }
+
+    const auto oldPlanSummary = plan_explainer_factory::make(child().get())->getPlanSummary();
+    const auto newPlanSummary = plan_explainer_factory::make(newRoot.get())->getPlanSummary();
+    if (oldPlanSummary == newPlanSummary) {
+        // Nothing better is available. The cached plan has made progress, so keep it.
+        LOGV2_DEBUG(5999209,
+                    1,
+                    "Replanning during execution selected the cached plan again",
+                    "query"_attr = redact(_canonicalQuery->toStringShort()),
+                    "planSummary"_attr = oldPlanSummary);
+        return PlanStage::NEED_TIME;
+    }
+
+    LOGV2_DEBUG(5999208,
+                1,
+                "Switching plans during execution",
+                "query"_attr = redact(_canonicalQuery->toStringShort()),
+                "oldPlanSummary"_attr = oldPlanSummary,
+                "newPlanSummary"_attr = newPlanSummary,
+                "resultsReturned"_attr = _returnedRecordIds.size());
+
+    // The data no longer matches the cached plan; make sure its entry is not used again.
+    PlanCache* cache = CollectionQueryInfo::get(collection()).getPlanCache();
+    cache->deactivate(*_canonicalQuery);
+
+    _children.clear();
+    _children.emplace_back(std::move(newRoot));
+    _replannedQs = std::move(newQs);
+
+    _specificStats.replannedMidExecution = true;
+    _specificStats.replanReason = str::stream()
+        << "cached plan was less efficient than expected during execution: expected "
+        << _numResults << " results every " << _decisionWorks << " works but it produced "
+        << _windowResults << " in " << _windowWorks << " works after returning "
+        << _returnedRecordIds.size() << " results";
+    return PlanStage::NEED_TIME;
+}
+
 bool CachedPlanStage::isEOF() {
     return _results.empty() && child()->isEOF();
 }
@@ -285,11 +417,37 @@ PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     if (!_results.empty()) {
         *out = _results.front();
         _results.pop();
+        trackReturnedResult(*out);
         return PlanStage::ADVANCED;
     }
 
+    if (_monitorMidExecution && _windowWorks >= _maxWorksBeforeReplan) {
+        if (_windowResults < _numResults) {
+            return replanMidExecution(out);
+        }
+        _windowWorks = 0;
+        _windowResults = 0;
+    }
+
     // Nothing left in trial period buffer.
-    return child()->work(out);
+    const auto state = child()->work(out);
+
+    if (_specificStats.replannedMidExecution && PlanStage::ADVANCED == state) {
+        // Drop the results which the replaced plan has returned already.
+        WorkingSetMember* member = _ws->get(*out);
+        if (member->hasRecordId() && _returnedRecordIds.count(member->recordId)) {
+            _ws->free(*out);
+            ++_specificStats.dupsDropped;
+            return PlanStage::NEED_TIME;
+        }
+    } else if (_monitorMidExecution) {
+        ++_windowWorks;
+        if (PlanStage::ADVANCED == state) {
+            ++_windowResults;
+            trackReturnedResult(*out);
+        }
+    }
+    return state;
 }
 
 std::unique_ptr<PlanStageStats> CachedPlanStage::getStats() {
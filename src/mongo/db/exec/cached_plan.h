@@ -39,6 +39,7 @@
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/record_id.h"
+#include "mongo/stdx/unordered_set.h"
 
 namespace mongo {
 
@@ -49,6 +50,13 @@ class PlanYieldPolicy;
  * high, the plan cache entry is deactivated and we use multi-planning to select an entirely new
  * winning plan. This process is called "replanning".
  *
+ * A cached plan which survives its trial period keeps being monitored while it runs. If, over any
+ * window of the same length as the trial period, it again falls far short of the works-per-result
+ * recorded in the plan cache, the query is replanned once more in place. Because results may
+ * already have been returned by then, this is only done for queries whose output does not depend
+ * on the order in which results are produced, and results the new plan produces a second time are
+ * dropped by record id.
+ *
  * This stage requires all indices to stay intact during the trial period so that replanning can
  * occur with the set of indices in 'params'. As a future improvement, we could instead refresh the
  * list of indices in 'params' prior to replanning, and thus avoid inheriting from
@@ -109,6 +117,31 @@ private:
      */
     Status tryYield(PlanYieldPolicy* yieldPolicy);
 
+    /**
+     * Returns true if the query may switch to a different plan after the cached plan has already
+     * returned some of its results, i.e. its output is insensitive to the order in which results
+     * are produced.
+     */
+    bool canReplanMidExecution() const;
+
+    /**
+     * Remembers the result 'id' which is about to be returned, so that it can be dropped if a plan
+     * selected by mid-execution replanning produces it again. Stops monitoring the cached plan if
+     * the result cannot be identified or too many results have been returned.
+     */
+    void trackReturnedResult(WorkingSetID id);
+
+    /**
+     * Replaces the cached plan, which has already started returning results, with a freshly
+     * selected plan. The candidate plans are run for the same bounded trial period as when the
+     * query is first multi-planned, yielding according to the policy of the enclosing executor,
+     * which this stage must therefore be the root of.
+     *
+     * Returns NEED_TIME once the child has been replaced or the cached plan has been kept, and
+     * NEED_YIELD if replanning hit a write conflict, in which case the cached plan is kept.
+     */
+    StageState replanMidExecution(WorkingSetID* out);
+
     // Not owned.
     WorkingSet* _ws;
 
@@ -128,6 +161,26 @@ private:
     // Any results produced during trial period execution are kept here.
     std::queue<WorkingSetID> _results;
 
+    // Copied from the trial period, these define how many results the cached plan must produce in
+    // every window of '_maxWorksBeforeReplan' work cycles while it is monitored.
+    size_t _maxWorksBeforeReplan = 0;
+    size_t _numResults = 0;
+
+    // The yield policy of the executor running this stage, which mid-execution replanning yields
+    // with. Set by pickBestPlan().
+    PlanYieldPolicy* _yieldPolicy = nullptr;
+
+    // True while the cached plan is being monitored for mid-execution replanning.
+    bool _monitorMidExecution = false;
+
+    // Work cycles and results of the cached plan in the current monitoring window.
+    size_t _windowWorks = 0;
+    size_t _windowResults = 0;
+
+    // The record ids of all results returned while the cached plan was monitored. After a
+    // mid-execution replan, results of the new plan found here are dropped.
+    stdx::unordered_set<RecordId, RecordId::Hasher> _returnedRecordIds;
+
     // Stats
     CachedPlanStats _specificStats;
 };
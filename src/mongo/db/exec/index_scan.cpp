@@ -42,6 +42,7 @@
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_knobs_gen.h"
 
 namespace {
 
@@ -123,6 +124,13 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
                 _forward,
                 _startKeyInclusive);
             return _indexCursor->seek(keyStringForSeek);
+        } else if (initPointLookup()) {
+            return _indexCursor->seek(IndexEntryComparison::makeKeyStringFromBSONKeyForSeek(
+                _pointStartKey,
+                indexAccessMethod()->getSortedDataInterface()->getKeyStringVersion(),
+                indexAccessMethod()->getSortedDataInterface()->getOrdering(),
+                _forward,
+                true));
         } else {
             _checker.reset(new IndexBoundsChecker(&_bounds, _keyPattern, _direction));
 
@@ -137,6 +145,88 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
     }
 }
 
+bool IndexScan::initPointLookup() {
+    const auto minPointLookups = internalQueryIndexScanMinPointLookups.load();
+    if (minPointLookups == 0) {
+        return false;
+    }
+
+    // Exactly one field may have several intervals, all of which must be points. Every other
+    // field must be a single point, and once a field spans all values so must all later fields,
+    // so that the keys matching each point form a contiguous range of the index.
+    boost::optional<size_t> pointField;
+    bool seenAllValues = false;
+    for (size_t fieldNo = 0; fieldNo < _bounds.fields.size(); ++fieldNo) {
+        const auto& intervals = _bounds.fields[fieldNo].intervals;
+        if (intervals.size() > 1) {
+            if (pointField || seenAllValues ||
+                !std::all_of(intervals.begin(), intervals.end(), [](auto&& interval) {
+                    return interval.isPoint();
+                })) {
+                return false;
+            }
+            pointField = fieldNo;
+        } else if (intervals.size() == 1 && intervals[0].isPoint()) {
+            if (seenAllValues) {
+                return false;
+            }
+        } else if (intervals.size() == 1 &&
+                   (intervals[0].isMinToMax() || intervals[0].isMaxToMin()) &&
+                   intervals[0].startInclusive && intervals[0].endInclusive) {
+            seenAllValues = true;
+        } else {
+            return false;
+        }
+    }
+
+    if (!pointField ||
+        _bounds.fields[*pointField].intervals.size() < static_cast<size_t>(minPointLookups)) {
+        return false;
+    }
+
+    _pointLookup = true;
+    _specificStats.pointLookup = true;
+    _pointField = *pointField;
+    _pointIndex = 0;
+    buildPointKeys();
+    return true;
+}
+
+void IndexScan::buildPointKeys() {
+    // The intervals are ordered along the direction of the scan, so the start of each interval is
+    // the first key the cursor reaches.
+    BSONObjBuilder startBob;
+    BSONObjBuilder endBob;
+    for (size_t fieldNo = 0; fieldNo < _bounds.fields.size(); ++fieldNo) {
+        const auto& interval = _bounds.fields[fieldNo]
+                                   .intervals[fieldNo == _pointField ? _pointIndex : 0];
+        startBob.append(interval.start);
+        endBob.append(interval.end);
+    }
+    _pointStartKey = startBob.obj();
+    _pointEndKey = endBob.obj();
+}
+
+IndexBoundsChecker::KeyState IndexScan::checkPointLookupKey(const BSONObj& key) {
+    const auto ordering = indexAccessMethod()->getSortedDataInterface()->getOrdering();
+    const auto numPoints = _bounds.fields[_pointField].intervals.size();
+    while (sgn(key.woCompare(_pointEndKey, ordering, /*compareFieldNames*/ false)) * _direction >
+           0) {
+        // The cursor has passed every key of the current point, so move on to the first point it
+        // has not passed yet. Points in between have no keys in the index.
+        if (++_pointIndex == numPoints) {
+            return IndexBoundsChecker::DONE;
+        }
+        buildPointKeys();
+    }
+
+    if (sgn(key.woCompare(_pointStartKey, ordering, /*compareFieldNames*/ false)) * _direction <
+        0) {
+        return IndexBoundsChecker::MUST_ADVANCE;
+    }
+    return IndexBoundsChecker::VALID;
+}
+
 PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     // Get the next kv pair from the index, if any.
     boost::optional<IndexKeyEntry> kv;
@@ -150,6 +240,15 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
                 break;
             case NEED_SEEK:
                 ++_specificStats.seeks;
+                if (_pointLookup) {
+                    kv = _indexCursor->seek(IndexEntryComparison::makeKeyStringFromBSONKeyForSeek(
+                        _pointStartKey,
+                        indexAccessMethod()->getSortedDataInterface()->getKeyStringVersion(),
+                        indexAccessMethod()->getSortedDataInterface()->getOrdering(),
+                        _forward,
+                        true));
+                    break;
+                }
                 kv = _indexCursor->seek(IndexEntryComparison::makeKeyStringFromSeekPointForSeek(
                     _seekPoint,
                     indexAccessMethod()->getSortedDataInterface()->getKeyStringVersion(),
@@ -187,6 +286,21 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
         ++_specificStats.keysExamined;
     }
 
+    if (kv && _pointLookup) {
+        switch (checkPointLookupKey(kv->key)) {
+            case IndexBoundsChecker::VALID:
+                break;
+
+            case IndexBoundsChecker::DONE:
+                kv = boost::none;
+                break;
+
+            case IndexBoundsChecker::MUST_ADVANCE:
+                _scanState = NEED_SEEK;
+                return PlanStage::NEED_TIME;
+        }
+    }
+
     if (kv && _checker) {
         switch (_checker->checkKey(kv->key, &_seekPoint)) {
             case IndexBoundsChecker::VALID:
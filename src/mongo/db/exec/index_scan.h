@@ -140,6 +140,23 @@ private:
      */
     boost::optional<IndexKeyEntry> initIndexScan();
 
+    /**
+     * Returns true if the bounds can be scanned as a list of point lookups, and sets up the keys
+     * of the first point if so.
+     */
+    bool initPointLookup();
+
+    /**
+     * Builds the start and end keys of the point at '_pointIndex'.
+     */
+    void buildPointKeys();
+
+    /**
+     * Checks the examined 'key' of a point lookup scan against the current point, moving on to
+     * later points if the cursor has passed it.
+     */
+    IndexBoundsChecker::KeyState checkPointLookupKey(const BSONObj& key);
+
     // The WorkingSet we fill with results.  Not owned by us.
     WorkingSet* const _workingSet;
 
@@ -199,6 +216,23 @@ private:
     bool _startKeyInclusive;
     // Is the end key included in the range?
     bool _endKeyInclusive;
+
+    //
+    // 3) If the bounds consist of a long list of point intervals on one field, e.g. for a large
+    //    $in, then the scan looks up the points in order. The cursor is only re-positioned when
+    //    the next point is not adjacent to the keys already read, and each key is compared
+    //    against the current point alone. The keys of a point are only built once the scan
+    //    reaches it. In this case _pointLookup is true.
+    //
+    bool _pointLookup = false;
+
+    // The field whose intervals are the points to look up, and the point currently scanned.
+    size_t _pointField = 0;
+    size_t _pointIndex = 0;
+
+    // The first and last keys, both inclusive, which match the current point.
+    BSONObj _pointStartKey;
+    BSONObj _pointEndKey;
 };
 
 }  // namespace mongo
@@ -224,6 +224,14 @@ struct CachedPlanStats : public SpecificStats {
     }
 
     std::optional<std::string> replanReason;
+
+    // True if the cached plan was replaced after it had already started producing results, rather
+    // than during its trial period.
+    bool replannedMidExecution = false;
+
+    // Results produced by the replacement plan which had already been returned by the cached plan
+    // and were therefore dropped.
+    size_t dupsDropped = 0;
 };
 
 struct CollectionScanStats : public SpecificStats {
@@ -471,7 +479,8 @@ struct IndexScanStats : public SpecificStats {
           dupsTested(0),
           dupsDropped(0),
           keysExamined(0),
-          seeks(0) {}
+          seeks(0),
+          pointLookup(false) {}
 
     std::unique_ptr<SpecificStats> clone() const final {
         auto specific = std::make_unique<IndexScanStats>(*this);
@@ -533,6 +542,10 @@ struct IndexScanStats : public SpecificStats {
 
     // Number of times the index cursor is re-positioned during the execution of the scan.
     size_t seeks;
+
+    // True if the bounds were scanned as a list of point lookups rather than checking each key
+    // against the bounds.
+    bool pointLookup;
 };
 
 struct LimitStats : public SpecificStats {
@@ -883,6 +883,32 @@ std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopy(bool isSmp) {
     return std::unique_ptr<RuntimeEnvironment>(new RuntimeEnvironment(*this));
 }
 
+std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeDeepCopy() const {
+    // With intra-query parallelism enabled the slot values are shared by all the threads, so the
+    // copy could not be modified anyway.
+    invariant(!_isSmp);
+
+    auto env = std::make_unique<RuntimeEnvironment>();
+    env->_state->slots = _state->slots;
+    env->_state->typeTags = _state->typeTags;
+    env->_state->owned = _state->owned;
+    env->_state->vals.reserve(_state->vals.size());
+    for (size_t idx = 0; idx < _state->vals.size(); ++idx) {
+        if (_state->owned[idx]) {
+            auto [tag, val] = value::copyValue(_state->typeTags[idx], _state->vals[idx]);
+            env->_state->typeTags[idx] = tag;
+            env->_state->vals.push_back(val);
+        } else {
+            env->_state->vals.push_back(_state->vals[idx]);
+        }
+    }
+
+    for (auto&& [name, slot] : env->_state->slots) {
+        env->emplaceAccessor(slot.first, slot.second);
+    }
+    return env;
+}
+
 void RuntimeEnvironment::debugString(StringBuilder* builder) {
     using namespace std::literals;
 
@@ -157,6 +157,13 @@ public:
      */
     std::unique_ptr<RuntimeEnvironment> makeCopy(bool isSmp);
 
+    /**
+     * Make an independent copy of this environment. Unlike 'makeCopy()', the new environment gets
+     * its own copy of the slot values, so resetting a slot in one environment is not visible in
+     * the other. Owned values are deep copied. The slots keep their SlotIds.
+     */
+    std::unique_ptr<RuntimeEnvironment> makeDeepCopy() const;
+
     /**
      * Dumps all the slots currently defined in this environment into the given string builder.
      */
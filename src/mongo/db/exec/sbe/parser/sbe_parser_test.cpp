@@ -364,6 +364,7 @@ protected:
                             stage_builder::makeFunction(
                                 "max", sbe::makeE<sbe::EVariable>(sbe::value::SlotId{1}))),
                 boost::none, /* optional collator slot */
+                true, /* allowDiskUse */
                 planNodeId),
             // GROUP with a collator slot.
             sbe::makeS<sbe::HashAggStage>(
@@ -376,6 +377,7 @@ protected:
                             stage_builder::makeFunction(
                                 "max", sbe::makeE<sbe::EVariable>(sbe::value::SlotId{1}))),
                 sbe::value::SlotId{4}, /* optional collator slot */
+                true, /* allowDiskUse */
                 planNodeId),
             // LIMIT
             sbe::makeS<sbe::LimitSkipStage>(
@@ -424,6 +426,7 @@ protected:
                                            sbe::makeSV(1, 2) /* inner conditions */,
                                            sbe::makeSV(5, 6) /* inner projections */,
                                            boost::none, /* optional collator slot */
+                                           true /* allowDiskUse */,
                                            planNodeId),
             // HJOIN with a collator slot.
             sbe::makeS<sbe::HashJoinStage>(sbe::makeS<sbe::CoScanStage>(planNodeId),
@@ -433,6 +436,7 @@ protected:
                                            sbe::makeSV(1, 2) /* inner conditions */,
                                            sbe::makeSV(5, 6) /* inner projections */,
                                            sbe::value::SlotId{7}, /* optional collator slot */
+                                           true /* allowDiskUse */,
                                            planNodeId),
             // FILTER
             sbe::makeS<sbe::FilterStage<false>>(
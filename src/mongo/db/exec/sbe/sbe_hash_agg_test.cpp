@@ -33,14 +33,17 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
 
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/idl/server_parameter_test_util.h"
 
 namespace mongo::sbe {
 
 using HashAggStageTest = PlanStageTestFixture;
+using HashAggStageSpillTest = PlanStageSpillTestFixture;
 
 TEST_F(HashAggStageTest, HashAggMinMaxTest) {
     using namespace std::literals;
@@ -82,6 +85,7 @@ TEST_F(HashAggStageTest, HashAggMinMaxTest) {
                    stage_builder::makeFunction(
                        "collMax", collExpr->clone(), makeE<EVariable>(scanSlot))),
             boost::none,
+            false /* allowDiskUse */,
             kEmptyPlanNodeId);
 
         auto outSlot = generateSlotId();
@@ -136,6 +140,7 @@ TEST_F(HashAggStageTest, HashAggAddToSetTest) {
                    stage_builder::makeFunction(
                        "collAddToSet", std::move(collExpr), makeE<EVariable>(scanSlot))),
             boost::none,
+            false /* allowDiskUse */,
             kEmptyPlanNodeId);
 
         return std::make_pair(hashAggSlot, std::move(hashAggStage));
@@ -220,6 +225,7 @@ TEST_F(HashAggStageTest, HashAggCollationTest) {
                                                makeE<EConstant>(value::TypeTags::NumberInt64,
                                                                 value::bitcastFrom<int64_t>(1)))),
                                     boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                    false /* allowDiskUse */,
                                     kEmptyPlanNodeId);
 
             return std::make_pair(countsSlot, std::move(hashAggStage));
@@ -280,4 +286,199 @@ TEST_F(HashAggStageTest, HashAggCollationTest) {
     }
 }
 
+TEST_F(HashAggStageTest, HashAggFailsWhenMemoryLimitExceededWithoutDiskUse) {
+    // With a one byte budget, the hash table is full as soon as the first group is created.
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySlotBasedExecutionHashAggMaxMemoryBytes", 1LL);
+
+    BSONArrayBuilder bab;
+    bab.append("a").append("a").append("b");
+    auto [inputTag, inputVal] = stage_builder::makeValue(bab.arr());
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    inputGuard.reset();
+    auto [scanSlot, scanStage] = generateVirtualScan(inputTag, inputVal);
+
+    auto countsSlot = generateSlotId();
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlot),
+        makeEM(countsSlot,
+               stage_builder::makeFunction(
+                   "sum",
+                   makeE<EConstant>(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(1)))),
+        boost::none,
+        false /* allowDiskUse */,
+        kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    ASSERT_THROWS_CODE(prepareTree(ctx.get(), stage.get(), countsSlot),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(HashAggStageSpillTest, HashAggSpillsNewGroupsWhenMemoryLimitExceeded) {
+    // With a one byte budget, only the first group is kept in memory and the rows of all other
+    // groups are spilled.
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySlotBasedExecutionHashAggMaxMemoryBytes", 1LL);
+
+    // The input consists of [key, value] pairs, with 20 rows for each of the keys 0 to 9.
+    const size_t kNumKeys = 10;
+    const size_t kRowsPerKey = 20;
+    BSONArrayBuilder bab;
+    for (size_t i = 0; i < kNumKeys * kRowsPerKey; ++i) {
+        bab.append(BSON_ARRAY(static_cast<int>(i % kNumKeys) << static_cast<int>(i)));
+    }
+    auto [inputTag, inputVal] = stage_builder::makeValue(bab.arr());
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    inputGuard.reset();
+    auto [scanSlots, scanStage] = generateVirtualScanMulti(2, inputTag, inputVal);
+
+    auto sumSlot = generateSlotId();
+    auto countSlot = generateSlotId();
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlots[0]),
+        makeEM(sumSlot,
+               stage_builder::makeFunction("sum", makeE<EVariable>(scanSlots[1])),
+               countSlot,
+               stage_builder::makeFunction(
+                   "sum",
+                   makeE<EConstant>(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(1)))),
+        boost::none,
+        true /* allowDiskUse */,
+        kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessors =
+        prepareTree(ctx.get(), stage.get(), makeSV(scanSlots[0], sumSlot, countSlot));
+    auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    // Every key is returned exactly once, with the sum and count of all of its rows.
+    auto resultsView = value::getArrayView(resultsVal);
+    ASSERT_EQ(resultsView->size(), kNumKeys);
+
+    std::set<int64_t> seenKeys;
+    for (size_t i = 0; i < resultsView->size(); ++i) {
+        auto row = value::getArrayView(resultsView->getAt(i).second);
+        auto [keyTag, keyVal] = row->getAt(0);
+        auto key = value::numericCast<int64_t>(keyTag, keyVal);
+        ASSERT_TRUE(seenKeys.insert(key).second);
+
+        // The values of key 'k' are k, k + 10, ..., k + 190.
+        const int64_t expectedSum =
+            kRowsPerKey * key + kNumKeys * kRowsPerKey * (kRowsPerKey - 1) / 2;
+        auto [sumTag, sumVal] = row->getAt(1);
+        ASSERT_TRUE(valueEquals(sumTag,
+                                sumVal,
+                                value::TypeTags::NumberInt64,
+                                value::bitcastFrom<int64_t>(expectedSum)));
+
+        auto [countTag, countVal] = row->getAt(2);
+        ASSERT_TRUE(valueEquals(countTag,
+                                countVal,
+                                value::TypeTags::NumberInt64,
+                                value::bitcastFrom<int64_t>(kRowsPerKey)));
+    }
+
+    // Rows of keys which share a partition are spilled again when that partition is aggregated.
+    auto stats = static_cast<const HashAggStats*>(stage->getSpecificStats());
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_EQ(stats->spilledGroups, kNumKeys - 1);
+    ASSERT_GTE(stats->spilledRecords, (kNumKeys - 1) * kRowsPerKey);
+
+    // Closing the stage drops its spill table.
+    stage->close();
+}
+
+TEST_F(HashAggStageSpillTest, HashAggSpillsOverCollectionScanWithoutTouchingItsSnapshot) {
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySlotBasedExecutionHashAggMaxMemoryBytes", 1LL);
+
+    // Every row carries a large string, so that the spilled rows are written out several times
+    // while the collection scan is still open. With a one byte budget, every partition holds more
+    // groups than fit in memory and is split again.
+    const size_t kNumKeys = 100;
+    const size_t kRowsPerKey = 4;
+    const std::string padding(4 * 1024, 'x');
+    std::vector<BSONObj> docs;
+    for (size_t i = 0; i < kNumKeys * kRowsPerKey; ++i) {
+        docs.push_back(BSON("_id" << static_cast<int>(i) << "a" << static_cast<int>(i % kNumKeys)
+                                  << "b" << static_cast<int>(i) << "c" << padding));
+    }
+    auto collUuid = createCollection(NamespaceString{"test.hashAggSpill"}, docs);
+    auto [scanSlots, scanStage] = generateCollScan(collUuid, {"a", "b", "c"});
+
+    auto sumSlot = generateSlotId();
+    auto countSlot = generateSlotId();
+    auto maxSlot = generateSlotId();
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlots[0]),
+        makeEM(sumSlot,
+               stage_builder::makeFunction("sum", makeE<EVariable>(scanSlots[1])),
+               countSlot,
+               stage_builder::makeFunction(
+                   "sum",
+                   makeE<EConstant>(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(1))),
+               maxSlot,
+               stage_builder::makeFunction("max", makeE<EVariable>(scanSlots[2]))),
+        boost::none,
+        true /* allowDiskUse */,
+        kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    stage->prepare(*ctx);
+    stage->attachToOperationContext(opCtx());
+    auto recoveryUnit = opCtx()->recoveryUnit();
+    const auto snapshotId = recoveryUnit->getSnapshotId();
+
+    stage->open(false);
+    auto resultAccessors = std::vector<value::SlotAccessor*>{stage->getAccessor(*ctx, scanSlots[0]),
+                                                             stage->getAccessor(*ctx, sumSlot),
+                                                             stage->getAccessor(*ctx, countSlot),
+                                                             stage->getAccessor(*ctx, maxSlot)};
+    auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    // The spilled rows were written through a recovery unit of their own, so the storage
+    // transaction the scan read from was neither committed nor abandoned.
+    ASSERT_EQ(opCtx()->recoveryUnit(), recoveryUnit);
+    ASSERT_EQ(recoveryUnit->getSnapshotId(), snapshotId);
+
+    auto resultsView = value::getArrayView(resultsVal);
+    ASSERT_EQ(resultsView->size(), kNumKeys);
+
+    std::set<int64_t> seenKeys;
+    for (size_t i = 0; i < resultsView->size(); ++i) {
+        auto row = value::getArrayView(resultsView->getAt(i).second);
+        auto [keyTag, keyVal] = row->getAt(0);
+        auto key = value::numericCast<int64_t>(keyTag, keyVal);
+        ASSERT_TRUE(seenKeys.insert(key).second);
+
+        // The values of key 'k' are k, k + 100, k + 200 and k + 300.
+        const int64_t expectedSum =
+            kRowsPerKey * key + kNumKeys * kRowsPerKey * (kRowsPerKey - 1) / 2;
+        auto [sumTag, sumVal] = row->getAt(1);
+        ASSERT_EQ(value::numericCast<int64_t>(sumTag, sumVal), expectedSum);
+
+        auto [countTag, countVal] = row->getAt(2);
+        ASSERT_EQ(value::numericCast<int64_t>(countTag, countVal), kRowsPerKey);
+
+        auto [maxTag, maxVal] = row->getAt(3);
+        ASSERT_TRUE(value::isString(maxTag));
+        ASSERT_EQ(value::getStringView(maxTag, maxVal), padding);
+    }
+
+    auto stats = static_cast<const HashAggStats*>(stage->getSpecificStats());
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_EQ(stats->spilledGroups, kNumKeys - 1);
+    ASSERT_GTE(stats->spilledRecords, (kNumKeys - 1) * kRowsPerKey);
+
+    stage->close();
+}
+
 }  // namespace mongo::sbe
@@ -33,14 +33,17 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
 
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/idl/server_parameter_test_util.h"
 
 namespace mongo::sbe {
 
 using HashJoinStageTest = PlanStageTestFixture;
+using HashJoinStageSpillTest = PlanStageSpillTestFixture;
 
 TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     using namespace std::literals;
@@ -79,6 +82,7 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
                                      makeSV(innerCondSlot),
                                      makeSV(),
                                      boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                     false /* allowDiskUse */,
                                      kEmptyPlanNodeId);
 
             return std::make_pair(makeSV(innerCondSlot, outerCondSlot), std::move(hashJoinStage));
@@ -136,4 +140,197 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     }
 }
 
+TEST_F(HashJoinStageTest, HashJoinFailsWhenMemoryLimitExceededWithoutDiskUse) {
+    // With a one byte budget, the hash table is full as soon as the first outer row is inserted.
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes", 1LL);
+
+    auto [innerTag, innerVal] = stage_builder::makeValue(BSON_ARRAY("a"
+                                                                    << "b"));
+    value::ValueGuard innerGuard{innerTag, innerVal};
+    auto [outerTag, outerVal] = stage_builder::makeValue(BSON_ARRAY("a"
+                                                                    << "b"));
+    value::ValueGuard outerGuard{outerTag, outerVal};
+
+    outerGuard.reset();
+    auto [outerCondSlot, outerStage] = generateVirtualScan(outerTag, outerVal);
+    innerGuard.reset();
+    auto [innerCondSlot, innerStage] = generateVirtualScan(innerTag, innerVal);
+
+    auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                      std::move(innerStage),
+                                      makeSV(outerCondSlot),
+                                      makeSV(),
+                                      makeSV(innerCondSlot),
+                                      makeSV(),
+                                      boost::none,
+                                      false /* allowDiskUse */,
+                                      kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    ASSERT_THROWS_CODE(prepareTree(ctx.get(), stage.get(), makeSV(innerCondSlot, outerCondSlot)),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(HashJoinStageSpillTest, HashJoinPartitionsBothSidesWhenMemoryLimitExceeded) {
+    // With a one byte budget, the join spills as soon as the first outer row is inserted, and all
+    // rows of both sides are joined partition by partition from disk.
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes", 1LL);
+
+    // The outer side consists of [key, value] pairs with two rows for each of the keys 0 to 9, and
+    // the inner side of [key, key + 100] pairs for the keys 0 to 14.
+    const size_t kNumOuterKeys = 10;
+    const size_t kOuterRowsPerKey = 2;
+    const size_t kNumInnerKeys = 15;
+    BSONArrayBuilder outerBab;
+    for (size_t i = 0; i < kNumOuterKeys * kOuterRowsPerKey; ++i) {
+        outerBab.append(BSON_ARRAY(static_cast<int>(i % kNumOuterKeys) << static_cast<int>(i)));
+    }
+    BSONArrayBuilder innerBab;
+    for (size_t i = 0; i < kNumInnerKeys; ++i) {
+        innerBab.append(BSON_ARRAY(static_cast<int>(i) << static_cast<int>(i + 100)));
+    }
+    auto [outerTag, outerVal] = stage_builder::makeValue(outerBab.arr());
+    value::ValueGuard outerGuard{outerTag, outerVal};
+    auto [innerTag, innerVal] = stage_builder::makeValue(innerBab.arr());
+    value::ValueGuard innerGuard{innerTag, innerVal};
+
+    outerGuard.reset();
+    auto [outerSlots, outerStage] = generateVirtualScanMulti(2, outerTag, outerVal);
+    innerGuard.reset();
+    auto [innerSlots, innerStage] = generateVirtualScanMulti(2, innerTag, innerVal);
+
+    auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                      std::move(innerStage),
+                                      makeSV(outerSlots[0]),
+                                      makeSV(outerSlots[1]),
+                                      makeSV(innerSlots[0]),
+                                      makeSV(innerSlots[1]),
+                                      boost::none,
+                                      true /* allowDiskUse */,
+                                      kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessors = prepareTree(
+        ctx.get(), stage.get(), makeSV(outerSlots[0], outerSlots[1], innerSlots[0], innerSlots[1]));
+    auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    // Every outer row is returned exactly once, joined with the inner row of its key.
+    auto resultsView = value::getArrayView(resultsVal);
+    ASSERT_EQ(resultsView->size(), kNumOuterKeys * kOuterRowsPerKey);
+
+    std::set<int64_t> seenOuterValues;
+    for (size_t i = 0; i < resultsView->size(); ++i) {
+        auto row = value::getArrayView(resultsView->getAt(i).second);
+        auto [outerKeyTag, outerKeyVal] = row->getAt(0);
+        auto [outerValueTag, outerValueVal] = row->getAt(1);
+        auto [innerKeyTag, innerKeyVal] = row->getAt(2);
+        auto [innerValueTag, innerValueVal] = row->getAt(3);
+
+        auto key = value::numericCast<int64_t>(outerKeyTag, outerKeyVal);
+        auto outerValue = value::numericCast<int64_t>(outerValueTag, outerValueVal);
+        ASSERT_EQ(outerValue % static_cast<int64_t>(kNumOuterKeys), key);
+        ASSERT_TRUE(seenOuterValues.insert(outerValue).second);
+        ASSERT_EQ(value::numericCast<int64_t>(innerKeyTag, innerKeyVal), key);
+        ASSERT_EQ(value::numericCast<int64_t>(innerValueTag, innerValueVal), key + 100);
+    }
+
+    auto stats = static_cast<const HashJoinStats*>(stage->getSpecificStats());
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_EQ(stats->spilledBuildRecords, kNumOuterKeys * kOuterRowsPerKey);
+    ASSERT_EQ(stats->spilledProbeRecords, kNumInnerKeys);
+
+    // Closing the stage drops its spill tables.
+    stage->close();
+}
+
+TEST_F(HashJoinStageSpillTest, HashJoinSpillsOverCollectionScansWithoutTouchingTheirSnapshot) {
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes", 1LL);
+
+    // Every row carries a large string, so that the rows of both sides are written out several
+    // times while the scan of that side is still open. The outer collection holds three documents
+    // for each of the keys 0 to 99, and the inner collection one document for each of the keys 0
+    // to 299.
+    const size_t kNumOuterKeys = 100;
+    const size_t kOuterRowsPerKey = 3;
+    const size_t kNumInnerKeys = 300;
+    const std::string padding(4 * 1024, 'x');
+    std::vector<BSONObj> outerDocs;
+    for (size_t i = 0; i < kNumOuterKeys * kOuterRowsPerKey; ++i) {
+        outerDocs.push_back(BSON("_id" << static_cast<int>(i) << "a"
+                                       << static_cast<int>(i % kNumOuterKeys) << "b"
+                                       << static_cast<int>(i) << "c" << padding));
+    }
+    std::vector<BSONObj> innerDocs;
+    for (size_t i = 0; i < kNumInnerKeys; ++i) {
+        innerDocs.push_back(BSON("_id" << static_cast<int>(i) << "a" << static_cast<int>(i) << "d"
+                                       << padding));
+    }
+    auto outerUuid = createCollection(NamespaceString{"test.hashJoinSpillOuter"}, outerDocs);
+    auto innerUuid = createCollection(NamespaceString{"test.hashJoinSpillInner"}, innerDocs);
+    auto [outerSlots, outerStage] = generateCollScan(outerUuid, {"a", "b", "c"});
+    auto [innerSlots, innerStage] = generateCollScan(innerUuid, {"a", "d"});
+
+    auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                      std::move(innerStage),
+                                      makeSV(outerSlots[0]),
+                                      makeSV(outerSlots[1], outerSlots[2]),
+                                      makeSV(innerSlots[0]),
+                                      makeSV(innerSlots[1]),
+                                      boost::none,
+                                      true /* allowDiskUse */,
+                                      kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    stage->prepare(*ctx);
+    stage->attachToOperationContext(opCtx());
+    auto recoveryUnit = opCtx()->recoveryUnit();
+    const auto snapshotId = recoveryUnit->getSnapshotId();
+
+    stage->open(false);
+    std::vector<value::SlotAccessor*> resultAccessors;
+    for (auto slot : makeSV(outerSlots[0], outerSlots[1], outerSlots[2], innerSlots[1])) {
+        resultAccessors.push_back(stage->getAccessor(*ctx, slot));
+    }
+    auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    // The spilled rows were written through a recovery unit of their own, so the storage
+    // transaction the scans read from was neither committed nor abandoned.
+    ASSERT_EQ(opCtx()->recoveryUnit(), recoveryUnit);
+    ASSERT_EQ(recoveryUnit->getSnapshotId(), snapshotId);
+
+    // Every outer row is returned exactly once, joined with the inner row of its key.
+    auto resultsView = value::getArrayView(resultsVal);
+    ASSERT_EQ(resultsView->size(), kNumOuterKeys * kOuterRowsPerKey);
+
+    std::set<int64_t> seenOuterValues;
+    for (size_t i = 0; i < resultsView->size(); ++i) {
+        auto row = value::getArrayView(resultsView->getAt(i).second);
+        auto [keyTag, keyVal] = row->getAt(0);
+        auto [outerValueTag, outerValueVal] = row->getAt(1);
+        auto key = value::numericCast<int64_t>(keyTag, keyVal);
+        auto outerValue = value::numericCast<int64_t>(outerValueTag, outerValueVal);
+        ASSERT_EQ(outerValue % static_cast<int64_t>(kNumOuterKeys), key);
+        ASSERT_TRUE(seenOuterValues.insert(outerValue).second);
+
+        for (size_t idx : {2, 3}) {
+            auto [paddingTag, paddingVal] = row->getAt(idx);
+            ASSERT_TRUE(value::isString(paddingTag));
+            ASSERT_EQ(value::getStringView(paddingTag, paddingVal), padding);
+        }
+    }
+
+    auto stats = static_cast<const HashJoinStats*>(stage->getSpecificStats());
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_EQ(stats->spilledBuildRecords, kNumOuterKeys * kOuterRowsPerKey);
+    ASSERT_EQ(stats->spilledProbeRecords, kNumInnerKeys);
+
+    stage->close();
+}
+
 }  // namespace mongo::sbe
@@ -36,7 +36,12 @@
 
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 
-
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/exec/sbe/stages/scan.h"
+#include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/db/storage/write_unit_of_work.h"
 #include "mongo/logv2/log.h"
 
 namespace mongo::sbe {
@@ -190,4 +195,50 @@ void PlanStageTestFixture::runTestMulti(int32_t numInputSlots,
     assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
 }
 
+void PlanStageSpillTestFixture::setUp() {
+    PlanStageTestFixture::setUp();
+    auto service = getServiceContext();
+    repl::ReplicationCoordinator::set(service,
+                                      std::make_unique<repl::ReplicationCoordinatorMock>(service));
+}
+
+CollectionUUID PlanStageSpillTestFixture::createCollection(const NamespaceString& nss,
+                                                           const std::vector<BSONObj>& docs) {
+    AutoGetDb autoDb(opCtx(), nss.db(), MODE_X);
+    WriteUnitOfWork wuow(opCtx());
+    auto collection = autoDb.ensureDbExists()->createCollection(opCtx(), nss);
+    ASSERT(collection);
+    for (auto&& doc : docs) {
+        ASSERT_OK(collection->insertDocument(opCtx(), InsertStatement(doc), nullptr));
+    }
+    wuow.commit();
+    return collection->uuid();
+}
+
+std::pair<value::SlotVector, std::unique_ptr<PlanStage>>
+PlanStageSpillTestFixture::generateCollScan(CollectionUUID collUuid,
+                                            std::vector<std::string> fields) {
+    value::SlotVector slots;
+    for (size_t idx = 0; idx < fields.size(); ++idx) {
+        slots.push_back(generateSlotId());
+    }
+
+    auto stage = makeS<ScanStage>(collUuid,
+                                  boost::none /* recordSlot */,
+                                  boost::none /* recordIdSlot */,
+                                  boost::none /* snapshotIdSlot */,
+                                  boost::none /* indexIdSlot */,
+                                  boost::none /* indexKeySlot */,
+                                  boost::none /* indexKeyPatternSlot */,
+                                  boost::none /* oplogTsSlot */,
+                                  std::move(fields),
+                                  slots,
+                                  boost::none /* seekKeySlot */,
+                                  true /* forward */,
+                                  nullptr /* yieldPolicy */,
+                                  kEmptyPlanNodeId,
+                                  ScanCallbacks{{}});
+    return {std::move(slots), std::move(stage)};
+}
+
 }  // namespace mongo::sbe
@@ -42,6 +42,7 @@
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sbe_stage_builder_helpers.h"
+#include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/unittest/unittest.h"
 
@@ -80,7 +81,7 @@ using MakeStageFn = std::function<std::pair<T, std::unique_ptr<PlanStage>>(
  * observe 1 output slot, use runTest(). For unittests where the PlanStage has multiple input slots
  * and/or where the test needs to observe multiple output slots, use runTestMulti().
  */
-class PlanStageTestFixture : public ServiceContextTest {
+class PlanStageTestFixture : public virtual ServiceContextTest {
 public:
     PlanStageTestFixture() = default;
 
@@ -252,4 +253,30 @@ private:
     std::unique_ptr<value::SlotIdGenerator> _slotIdGenerator;
 };
 
+/**
+ * PlanStageTestFixture backed by a storage engine, for testing stages which spill to temporary
+ * record stores, including over scans of real collections.
+ */
+class PlanStageSpillTestFixture : public ServiceContextMongoDTest, public PlanStageTestFixture {
+public:
+    void setUp() override;
+
+    void tearDown() override {
+        PlanStageTestFixture::tearDown();
+        ServiceContextMongoDTest::tearDown();
+    }
+
+    /**
+     * Creates the collection 'nss' holding 'docs' and returns its UUID.
+     */
+    CollectionUUID createCollection(const NamespaceString& nss, const std::vector<BSONObj>& docs);
+
+    /**
+     * Makes a ScanStage over the collection 'collUuid' which produces the values of the top-level
+     * 'fields' of each document, and returns it along with the slots holding those values.
+     */
+    std::pair<value::SlotVector, std::unique_ptr<PlanStage>> generateCollScan(
+        CollectionUUID collUuid, std::vector<std::string> fields);
+};
+
 }  // namespace mongo::sbe
@@ -68,4 +68,78 @@ TEST_F(SortStageTest, SortNumbersTest) {
     runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
 }
 
+TEST_F(SortStageTest, SortMixedTypesDescendingWithLimitTest) {
+    // Mixes key types which can be encoded as a KeyString with an array, which cannot, so all rows
+    // are compared value by value once the array is seen. Keeps only the top 4 rows.
+    auto oid = OID("5f1d84de3a5b0c7a8e9d1234");
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(
+        BSON_ARRAY(5 << "A") << BSON_ARRAY("b"
+                                           << "B")
+                             << BSON_ARRAY(BSONNULL << "C") << BSON_ARRAY(oid << "D")
+                             << BSON_ARRAY(2.5 << "E") << BSON_ARRAY(BSON_ARRAY(1) << "F")
+                             << BSON_ARRAY("a"
+                                           << "G")));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(oid << "D") << BSON_ARRAY(BSON_ARRAY(1) << "F") << BSON_ARRAY("b"
+                                                                                          << "B")
+                                          << BSON_ARRAY("a"
+                                                        << "G")));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto makeStageFn = [](value::SlotVector scanSlots, std::unique_ptr<PlanStage> scanStage) {
+        auto sortStage =
+            makeS<SortStage>(std::move(scanStage),
+                             makeSV(scanSlots[0]),
+                             std::vector<value::SortDirection>{value::SortDirection::Descending},
+                             makeSV(scanSlots[1]),
+                             4,
+                             204857600,
+                             false,
+                             kEmptyPlanNodeId);
+
+        return std::make_pair(scanSlots, std::move(sortStage));
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTestMulti(2, inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+
+TEST_F(SortStageTest, SortLargeIntegersLikeValueComparisonTest) {
+    // 2^53 + 3 converts to the double 2^53 + 4, so the first keys of both rows compare equal and
+    // the rows are ordered by their second keys.
+    const long long kLargeInt = (1LL << 53) + 3;
+    const double kLargeDouble = static_cast<double>((1LL << 53) + 4);
+    auto [inputTag, inputVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(kLargeInt << 1 << "A") << BSON_ARRAY(kLargeDouble << 0 << "B")
+                                                     << BSON_ARRAY(1 << 2 << "C")));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(1 << 2 << "C") << BSON_ARRAY(kLargeDouble << 0 << "B")
+                                             << BSON_ARRAY(kLargeInt << 1 << "A")));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto makeStageFn = [](value::SlotVector scanSlots, std::unique_ptr<PlanStage> scanStage) {
+        auto sortStage = makeS<SortStage>(
+            std::move(scanStage),
+            makeSV(scanSlots[0], scanSlots[1]),
+            std::vector<value::SortDirection>{value::SortDirection::Ascending,
+                                              value::SortDirection::Ascending},
+            makeSV(scanSlots[2]),
+            std::numeric_limits<std::size_t>::max(),
+            204857600,
+            false,
+            kEmptyPlanNodeId);
+
+        return std::make_pair(scanSlots, std::move(sortStage));
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTestMulti(3, inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+
 }  // namespace mongo::sbe
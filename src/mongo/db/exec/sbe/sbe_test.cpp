@@ -401,4 +401,110 @@ TEST(SBEVM, ConvertBinDataToBsonObj) {
 
     ASSERT_EQ(originalBinData.woCompare(convertedBinData), 0);
 }
+
+TEST(SBEVM, FusedCompareMatchesInstruction) {
+    std::vector<std::pair<value::TypeTags, value::Value>> inputs{
+        {value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(3)},
+        {value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(4)},
+        {value::TypeTags::NumberDouble, value::bitcastFrom<double>(4.5)},
+        {value::TypeTags::NumberDouble, value::bitcastFrom<double>(5)},
+        {value::TypeTags::Null, 0},
+    };
+    auto [strTag, strVal] = value::makeNewString("abc"_sd);
+    value::ValueGuard strGuard{strTag, strVal};
+    inputs.emplace_back(strTag, strVal);
+
+    std::vector<std::pair<value::TypeTags, value::Value>> constants{
+        {value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(4)},
+        {value::TypeTags::NumberDouble, value::bitcastFrom<double>(4.5)},
+        {strTag, strVal},
+    };
+
+    using AppendFn = void (vm::CodeFragment::*)();
+    std::vector<AppendFn> ops{&vm::CodeFragment::appendLess,
+                              &vm::CodeFragment::appendLessEq,
+                              &vm::CodeFragment::appendGreater,
+                              &vm::CodeFragment::appendGreaterEq,
+                              &vm::CodeFragment::appendEq,
+                              &vm::CodeFragment::appendNeq};
+
+    vm::ByteCode interpreter;
+    for (auto [lhsTag, lhsVal] : inputs) {
+        for (auto [rhsTag, rhsVal] : constants) {
+            for (auto op : ops) {
+                // Appending an empty fragment after the constant prevents the fusion.
+                vm::CodeFragment plain;
+                plain.appendConstVal(lhsTag, lhsVal);
+                plain.appendConstVal(rhsTag, rhsVal);
+                plain.append(std::make_unique<vm::CodeFragment>());
+                (plain.*op)();
+
+                vm::CodeFragment fused;
+                fused.appendConstVal(lhsTag, lhsVal);
+                fused.appendConstVal(rhsTag, rhsVal);
+                (fused.*op)();
+
+                ASSERT_LT(fused.instrs().size(), plain.instrs().size());
+                ASSERT_EQ(fused.stackSize(), plain.stackSize());
+
+                auto [plainOwned, plainTag, plainVal] = interpreter.run(&plain);
+                auto [fusedOwned, fusedTag, fusedVal] = interpreter.run(&fused);
+
+                ASSERT_FALSE(plainOwned);
+                ASSERT_FALSE(fusedOwned);
+                ASSERT_EQ(fusedTag, plainTag);
+                ASSERT_EQ(fusedVal, plainVal);
+            }
+        }
+    }
+}
+
+TEST(SBEVM, ProfileCountsInstructionsAndBuiltins) {
+    vm::CodeFragment code;
+    code.appendConstVal(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(-3));
+    code.appendFunction(vm::Builtin::abs, 1);
+
+    vm::ByteCodeProfile profile;
+    vm::ByteCode interpreter;
+    interpreter.setProfile(&profile);
+
+    const auto period = static_cast<long long>(vm::ByteCodeProfile::kSamplingPeriod);
+    const long long runs = 64 * period;
+    for (long long run = 0; run < runs; ++run) {
+        auto [owned, tag, val] = interpreter.run(&code);
+        ASSERT_FALSE(owned);
+        ASSERT_EQ(tag, value::TypeTags::NumberInt32);
+        ASSERT_EQ(value::bitcastTo<int32_t>(val), 3);
+    }
+
+    BSONObjBuilder bob;
+    profile.appendToBSON(&bob);
+    auto obj = bob.obj();
+
+    auto pushConst = obj["instructions"]["pushConstVal"];
+    auto function = obj["instructions"]["functionSmall"];
+    auto abs = obj["builtins"]["abs"];
+    ASSERT_EQ(pushConst["count"].numberLong(), runs);
+    ASSERT_EQ(function["count"].numberLong(), runs);
+    ASSERT_EQ(abs["count"].numberLong(), runs);
+
+    // Every instruction executed is counted, but only one in about every sampling period is timed.
+    // The samples are not spaced evenly, so they do not all fall on the same instruction of the
+    // loop even though its length divides the sampling period.
+    const auto samples = pushConst["samples"].numberLong() + function["samples"].numberLong();
+    ASSERT_GTE(samples, runs / period);
+    ASSERT_LTE(samples, 4 * runs / period);
+    ASSERT_GT(pushConst["samples"].numberLong(), 0);
+    ASSERT_GT(function["samples"].numberLong(), 0);
+    ASSERT_EQ(abs["samples"].numberLong(), function["samples"].numberLong());
+    ASSERT_EQ(obj["instructions"].Obj().nFields(), 2);
+    ASSERT_EQ(obj["builtins"].Obj().nFields(), 1);
+
+    // Once the profile is detached the counts stay as they were.
+    interpreter.setProfile(nullptr);
+    interpreter.run(&code);
+    BSONObjBuilder afterBob;
+    profile.appendToBSON(&afterBob);
+    ASSERT_BSONOBJ_EQ(afterBob.obj(), obj);
+}
 }  // namespace mongo::sbe
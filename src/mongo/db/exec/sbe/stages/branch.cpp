@@ -68,6 +68,7 @@ void BranchStage::prepare(CompileCtx& ctx) {
 
     _children[0]->prepare(ctx);
     _children[1]->prepare(ctx);
+    _bytecode.setProfile(getVmProfile());
 
     for (size_t idx = 0; idx < _outputVals.size(); ++idx) {
         std::vector<value::SlotAccessor*> accessors;
@@ -33,6 +33,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/client.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 std::unique_ptr<ThreadPool> s_globalThreadPool;
@@ -82,21 +83,57 @@ std::unique_ptr<ExchangeBuffer> ExchangePipe::getEmptyBuffer() {
     return std::move(_emptyBuffers[_emptyCount]);
 }
 
-std::unique_ptr<ExchangeBuffer> ExchangePipe::getFullBuffer() {
+std::unique_ptr<ExchangeBuffer> ExchangePipe::getFullBuffer(OperationContext* opCtx) {
     stdx::unique_lock lock(_mutex);
 
-    _cond.wait(lock, [this]() { return _closed || _fullCount != _fullPosition; });
+    auto pred = [this]() { return _closed || _fullCount != _fullPosition || _trialRunPaused; };
+    if (opCtx) {
+        opCtx->waitForConditionOrInterrupt(_cond, lock, pred);
+    } else {
+        _cond.wait(lock, pred);
+    }
 
     if (_closed) {
         return nullptr;
     }
 
+    if (_fullCount == _fullPosition) {
+        uasserted(ErrorCodes::QueryTrialRunCompleted, "Trial run early exit in exchange");
+    }
+
     auto pos = _fullPosition;
     _fullPosition = (_fullPosition + 1) % _fullBuffers.size();
 
     return std::move(_fullBuffers[pos]);
 }
 
+void ExchangePipe::pauseForTrialRun() {
+    stdx::unique_lock lock(_mutex);
+
+    if (!_trialRunOver) {
+        _trialRunPaused = true;
+        _cond.notify_all();
+    }
+}
+
+bool ExchangePipe::waitForTrialRunEnd(OperationContext* opCtx) {
+    stdx::unique_lock lock(_mutex);
+
+    opCtx->waitForConditionOrInterrupt(
+        _cond, lock, [this]() { return _closed || !_trialRunPaused; });
+
+    return !_closed;
+}
+
+void ExchangePipe::endTrialRun() {
+    stdx::unique_lock lock(_mutex);
+
+    _trialRunOver = true;
+    _trialRunPaused = false;
+
+    _cond.notify_all();
+}
+
 void ExchangePipe::putEmptyBuffer(std::unique_ptr<ExchangeBuffer> b) {
     stdx::unique_lock lock(_mutex);
 
@@ -121,23 +158,57 @@ ExchangeState::ExchangeState(size_t numOfProducers,
                              value::SlotVector fields,
                              ExchangePolicy policy,
                              std::unique_ptr<EExpression> partition,
-                             std::unique_ptr<EExpression> orderLess)
+                             std::unique_ptr<EExpression> orderLess,
+                             ExchangeYieldPolicyFactory yieldPolicyFactory)
     : _policy(policy),
       _numOfProducers(numOfProducers),
       _fields(std::move(fields)),
       _partition(std::move(partition)),
-      _orderLess(std::move(orderLess)) {}
+      _orderLess(std::move(orderLess)),
+      _yieldPolicyFactory(std::move(yieldPolicyFactory)) {}
 
 ExchangePipe* ExchangeState::pipe(size_t consumerTid, size_t producerTid) {
     return _consumers[consumerTid]->pipe(producerTid);
 }
 
+namespace {
+void killProducer(OperationContext* opCtx, ErrorCodes::Error code) {
+    stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+    opCtx->getServiceContext()->killOperation(clientLock, opCtx, code);
+}
+}  // namespace
+
+void ExchangeState::registerProducerOpCtx(OperationContext* opCtx) {
+    stdx::lock_guard lk(_producerOpCtxsMutex);
+    _producerOpCtxs.push_back(opCtx);
+    if (_producerInterruptCode) {
+        killProducer(opCtx, *_producerInterruptCode);
+    }
+}
+
+void ExchangeState::unregisterProducerOpCtx(OperationContext* opCtx) {
+    stdx::lock_guard lk(_producerOpCtxsMutex);
+    _producerOpCtxs.erase(std::find(_producerOpCtxs.begin(), _producerOpCtxs.end(), opCtx));
+}
+
+void ExchangeState::interruptProducers(ErrorCodes::Error code) {
+    stdx::lock_guard lk(_producerOpCtxsMutex);
+    if (_producerInterruptCode) {
+        return;
+    }
+
+    _producerInterruptCode = code;
+    for (auto opCtx : _producerOpCtxs) {
+        killProducer(opCtx, code);
+    }
+}
+
 ExchangeBuffer* ExchangeConsumer::getBuffer(size_t producerId) {
     if (_fullBuffers[producerId]) {
         return _fullBuffers[producerId].get();
     }
 
-    _fullBuffers[producerId] = _pipes[producerId]->getFullBuffer();
+    _fullBuffers[producerId] = _pipes[producerId]->getFullBuffer(_opCtx);
 
     return _fullBuffers[producerId].get();
 }
@@ -159,11 +230,16 @@ ExchangeConsumer::ExchangeConsumer(std::unique_ptr<PlanStage> input,
                                    ExchangePolicy policy,
                                    std::unique_ptr<EExpression> partition,
                                    std::unique_ptr<EExpression> orderLess,
-                                   PlanNodeId planNodeId)
+                                   PlanNodeId planNodeId,
+                                   ExchangeYieldPolicyFactory yieldPolicyFactory)
     : PlanStage("exchange"_sd, planNodeId) {
     _children.emplace_back(std::move(input));
-    _state = std::make_shared<ExchangeState>(
-        numOfProducers, std::move(fields), policy, std::move(partition), std::move(orderLess));
+    _state = std::make_shared<ExchangeState>(numOfProducers,
+                                             std::move(fields),
+                                             policy,
+                                             std::move(partition),
+                                             std::move(orderLess),
+                                             std::move(yieldPolicyFactory));
 
     _tid = _state->addConsumer(this);
     _orderPreserving = _state->isOrderPreserving();
@@ -209,7 +285,10 @@ void ExchangeConsumer::open(bool reOpen) {
         stdx::unique_lock lock(_state->consumerOpenMutex());
         bool allConsumers = (++_state->consumerOpen()) == _state->numOfConsumers();
 
-        // Create all pipes.
+        // Create all pipes. The pipes of a previous execution are not used by anyone anymore.
+        _pipes.clear();
+        _fullBuffers.clear();
+        _bufferPos.clear();
         if (_orderPreserving) {
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 _pipes.emplace_back(std::make_unique<ExchangePipe>(2));
@@ -232,32 +311,35 @@ void ExchangeConsumer::open(bool reOpen) {
                     lock, [this]() { return _state->consumerOpen() == _state->numOfConsumers(); });
             }
 
-            // Clone n copies of the subtree for every producer.
-
-            PlanStage* masterSubTree = _children[0].get();
-            masterSubTree->detachFromOperationContext();
+            _state->resetProducers();
 
+            // Clone n copies of the subtree for every producer. The subtree itself is never
+            // executed, it is kept so that the exchange can be reopened after close().
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-                if (idx == 0) {
-                    _state->producerPlans().emplace_back(std::make_unique<ExchangeProducer>(
-                        std::move(_children[0]), _state, _commonStats.nodeId));
-                    // We have moved the child to the producer so clear the children vector.
-                    _children.clear();
-                } else {
-                    _state->producerPlans().emplace_back(std::make_unique<ExchangeProducer>(
-                        masterSubTree->clone(), _state, _commonStats.nodeId));
-                }
+                _state->producerPlans().emplace_back(std::make_unique<ExchangeProducer>(
+                    _children[0]->clone(), _state, _commonStats.nodeId));
             }
 
-            // Start n producers.
+            // Start n producers. The producers run on their own operation contexts, which share
+            // the deadline of the consumer's operation and are killed when it is interrupted.
             invariant(_state->producerCompileCtxs().size() == _state->numOfProducers());
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 auto pf = makePromiseFuture<void>();
                 s_globalThreadPool->schedule(
-                    [this, idx, promise = std::move(pf.promise)](auto status) mutable {
-                        invariant(status);
+                    [this,
+                     idx,
+                     deadline = _opCtx->getDeadline(),
+                     timeoutError = _opCtx->getTimeoutError(),
+                     promise = std::move(pf.promise)](auto status) mutable {
+                        if (!status.isOK()) {
+                            promise.setError(status);
+                            return;
+                        }
 
                         auto opCtx = cc().makeOperationContext();
+                        opCtx->setDeadlineByDate(deadline, timeoutError);
+                        _state->registerProducerOpCtx(opCtx.get());
+                        ON_BLOCK_EXIT([&] { _state->unregisterProducerOpCtx(opCtx.get()); });
 
                         promise.setWith([&] {
                             ExchangeProducer::start(opCtx.get(),
@@ -298,7 +380,13 @@ PlanState ExchangeConsumer::getNext() {
         uasserted(4822834, "ordere exchange not yet implemented");
     } else {
         while (_eofs < _state->numOfProducers()) {
-            auto buffer = getBuffer(0);
+            ExchangeBuffer* buffer;
+            try {
+                buffer = getBuffer(0);
+            } catch (const ExceptionForCat<ErrorCategory::Interruption>& ex) {
+                _state->interruptProducers(ex.code());
+                throw;
+            }
             if (!buffer) {
                 // early out
                 return trackPlanState(PlanState::IS_EOF);
@@ -324,6 +412,14 @@ PlanState ExchangeConsumer::getNext() {
     }
     return trackPlanState(PlanState::IS_EOF);
 }
+void ExchangeConsumer::doDetachFromTrialRunTracker() {
+    // The subtree has already been detached, so the producers no longer count reads against the
+    // trial run once they resume.
+    for (auto& p : _pipes) {
+        p->endTrialRun();
+    }
+}
+
 void ExchangeConsumer::close() {
     auto optTimer(getOptTimer(_opCtx));
 
@@ -442,6 +538,20 @@ void ExchangeProducer::closePipes() {
     }
 }
 
+bool ExchangeProducer::pauseForTrialRun() {
+    for (auto& p : _pipes) {
+        p->pauseForTrialRun();
+    }
+
+    for (auto& p : _pipes) {
+        if (!p->waitForTrialRunEnd(_opCtx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 ExchangeProducer::ExchangeProducer(std::unique_ptr<PlanStage> input,
                                    std::shared_ptr<ExchangeState> state,
                                    PlanNodeId planNodeId)
@@ -464,6 +574,13 @@ void ExchangeProducer::start(OperationContext* opCtx,
 
     p->attachToOperationContext(opCtx);
 
+    // Stages which yield on behalf of the consumer's query yield on behalf of the producer instead.
+    std::unique_ptr<PlanYieldPolicy> yieldPolicy;
+    if (auto&& yieldPolicyFactory = p->_state->yieldPolicyFactory()) {
+        yieldPolicy = yieldPolicyFactory(opCtx, p);
+    }
+    p->rebindYieldPolicy(yieldPolicy.get());
+
     try {
         p->prepare(ctx);
         p->open(false);
@@ -523,7 +640,22 @@ bool ExchangeProducer::appendData(size_t consumerId) {
 PlanState ExchangeProducer::getNext() {
     auto optTimer(getOptTimer(_opCtx));
 
-    while (_children[0]->getNext() == PlanState::ADVANCED) {
+    for (;;) {
+        PlanState state;
+        try {
+            state = _children[0]->getNext();
+        } catch (const ExceptionFor<ErrorCodes::QueryTrialRunCompleted>&) {
+            // The subtree used up the reads of the trial run the plan is in. It carries on from
+            // where it stopped once the trial run is over, unless the plan is closed instead.
+            if (!pauseForTrialRun()) {
+                return trackPlanState(PlanState::IS_EOF);
+            }
+            continue;
+        }
+        if (state != PlanState::ADVANCED) {
+            break;
+        }
+
         // Push to the correct pipe.
         switch (_state->policy()) {
             case ExchangePolicy::broadcast: {
@@ -44,6 +44,13 @@ class ExchangeProducer;
 
 enum class ExchangePolicy { broadcast, roundrobin, partition };
 
+/**
+ * Creates the yield policy of a producer which runs on 'opCtx'. The policy must yield the tree
+ * rooted at 'producer'.
+ */
+using ExchangeYieldPolicyFactory = std::function<std::unique_ptr<PlanYieldPolicy>(
+    OperationContext* opCtx, PlanStage* producer)>;
+
 // A unit of exchange between a consumer and a producer
 class ExchangeBuffer {
 public:
@@ -123,10 +130,29 @@ public:
 
     void close();
     std::unique_ptr<ExchangeBuffer> getEmptyBuffer();
-    std::unique_ptr<ExchangeBuffer> getFullBuffer();
+    // Waits for a full buffer. If 'opCtx' is not null, the wait is interrupted along with 'opCtx'.
+    // Throws QueryTrialRunCompleted if a producer paused for the trial run and no buffer is full.
+    std::unique_ptr<ExchangeBuffer> getFullBuffer(OperationContext* opCtx);
     void putEmptyBuffer(std::unique_ptr<ExchangeBuffer>);
     void putFullBuffer(std::unique_ptr<ExchangeBuffer>);
 
+    /**
+     * Called by a producer whose stages used up the reads of the trial run the plan is in. Wakes
+     * the consumer, which then ends its trial run once it has drained the full buffers.
+     */
+    void pauseForTrialRun();
+
+    /**
+     * Waits until the consumer is done with the trial run, or the pipe is closed, in which case it
+     * returns false. Returns right away if the trial run is already over.
+     */
+    bool waitForTrialRunEnd(OperationContext* opCtx);
+
+    /**
+     * Called by the consumer once its plan is no longer in a trial run. Resumes paused producers.
+     */
+    void endTrialRun();
+
 private:
     Mutex _mutex = MONGO_MAKE_LATCH("ExchangePipe::_mutex");
     stdx::condition_variable _cond;
@@ -139,6 +165,10 @@ private:
 
     // early out - pipe closed
     bool _closed{false};
+
+    // Whether a producer is paused until the trial run the plan is in is over, and whether it is.
+    bool _trialRunPaused{false};
+    bool _trialRunOver{false};
 };
 
 /**
@@ -150,7 +180,8 @@ public:
                   value::SlotVector fields,
                   ExchangePolicy policy,
                   std::unique_ptr<EExpression> partition,
-                  std::unique_ptr<EExpression> orderLess);
+                  std::unique_ptr<EExpression> orderLess,
+                  ExchangeYieldPolicyFactory yieldPolicyFactory);
 
     bool isOrderPreserving() const {
         return !!_orderLess;
@@ -173,6 +204,20 @@ public:
         _producerResults.emplace_back(std::move(f));
     }
 
+    /**
+     * Forgets the producers of a previous execution, so that the exchange can be opened again
+     * after it has been closed. Must only be called while all consumers are being opened.
+     */
+    void resetProducers() {
+        _producers.clear();
+        _producerPlans.clear();
+        _producerResults.clear();
+        _consumerClose = 0;
+
+        stdx::lock_guard lk(_producerOpCtxsMutex);
+        _producerInterruptCode = boost::none;
+    }
+
     auto& consumerOpenMutex() {
         return _consumerOpenMutex;
     }
@@ -217,6 +262,23 @@ public:
     }
     ExchangePipe* pipe(size_t consumerTid, size_t producerTid);
 
+    const auto& yieldPolicyFactory() const {
+        return _yieldPolicyFactory;
+    }
+
+    /**
+     * Called by a producer to let the consumers interrupt its operation context. If the producers
+     * have already been interrupted, 'opCtx' is killed right away.
+     */
+    void registerProducerOpCtx(OperationContext* opCtx);
+    void unregisterProducerOpCtx(OperationContext* opCtx);
+
+    /**
+     * Called by a consumer when the operation it runs on is interrupted. Kills the operation
+     * contexts of all producers with 'code', so that the producers stop scanning and yielding.
+     */
+    void interruptProducers(ErrorCodes::Error code);
+
 private:
     const ExchangePolicy _policy;
     const size_t _numOfProducers;
@@ -235,6 +297,15 @@ private:
     // The '<' function for order preserving exchange.
     const std::unique_ptr<EExpression> _orderLess;
 
+    // Creates the yield policies of the producers. Producers do not yield if this is not set.
+    const ExchangeYieldPolicyFactory _yieldPolicyFactory;
+
+    // The operation contexts of the running producers, and the code they were killed with if the
+    // consumers were interrupted during the current execution.
+    mongo::Mutex _producerOpCtxsMutex;
+    std::vector<OperationContext*> _producerOpCtxs;
+    boost::optional<ErrorCodes::Error> _producerInterruptCode;
+
     // This is verbose and heavyweight. Recondsider something lighter
     // at minimum try to share a single mutex (i.e. _stateMutex) if safe
     mongo::Mutex _consumerOpenMutex;
@@ -254,7 +325,8 @@ public:
                      ExchangePolicy policy,
                      std::unique_ptr<EExpression> partition,
                      std::unique_ptr<EExpression> orderLess,
-                     PlanNodeId planNodeId);
+                     PlanNodeId planNodeId,
+                     ExchangeYieldPolicyFactory yieldPolicyFactory = {});
 
     ExchangeConsumer(std::shared_ptr<ExchangeState> state, PlanNodeId planNodeId);
 
@@ -272,6 +344,9 @@ public:
 
     ExchangePipe* pipe(size_t producerTid);
 
+protected:
+    void doDetachFromTrialRunTracker() final;
+
 private:
     ExchangeBuffer* getBuffer(size_t producerId);
     void putBuffer(size_t producerId);
@@ -327,6 +402,12 @@ private:
     void closePipes();
     bool appendData(size_t consumerId);
 
+    /**
+     * Pauses the producer when its stages have used up the reads of the trial run the plan is in,
+     * until the consumers are done with the trial run. Returns false if the pipes were closed.
+     */
+    bool pauseForTrialRun();
+
     std::shared_ptr<ExchangeState> _state;
     size_t _tid{0};
     size_t _roundRobinCounter{0};
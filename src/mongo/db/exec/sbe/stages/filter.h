@@ -63,6 +63,7 @@ public:
 
         ctx.root = this;
         _filterCode = _filter->compile(ctx);
+        _bytecode.setProfile(getVmProfile());
     }
 
     value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final {
@@ -31,6 +31,9 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include <algorithm>
+
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -39,11 +42,13 @@ HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector gbs,
                            value::SlotMap<std::unique_ptr<EExpression>> aggs,
                            boost::optional<value::SlotId> collatorSlot,
+                           bool allowDiskUse,
                            PlanNodeId planNodeId)
     : PlanStage("group"_sd, planNodeId),
       _gbs(std::move(gbs)),
       _aggs(std::move(aggs)),
-      _collatorSlot(collatorSlot) {
+      _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse) {
     _children.emplace_back(std::move(input));
 }
 
@@ -52,12 +57,17 @@ std::unique_ptr<PlanStage> HashAggStage::clone() const {
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
-    return std::make_unique<HashAggStage>(
-        _children[0]->clone(), _gbs, std::move(aggs), _collatorSlot, _commonStats.nodeId);
+    return std::make_unique<HashAggStage>(_children[0]->clone(),
+                                          _gbs,
+                                          std::move(aggs),
+                                          _collatorSlot,
+                                          _allowDiskUse,
+                                          _commonStats.nodeId);
 }
 
 void HashAggStage::prepare(CompileCtx& ctx) {
     _children[0]->prepare(ctx);
+    _bytecode.setProfile(getVmProfile());
 
     if (_collatorSlot) {
         _collatorAccessor = getAccessor(ctx, *_collatorSlot);
@@ -74,6 +84,7 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         uassert(4822827, str::stream() << "duplicate field: " << slot, inserted);
 
         _inKeyAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
+        registerInputSlot(slot, _inKeyAccessors.back());
         _outKeyAccessors.emplace_back(std::make_unique<HashKeyAccessor>(_htIt, counter++));
         _outAccessors[slot] = _outKeyAccessors.back().get();
     }
@@ -94,7 +105,9 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         ctx.aggExpression = true;
         ctx.accumulator = _outAggAccessors.back().get();
 
+        _compilingAggs = true;
         _aggCodes.emplace_back(expr->compile(ctx));
+        _compilingAggs = false;
         ctx.aggExpression = false;
     }
     _compiled = true;
@@ -105,6 +118,8 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
         if (auto it = _outAccessors.find(slot); it != _outAccessors.end()) {
             return it->second;
         }
+    } else if (_compilingAggs) {
+        return getAggInputAccessor(ctx, slot);
     } else {
         return _children[0]->getAccessor(ctx, slot);
     }
@@ -112,6 +127,216 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
     return ctx.getAccessor(slot);
 }
 
+value::SlotAccessor* HashAggStage::getAggInputAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _inRowSlots.find(slot); it != _inRowSlots.end()) {
+        return _inSwitchAccessors[it->second].get();
+    }
+
+    auto accessor = _children[0]->getAccessor(ctx, slot);
+
+    // Correlated and runtime environment slots do not change from one input row to the next, so
+    // there is no need to spill their values.
+    const bool isCorrelated =
+        std::any_of(ctx.correlated.begin(), ctx.correlated.end(), [&](auto&& correlated) {
+            return correlated.second == accessor;
+        });
+    if (isCorrelated || dynamic_cast<RuntimeEnvironment::Accessor*>(accessor)) {
+        return accessor;
+    }
+
+    registerInputSlot(slot, accessor);
+    return _inSwitchAccessors.back().get();
+}
+
+void HashAggStage::registerInputSlot(value::SlotId slot, value::SlotAccessor* accessor) {
+    const size_t idx = _inRowAccessors.size();
+    _inRowAccessors.emplace_back(accessor);
+    _inRowSlots.emplace(slot, idx);
+    _spilledRowAccessors.emplace_back(
+        std::make_unique<value::MaterializedSingleRowAccessor>(_spilledRow, idx));
+    _inSwitchAccessors.emplace_back(std::make_unique<value::SwitchAccessor>(
+        std::vector<value::SlotAccessor*>{accessor, _spilledRowAccessors.back().get()}));
+}
+
+void HashAggStage::aggregateRow(value::MaterializedRow key) {
+    auto [it, inserted] = _ht->try_emplace(std::move(key), value::MaterializedRow{0});
+    if (inserted) {
+        // Copy keys.
+        const_cast<value::MaterializedRow&>(it->first).makeOwned();
+        // Initialize accumulators.
+        it->second.resize(_outAggAccessors.size() + kNumHiddenAggColumns);
+    }
+
+    // Accumulate.
+    _htIt = it;
+    accumulate();
+    updateMemoryUsage();
+}
+
+void HashAggStage::accumulate() {
+    for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+        auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
+        _outAggAccessors[idx]->reset(owned, tag, val);
+    }
+}
+
+void HashAggStage::updateMemoryUsage() {
+    auto& aggs = _htIt->second;
+    const size_t sizeIdx = _outAggAccessors.size();
+    const size_t countIdx = sizeIdx + 1;
+
+    auto readCounter = [&](size_t idx) -> int64_t {
+        auto [tag, val] = aggs.getViewOfValue(idx);
+        return tag == value::TypeTags::NumberInt64 ? value::bitcastTo<int64_t>(val) : 0;
+    };
+
+    const auto count = readCounter(countIdx) + 1;
+    aggs.reset(countIdx, false, value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(count));
+
+    // Estimating the size of a group is linear in the size of its values, and accumulators such
+    // as $push grow with every row. Re-estimating only after the 1st, 2nd, 4th, 8th, ... row keeps
+    // the total cost linear in the size of the input while never being off by more than half.
+    if (count & (count - 1)) {
+        return;
+    }
+
+    const int64_t size = _htIt->first.memUsageForSorter() + aggs.memUsageForSorter();
+    _htMemoryUsage += size - readCounter(sizeIdx);
+    aggs.reset(sizeIdx, false, value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(size));
+}
+
+size_t HashAggStage::partitionOf(const value::MaterializedRow& key, size_t depth) const {
+    // Every level of re-partitioning splits a partition by the next few bits of the hash.
+    return (_ht->hash_function()(key) >> (depth * kPartitionBits)) % kNumPartitions;
+}
+
+bool HashAggStage::shouldSpill(const value::MaterializedRow& key) const {
+    // Once a row of the current pass has been spilled, every group which is not in memory yet is
+    // spilled as well, even if the memory usage has dropped below the budget since. Otherwise a
+    // group whose first rows were spilled could be created in memory too and returned twice.
+    return (_spilling || _htMemoryUsage >= _htMemoryLimit) && _ht->find(key) == _ht->end();
+}
+
+void HashAggStage::spillRow(const value::MaterializedRow& key) {
+    if (!_recordStore) {
+        _recordStore = std::make_unique<SpillingStore>(_opCtx);
+        _specificStats.usedDisk = true;
+    }
+
+    if (!_spilling) {
+        uassert(5999114,
+                str::stream() << "group could not fit the groups of a spilled partition within the "
+                                 "memory limit of "
+                              << _htMemoryLimit << " bytes after " << kMaxPartitionDepth
+                              << " levels of re-partitioning",
+                _spillDepth < kMaxPartitionDepth);
+
+        _spilling = true;
+        _spillBase = _spillCounts.size();
+        _spillBufs.resize(_spillBase + kNumPartitions);
+        _spillCounts.resize(_spillBase + kNumPartitions, 0);
+        _spillDepths.resize(_spillBase + kNumPartitions, _spillDepth);
+    }
+
+    // Read the row through the switch accessors, so that a row of a spilled partition which is
+    // spilled again is read from '_spilledRow'.
+    value::MaterializedRow row{_inSwitchAccessors.size()};
+    for (size_t idx = 0; idx < _inSwitchAccessors.size(); ++idx) {
+        auto [tag, val] = _inSwitchAccessors[idx]->getViewOfValue();
+        row.reset(idx, false, tag, val);
+    }
+
+    auto& buf = _spillBufs[_spillBase + partitionOf(key, _spillDepth)];
+    const auto before = buf.len();
+    row.serializeForSorter(buf);
+    _spillBufBytes += buf.len() - before;
+    ++_specificStats.spilledRecords;
+
+    if (_spillBufBytes >= kSpillBatchBytes) {
+        flushSpilledRows();
+    }
+}
+
+void HashAggStage::flushSpilledRows() {
+    if (!_spillBufBytes) {
+        return;
+    }
+
+    std::vector<Record> records;
+    for (size_t partition = _spillBase; partition < _spillBufs.size(); ++partition) {
+        auto& buf = _spillBufs[partition];
+        if (buf.len()) {
+            const RecordId rid{static_cast<int64_t>(partition << kPartitionShift) +
+                               ++_spillCounts[partition]};
+            records.push_back(Record{rid, RecordData(buf.buf(), buf.len())});
+        }
+    }
+
+    _recordStore->insertRecords(_opCtx, &records);
+
+    for (size_t partition = _spillBase; partition < _spillBufs.size(); ++partition) {
+        _spillBufs[partition].reset();
+    }
+    _spillBufBytes = 0;
+}
+
+void HashAggStage::aggregateSpilledPartition(size_t partition) {
+    _ht->clear();
+    _htMemoryUsage = 0;
+
+    // Groups of this partition which do not fit in memory are spilled to partitions of their own,
+    // which are aggregated after this one.
+    _spilling = false;
+    _spillDepth = _spillDepths[partition] + 1;
+
+    // From now on the aggregate expressions read their inputs from '_spilledRow'.
+    for (auto& accessor : _inSwitchAccessors) {
+        accessor->setIndex(1);
+    }
+
+    for (int64_t seq = 1; seq <= _spillCounts[partition]; ++seq) {
+        const RecordId rid{static_cast<int64_t>(partition << kPartitionShift) + seq};
+        auto data = _recordStore->findRecord(_opCtx, rid);
+
+        BufReader reader(data.data(), data.size());
+        while (!reader.atEof()) {
+            _spilledRow = value::MaterializedRow::deserializeForSorter(reader, {});
+
+            value::MaterializedRow key{_inKeyAccessors.size()};
+            for (size_t idx = 0; idx < _inKeyAccessors.size(); ++idx) {
+                auto [tag, val] = _spilledRow.getViewOfValue(idx);
+                key.reset(idx, false, tag, val);
+            }
+
+            if (shouldSpill(key)) {
+                spillRow(key);
+                continue;
+            }
+
+            const auto groups = _ht->size();
+            aggregateRow(std::move(key));
+            _specificStats.spilledGroups += _ht->size() - groups;
+        }
+    }
+
+    flushSpilledRows();
+}
+
+void HashAggStage::releaseSpillTable() {
+    _spillBufs.clear();
+    _spillBufBytes = 0;
+    _spillCounts.clear();
+    _spillDepths.clear();
+    _spilling = false;
+    _spillDepth = 0;
+    _spillBase = 0;
+
+    if (_recordStore) {
+        _recordStore->release(_opCtx);
+        _recordStore.reset();
+    }
+}
+
 void HashAggStage::open(bool reOpen) {
     auto optTimer(getOptTimer(_opCtx));
 
@@ -129,6 +354,14 @@ void HashAggStage::open(bool reOpen) {
         _ht.emplace();
     }
 
+    releaseSpillTable();
+    for (auto& accessor : _inSwitchAccessors) {
+        accessor->setIndex(0);
+    }
+
+    _htMemoryUsage = 0;
+    _htMemoryLimit = internalQuerySlotBasedExecutionHashAggMaxMemoryBytes.load();
+
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inKeyAccessors.size()};
         // Copy keys in order to do the lookup.
@@ -138,25 +371,31 @@ void HashAggStage::open(bool reOpen) {
             key.reset(idx++, false, tag, val);
         }
 
-        auto [it, inserted] = _ht->try_emplace(std::move(key), value::MaterializedRow{0});
-        if (inserted) {
-            // Copy keys.
-            const_cast<value::MaterializedRow&>(it->first).makeOwned();
-            // Initialize accumulators.
-            it->second.resize(_outAggAccessors.size());
+        // Once the memory budget is exhausted, only groups which are already in memory are
+        // updated in place.
+        if (shouldSpill(key)) {
+            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                    str::stream() << "group exceeded memory limit of " << _htMemoryLimit
+                                  << " bytes, but did not opt in to external sorting.",
+                    _allowDiskUse);
+            spillRow(key);
+            continue;
         }
 
-        // Accumulate.
-        _htIt = it;
-        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
-            auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
-            _outAggAccessors[idx]->reset(owned, tag, val);
-        }
+        aggregateRow(std::move(key));
+
+        uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                str::stream() << "group exceeded memory limit of " << _htMemoryLimit
+                              << " bytes, but did not opt in to external sorting.",
+                _allowDiskUse || _htMemoryUsage <= _htMemoryLimit);
     }
 
     _children[0]->close();
 
+    flushSpilledRows();
+
     _htIt = _ht->end();
+    _nextPartition = 0;
 }
 
 PlanState HashAggStage::getNext() {
@@ -168,8 +407,15 @@ PlanState HashAggStage::getNext() {
         ++_htIt;
     }
 
-    if (_htIt == _ht->end()) {
-        return trackPlanState(PlanState::IS_EOF);
+    // Once the groups in the hash table are exhausted, move on to the next non-empty partition of
+    // the spill table.
+    while (_htIt == _ht->end()) {
+        if (_nextPartition == _spillCounts.size()) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
+
+        aggregateSpilledPartition(_nextPartition++);
+        _htIt = _ht->begin();
     }
 
     return trackPlanState(PlanState::ADVANCED);
@@ -177,11 +423,15 @@ PlanState HashAggStage::getNext() {
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
 
     if (includeDebugInfo) {
         DebugPrinter printer;
         BSONObjBuilder bob;
         bob.append("groupBySlots", _gbs);
+        bob.appendBool("usedDisk", _specificStats.usedDisk);
+        bob.appendNumber("spilledGroups", static_cast<long long>(_specificStats.spilledGroups));
+        bob.appendNumber("spilledRecords", static_cast<long long>(_specificStats.spilledRecords));
         if (!_aggs.empty()) {
             BSONObjBuilder childrenBob(bob.subobjStart("expressions"));
             for (auto&& [slot, expr] : _aggs) {
@@ -196,7 +446,7 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
@@ -204,6 +454,7 @@ void HashAggStage::close() {
 
     trackClose();
     _ht = boost::none;
+    releaseSpillTable();
 }
 
 std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
@@ -33,17 +33,35 @@
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/util/spilling.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 namespace sbe {
+/**
+ * Groups the rows produced by its child by the values of the 'gbs' slots and computes the 'aggs'
+ * expressions for each group.
+ *
+ * The stage keeps track of the approximate size of its hash table. Once the table grows past
+ * 'internalQuerySlotBasedExecutionHashAggMaxMemoryBytes', input rows belonging to groups which are
+ * not already in memory are either written to a temporary record store (if 'allowDiskUse' is
+ * true), or the query fails with 'QueryExceededMemoryLimitNoDiskUseAllowed'. The aggregate
+ * expressions cannot merge partial results, so the spilled rows are kept raw, split into
+ * partitions by the hash of their group key. Groups held in memory are returned first, after which
+ * each partition is read back and aggregated on its own. A partition whose groups do not fit in
+ * memory either is split again by the next bits of the hash, up to 'kMaxPartitionDepth' times.
+ *
+ * Groups which are already in memory keep being updated once the budget is exhausted; if they grow
+ * past the budget without 'allowDiskUse' the query fails as well.
+ */
 class HashAggStage final : public PlanStage {
 public:
     HashAggStage(std::unique_ptr<PlanStage> input,
                  value::SlotVector gbs,
                  value::SlotMap<std::unique_ptr<EExpression>> aggs,
                  boost::optional<value::SlotId> collatorSlot,
+                 bool allowDiskUse,
                  PlanNodeId planNodeId);
 
     std::unique_ptr<PlanStage> clone() const final;
@@ -67,9 +85,79 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashAggAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    // Spilled rows are split into this many partitions, each of which is aggregated on its own.
+    static constexpr size_t kPartitionBits = 4;
+    static constexpr size_t kNumPartitions = size_t{1} << kPartitionBits;
+    // The number of times the rows of a partition may be split again before the query fails.
+    static constexpr size_t kMaxPartitionDepth = 8;
+    // The partition of a spill table record is stored in the high bits of its RecordId.
+    static constexpr int kPartitionShift = 40;
+    // Spilled rows are buffered in memory and written out once this many bytes are pending.
+    static constexpr int kSpillBatchBytes = 1024 * 1024;
+    // Every group carries two hidden trailing columns after its aggregate values: the last memory
+    // estimate of the group and the number of rows accumulated into it.
+    static constexpr size_t kNumHiddenAggColumns = 2;
+
+    /**
+     * Returns the accessor through which the aggregate expressions read the child slot 'slot'.
+     * Slots produced by the child are read either from the child or from '_spilledRow', depending
+     * on whether the stage is aggregating a spilled partition.
+     */
+    value::SlotAccessor* getAggInputAccessor(CompileCtx& ctx, value::SlotId slot);
+    void registerInputSlot(value::SlotId slot, value::SlotAccessor* accessor);
+
+    /**
+     * Finds or creates the group identified by 'key' and accumulates the current input row into
+     * it.
+     */
+    void aggregateRow(value::MaterializedRow key);
+
+    /**
+     * Runs the aggregate expressions against the group pointed to by '_htIt'.
+     */
+    void accumulate();
+
+    /**
+     * Refreshes the memory estimate of the group pointed to by '_htIt' after a row has been
+     * accumulated into it.
+     */
+    void updateMemoryUsage();
+
+    /**
+     * Returns the partition, among the 'kNumPartitions' partitions a level of partitioning has,
+     * to which the group 'key' is spilled at the given 'depth'.
+     */
+    size_t partitionOf(const value::MaterializedRow& key, size_t depth) const;
+
+    /**
+     * Returns whether the current row, whose group key is 'key', must be spilled rather than
+     * aggregated in memory.
+     */
+    bool shouldSpill(const value::MaterializedRow& key) const;
+
+    /**
+     * Buffers the current row, whose group key is 'key', for the spill table partition the key
+     * hashes to. Creates the spill table on first use.
+     */
+    void spillRow(const value::MaterializedRow& key);
+
+    /**
+     * Writes all buffered rows to the spill table in a single storage transaction.
+     */
+    void flushSpilledRows();
+
+    /**
+     * Replaces the contents of the hash table with the groups built from the rows spilled to
+     * 'partition'. Rows of groups which do not fit in memory are spilled to new partitions.
+     */
+    void aggregateSpilledPartition(size_t partition);
+
+    void releaseSpillTable();
+
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
 
     value::SlotAccessorMap _outAccessors;
     std::vector<value::SlotAccessor*> _inKeyAccessors;
@@ -84,8 +172,44 @@ private:
     boost::optional<TableType> _ht;
     TableType::iterator _htIt;
 
+    // The approximate number of bytes held by the groups in '_ht', and the budget it may grow to
+    // before new groups are spilled.
+    long long _htMemoryUsage{0};
+    long long _htMemoryLimit{0};
+
+    // The child accessors of every slot needed to aggregate an input row: the group by slots
+    // followed by the slots read by the aggregate expressions. A spilled row holds their values.
+    std::vector<value::SlotAccessor*> _inRowAccessors;
+    value::SlotMap<size_t> _inRowSlots;
+    std::vector<std::unique_ptr<value::MaterializedSingleRowAccessor>> _spilledRowAccessors;
+    std::vector<std::unique_ptr<value::SwitchAccessor>> _inSwitchAccessors;
+    bool _compilingAggs{false};
+
+    // The spill table. The rows of each partition are buffered in '_spillBufs' and written out in
+    // batches, so a single record holds many rows of the same partition. '_spillCounts' and
+    // '_spillDepths' hold the number of records of each partition and how many times its rows
+    // have been partitioned.
+    std::unique_ptr<SpillingStore> _recordStore;
+    std::vector<BufBuilder> _spillBufs;
+    int _spillBufBytes{0};
+    std::vector<int64_t> _spillCounts;
+    std::vector<size_t> _spillDepths;
+    size_t _nextPartition{0};
+
+    // Whether rows of the current pass, over either the child or a spilled partition, have been
+    // spilled. If so, they went to the 'kNumPartitions' partitions starting at '_spillBase', at
+    // depth '_spillDepth'.
+    bool _spilling{false};
+    size_t _spillDepth{0};
+    size_t _spillBase{0};
+
+    // The spilled row currently being aggregated.
+    value::MaterializedRow _spilledRow;
+
     vm::ByteCode _bytecode;
 
+    HashAggStats _specificStats;
+
     bool _compiled{false};
 };
 }  // namespace sbe
@@ -32,6 +32,7 @@
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -43,6 +44,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              value::SlotVector innerCond,
                              value::SlotVector innerProjects,
                              boost::optional<value::SlotId> collatorSlot,
+                             bool allowDiskUse,
                              PlanNodeId planNodeId)
     : PlanStage("hj"_sd, planNodeId),
       _outerCond(std::move(outerCond)),
@@ -50,6 +52,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
       _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse),
       _probeKey(0) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
@@ -67,6 +70,7 @@ std::unique_ptr<PlanStage> HashJoinStage::clone() const {
                                            _innerCond,
                                            _innerProjects,
                                            _collatorSlot,
+                                           _allowDiskUse,
                                            _commonStats.nodeId);
 }
 
@@ -100,6 +104,24 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         _inInnerKeyAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
     }
 
+    for (auto& slot : _innerProjects) {
+        _inInnerProjectAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+    }
+
+    // The inner values are laid out in the spilled probe rows in the same order.
+    counter = 0;
+    for (auto slots : {&_innerCond, &_innerProjects}) {
+        for (auto& slot : *slots) {
+            _outSpilledInnerAccessors.emplace_back(
+                std::make_unique<value::MaterializedSingleRowAccessor>(_spilledInnerRow,
+                                                                       counter++));
+            _outInnerSwitchAccessors.emplace_back(
+                std::make_unique<value::SwitchAccessor>(std::vector<value::SlotAccessor*>{
+                    _children[1]->getAccessor(ctx, slot), _outSpilledInnerAccessors.back().get()}));
+            _outInnerAccessors.emplace(slot, _outInnerSwitchAccessors.back().get());
+        }
+    }
+
     counter = 0;
     for (auto& slot : _outerProjects) {
         auto [it, inserted] = dupCheck.emplace(slot);
@@ -112,6 +134,7 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
     }
 
     _probeKey.resize(_inInnerKeyAccessors.size());
+    _bytecode.setProfile(getVmProfile());
 
     _compiled = true;
 }
@@ -122,15 +145,172 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
             return it->second;
         }
 
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second;
+        }
+
         return _children[1]->getAccessor(ctx, slot);
     }
 
     return ctx.getAccessor(slot);
 }
 
+void HashJoinStage::spillHashTable() {
+    for (auto table : {&_buildTable, &_probeTable}) {
+        table->emplace();
+        (*table)->store = std::make_unique<SpillingStore>(_opCtx);
+        (*table)->bufs = std::vector<BufBuilder>(kNumPartitions);
+        (*table)->counts.fill(0);
+    }
+    _specificStats.usedDisk = true;
+
+    for (auto&& [key, project] : *_ht) {
+        spillRow(*_buildTable, key, {&key, &project});
+        ++_specificStats.spilledBuildRecords;
+    }
+
+    _ht->clear();
+    _htMemoryUsage = 0;
+}
+
+void HashJoinStage::spillRow(SpillTable& table,
+                             const value::MaterializedRow& key,
+                             std::initializer_list<const value::MaterializedRow*> rows) {
+    // The partition is picked with the hash table's own hasher so that keys which are equal under
+    // the collation always land in the same partition.
+    auto& buf = table.bufs[_ht->hash_function()(key) % kNumPartitions];
+    const auto before = buf.len();
+    for (auto row : rows) {
+        row->serializeForSorter(buf);
+    }
+    table.bufBytes += buf.len() - before;
+
+    if (table.bufBytes >= kSpillBatchBytes) {
+        flushSpilledRows(table);
+    }
+}
+
+void HashJoinStage::flushSpilledRows(SpillTable& table) {
+    if (!table.bufBytes) {
+        return;
+    }
+
+    std::vector<Record> records;
+    for (size_t partition = 0; partition < kNumPartitions; ++partition) {
+        auto& buf = table.bufs[partition];
+        if (buf.len()) {
+            const RecordId rid{static_cast<int64_t>(partition << kPartitionShift) +
+                               ++table.counts[partition]};
+            records.push_back(Record{rid, RecordData(buf.buf(), buf.len())});
+        }
+    }
+
+    table.store->insertRecords(_opCtx, &records);
+
+    for (auto& buf : table.bufs) {
+        buf.reset();
+    }
+    table.bufBytes = 0;
+}
+
+RecordData HashJoinStage::readSpilledRecord(const SpillTable& table,
+                                            size_t partition,
+                                            int64_t seq) {
+    const RecordId rid{static_cast<int64_t>(partition << kPartitionShift) + seq};
+    return table.store->findRecord(_opCtx, rid);
+}
+
+void HashJoinStage::partitionInnerSide() {
+    value::MaterializedRow row{_inInnerKeyAccessors.size() + _inInnerProjectAccessors.size()};
+
+    while (_children[1]->getNext() == PlanState::ADVANCED) {
+        size_t idx = 0;
+        for (auto& p : _inInnerKeyAccessors) {
+            auto [tag, val] = p->getViewOfValue();
+            _probeKey.reset(idx, false, tag, val);
+            row.reset(idx++, false, tag, val);
+        }
+
+        for (auto& p : _inInnerProjectAccessors) {
+            auto [tag, val] = p->getViewOfValue();
+            row.reset(idx++, false, tag, val);
+        }
+
+        spillRow(*_probeTable, _probeKey, {&row});
+        ++_specificStats.spilledProbeRecords;
+    }
+
+    flushSpilledRows(*_probeTable);
+}
+
+bool HashJoinStage::nextSpilledProbeRow() {
+    while (_probeOffset == static_cast<int>(_probeData.size())) {
+        if (_probePartition == kNumPartitions) {
+            return false;
+        }
+
+        if (_probeSeq == _probeTable->counts[_probePartition]) {
+            ++_probePartition;
+            _probeSeq = 0;
+            continue;
+        }
+
+        _probeData = readSpilledRecord(*_probeTable, _probePartition, ++_probeSeq);
+        _probeOffset = 0;
+    }
+
+    // Build partitions without any probe rows are never loaded.
+    if (_probePartition != _loadedPartition) {
+        loadBuildPartition(_probePartition);
+    }
+
+    BufReader reader(_probeData.data() + _probeOffset, _probeData.size() - _probeOffset);
+    _spilledInnerRow = value::MaterializedRow::deserializeForSorter(reader, {});
+    _probeOffset += reader.offset();
+
+    for (size_t idx = 0; idx < _probeKey.size(); ++idx) {
+        auto [tag, val] = _spilledInnerRow.getViewOfValue(idx);
+        _probeKey.reset(idx, false, tag, val);
+    }
+
+    return true;
+}
+
+void HashJoinStage::loadBuildPartition(size_t partition) {
+    _ht->clear();
+    _loadedPartition = partition;
+
+    for (int64_t seq = 1; seq <= _buildTable->counts[partition]; ++seq) {
+        auto data = readSpilledRecord(*_buildTable, partition, seq);
+        BufReader reader(data.data(), data.size());
+        while (!reader.atEof()) {
+            auto key = value::MaterializedRow::deserializeForSorter(reader, {});
+            auto project = value::MaterializedRow::deserializeForSorter(reader, {});
+            _ht->emplace(std::move(key), std::move(project));
+        }
+    }
+}
+
+void HashJoinStage::releaseSpillTables() {
+    _loadedPartition = boost::none;
+    _probePartition = 0;
+    _probeSeq = 0;
+    _probeData = RecordData{};
+    _probeOffset = 0;
+
+    for (auto table : {&_buildTable, &_probeTable}) {
+        if (*table) {
+            (*table)->store->release(_opCtx);
+            table->reset();
+        }
+    }
+}
+
 void HashJoinStage::open(bool reOpen) {
     auto optTimer(getOptTimer(_opCtx));
 
+    releaseSpillTables();
+
     if (_collatorAccessor) {
         auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
         uassert(5402504, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
@@ -142,6 +322,9 @@ void HashJoinStage::open(bool reOpen) {
         _ht.emplace();
     }
 
+    _htMemoryUsage = 0;
+    _htMemoryLimit = internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes.load();
+
     _commonStats.opens++;
     _children[0]->open(reOpen);
     // Insert the outer side into the hash table.
@@ -163,13 +346,42 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
+        if (_buildTable) {
+            spillRow(*_buildTable, key, {&key, &project});
+            ++_specificStats.spilledBuildRecords;
+            continue;
+        }
+
+        _htMemoryUsage += key.memUsageForSorter() + project.memUsageForSorter();
         _ht->emplace(std::move(key), std::move(project));
+
+        if (_htMemoryUsage >= _htMemoryLimit) {
+            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                    str::stream() << "hash join exceeded memory limit of " << _htMemoryLimit
+                                  << " bytes, but did not opt in to external sorting.",
+                    _allowDiskUse);
+            spillHashTable();
+        }
     }
 
     _children[0]->close();
 
+    if (_buildTable) {
+        flushSpilledRows(*_buildTable);
+    }
+
     _children[1]->open(reOpen);
 
+    for (auto& accessor : _outInnerSwitchAccessors) {
+        accessor->setIndex(_buildTable ? 1 : 0);
+    }
+
+    // Once the build side has spilled, the probe side is partitioned in the same way up front and
+    // the partitions are then joined one at a time.
+    if (_buildTable) {
+        partitionInnerSide();
+    }
+
     _htIt = _ht->end();
     _htItEnd = _ht->end();
 }
@@ -183,17 +395,23 @@ PlanState HashJoinStage::getNext() {
 
     if (_htIt == _htItEnd) {
         while (_htIt == _htItEnd) {
-            auto state = _children[1]->getNext();
-            if (state == PlanState::IS_EOF) {
-                // LEFT and OUTER joins should enumerate "non-returned" rows here.
-                return trackPlanState(state);
-            }
-
-            // Copy keys in order to do the lookup.
-            size_t idx = 0;
-            for (auto& p : _inInnerKeyAccessors) {
-                auto [tag, val] = p->getViewOfValue();
-                _probeKey.reset(idx++, false, tag, val);
+            if (_buildTable) {
+                if (!nextSpilledProbeRow()) {
+                    return trackPlanState(PlanState::IS_EOF);
+                }
+            } else {
+                auto state = _children[1]->getNext();
+                if (state == PlanState::IS_EOF) {
+                    // LEFT and OUTER joins should enumerate "non-returned" rows here.
+                    return trackPlanState(state);
+                }
+
+                // Copy keys in order to do the lookup.
+                size_t idx = 0;
+                for (auto& p : _inInnerKeyAccessors) {
+                    auto [tag, val] = p->getViewOfValue();
+                    _probeKey.reset(idx++, false, tag, val);
+                }
             }
 
             auto [low, hi] = _ht->equal_range(_probeKey);
@@ -213,17 +431,30 @@ void HashJoinStage::close() {
     trackClose();
     _children[1]->close();
     _ht = boost::none;
+    releaseSpillTables();
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.appendBool("usedDisk", _specificStats.usedDisk);
+        bob.appendNumber("spilledBuildRecords",
+                         static_cast<long long>(_specificStats.spilledBuildRecords));
+        bob.appendNumber("spilledProbeRecords",
+                         static_cast<long long>(_specificStats.spilledProbeRecords));
+        ret->debugInfo = bob.obj();
+    }
+
     ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
     ret->children.emplace_back(_children[1]->getStats(includeDebugInfo));
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
@@ -29,12 +29,26 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/util/spilling.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 
 namespace mongo::sbe {
+/**
+ * Joins the rows of its outer (build) and inner (probe) children on equality of the 'outerCond'
+ * and 'innerCond' slots. The outer side is loaded into a hash table which is then probed by every
+ * row of the inner side.
+ *
+ * Once the hash table grows past 'internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes' the
+ * stage either fails with 'QueryExceededMemoryLimitNoDiskUseAllowed' (if 'allowDiskUse' is false)
+ * or switches to a grace hash join: both sides are hash partitioned into temporary record stores,
+ * and each build partition is loaded into memory in turn and joined with the matching probe
+ * partition. In that mode only the 'innerCond' and 'innerProjects' slots of the inner side are
+ * available to the parent stage.
+ */
 class HashJoinStage final : public PlanStage {
 public:
     HashJoinStage(std::unique_ptr<PlanStage> outer,
@@ -44,6 +58,7 @@ public:
                   value::SlotVector innerCond,
                   value::SlotVector innerProjects,
                   boost::optional<value::SlotId> collatorSlot,
+                  bool allowDiskUse,
                   PlanNodeId planNodeId);
 
     std::unique_ptr<PlanStage> clone() const final;
@@ -67,11 +82,68 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashProjectAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    // The number of partitions each side is split into once the join spills.
+    static constexpr size_t kNumPartitions = 32;
+    // Record ids of spilled records carry their partition above this bit.
+    static constexpr int kPartitionShift = 40;
+    // Spilled rows are buffered in memory and written out once this many bytes are pending.
+    static constexpr int kSpillBatchBytes = 1024 * 1024;
+
+    /**
+     * A hash partitioned spill table. The rows of each partition are buffered in 'bufs' and written
+     * out in batches, so a single record holds many rows of the same partition. The records of
+     * partition 'p' have the record ids '(p << kPartitionShift) + 1' to
+     * '(p << kPartitionShift) + counts[p]'.
+     */
+    struct SpillTable {
+        std::unique_ptr<SpillingStore> store;
+        std::vector<BufBuilder> bufs;
+        int bufBytes{0};
+        std::array<int64_t, kNumPartitions> counts;
+    };
+
+    /**
+     * Creates the spill tables and moves the contents of the hash table into the build partitions.
+     */
+    void spillHashTable();
+
+    /**
+     * Buffers 'rows' for the partition of 'table' selected by the hash of 'key', writing out the
+     * buffered rows of 'table' once they reach 'kSpillBatchBytes'.
+     */
+    void spillRow(SpillTable& table,
+                  const value::MaterializedRow& key,
+                  std::initializer_list<const value::MaterializedRow*> rows);
+
+    /**
+     * Writes the buffered rows of every partition of 'table' out as one record per partition, in a
+     * single storage transaction of the spill table's own recovery unit.
+     */
+    void flushSpilledRows(SpillTable& table);
+
+    RecordData readSpilledRecord(const SpillTable& table, size_t partition, int64_t seq);
+
+    /**
+     * Materializes every row of the inner side into the probe partitions.
+     */
+    void partitionInnerSide();
+
+    /**
+     * Reads the next spilled probe row into '_spilledInnerRow' and points '_probeKey' at its key,
+     * loading the matching build partition into the hash table first if needed. Returns false once
+     * all probe partitions have been consumed.
+     */
+    bool nextSpilledProbeRow();
+    void loadBuildPartition(size_t partition);
+
+    void releaseSpillTables();
+
     const value::SlotVector _outerCond;
     const value::SlotVector _outerProjects;
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -91,6 +163,15 @@ private:
     // Accessors of input condition values (keys) that are being inserted into the hash table.
     std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
 
+    // Accessors of the inner side values which are materialized into the probe partitions.
+    std::vector<value::SlotAccessor*> _inInnerProjectAccessors;
+
+    // Inner side values exposed to the parent. These switch between the inner child and the
+    // probe row read back from disk, depending on whether the join has spilled.
+    value::SlotAccessorMap _outInnerAccessors;
+    std::vector<std::unique_ptr<value::SwitchAccessor>> _outInnerSwitchAccessors;
+    std::vector<std::unique_ptr<value::MaterializedSingleRowAccessor>> _outSpilledInnerAccessors;
+
     // Accessor for collator. Only set if collatorSlot provided during construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
 
@@ -101,8 +182,33 @@ private:
     TableType::iterator _htIt;
     TableType::iterator _htItEnd;
 
+    // The approximate number of bytes held by the rows in '_ht', and the budget it may grow to
+    // before the join spills.
+    long long _htMemoryUsage{0};
+    long long _htMemoryLimit{0};
+
+    // The spill tables, only created once the join spills.
+    boost::optional<SpillTable> _buildTable;
+    boost::optional<SpillTable> _probeTable;
+
+    // The partition currently loaded into '_ht'.
+    boost::optional<size_t> _loadedPartition;
+
+    // The position of the next spilled probe row: the partition and record it is read from, and
+    // its offset in the record's data.
+    size_t _probePartition{0};
+    int64_t _probeSeq{0};
+    RecordData _probeData;
+    int _probeOffset{0};
+
+    // The inner condition values followed by the inner projections of the current probe row, when
+    // it has been read back from disk.
+    value::MaterializedRow _spilledInnerRow;
+
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    HashJoinStats _specificStats;
 };
 }  // namespace mongo::sbe
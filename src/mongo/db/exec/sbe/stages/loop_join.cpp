@@ -76,6 +76,7 @@ void LoopJoinStage::prepare(CompileCtx& ctx) {
     if (_predicate) {
         ctx.root = this;
         _predicateCode = _predicate->compile(ctx);
+        _bytecode.setProfile(getVmProfile());
     }
 }
 
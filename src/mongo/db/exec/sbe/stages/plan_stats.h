@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/exec/sbe/vm/vm_profile.h"
 #include "mongo/db/query/stage_types.h"
 
 namespace mongo::sbe {
@@ -60,6 +61,10 @@ struct CommonStats {
     // cache.
     boost::optional<long long> executionTimeMillis;
 
+    // Profile of the bytecode executed by this stage. Only populated when VM profiling was
+    // requested for the query, see PlanStage::markShouldCollectVmProfile().
+    boost::optional<vm::ByteCodeProfile> vmProfile;
+
     size_t advances{0};
     size_t opens{0};
     size_t closes{0};
@@ -196,6 +201,38 @@ struct TraverseStats : public SpecificStats {
     size_t innerCloses{0};
 };
 
+struct HashAggStats : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashAggStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    bool usedDisk{false};
+    // The number of groups built from the spill table after the hash table reached its memory
+    // budget.
+    size_t spilledGroups{0};
+    // The number of input rows which were written to the spill table.
+    size_t spilledRecords{0};
+};
+
+struct HashJoinStats : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashJoinStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    bool usedDisk{false};
+    // The number of outer (build) and inner (probe) rows written to the partitions on disk.
+    size_t spilledBuildRecords{0};
+    size_t spilledProbeRecords{0};
+};
+
 /**
  * Calculates the total number of physical reads in the given plan stats tree. If a stage can do
  * a physical read (e.g. COLLSCAN or IXSCAN), then its 'numReads' stats is added to the total.
@@ -51,6 +51,7 @@ std::unique_ptr<PlanStage> ProjectStage::clone() const {
 
 void ProjectStage::prepare(CompileCtx& ctx) {
     _children[0]->prepare(ctx);
+    _bytecode.setProfile(getVmProfile());
 
     // Compile project expressions here.
     for (auto& [slot, expr] : _projects) {
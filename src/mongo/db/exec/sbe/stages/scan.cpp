@@ -39,6 +39,69 @@
 
 namespace mongo {
 namespace sbe {
+void ScanFieldExtractor::init(const std::vector<std::string>& fields,
+                              const value::FieldAccessorMap& accessors) {
+    _fields.clear();
+    _fieldsByName.clear();
+    _lengths = 0;
+    _firstChars.reset();
+    _previousLayout.clear();
+
+    _fields.reserve(fields.size());
+    for (auto&& name : fields) {
+        _fields.push_back({name, accessors.at(name).get()});
+        _lengths |= uint64_t{1} << (name.size() % 64);
+        if (!name.empty()) {
+            _firstChars.set(static_cast<unsigned char>(name[0]));
+        }
+    }
+    for (auto&& field : _fields) {
+        _fieldsByName.emplace(field.name, &field);
+    }
+}
+
+void ScanFieldExtractor::extract(const char* rawBson) {
+    for (auto&& field : _fields) {
+        field.accessor->reset();
+    }
+
+    auto fieldsToMatch = _fields.size();
+    auto be = rawBson + 4;
+    auto end = rawBson + ConstDataView(rawBson).read<LittleEndian<uint32_t>>();
+    for (size_t pos = 0; *be != 0; ++pos) {
+        auto sv = bson::fieldNameView(be);
+
+        const Field* field = nullptr;
+        if (pos < _previousLayout.size() && _previousLayout[pos] &&
+            _previousLayout[pos]->name == sv) {
+            field = _previousLayout[pos];
+        } else if (mayMatch(sv)) {
+            if (auto it = _fieldsByName.find(sv); it != _fieldsByName.end()) {
+                field = it->second;
+            }
+        }
+
+        if (pos < _previousLayout.size()) {
+            _previousLayout[pos] = field;
+        } else {
+            _previousLayout.push_back(field);
+        }
+
+        if (field) {
+            // Found the field so convert it to Value.
+            auto [tag, val] = bson::convertFrom(true, be, end, sv.size());
+            field->accessor->reset(false, tag, val);
+
+            if ((--fieldsToMatch) == 0) {
+                // No need to scan any further so bail out early.
+                break;
+            }
+        }
+
+        be = bson::advance(be, sv.size());
+    }
+}
+
 ScanStage::ScanStage(CollectionUUID collectionUuid,
                      boost::optional<value::SlotId> recordSlot,
                      boost::optional<value::SlotId> recordIdSlot,
@@ -111,6 +174,7 @@ void ScanStage::prepare(CompileCtx& ctx) {
         auto [itRename, insertedRename] = _varAccessors.emplace(_vars[idx], it->second.get());
         uassert(4822815, str::stream() << "duplicate field: " << _vars[idx], insertedRename);
     }
+    _fieldExtractor.init(_fields, _fieldAccessors);
 
     if (_seekKeySlot) {
         _seekKeyAccessor = ctx.getAccessor(*_seekKeySlot);
@@ -134,6 +198,7 @@ void ScanStage::prepare(CompileCtx& ctx) {
 
     if (_oplogTsSlot) {
         _oplogTsAccessor = ctx.getRuntimeEnvAccessor(*_oplogTsSlot);
+        _oplogTsFieldAccessor = _fieldAccessors.at(repl::OpTime::kTimestampFieldName).get();
     }
 
     std::tie(_collName, _catalogEpoch) =
@@ -327,33 +392,14 @@ PlanState ScanStage::getNext() {
     }
 
     if (!_fieldAccessors.empty()) {
-        auto fieldsToMatch = _fieldAccessors.size();
-        auto rawBson = nextRecord->data.data();
-        auto be = rawBson + 4;
-        auto end = rawBson + ConstDataView(rawBson).read<LittleEndian<uint32_t>>();
-        for (auto& [name, accessor] : _fieldAccessors) {
-            accessor->reset();
-        }
-        while (*be != 0) {
-            auto sv = bson::fieldNameView(be);
-            if (auto it = _fieldAccessors.find(sv); it != _fieldAccessors.end()) {
-                // Found the field so convert it to Value.
-                auto [tag, val] = bson::convertFrom(true, be, end, sv.size());
-
-                if (_oplogTsAccessor && it->first == repl::OpTime::kTimestampFieldName) {
-                    auto&& [ownedTag, ownedVal] = value::copyValue(tag, val);
-                    _oplogTsAccessor->reset(false, ownedTag, ownedVal);
-                }
-
-                it->second->reset(false, tag, val);
+        _fieldExtractor.extract(nextRecord->data.data());
 
-                if ((--fieldsToMatch) == 0) {
-                    // No need to scan any further so bail out early.
-                    break;
-                }
+        if (_oplogTsAccessor) {
+            if (auto [tag, val] = _oplogTsFieldAccessor->getViewOfValue();
+                tag != value::TypeTags::Nothing) {
+                auto&& [ownedTag, ownedVal] = value::copyValue(tag, val);
+                _oplogTsAccessor->reset(false, ownedTag, ownedVal);
             }
-
-            be = bson::advance(be, sv.size());
         }
     }
 
@@ -507,10 +553,10 @@ ParallelScanStage::ParallelScanStage(CollectionUUID collectionUuid,
       _indexKeyPatternSlot(indexKeyPatternSlot),
       _fields(std::move(fields)),
       _vars(std::move(vars)),
+      _state(std::make_shared<ParallelState>()),
+      _isClone(false),
       _scanCallbacks(std::move(callbacks)) {
     invariant(_fields.size() == _vars.size());
-
-    _state = std::make_shared<ParallelState>();
 }
 
 ParallelScanStage::ParallelScanStage(const std::shared_ptr<ParallelState>& state,
@@ -537,11 +583,39 @@ ParallelScanStage::ParallelScanStage(const std::shared_ptr<ParallelState>& state
       _fields(std::move(fields)),
       _vars(std::move(vars)),
       _state(state),
+      _isClone(true),
       _scanCallbacks(std::move(callbacks)) {
     invariant(_fields.size() == _vars.size());
+
+    stdx::lock_guard lock(_state->mutex);
+    ++_state->numClones;
+}
+
+ParallelScanStage::~ParallelScanStage() {
+    if (_isClone) {
+        stdx::lock_guard lock(_state->mutex);
+        --_state->numClones;
+    }
 }
 
 std::unique_ptr<PlanStage> ParallelScanStage::clone() const {
+    {
+        // An exchange makes the clones for an execution of the plan before it starts any of them,
+        // and the clones of the previous execution are gone by then. So the first clone made while
+        // no other exists starts a new execution, which must not pick up where the previous one
+        // left off. If the plan is in a trial run, the clones may read as much as the trial run
+        // has left.
+        stdx::lock_guard lock(_state->mutex);
+        if (_state->numClones == 0) {
+            _state->ranges.clear();
+            _state->currentRange.store(0);
+            _state->numReads.store(0);
+            _state->maxReads.store(
+                _tracker ? std::max(_tracker->getRemaining<TrialRunTracker::kNumReads>(), size_t{1})
+                         : 0);
+        }
+    }
+
     return std::make_unique<ParallelScanStage>(_state,
                                                _collUuid,
                                                _recordSlot,
@@ -573,6 +647,7 @@ void ParallelScanStage::prepare(CompileCtx& ctx) {
         auto [itRename, insertedRename] = _varAccessors.emplace(_vars[idx], it->second.get());
         uassert(4822817, str::stream() << "duplicate field: " << _vars[idx], insertedRename);
     }
+    _fieldExtractor.init(_fields, _fieldAccessors);
 
     if (_snapshotIdSlot) {
         _snapshotIdAccessor = ctx.getAccessor(*_snapshotIdSlot);
@@ -649,6 +724,15 @@ void ParallelScanStage::doRestoreState() {
     }
 }
 
+void ParallelScanStage::doDetachFromTrialRunTracker() {
+    _tracker = nullptr;
+    _state->maxReads.store(0);
+}
+
+void ParallelScanStage::doAttachToTrialRunTracker(TrialRunTracker* tracker) {
+    _tracker = tracker;
+}
+
 void ParallelScanStage::doDetachFromOperationContext() {
     if (_cursor) {
         _cursor->detachFromOperationContext();
@@ -737,6 +821,12 @@ PlanState ParallelScanStage::getNext() {
 
     checkForInterrupt(_opCtx);
 
+    // The clones stop before reading a record once they have used up the reads of the trial run
+    // between them, so that they can carry on from there if the plan keeps running afterwards.
+    if (auto maxReads = _state->maxReads.load(); maxReads && _state->numReads.load() >= maxReads) {
+        uasserted(ErrorCodes::QueryTrialRunCompleted, "Trial run early exit in pscan");
+    }
+
     boost::optional<Record> nextRecord;
 
     // Loop until we have a valid result or we return EOF.
@@ -787,29 +877,18 @@ PlanState ParallelScanStage::getNext() {
 
 
     if (!_fieldAccessors.empty()) {
-        auto fieldsToMatch = _fieldAccessors.size();
-        auto rawBson = nextRecord->data.data();
-        auto be = rawBson + 4;
-        auto end = rawBson + ConstDataView(rawBson).read<LittleEndian<uint32_t>>();
-        for (auto& [name, accessor] : _fieldAccessors) {
-            accessor->reset();
-        }
-        while (*be != 0) {
-            auto sv = bson::fieldNameView(be);
-            if (auto it = _fieldAccessors.find(sv); it != _fieldAccessors.end()) {
-                // Found the field so convert it to Value.
-                auto [tag, val] = bson::convertFrom(true, be, end, sv.size());
-
-                it->second->reset(false, tag, val);
-
-                if ((--fieldsToMatch) == 0) {
-                    // No need to scan any further so bail out early.
-                    break;
-                }
-            }
+        _fieldExtractor.extract(nextRecord->data.data());
+    }
 
-            be = bson::advance(be, sv.size());
+    if (_isClone) {
+        if (_state->maxReads.load()) {
+            _state->numReads.fetchAndAdd(1);
         }
+    } else if (_tracker && _tracker->trackProgress<TrialRunTracker::kNumReads>(1)) {
+        // The stage is run without clones, in which case it ends the trial run itself, as the
+        // ScanStage does.
+        _tracker = nullptr;
+        uasserted(ErrorCodes::QueryTrialRunCompleted, "Trial run early exit in pscan");
     }
 
     return trackPlanState(PlanState::ADVANCED);
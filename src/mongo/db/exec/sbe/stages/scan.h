@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <bitset>
+
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/collection_helpers.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
@@ -55,6 +57,53 @@ struct ScanCallbacks {
     ScanOpenCallback scanOpenCallback;
 };
 
+/**
+ * Extracts a fixed set of top-level fields from BSON documents. All the fields are resolved in a
+ * single walk over a document, which stops as soon as every field has been found.
+ *
+ * Most fields of a wide document are usually not requested, so each field name is first checked
+ * against a cheap filter on its length and first character, and only looked up by name if it
+ * passes. The extractor also remembers which requested field was found at each position of the
+ * previous document. Documents in a collection tend to share a layout, so the field at a given
+ * position can usually be confirmed with a single comparison rather than a lookup.
+ */
+class ScanFieldExtractor {
+public:
+    /**
+     * Sets up the extractor to store the value of each field in 'fields' in the accessor for that
+     * field in 'accessors'. Both must outlive the extractor.
+     */
+    void init(const std::vector<std::string>& fields, const value::FieldAccessorMap& accessors);
+
+    /**
+     * Resets all the accessors, then points each of them to the value of its field in the BSON
+     * object 'rawBson' if the field is present. The values are not copied.
+     */
+    void extract(const char* rawBson);
+
+private:
+    struct Field {
+        StringData name;
+        value::OwnedValueAccessor* accessor;
+    };
+
+    bool mayMatch(StringData name) const {
+        return (_lengths & (uint64_t{1} << (name.size() % 64))) &&
+            (name.empty() || _firstChars.test(static_cast<unsigned char>(name[0])));
+    }
+
+    std::vector<Field> _fields;
+    StringMap<const Field*> _fieldsByName;
+
+    // Bit sets of the lengths (modulo 64) and the first characters of the requested field names.
+    uint64_t _lengths{0};
+    std::bitset<256> _firstChars;
+
+    // The requested field found at each position of the previous document, or nullptr if the
+    // field at that position was not requested.
+    std::vector<const Field*> _previousLayout;
+};
+
 class ScanStage final : public PlanStage {
 public:
     ScanStage(CollectionUUID collectionUuid,
@@ -129,6 +178,8 @@ private:
     value::FieldAccessorMap _fieldAccessors;
     value::SlotAccessorMap _varAccessors;
     value::SlotAccessor* _seekKeyAccessor{nullptr};
+    ScanFieldExtractor _fieldExtractor;
+    value::OwnedValueAccessor* _oplogTsFieldAccessor{nullptr};
 
     bool _open{false};
 
@@ -149,6 +200,14 @@ class ParallelScanStage final : public PlanStage {
         Mutex mutex = MONGO_MAKE_LATCH("ParallelScanStage::ParallelState::mutex");
         std::vector<Range> ranges;
         AtomicWord<size_t> currentRange{0};
+
+        // The number of clones of the stage which exist. Protected by 'mutex'.
+        size_t numClones{0};
+
+        // The number of records the clones may read between them before they stop for the trial
+        // run the plan is in, or zero outside of a trial run, and the number read so far.
+        AtomicWord<size_t> maxReads{0};
+        AtomicWord<size_t> numReads{0};
     };
 
 public:
@@ -165,6 +224,9 @@ public:
                       PlanNodeId nodeId,
                       ScanCallbacks callbacks);
 
+    /**
+     * Makes a clone of a parallel scan, which shares 'state' with the other clones.
+     */
     ParallelScanStage(const std::shared_ptr<ParallelState>& state,
                       CollectionUUID collectionUuid,
                       boost::optional<value::SlotId> recordSlot,
@@ -179,6 +241,8 @@ public:
                       PlanNodeId nodeId,
                       ScanCallbacks callbacks);
 
+    ~ParallelScanStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -196,6 +260,8 @@ protected:
     void doRestoreState() final;
     void doDetachFromOperationContext() final;
     void doAttachToOperationContext(OperationContext* opCtx) final;
+    void doDetachFromTrialRunTracker() final;
+    void doAttachToTrialRunTracker(TrialRunTracker* tracker) final;
 
 private:
     boost::optional<Record> nextRange();
@@ -219,7 +285,13 @@ private:
     NamespaceString _collName;
     uint64_t _catalogEpoch;
 
-    std::shared_ptr<ParallelState> _state;
+    // Shared by this stage and all of its clones.
+    const std::shared_ptr<ParallelState> _state;
+    const bool _isClone;
+
+    // If provided, used during a trial run to accumulate certain execution stats. The clones made
+    // during the trial run share the reads left to it through '_state' instead.
+    TrialRunTracker* _tracker{nullptr};
 
     const ScanCallbacks _scanCallbacks;
 
@@ -232,6 +304,7 @@ private:
 
     value::FieldAccessorMap _fieldAccessors;
     value::SlotAccessorMap _varAccessors;
+    ScanFieldExtractor _fieldExtractor;
 
     size_t _currentRange{std::numeric_limits<std::size_t>::max()};
     Range _range;
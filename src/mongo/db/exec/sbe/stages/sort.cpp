@@ -34,6 +34,7 @@
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/trial_run_tracker.h"
 #include "mongo/db/stats/resource_consumption_metrics.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/str.h"
 
 namespace {
@@ -67,6 +68,14 @@ SortStage::SortStage(std::unique_ptr<PlanStage> input,
 
     _specificStats.limit = limit;
     _specificStats.maxMemoryUsageBytes = memoryLimit;
+
+    if (_obs.size() <= Ordering::kMaxCompoundIndexKeys) {
+        BSONObjBuilder bob;
+        for (auto dir : _dirs) {
+            bob.append(""_sd, dir == value::SortDirection::Ascending ? 1 : -1);
+        }
+        _keyStringOrdering = Ordering::make(bob.done());
+    }
 }
 
 SortStage::~SortStage() {}
@@ -118,6 +127,56 @@ value::SlotAccessor* SortStage::getAccessor(CompileCtx& ctx, value::SlotId slot)
     return ctx.getAccessor(slot);
 }
 
+std::pair<value::TypeTags, value::Value> SortStage::makeKeyString() const {
+    // 'value::compareValue()' compares a 64-bit integer with a double by converting the integer to
+    // a double, while a KeyString compares them exactly. The two agree for integers which convert
+    // exactly.
+    constexpr int64_t kMaxExactInt64 = 1LL << std::numeric_limits<double>::digits;
+
+    KeyString::Builder kb{KeyString::Version::V1, *_keyStringOrdering};
+    for (auto accessor : _inKeyAccessors) {
+        // Only the types for which the KeyString order is known to agree with
+        // 'value::compareValue()' are encoded.
+        auto [tag, val] = accessor->getViewOfValue();
+        switch (tag) {
+            case value::TypeTags::NumberInt32:
+                kb.appendNumberLong(value::bitcastTo<int32_t>(val));
+                break;
+            case value::TypeTags::NumberInt64: {
+                auto num = value::bitcastTo<int64_t>(val);
+                if (num > kMaxExactInt64 || num < -kMaxExactInt64) {
+                    return {value::TypeTags::Nothing, 0};
+                }
+                kb.appendNumberLong(num);
+                break;
+            }
+            case value::TypeTags::NumberDouble:
+                kb.appendNumberDouble(value::bitcastTo<double>(val));
+                break;
+            case value::TypeTags::StringSmall:
+            case value::TypeTags::StringBig:
+            case value::TypeTags::bsonString:
+                kb.appendString(value::getStringView(tag, val));
+                break;
+            case value::TypeTags::Null:
+                kb.appendNull();
+                break;
+            case value::TypeTags::ObjectId:
+            case value::TypeTags::bsonObjectId: {
+                auto objId = tag == value::TypeTags::ObjectId
+                    ? value::getObjectIdView(val)->data()
+                    : value::bitcastTo<uint8_t*>(val);
+                kb.appendOID(OID::from(objId));
+                break;
+            }
+            default:
+                return {value::TypeTags::Nothing, 0};
+        }
+    }
+
+    return value::makeNewString(StringData{kb.getBuffer(), kb.getSize()});
+}
+
 void SortStage::makeSorter() {
     SortOptions opts;
     opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
@@ -126,10 +185,24 @@ void SortStage::makeSorter() {
     opts.limit =
         _specificStats.limit != std::numeric_limits<size_t>::max() ? _specificStats.limit : 0;
 
+    // The comparator reads '_useKeyStrings', which open() may clear while it adds rows to the
+    // sorter. Runs are only merged once all rows have been added, but a background spill would
+    // sort concurrently with open(), so it is only allowed when KeyStrings are never used.
+    opts.backgroundSpill = !_keyStringOrdering && gInternalSorterBackgroundSpill.load();
+    opts.mergeThreads = gInternalSorterMergeThreads.load();
+
     auto comp = [&](const SorterData& lhs, const SorterData& rhs) {
-        auto size = lhs.first.size();
+        auto size = _obs.size();
         auto& left = lhs.first;
         auto& right = rhs.first;
+        if (_useKeyStrings) {
+            // The sort directions are already accounted for by the KeyString ordering.
+            auto [lhsTag, lhsVal] = left.getViewOfValue(size);
+            auto [rhsTag, rhsVal] = right.getViewOfValue(size);
+            return value::getStringView(lhsTag, lhsVal)
+                .compare(value::getStringView(rhsTag, rhsVal));
+        }
+
         for (size_t idx = 0; idx < size; ++idx) {
             auto [lhsTag, lhsVal] = left.getViewOfValue(idx);
             auto [rhsTag, rhsVal] = right.getViewOfValue(idx);
@@ -164,11 +237,25 @@ void SortStage::open(bool reOpen) {
     _children[0]->open(reOpen);
 
     makeSorter();
+    _useKeyStrings = _keyStringOrdering.has_value();
 
     while (_children[0]->getNext() == PlanState::ADVANCED) {
-        value::MaterializedRow keys{_inKeyAccessors.size()};
+        value::MaterializedRow keys{_inKeyAccessors.size() + (_keyStringOrdering ? 1 : 0)};
         value::MaterializedRow vals{_inValueAccessors.size()};
 
+        // The KeyString is built from views of the input values, so it must be made before the
+        // values are moved into the row below. The KeyStrings of the rows which were already
+        // sorted remain in place but are no longer compared once one row has none. The two
+        // comparisons agree on those rows, so the runs already sorted stay in order.
+        if (_useKeyStrings) {
+            auto [tag, val] = makeKeyString();
+            if (tag == value::TypeTags::Nothing) {
+                _useKeyStrings = false;
+            } else {
+                keys.reset(_inKeyAccessors.size(), true, tag, val);
+            }
+        }
+
         size_t idx = 0;
         for (auto accessor : _inKeyAccessors) {
             auto [tag, val] = accessor->copyOrMoveValue();
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/bson/ordering.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 
 namespace mongo {
@@ -71,6 +72,14 @@ protected:
 private:
     void makeSorter();
 
+    /**
+     * Encodes the current input key values as a single KeyString, so that the sorter can compare
+     * keys of two rows with a memcmp rather than value by value. The KeyString is returned as a
+     * string value, which holds short KeyStrings inline. Returns Nothing if a key cannot be encoded
+     * such that the KeyString order agrees with 'value::compareValue()'.
+     */
+    std::pair<value::TypeTags, value::Value> makeKeyString() const;
+
     using SorterIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
     using SorterData = std::pair<value::MaterializedRow, value::MaterializedRow>;
 
@@ -80,6 +89,15 @@ private:
     const bool _allowDiskUse;
     SortStats _specificStats;
 
+    // The ordering used to encode the sort keys into a KeyString, which is stored in an extra
+    // column after the key values of each row. Not set if there are too many sort keys to encode.
+    boost::optional<Ordering> _keyStringOrdering;
+
+    // True while every row given to the sorter during the current execution has a KeyString. Once
+    // a row's keys cannot be encoded, all rows are compared value by value, so that a comparison
+    // never mixes the two.
+    bool _useKeyStrings{false};
+
     std::vector<value::SlotAccessor*> _inKeyAccessors;
     std::vector<value::SlotAccessor*> _inValueAccessors;
 
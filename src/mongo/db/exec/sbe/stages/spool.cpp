@@ -187,6 +187,7 @@ void SpoolLazyProducerStage::prepare(CompileCtx& ctx) {
     if (_predicate) {
         ctx.root = this;
         _predicateCode = _predicate->compile(ctx);
+        _bytecode.setProfile(getVmProfile());
     }
 
     value::SlotSet dupCheck;
@@ -250,6 +250,19 @@ public:
         }
     }
 
+    /**
+     * Force this stage to profile the bytecode it executes. Must be called before the stage is
+     * prepared.
+     */
+    void markShouldCollectVmProfile() {
+        _commonStats.vmProfile.emplace();
+
+        auto stage = static_cast<T*>(this);
+        for (auto&& child : stage->_children) {
+            child->markShouldCollectVmProfile();
+        }
+    }
+
 protected:
     PlanState trackPlanState(PlanState state) {
         if (state == PlanState::IS_EOF) {
@@ -290,6 +303,14 @@ protected:
         return boost::none;
     }
 
+    /**
+     * Returns the profile the stage's bytecode should be recorded into, or nullptr if VM profiling
+     * is not enabled.
+     */
+    vm::ByteCodeProfile* getVmProfile() {
+        return _commonStats.vmProfile.get_ptr();
+    }
+
     CommonStats _commonStats;
 
 private:
@@ -337,7 +358,7 @@ public:
     }
 
 protected:
-    PlanYieldPolicy* const _yieldPolicy{nullptr};
+    PlanYieldPolicy* _yieldPolicy{nullptr};
 
 private:
     static const int kInterruptCheckPeriod = 128;
@@ -365,6 +386,20 @@ public:
      */
     virtual std::unique_ptr<PlanStage> clone() const = 0;
 
+    /**
+     * Points every stage in this tree which was constructed with yielding enabled to the given
+     * 'yieldPolicy'. A tree cloned from one built for a different query still refers to the yield
+     * policy of that query, so it must be rebound before it is registered with a new executor.
+     */
+    void rebindYieldPolicy(PlanYieldPolicy* yieldPolicy) {
+        if (_yieldPolicy) {
+            _yieldPolicy = yieldPolicy;
+        }
+        for (auto&& child : _children) {
+            child->rebindYieldPolicy(yieldPolicy);
+        }
+    }
+
     /**
      * Prepare this SBE PlanStage tree for execution. Must be called once, and must be called
      * prior to open(), getNext(), close(), saveState(), or restoreState(),
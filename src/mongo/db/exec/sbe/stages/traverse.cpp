@@ -74,6 +74,7 @@ std::unique_ptr<PlanStage> TraverseStage::clone() const {
 void TraverseStage::prepare(CompileCtx& ctx) {
     // Prepare the outer side as usual.
     _children[0]->prepare(ctx);
+    _bytecode.setProfile(getVmProfile());
 
     // Get the inField (incoming) accessor.
     _inFieldAccessor = _children[0]->getAccessor(ctx, _inField);
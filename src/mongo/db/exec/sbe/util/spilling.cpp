@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/util/spilling.h"
+
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace sbe {
+SpillingStore::SpillingStore(OperationContext* opCtx) {
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    tassert(5999112, "Cannot spill without a storage engine", storageEngine);
+
+    _spillingUnit.reset(storageEngine->newRecoveryUnit());
+    _spillingState = WriteUnitOfWork::RecoveryUnitState::kNotInUnitOfWork;
+
+    switchToSpilling(opCtx);
+    ON_BLOCK_EXIT([&] { switchToOriginal(opCtx); });
+    _store = storageEngine->makeTemporaryRecordStore(opCtx);
+}
+
+void SpillingStore::insertRecords(OperationContext* opCtx, std::vector<Record>* records) {
+    switchToSpilling(opCtx);
+    ON_BLOCK_EXIT([&] { switchToOriginal(opCtx); });
+
+    WriteUnitOfWork wuow(opCtx);
+    uassertStatusOK(_store->rs()->insertRecords(
+        opCtx, records, std::vector<Timestamp>(records->size(), Timestamp{})));
+    wuow.commit();
+}
+
+RecordData SpillingStore::findRecord(OperationContext* opCtx, const RecordId& rid) {
+    switchToSpilling(opCtx);
+    ON_BLOCK_EXIT([&] { switchToOriginal(opCtx); });
+
+    RecordData data;
+    auto found = _store->rs()->findRecord(opCtx, rid, &data);
+    tassert(5999113, str::stream() << "Could not find spilled record " << rid, found);
+    return data;
+}
+
+void SpillingStore::release(OperationContext* opCtx) {
+    if (!_store) {
+        return;
+    }
+
+    // The table can only be dropped once no snapshot of the spilling recovery unit has it open.
+    _spillingUnit->abandonSnapshot();
+
+    switchToSpilling(opCtx);
+    ON_BLOCK_EXIT([&] { switchToOriginal(opCtx); });
+
+    // Dropping the table requires at least a global intent lock.
+    Lock::GlobalLock lk(opCtx, MODE_IS);
+    _store->finalizeTemporaryTable(opCtx, TemporaryRecordStore::FinalizationAction::kDelete);
+    _store.reset();
+}
+
+void SpillingStore::switchToSpilling(OperationContext* opCtx) {
+    invariant(!_originalUnit);
+    _originalUnit = opCtx->releaseRecoveryUnit();
+    _originalState = opCtx->setRecoveryUnit(std::move(_spillingUnit), _spillingState);
+}
+
+void SpillingStore::switchToOriginal(OperationContext* opCtx) {
+    invariant(!_spillingUnit);
+    _spillingUnit = opCtx->releaseRecoveryUnit();
+    _spillingState = opCtx->setRecoveryUnit(std::move(_originalUnit), _originalState);
+}
+}  // namespace sbe
+}  // namespace mongo
@@ -0,0 +1,88 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_data.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/db/storage/temporary_record_store.h"
+#include "mongo/db/storage/write_unit_of_work.h"
+
+namespace mongo {
+namespace sbe {
+/**
+ * A temporary record store to which a stage spills the rows it cannot hold in memory.
+ *
+ * Every read and write of the store runs in a recovery unit of its own, which is swapped into the
+ * operation for the duration of the call. Spilling therefore never commits or abandons the storage
+ * transaction the stage's children are reading from, and the spilled rows never become part of an
+ * enclosing multi-document transaction.
+ */
+class SpillingStore {
+public:
+    explicit SpillingStore(OperationContext* opCtx);
+
+    SpillingStore(const SpillingStore&) = delete;
+    SpillingStore& operator=(const SpillingStore&) = delete;
+
+    /**
+     * Inserts 'records' with the record ids they carry, committing them in a single storage
+     * transaction.
+     */
+    void insertRecords(OperationContext* opCtx, std::vector<Record>* records);
+
+    /**
+     * Returns an owned copy of the record 'rid', which must exist.
+     */
+    RecordData findRecord(OperationContext* opCtx, const RecordId& rid);
+
+    /**
+     * Drops the underlying table. Must be called before destruction.
+     */
+    void release(OperationContext* opCtx);
+
+private:
+    void switchToSpilling(OperationContext* opCtx);
+    void switchToOriginal(OperationContext* opCtx);
+
+    std::unique_ptr<TemporaryRecordStore> _store;
+
+    std::unique_ptr<RecoveryUnit> _spillingUnit;
+    WriteUnitOfWork::RecoveryUnitState _spillingState;
+
+    std::unique_ptr<RecoveryUnit> _originalUnit;
+    WriteUnitOfWork::RecoveryUnitState _originalState;
+};
+}  // namespace sbe
+}  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/sbe/vm/vm.h"
 
 #include <boost/algorithm/string.hpp>
+#include <chrono>
 #include <pcre.h>
 
 #include "mongo/bson/oid.h"
@@ -135,6 +136,14 @@ int Instruction::stackOffset[Instruction::Tags::lastInstruction] = {
     0,   // jmpNothing
 
     -1,  // fail
+
+    0,  // getFieldImm
+    0,  // lessImm
+    0,  // lessEqImm
+    0,  // greaterImm
+    0,  // greaterEqImm
+    0,  // eqImm
+    0,  // neqImm
 };
 
 namespace {
@@ -154,6 +163,45 @@ size_t writeToMemory(uint8_t* ptr, const T val) noexcept {
     memcpy(ptr, &val, sizeof(T));
     return sizeof(T);
 }
+
+/**
+ * Compares a value against the constant operand of a fused comparison instruction. Comparisons
+ * between values of the constant's own type (int32, int64, double or string) are done directly,
+ * everything else goes through genericCompare().
+ */
+template <typename Op>
+std::pair<value::TypeTags, value::Value> compareImmediate(value::TypeTags lhsTag,
+                                                          value::Value lhsValue,
+                                                          value::TypeTags rhsTag,
+                                                          value::Value rhsValue) {
+    Op op{};
+    if (lhsTag == rhsTag) {
+        switch (rhsTag) {
+            case value::TypeTags::NumberInt32:
+                return {value::TypeTags::Boolean,
+                        value::bitcastFrom<bool>(op(value::bitcastTo<int32_t>(lhsValue),
+                                                    value::bitcastTo<int32_t>(rhsValue)))};
+            case value::TypeTags::NumberInt64:
+                return {value::TypeTags::Boolean,
+                        value::bitcastFrom<bool>(op(value::bitcastTo<int64_t>(lhsValue),
+                                                    value::bitcastTo<int64_t>(rhsValue)))};
+            case value::TypeTags::NumberDouble:
+                return {value::TypeTags::Boolean,
+                        value::bitcastFrom<bool>(op(value::bitcastTo<double>(lhsValue),
+                                                    value::bitcastTo<double>(rhsValue)))};
+            default:
+                break;
+        }
+    }
+
+    if (value::isString(lhsTag) && value::isString(rhsTag)) {
+        auto lhsStr = value::getStringView(lhsTag, lhsValue);
+        auto rhsStr = value::getStringView(rhsTag, rhsValue);
+        return {value::TypeTags::Boolean, value::bitcastFrom<bool>(op(lhsStr.compare(rhsStr), 0))};
+    }
+
+    return genericCompare<Op>(lhsTag, lhsValue, rhsTag, rhsValue);
+}
 }  // namespace
 
 void CodeFragment::adjustStackSimple(const Instruction& i) {
@@ -182,6 +230,7 @@ void CodeFragment::copyCodeAndFixup(const CodeFragment& from) {
     }
 
     _instrs.insert(_instrs.end(), from._instrs.begin(), from._instrs.end());
+    _endsWithConst = false;
 }
 
 void CodeFragment::append(std::unique_ptr<CodeFragment> code) {
@@ -191,6 +240,12 @@ void CodeFragment::append(std::unique_ptr<CodeFragment> code) {
     copyCodeAndFixup(*code);
 
     _stackSize += code->_stackSize;
+
+    // A fragment made of a single constant (e.g. a compiled EConstant) contains no jumps, so the
+    // constant may be fused with whatever instruction follows.
+    _endsWithConst = code->_endsWithConst &&
+        code->_instrs.size() ==
+            sizeof(Instruction) + sizeof(value::TypeTags) + sizeof(value::Value);
 }
 
 void CodeFragment::append(std::unique_ptr<CodeFragment> lhs, std::unique_ptr<CodeFragment> rhs) {
@@ -216,6 +271,8 @@ void CodeFragment::appendConstVal(value::TypeTags tag, value::Value val) {
     offset += writeToMemory(offset, i);
     offset += writeToMemory(offset, tag);
     offset += writeToMemory(offset, val);
+
+    _endsWithConst = true;
 }
 
 void CodeFragment::appendAccessVal(value::SlotAccessor* accessor) {
@@ -307,8 +364,29 @@ void CodeFragment::appendSimpleInstruction(Instruction::Tags tag) {
     offset += writeToMemory(offset, i);
 }
 
+void CodeFragment::appendFusableInstruction(Instruction::Tags tag, Instruction::Tags fusedTag) {
+    if (!_endsWithConst) {
+        appendSimpleInstruction(tag);
+        return;
+    }
+
+    // The fused instruction has the same layout as 'pushConstVal', so only the opcode needs to be
+    // rewritten. The stack is adjusted as if both instructions had been appended.
+    Instruction fused;
+    fused.tag = fusedTag;
+    writeToMemory(_instrs.data() + _instrs.size() - sizeof(Instruction) -
+                      sizeof(value::TypeTags) - sizeof(value::Value),
+                  fused);
+
+    Instruction i;
+    i.tag = tag;
+    adjustStackSimple(i);
+
+    _endsWithConst = false;
+}
+
 void CodeFragment::appendGetField() {
-    appendSimpleInstruction(Instruction::getField);
+    appendFusableInstruction(Instruction::getField, Instruction::getFieldImm);
 }
 
 void CodeFragment::appendGetElement() {
@@ -3209,6 +3287,13 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
 }
 
 std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragment* code) {
+    // The profiling checks are compiled into a separate copy of the interpreter loop so that the
+    // regular loop does not pay for them.
+    return MONGO_unlikely(_profile != nullptr) ? runImpl<true>(code) : runImpl<false>(code);
+}
+
+template <bool kProfile>
+std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::runImpl(const CodeFragment* code) {
     auto pcPointer = code->instrs().data();
     auto pcEnd = pcPointer + code->instrs().size();
 
@@ -3218,6 +3303,17 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
         } else {
             Instruction i = readFromMemory<Instruction>(pcPointer);
             pcPointer += sizeof(i);
+
+            [[maybe_unused]] bool sampled = false;
+            [[maybe_unused]] int sampledBuiltin = -1;
+            [[maybe_unused]] std::chrono::steady_clock::time_point sampleStart;
+            if constexpr (kProfile) {
+                sampled = _profile->recordInstruction(i.tag);
+                if (sampled) {
+                    sampleStart = std::chrono::steady_clock::now();
+                }
+            }
+
             switch (i.tag) {
                 case Instruction::pushConstVal: {
                     auto tag = readFromMemory<value::TypeTags>(pcPointer);
@@ -4132,6 +4228,11 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
                         pcPointer += sizeof(SmallArityType);
                     }
 
+                    if constexpr (kProfile) {
+                        _profile->recordBuiltin(static_cast<uint8_t>(f));
+                        sampledBuiltin = static_cast<int>(f);
+                    }
+
                     auto [owned, tag, val] = dispatchBuiltin(f, arity);
 
                     for (ArityType cnt = 0; cnt < arity; ++cnt) {
@@ -4179,6 +4280,132 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
                     }
                     break;
                 }
+                case Instruction::getFieldImm: {
+                    auto fieldTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(fieldTag);
+                    auto fieldVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(fieldVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [owned, tag, val] = getField(lhsTag, lhsVal, fieldTag, fieldVal);
+
+                    topStack(owned, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
+                case Instruction::lessImm: {
+                    auto rhsTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(rhsTag);
+                    auto rhsVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(rhsVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [tag, val] =
+                        compareImmediate<std::less<>>(lhsTag, lhsVal, rhsTag, rhsVal);
+
+                    topStack(false, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
+                case Instruction::lessEqImm: {
+                    auto rhsTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(rhsTag);
+                    auto rhsVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(rhsVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [tag, val] =
+                        compareImmediate<std::less_equal<>>(lhsTag, lhsVal, rhsTag, rhsVal);
+
+                    topStack(false, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
+                case Instruction::greaterImm: {
+                    auto rhsTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(rhsTag);
+                    auto rhsVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(rhsVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [tag, val] =
+                        compareImmediate<std::greater<>>(lhsTag, lhsVal, rhsTag, rhsVal);
+
+                    topStack(false, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
+                case Instruction::greaterEqImm: {
+                    auto rhsTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(rhsTag);
+                    auto rhsVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(rhsVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [tag, val] =
+                        compareImmediate<std::greater_equal<>>(lhsTag, lhsVal, rhsTag, rhsVal);
+
+                    topStack(false, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
+                case Instruction::eqImm: {
+                    auto rhsTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(rhsTag);
+                    auto rhsVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(rhsVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [tag, val] =
+                        compareImmediate<std::equal_to<>>(lhsTag, lhsVal, rhsTag, rhsVal);
+
+                    topStack(false, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
+                case Instruction::neqImm: {
+                    auto rhsTag = readFromMemory<value::TypeTags>(pcPointer);
+                    pcPointer += sizeof(rhsTag);
+                    auto rhsVal = readFromMemory<value::Value>(pcPointer);
+                    pcPointer += sizeof(rhsVal);
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [tag, val] =
+                        compareImmediate<std::equal_to<>>(lhsTag, lhsVal, rhsTag, rhsVal);
+                    std::tie(tag, val) = genericNot(tag, val);
+
+                    topStack(false, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
                 case Instruction::fail: {
                     auto [ownedCode, tagCode, valCode] = getFromStack(1);
                     invariant(tagCode == value::TypeTags::NumberInt64);
@@ -4197,6 +4424,15 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
                 default:
                     MONGO_UNREACHABLE;
             }
+
+            if constexpr (kProfile) {
+                if (sampled) {
+                    _profile->recordSample(
+                        i.tag,
+                        sampledBuiltin,
+                        duration_cast<Nanoseconds>(std::chrono::steady_clock::now() - sampleStart));
+                }
+            }
         }
     }
     uassert(
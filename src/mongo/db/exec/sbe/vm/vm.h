@@ -36,6 +36,7 @@
 #include "mongo/db/exec/sbe/values/slot.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/sbe/vm/datetime.h"
+#include "mongo/db/exec/sbe/vm/vm_profile.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/datetime/date_time_support.h"
 
@@ -253,6 +254,18 @@ struct Instruction {
 
         fail,
 
+        // Fused instructions. Each of them carries a constant operand inline and behaves exactly
+        // like a 'pushConstVal' of that constant followed by the instruction it is named after.
+        // They are emitted by CodeFragment when one of those instructions directly follows a
+        // constant, and save a dispatch and a round trip through the stack.
+        getFieldImm,
+        lessImm,
+        lessEqImm,
+        greaterImm,
+        greaterEqImm,
+        eqImm,
+        neqImm,
+
         lastInstruction  // this is just a marker used to calculate number of instructions
     };
 
@@ -383,22 +396,22 @@ public:
     void appendNegate();
     void appendNot();
     void appendLess() {
-        appendSimpleInstruction(Instruction::less);
+        appendFusableInstruction(Instruction::less, Instruction::lessImm);
     }
     void appendLessEq() {
-        appendSimpleInstruction(Instruction::lessEq);
+        appendFusableInstruction(Instruction::lessEq, Instruction::lessEqImm);
     }
     void appendGreater() {
-        appendSimpleInstruction(Instruction::greater);
+        appendFusableInstruction(Instruction::greater, Instruction::greaterImm);
     }
     void appendGreaterEq() {
-        appendSimpleInstruction(Instruction::greaterEq);
+        appendFusableInstruction(Instruction::greaterEq, Instruction::greaterEqImm);
     }
     void appendEq() {
-        appendSimpleInstruction(Instruction::eq);
+        appendFusableInstruction(Instruction::eq, Instruction::eqImm);
     }
     void appendNeq() {
-        appendSimpleInstruction(Instruction::neq);
+        appendFusableInstruction(Instruction::neq, Instruction::neqImm);
     }
     void appendCmp3w() {
         appendSimpleInstruction(Instruction::cmp3w);
@@ -465,7 +478,15 @@ public:
 
 private:
     void appendSimpleInstruction(Instruction::Tags tag);
+
+    /**
+     * Appends the instruction 'tag', or, if the fragment ends with a constant, turns that
+     * 'pushConstVal' into the equivalent fused instruction 'fusedTag'.
+     */
+    void appendFusableInstruction(Instruction::Tags tag, Instruction::Tags fusedTag);
+
     auto allocateSpace(size_t size) {
+        _endsWithConst = false;
         auto oldSize = _instrs.size();
         _instrs.resize(oldSize + size);
         return _instrs.data() + oldSize;
@@ -491,6 +512,13 @@ private:
     std::vector<FixUp> _fixUps;
 
     size_t _stackSize{0};
+
+    /**
+     * True if the last instruction of the fragment is a 'pushConstVal' which can be fused with the
+     * next instruction. This only holds if no jump in the fragment may land right after the
+     * constant, so it is only propagated by append() for fragments made of that one instruction.
+     */
+    bool _endsWithConst{false};
 };
 
 class ByteCode {
@@ -500,11 +528,24 @@ public:
     std::tuple<uint8_t, value::TypeTags, value::Value> run(const CodeFragment* code);
     bool runPredicate(const CodeFragment* code);
 
+    /**
+     * Records the instructions executed by subsequent runs into 'profile', or stops recording
+     * them if 'profile' is nullptr. The profile is not owned and must outlive this object.
+     */
+    void setProfile(ByteCodeProfile* profile) {
+        _profile = profile;
+    }
+
 private:
     std::vector<uint8_t> _argStackOwned;
     std::vector<value::TypeTags> _argStackTags;
     std::vector<value::Value> _argStackVals;
 
+    ByteCodeProfile* _profile{nullptr};
+
+    template <bool kProfile>
+    std::tuple<uint8_t, value::TypeTags, value::Value> runImpl(const CodeFragment* code);
+
     std::tuple<bool, value::TypeTags, value::Value> genericAdd(value::TypeTags lhsTag,
                                                                value::Value lhsValue,
                                                                value::TypeTags rhsTag,
@@ -0,0 +1,389 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/vm/vm_profile.h"
+
+#include <limits>
+#include <type_traits>
+
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+namespace {
+StringData instructionName(uint8_t tag) {
+    switch (tag) {
+        case Instruction::pushConstVal:
+            return "pushConstVal"_sd;
+        case Instruction::pushAccessVal:
+            return "pushAccessVal"_sd;
+        case Instruction::pushMoveVal:
+            return "pushMoveVal"_sd;
+        case Instruction::pushLocalVal:
+            return "pushLocalVal"_sd;
+        case Instruction::pop:
+            return "pop"_sd;
+        case Instruction::swap:
+            return "swap"_sd;
+        case Instruction::add:
+            return "add"_sd;
+        case Instruction::sub:
+            return "sub"_sd;
+        case Instruction::mul:
+            return "mul"_sd;
+        case Instruction::div:
+            return "div"_sd;
+        case Instruction::idiv:
+            return "idiv"_sd;
+        case Instruction::mod:
+            return "mod"_sd;
+        case Instruction::negate:
+            return "negate"_sd;
+        case Instruction::numConvert:
+            return "numConvert"_sd;
+        case Instruction::logicNot:
+            return "logicNot"_sd;
+        case Instruction::less:
+            return "less"_sd;
+        case Instruction::lessEq:
+            return "lessEq"_sd;
+        case Instruction::greater:
+            return "greater"_sd;
+        case Instruction::greaterEq:
+            return "greaterEq"_sd;
+        case Instruction::eq:
+            return "eq"_sd;
+        case Instruction::neq:
+            return "neq"_sd;
+        case Instruction::cmp3w:
+            return "cmp3w"_sd;
+        case Instruction::collLess:
+            return "collLess"_sd;
+        case Instruction::collLessEq:
+            return "collLessEq"_sd;
+        case Instruction::collGreater:
+            return "collGreater"_sd;
+        case Instruction::collGreaterEq:
+            return "collGreaterEq"_sd;
+        case Instruction::collEq:
+            return "collEq"_sd;
+        case Instruction::collNeq:
+            return "collNeq"_sd;
+        case Instruction::collCmp3w:
+            return "collCmp3w"_sd;
+        case Instruction::fillEmpty:
+            return "fillEmpty"_sd;
+        case Instruction::getField:
+            return "getField"_sd;
+        case Instruction::getElement:
+            return "getElement"_sd;
+        case Instruction::collComparisonKey:
+            return "collComparisonKey"_sd;
+        case Instruction::aggSum:
+            return "aggSum"_sd;
+        case Instruction::aggMin:
+            return "aggMin"_sd;
+        case Instruction::aggMax:
+            return "aggMax"_sd;
+        case Instruction::aggFirst:
+            return "aggFirst"_sd;
+        case Instruction::aggLast:
+            return "aggLast"_sd;
+        case Instruction::aggCollMin:
+            return "aggCollMin"_sd;
+        case Instruction::aggCollMax:
+            return "aggCollMax"_sd;
+        case Instruction::exists:
+            return "exists"_sd;
+        case Instruction::isNull:
+            return "isNull"_sd;
+        case Instruction::isObject:
+            return "isObject"_sd;
+        case Instruction::isArray:
+            return "isArray"_sd;
+        case Instruction::isString:
+            return "isString"_sd;
+        case Instruction::isNumber:
+            return "isNumber"_sd;
+        case Instruction::isBinData:
+            return "isBinData"_sd;
+        case Instruction::isDate:
+            return "isDate"_sd;
+        case Instruction::isNaN:
+            return "isNaN"_sd;
+        case Instruction::isRecordId:
+            return "isRecordId"_sd;
+        case Instruction::isMinKey:
+            return "isMinKey"_sd;
+        case Instruction::isMaxKey:
+            return "isMaxKey"_sd;
+        case Instruction::typeMatch:
+            return "typeMatch"_sd;
+        case Instruction::function:
+            return "function"_sd;
+        case Instruction::functionSmall:
+            return "functionSmall"_sd;
+        case Instruction::jmp:
+            return "jmp"_sd;
+        case Instruction::jmpTrue:
+            return "jmpTrue"_sd;
+        case Instruction::jmpNothing:
+            return "jmpNothing"_sd;
+        case Instruction::fail:
+            return "fail"_sd;
+        case Instruction::getFieldImm:
+            return "getFieldImm"_sd;
+        case Instruction::lessImm:
+            return "lessImm"_sd;
+        case Instruction::lessEqImm:
+            return "lessEqImm"_sd;
+        case Instruction::greaterImm:
+            return "greaterImm"_sd;
+        case Instruction::greaterEqImm:
+            return "greaterEqImm"_sd;
+        case Instruction::eqImm:
+            return "eqImm"_sd;
+        case Instruction::neqImm:
+            return "neqImm"_sd;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+StringData builtinName(Builtin f) {
+    switch (f) {
+        case Builtin::split:
+            return "split"_sd;
+        case Builtin::regexMatch:
+            return "regexMatch"_sd;
+        case Builtin::replaceOne:
+            return "replaceOne"_sd;
+        case Builtin::dateDiff:
+            return "dateDiff"_sd;
+        case Builtin::dateParts:
+            return "dateParts"_sd;
+        case Builtin::dateToParts:
+            return "dateToParts"_sd;
+        case Builtin::isoDateToParts:
+            return "isoDateToParts"_sd;
+        case Builtin::dayOfYear:
+            return "dayOfYear"_sd;
+        case Builtin::dayOfMonth:
+            return "dayOfMonth"_sd;
+        case Builtin::dayOfWeek:
+            return "dayOfWeek"_sd;
+        case Builtin::datePartsWeekYear:
+            return "datePartsWeekYear"_sd;
+        case Builtin::dropFields:
+            return "dropFields"_sd;
+        case Builtin::newArray:
+            return "newArray"_sd;
+        case Builtin::newObj:
+            return "newObj"_sd;
+        case Builtin::ksToString:
+            return "ksToString"_sd;
+        case Builtin::newKs:
+            return "newKs"_sd;
+        case Builtin::abs:
+            return "abs"_sd;
+        case Builtin::ceil:
+            return "ceil"_sd;
+        case Builtin::floor:
+            return "floor"_sd;
+        case Builtin::trunc:
+            return "trunc"_sd;
+        case Builtin::exp:
+            return "exp"_sd;
+        case Builtin::ln:
+            return "ln"_sd;
+        case Builtin::log10:
+            return "log10"_sd;
+        case Builtin::sqrt:
+            return "sqrt"_sd;
+        case Builtin::addToArray:
+            return "addToArray"_sd;
+        case Builtin::addToSet:
+            return "addToSet"_sd;
+        case Builtin::collAddToSet:
+            return "collAddToSet"_sd;
+        case Builtin::doubleDoubleSum:
+            return "doubleDoubleSum"_sd;
+        case Builtin::bitTestZero:
+            return "bitTestZero"_sd;
+        case Builtin::bitTestMask:
+            return "bitTestMask"_sd;
+        case Builtin::bitTestPosition:
+            return "bitTestPosition"_sd;
+        case Builtin::bsonSize:
+            return "bsonSize"_sd;
+        case Builtin::toUpper:
+            return "toUpper"_sd;
+        case Builtin::toLower:
+            return "toLower"_sd;
+        case Builtin::coerceToString:
+            return "coerceToString"_sd;
+        case Builtin::concat:
+            return "concat"_sd;
+        case Builtin::acos:
+            return "acos"_sd;
+        case Builtin::acosh:
+            return "acosh"_sd;
+        case Builtin::asin:
+            return "asin"_sd;
+        case Builtin::asinh:
+            return "asinh"_sd;
+        case Builtin::atan:
+            return "atan"_sd;
+        case Builtin::atanh:
+            return "atanh"_sd;
+        case Builtin::atan2:
+            return "atan2"_sd;
+        case Builtin::cos:
+            return "cos"_sd;
+        case Builtin::cosh:
+            return "cosh"_sd;
+        case Builtin::degreesToRadians:
+            return "degreesToRadians"_sd;
+        case Builtin::radiansToDegrees:
+            return "radiansToDegrees"_sd;
+        case Builtin::sin:
+            return "sin"_sd;
+        case Builtin::sinh:
+            return "sinh"_sd;
+        case Builtin::tan:
+            return "tan"_sd;
+        case Builtin::tanh:
+            return "tanh"_sd;
+        case Builtin::round:
+            return "round"_sd;
+        case Builtin::isMember:
+            return "isMember"_sd;
+        case Builtin::collIsMember:
+            return "collIsMember"_sd;
+        case Builtin::indexOfBytes:
+            return "indexOfBytes"_sd;
+        case Builtin::indexOfCP:
+            return "indexOfCP"_sd;
+        case Builtin::isDayOfWeek:
+            return "isDayOfWeek"_sd;
+        case Builtin::isTimeUnit:
+            return "isTimeUnit"_sd;
+        case Builtin::isTimezone:
+            return "isTimezone"_sd;
+        case Builtin::setUnion:
+            return "setUnion"_sd;
+        case Builtin::setIntersection:
+            return "setIntersection"_sd;
+        case Builtin::setDifference:
+            return "setDifference"_sd;
+        case Builtin::collSetUnion:
+            return "collSetUnion"_sd;
+        case Builtin::collSetIntersection:
+            return "collSetIntersection"_sd;
+        case Builtin::collSetDifference:
+            return "collSetDifference"_sd;
+        case Builtin::runJsPredicate:
+            return "runJsPredicate"_sd;
+        case Builtin::regexCompile:
+            return "regexCompile"_sd;
+        case Builtin::regexFind:
+            return "regexFind"_sd;
+        case Builtin::regexFindAll:
+            return "regexFindAll"_sd;
+        case Builtin::shardFilter:
+            return "shardFilter"_sd;
+        case Builtin::shardHash:
+            return "shardHash"_sd;
+        case Builtin::extractSubArray:
+            return "extractSubArray"_sd;
+        case Builtin::isArrayEmpty:
+            return "isArrayEmpty"_sd;
+        case Builtin::reverseArray:
+            return "reverseArray"_sd;
+        case Builtin::dateAdd:
+            return "dateAdd"_sd;
+        case Builtin::hasNullBytes:
+            return "hasNullBytes"_sd;
+        case Builtin::getRegexPattern:
+            return "getRegexPattern"_sd;
+        case Builtin::getRegexFlags:
+            return "getRegexFlags"_sd;
+        case Builtin::ftsMatch:
+            return "ftsMatch"_sd;
+        case Builtin::generateSortKey:
+            return "generateSortKey"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+template <typename NameFn>
+void appendEntries(BSONObjBuilder* bob,
+                   const std::vector<ByteCodeProfile::Entry>& entries,
+                   NameFn nameFn) {
+    for (size_t idx = 0; idx < entries.size(); ++idx) {
+        auto&& entry = entries[idx];
+        if (entry.count == 0) {
+            continue;
+        }
+
+        BSONObjBuilder entryBob(bob->subobjStart(nameFn(idx)));
+        entryBob.appendNumber("count", static_cast<long long>(entry.count));
+        entryBob.appendNumber("samples", static_cast<long long>(entry.samples));
+        entryBob.appendNumber("estimatedTimeNanos",
+                              durationCount<Nanoseconds>(entry.estimatedTime()));
+    }
+}
+}  // namespace
+
+ByteCodeProfile::ByteCodeProfile()
+    : _instructions(Instruction::lastInstruction),
+      _builtins(std::numeric_limits<std::underlying_type_t<Builtin>>::max() + 1),
+      _random(SecureRandom().nextInt64()),
+      _samplingCountdown(nextSamplingGap()) {}
+
+void ByteCodeProfile::appendToBSON(BSONObjBuilder* bob) const {
+    {
+        BSONObjBuilder instructionsBob(bob->subobjStart("instructions"));
+        appendEntries(&instructionsBob, _instructions, [](size_t idx) {
+            return instructionName(static_cast<uint8_t>(idx));
+        });
+    }
+    {
+        BSONObjBuilder builtinsBob(bob->subobjStart("builtins"));
+        appendEntries(&builtinsBob, _builtins, [](size_t idx) {
+            return builtinName(static_cast<Builtin>(idx));
+        });
+    }
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+
+/**
+ * Execution profile of the bytecode run by a single plan stage. Counts how many times each
+ * instruction and each builtin function was executed, and samples the time spent in them.
+ *
+ * Reading a clock around every instruction would cost more than most instructions do, so only
+ * one in about every 'kSamplingPeriod' instructions is timed. The time reported for an instruction
+ * is extrapolated from its samples. The gap between two samples is drawn at random, since a fixed
+ * gap would keep sampling the same few instructions of a loop whose length divides it.
+ */
+class ByteCodeProfile {
+public:
+    static constexpr uint64_t kSamplingPeriod = 16;
+
+    struct Entry {
+        uint64_t count{0};
+        uint64_t samples{0};
+        Nanoseconds sampledTime{0};
+
+        Nanoseconds estimatedTime() const {
+            return samples ? Nanoseconds{durationCount<Nanoseconds>(sampledTime) *
+                                         static_cast<long long>(count) /
+                                         static_cast<long long>(samples)}
+                           : Nanoseconds{0};
+        }
+    };
+
+    ByteCodeProfile();
+
+    /**
+     * Records an execution of the instruction 'tag'. Returns true if this execution should be
+     * timed, in which case the caller must report its duration through recordSample().
+     */
+    bool recordInstruction(uint8_t tag) {
+        ++_instructions[tag].count;
+        if (--_samplingCountdown != 0) {
+            return false;
+        }
+        _samplingCountdown = nextSamplingGap();
+        return true;
+    }
+
+    void recordBuiltin(uint8_t builtin) {
+        ++_builtins[builtin].count;
+    }
+
+    /**
+     * Records the duration of a sampled execution of the instruction 'tag'. If the instruction
+     * was a call to a builtin function, 'builtin' holds the function and is charged as well.
+     */
+    void recordSample(uint8_t tag, int builtin, Nanoseconds elapsed) {
+        auto& entry = _instructions[tag];
+        ++entry.samples;
+        entry.sampledTime += elapsed;
+        if (builtin >= 0) {
+            auto& builtinEntry = _builtins[builtin];
+            ++builtinEntry.samples;
+            builtinEntry.sampledTime += elapsed;
+        }
+    }
+
+    /**
+     * Appends the executed instructions and builtins, keyed by name, to 'bob'.
+     */
+    void appendToBSON(BSONObjBuilder* bob) const;
+
+private:
+    /**
+     * Returns a number of instructions between 1 and 2 * 'kSamplingPeriod' - 1, so that one in
+     * every 'kSamplingPeriod' instructions is timed on average.
+     */
+    uint64_t nextSamplingGap() {
+        return 1 + _random.nextInt64(2 * kSamplingPeriod - 1);
+    }
+
+    // Indexed by Instruction::Tags and by Builtin respectively.
+    std::vector<Entry> _instructions;
+    std::vector<Entry> _builtins;
+
+    PseudoRandom _random;
+    uint64_t _samplingCountdown;
+};
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
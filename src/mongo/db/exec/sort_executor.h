@@ -184,6 +184,10 @@ private:
             opts.tempDir = _tempDir;
         }
 
+        // The comparator only reads the sort directions, so it can be used by several threads.
+        opts.backgroundSpill = gInternalSorterBackgroundSpill.load();
+        opts.mergeThreads = gInternalSorterMergeThreads.load();
+
         return opts;
     }
 
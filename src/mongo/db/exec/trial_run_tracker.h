@@ -82,6 +82,16 @@ public:
         return _done;
     }
 
+    /**
+     * Returns by how much the trial run metric specified as a template parameter 'metric' may
+     * still grow before it reaches its maximum.
+     */
+    template <TrialRunMetric metric>
+    size_t getRemaining() const {
+        static_assert(metric >= 0 && metric < sizeof(_metrics));
+        return _done ? 0 : _maxMetrics[metric] - _metrics[metric];
+    }
+
 private:
     const size_t _maxMetrics[TrialRunMetric::kLastElem];
     size_t _metrics[TrialRunMetric::kLastElem]{0};
@@ -139,6 +139,12 @@ public:
         INTERNAL_SCHEMA_XOR,
     };
 
+    /**
+     * Identifies a constant of a predicate which has been turned into an input parameter, so that
+     * plans built for the expression can be rebound to other values. See expression::parameterize.
+     */
+    using InputParamId = int32_t;
+
     /**
      * An iterator to walk through the children expressions of the given MatchExpressions. Along
      * with the defined 'begin()' and 'end()' functions, which take a reference to a
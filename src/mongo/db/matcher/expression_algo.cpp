@@ -29,6 +29,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cmath>
+
 #include "mongo/base/checked_cast.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_algo.h"
@@ -328,6 +330,69 @@ std::pair<unique_ptr<MatchExpression>, unique_ptr<MatchExpression>> splitMatchEx
     }
 }
 
+/**
+ * Returns true if a plan built for a predicate comparing against 'elem' works for any other value
+ * of the same canonical type.
+ */
+bool isParameterizableValue(const BSONElement& elem) {
+    switch (elem.type()) {
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case Date:
+        case jstOID:
+        case Bool:
+        case bsonTimestamp:
+            return true;
+        case NumberDouble:
+            return !std::isnan(elem.numberDouble());
+        case NumberDecimal:
+            return !elem.numberDecimal().isNaN();
+        default:
+            return false;
+    }
+}
+
+void parameterizeTree(MatchExpression* expr, std::vector<const MatchExpression*>* params) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                parameterizeTree(expr->getChild(i), params);
+            }
+            return;
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            auto cmpExpr = static_cast<ComparisonMatchExpression*>(expr);
+            if (!isParameterizableValue(cmpExpr->getData())) {
+                cmpExpr->setInputParamId(boost::none);
+                return;
+            }
+            cmpExpr->setInputParamId(static_cast<MatchExpression::InputParamId>(params->size()));
+            params->push_back(expr);
+            return;
+        }
+        case MatchExpression::MATCH_IN: {
+            auto inExpr = static_cast<InMatchExpression*>(expr);
+            const auto& equalities = inExpr->getEqualities();
+            if (!inExpr->getRegexes().empty() || equalities.empty() ||
+                !std::all_of(equalities.begin(), equalities.end(), isParameterizableValue)) {
+                inExpr->setInputParamId(boost::none);
+                return;
+            }
+            inExpr->setInputParamId(static_cast<MatchExpression::InputParamId>(params->size()));
+            params->push_back(expr);
+            return;
+        }
+        default:
+            return;
+    }
+}
 }  // namespace
 
 namespace expression {
@@ -503,5 +568,26 @@ bool isPathPrefixOf(StringData first, StringData second) {
 
     return second.startsWith(first) && second[first.size()] == '.';
 }
+
+std::vector<const MatchExpression*> parameterize(MatchExpression* root) {
+    std::vector<const MatchExpression*> params;
+    parameterizeTree(root, &params);
+    return params;
+}
+
+boost::optional<MatchExpression::InputParamId> getInputParamId(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            return static_cast<const ComparisonMatchExpression*>(expr)->getInputParamId();
+        case MatchExpression::MATCH_IN:
+            return static_cast<const InMatchExpression*>(expr)->getInputParamId();
+        default:
+            return boost::none;
+    }
+}
 }  // namespace expression
 }  // namespace mongo
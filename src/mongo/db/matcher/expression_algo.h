@@ -33,12 +33,15 @@
 #include <memory>
 #include <set>
 
+#include <boost/optional.hpp>
+#include <vector>
+
 #include "mongo/base/string_data.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/util/string_map.h"
 
 namespace mongo {
 
-class MatchExpression;
 struct DepsTracker;
 
 namespace expression {
@@ -151,5 +154,21 @@ splitMatchExpressionBy(std::unique_ptr<MatchExpression> expr,
  * {new: {$gt: 3}}.
  */
 void applyRenamesToExpression(MatchExpression* expr, const StringMap<std::string>& renames);
+
+/**
+ * Assigns input parameter ids to the constants of the comparison and $in predicates of 'root'
+ * which are reachable through $and, $or, $nor and $not. A constant is only parameterized if any
+ * other value of the same canonical BSON type would be compiled into the same plan, which rules out
+ * e.g. null, NaN, MinKey, MaxKey, arrays, objects and regexes.
+ *
+ * Returns the parameterized predicates, indexed by their input parameter id. Ids are assigned in
+ * tree order, so two expressions with the same shape get the same ids.
+ */
+std::vector<const MatchExpression*> parameterize(MatchExpression* root);
+
+/**
+ * Returns the input parameter id assigned to 'expr' by parameterize(), if any.
+ */
+boost::optional<MatchExpression::InputParamId> getInputParamId(const MatchExpression* expr);
 }  // namespace expression
 }  // namespace mongo
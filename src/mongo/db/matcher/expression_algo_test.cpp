@@ -1468,4 +1468,53 @@ TEST(HasExistencePredicateOnPath, ReturnsFalseWhenExistsOnSubpath) {
         expression::hasExistencePredicateOnPath(*swMatchExpression.getValue().get(), "a"_sd));
 }
 
+TEST(Parameterize, AssignsIdsToComparisonsAndInInTreeOrder) {
+    BSONObj matchPredicate =
+        fromjson("{$and: [{a: {$gt: 5}}, {$or: [{b: 'x'}, {c: {$in: [1, 2, 3]}}]}]}");
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto swMatchExpression = MatchExpressionParser::parse(matchPredicate, std::move(expCtx));
+    ASSERT_OK(swMatchExpression.getStatus());
+    auto root = swMatchExpression.getValue().get();
+
+    auto inputParams = expression::parameterize(root);
+    ASSERT_EQ(inputParams.size(), 3U);
+    ASSERT_EQ(inputParams[0], root->getChild(0));
+    ASSERT_EQ(inputParams[1], root->getChild(1)->getChild(0));
+    ASSERT_EQ(inputParams[2], root->getChild(1)->getChild(1));
+    for (size_t i = 0; i < inputParams.size(); ++i) {
+        ASSERT_TRUE(expression::getInputParamId(inputParams[i]) ==
+                    static_cast<MatchExpression::InputParamId>(i));
+    }
+}
+
+TEST(Parameterize, SkipsValuesWhichDetermineThePlan) {
+    BSONObj matchPredicate = fromjson(
+        "{$and: [{a: null}, {b: {$lt: NaN}}, {c: [1, 2]}, {d: {$in: [1, /x/]}}, {e: {$gte: {}}},"
+        "{f: {$exists: true}}]}");
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto swMatchExpression = MatchExpressionParser::parse(matchPredicate, std::move(expCtx));
+    ASSERT_OK(swMatchExpression.getStatus());
+    auto root = swMatchExpression.getValue().get();
+
+    ASSERT_TRUE(expression::parameterize(root).empty());
+    for (size_t i = 0; i < root->numChildren(); ++i) {
+        ASSERT_FALSE(expression::getInputParamId(root->getChild(i)));
+    }
+}
+
+TEST(Parameterize, InputParamIdsAreKeptByShallowClone) {
+    BSONObj matchPredicate = fromjson("{$or: [{a: {$lte: 2}}, {b: {$in: ['x', 'y']}}]}");
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto swMatchExpression = MatchExpressionParser::parse(matchPredicate, std::move(expCtx));
+    ASSERT_OK(swMatchExpression.getStatus());
+    auto root = swMatchExpression.getValue().get();
+    expression::parameterize(root);
+
+    auto clone = root->shallowClone();
+    ASSERT_TRUE(expression::getInputParamId(clone->getChild(0)) ==
+                MatchExpression::InputParamId{0});
+    ASSERT_TRUE(expression::getInputParamId(clone->getChild(1)) ==
+                MatchExpression::InputParamId{1});
+}
+
 }  // namespace mongo
@@ -44,6 +44,7 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/matcher/path.h"
 #include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/regex_util.h"
 #include "mongo/util/str.h"
 
@@ -388,7 +389,9 @@ std::unique_ptr<MatchExpression> InMatchExpression::shallowClone() const {
     next->_hasNull = _hasNull;
     next->_hasEmptyArray = _hasEmptyArray;
     next->_equalitySet = _equalitySet;
+    next->_equalityHashSet = _equalityHashSet;
     next->_originalEqualityVector = _originalEqualityVector;
+    next->_inputParamId = _inputParamId;
     for (auto&& regex : _regexes) {
         std::unique_ptr<RegexMatchExpression> clonedRegex(
             static_cast<RegexMatchExpression*>(regex->shallowClone().release()));
@@ -397,7 +400,18 @@ std::unique_ptr<MatchExpression> InMatchExpression::shallowClone() const {
     return next;
 }
 
+InMatchExpression::EqualityHashSet::EqualityHashSet(const CollatorInterface* collator,
+                                                    const std::vector<BSONElement>& equalities)
+    : eltCmp(BSONElementComparator::FieldNamesMode::kIgnore, collator),
+      set(eltCmp.makeBSONEltUnorderedSet()) {
+    set.reserve(equalities.size());
+    set.insert(equalities.begin(), equalities.end());
+}
+
 bool InMatchExpression::contains(const BSONElement& e) const {
+    if (_equalityHashSet) {
+        return _equalityHashSet->set.find(e) != _equalityHashSet->set.end();
+    }
     return std::binary_search(_equalitySet.begin(), _equalitySet.end(), e, _eltCmp.makeLessThan());
 }
 
@@ -495,6 +509,11 @@ void InMatchExpression::_doSetCollator(const CollatorInterface* collator) {
     _collator = collator;
     _eltCmp = BSONElementComparator(BSONElementComparator::FieldNamesMode::kIgnore, _collator);
 
+    // We need to re-compute '_equalitySet', since our set comparator has changed.
+    updateEqualitySet();
+}
+
+void InMatchExpression::updateEqualitySet() {
     if (!std::is_sorted(_originalEqualityVector.begin(),
                         _originalEqualityVector.end(),
                         _eltCmp.makeLessThan())) {
@@ -502,13 +521,18 @@ void InMatchExpression::_doSetCollator(const CollatorInterface* collator) {
             _originalEqualityVector.begin(), _originalEqualityVector.end(), _eltCmp.makeLessThan());
     }
 
-    // We need to re-compute '_equalitySet', since our set comparator has changed.
     _equalitySet.clear();
     _equalitySet.reserve(_originalEqualityVector.size());
     std::unique_copy(_originalEqualityVector.begin(),
                      _originalEqualityVector.end(),
                      std::back_inserter(_equalitySet),
                      _eltCmp.makeEqualTo());
+
+    _equalityHashSet.reset();
+    if (_equalitySet.size() >=
+        static_cast<size_t>(internalQueryInMatchHashSetMinEqualities.load())) {
+        _equalityHashSet = std::make_shared<EqualityHashSet>(_collator, _equalitySet);
+    }
 }
 
 Status InMatchExpression::setEqualities(std::vector<BSONElement> equalities) {
@@ -528,20 +552,7 @@ Status InMatchExpression::setEqualities(std::vector<BSONElement> equalities) {
     }
 
     _originalEqualityVector = std::move(equalities);
-
-    if (!std::is_sorted(_originalEqualityVector.begin(),
-                        _originalEqualityVector.end(),
-                        _eltCmp.makeLessThan())) {
-        std::sort(
-            _originalEqualityVector.begin(), _originalEqualityVector.end(), _eltCmp.makeLessThan());
-    }
-
-    _equalitySet.clear();
-    _equalitySet.reserve(_originalEqualityVector.size());
-    std::unique_copy(_originalEqualityVector.begin(),
-                     _originalEqualityVector.end(),
-                     std::back_inserter(_equalitySet),
-                     _eltCmp.makeEqualTo());
+    updateEqualitySet();
 
     return Status::OK();
 }
@@ -155,6 +155,18 @@ public:
         return _collator;
     }
 
+    /**
+     * The input parameter assigned to the right hand side, if the expression has been
+     * parameterized.
+     */
+    boost::optional<InputParamId> getInputParamId() const {
+        return _inputParamId;
+    }
+
+    void setInputParamId(boost::optional<InputParamId> paramId) {
+        _inputParamId = paramId;
+    }
+
 protected:
     /**
      * 'collator' must outlive the ComparisonMatchExpression and any clones made of it.
@@ -170,6 +182,8 @@ protected:
     // Collator used to compare elements. By default, simple binary comparison will be used.
     const CollatorInterface* _collator = nullptr;
 
+    boost::optional<InputParamId> _inputParamId;
+
 private:
     ExpressionOptimizerFunc getOptimizer() const final {
         return [](std::unique_ptr<MatchExpression> expression) { return expression; };
@@ -234,6 +248,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(getInputParamId());
         return e;
     }
 
@@ -270,6 +285,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(getInputParamId());
         return e;
     }
 
@@ -306,6 +322,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(getInputParamId());
         return e;
     }
 
@@ -347,6 +364,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(getInputParamId());
         return e;
     }
 
@@ -387,6 +405,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(getInputParamId());
         return e;
     }
 
@@ -608,6 +627,17 @@ public:
         return _hasEmptyArray;
     }
 
+    /**
+     * The input parameter assigned to the equalities, if the expression has been parameterized.
+     */
+    boost::optional<InputParamId> getInputParamId() const {
+        return _inputParamId;
+    }
+
+    void setInputParamId(boost::optional<InputParamId> paramId) {
+        _inputParamId = paramId;
+    }
+
     void acceptVisitor(MatchExpressionMutableVisitor* visitor) final {
         visitor->visit(this);
     }
@@ -617,8 +647,28 @@ public:
     }
 
 private:
+    /**
+     * A hash set of the equalities of an InMatchExpression, which uses its own copy of the element
+     * comparator so that it can be shared by clones of the expression.
+     */
+    struct EqualityHashSet {
+        EqualityHashSet(const CollatorInterface* collator,
+                        const std::vector<BSONElement>& equalities);
+
+        const BSONElementComparator eltCmp;
+        BSONEltUnorderedSet set;
+    };
+
     ExpressionOptimizerFunc getOptimizer() const final;
 
+    /**
+     * Recomputes '_equalitySet' and '_equalityHashSet' from '_originalEqualityVector', sorting the
+     * latter if needed.
+     */
+    void updateEqualitySet();
+
+    boost::optional<InputParamId> _inputParamId;
+
     // Whether or not '_equalities' has a jstNULL element in it.
     bool _hasNull = false;
 
@@ -642,10 +692,13 @@ private:
     // support std::binary_search. Because we need to sort the elements anyway for things like index
     // bounds building, using binary search avoids the overhead of inserting into a hash table which
     // doesn't pay for itself in the common case where lookups are done a few times if ever.
-    // TODO It may be worth dynamically creating a hashset after matchesSingleElement() has been
-    // called "many" times.
     std::vector<BSONElement> _equalitySet;
 
+    // Hash set of the elements of '_equalitySet', used for lookups instead of binary search once
+    // there are at least 'internalQueryInMatchHashSetMinEqualities' of them. It is built along with
+    // '_equalitySet' and is immutable, so clones with the same collator share it.
+    std::shared_ptr<const EqualityHashSet> _equalityHashSet;
+
     // Container of regex elements this object owns.
     std::vector<std::unique_ptr<RegexMatchExpression>> _regexes;
 };
@@ -37,6 +37,7 @@
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/unittest/death_test.h"
 
 namespace mongo {
@@ -1370,6 +1371,41 @@ TEST(InMatchExpression, ChangingCollationAfterAddingEqualitiesPreservesEqualitie
     ASSERT(in.contains(obj2.firstElement()));
 }
 
+TEST(InMatchExpression, LargeEqualityListsMatchThroughCollationAwareHashSet) {
+    const int oldMinEqualities = internalQueryInMatchHashSetMinEqualities.load();
+    ON_BLOCK_EXIT([&] { internalQueryInMatchHashSetMinEqualities.store(oldMinEqualities); });
+    internalQueryInMatchHashSetMinEqualities.store(4);
+
+    BSONArrayBuilder operandBuilder;
+    for (int i = 0; i < 10; ++i) {
+        operandBuilder.append(i);
+        operandBuilder.append("Str" + std::to_string(i));
+    }
+    BSONArray operand = operandBuilder.arr();
+
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    InMatchExpression in("a");
+    in.setCollator(&collator);
+    std::vector<BSONElement> equalities;
+    for (auto&& elem : operand) {
+        equalities.push_back(elem);
+    }
+    ASSERT_OK(in.setEqualities(std::move(equalities)));
+
+    auto clone = in.shallowClone();
+    for (const MatchExpression* expr : std::vector<const MatchExpression*>{&in, clone.get()}) {
+        // Numbers of different types compare equal, and strings are compared under the collation.
+        ASSERT(expr->matchesBSON(BSON("a" << 7.0), nullptr));
+        ASSERT(expr->matchesBSON(BSON("a" << 8LL), nullptr));
+        ASSERT(expr->matchesBSON(BSON("a"
+                                      << "anything"),
+                                 nullptr));
+        ASSERT(expr->matchesBSON(BSON("a" << BSON_ARRAY(100 << 9)), nullptr));
+        ASSERT(!expr->matchesBSON(BSON("a" << 10), nullptr));
+        ASSERT(!expr->matchesBSON(BSON("a" << BSON_ARRAY(100 << 10.5)), nullptr));
+    }
+}
+
 std::vector<uint32_t> bsonArrayToBitPositions(const BSONArray& ba) {
     std::vector<uint32_t> bitPositions;
 
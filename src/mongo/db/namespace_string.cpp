@@ -115,6 +115,12 @@ const NamespaceString NamespaceString::kConfigSettingsNamespace(NamespaceString:
 const NamespaceString NamespaceString::kVectorClockNamespace(NamespaceString::kConfigDb,
                                                              "vectorClock");
 
+const NamespaceString NamespaceString::kPlanCacheSnapshotsNamespace(NamespaceString::kConfigDb,
+                                                                    "planCacheSnapshots");
+
+const NamespaceString NamespaceString::kCollectionStatisticsNamespace(NamespaceString::kConfigDb,
+                                                                      "collectionStatistics");
+
 const NamespaceString NamespaceString::kReshardingApplierProgressNamespace(
     NamespaceString::kConfigDb, "localReshardingOperations.recipient.progress_applier");
 
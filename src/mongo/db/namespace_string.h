@@ -166,6 +166,12 @@ public:
     // Namespace for vector clock state.
     static const NamespaceString kVectorClockNamespace;
 
+    // Namespace for snapshots of the plan caches of collections.
+    static const NamespaceString kPlanCacheSnapshotsNamespace;
+
+    // Namespace for the statistics built by the analyze command.
+    static const NamespaceString kCollectionStatisticsNamespace;
+
     // Namespace for storing oplog applier progress for resharding.
     static const NamespaceString kReshardingApplierProgressNamespace;
 
@@ -31,13 +31,16 @@
 
 #include "mongo/db/pipeline/document_source_facet.h"
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/client.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/document_source_tee_consumer.h"
@@ -45,7 +48,15 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/tee_buffer.h"
+#include "mongo/db/pipeline/variables.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/future.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -55,6 +66,94 @@ using std::pair;
 using std::string;
 using std::vector;
 
+namespace {
+// Runs the sub-pipelines of a $facet stage concurrently. The pool is capped by
+// 'internalQueryFacetMaxThreads', see reserveFacetThreads().
+std::unique_ptr<ThreadPool> facetThreadPool;
+AtomicWord<int> reservedFacetThreads{0};
+MONGO_INITIALIZER_WITH_PREREQUISITES(FacetThreadPool, ("EndStartupOptionStorage"))
+(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "FacetThreadPool";
+    options.threadNamePrefix = "Facet";
+    options.minThreads = 0;
+    options.maxThreads = internalQueryFacetMaxThreads.load();
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    facetThreadPool = std::make_unique<ThreadPool>(options);
+    facetThreadPool->startup();
+}
+
+/**
+ * Reserves 'numThreads' threads of 'facetThreadPool' for the facets of a $facet stage. Every facet
+ * waits for the others at the end of each batch, so a facet left waiting for a free thread would
+ * hold up all the others. Returns false if the pool cannot run all of them at once, in which case
+ * the facets must run on the calling thread instead.
+ */
+bool reserveFacetThreads(int numThreads) {
+    const auto maxThreads = internalQueryFacetMaxThreads.load();
+    auto reserved = reservedFacetThreads.load();
+    do {
+        if (reserved + numThreads > maxThreads) {
+            return false;
+        }
+    } while (!reservedFacetThreads.compareAndSwap(&reserved, reserved + numThreads));
+    return true;
+}
+
+void releaseFacetThreads(int numThreads) {
+    reservedFacetThreads.subtractAndFetch(numThreads);
+}
+
+/**
+ * The operation contexts of the workers running the facets of a $facet stage, so that they can be
+ * interrupted along with the operation they work for.
+ */
+class FacetWorkers {
+public:
+    /**
+     * Called by a worker to let the $facet thread interrupt its operation context. If the workers
+     * have already been interrupted, 'opCtx' is killed right away.
+     */
+    void registerWorker(OperationContext* opCtx) {
+        stdx::lock_guard lk(_mutex);
+        _workerOpCtxs.push_back(opCtx);
+        if (_interruptCode) {
+            _kill(opCtx, *_interruptCode);
+        }
+    }
+
+    void unregisterWorker(OperationContext* opCtx) {
+        stdx::lock_guard lk(_mutex);
+        _workerOpCtxs.erase(std::find(_workerOpCtxs.begin(), _workerOpCtxs.end(), opCtx));
+    }
+
+    /**
+     * Kills the operation contexts of all workers, current and future, with 'code'.
+     */
+    void interruptWorkers(ErrorCodes::Error code) {
+        stdx::lock_guard lk(_mutex);
+        if (_interruptCode) {
+            return;
+        }
+
+        _interruptCode = code;
+        for (auto opCtx : _workerOpCtxs) {
+            _kill(opCtx, code);
+        }
+    }
+
+private:
+    static void _kill(OperationContext* opCtx, ErrorCodes::Error code) {
+        stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+        opCtx->getServiceContext()->killOperation(clientLock, opCtx, code);
+    }
+
+    Mutex _mutex = MONGO_MAKE_LATCH("FacetWorkers::_mutex");
+    std::vector<OperationContext*> _workerOpCtxs;
+    boost::optional<ErrorCodes::Error> _interruptCode;
+};
+}  // namespace
+
 DocumentSourceFacet::DocumentSourceFacet(std::vector<FacetPipeline> facetPipelines,
                                          const intrusive_ptr<ExpressionContext>& expCtx,
                                          size_t bufferSizeBytes,
@@ -66,7 +165,7 @@ DocumentSourceFacet::DocumentSourceFacet(std::vector<FacetPipeline> facetPipelin
     for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
         auto& facet = _facets[facetId];
         facet.pipeline->addInitialSource(
-            DocumentSourceTeeConsumer::create(pExpCtx, facetId, _teeBuffer));
+            DocumentSourceTeeConsumer::create(facet.pipeline->getContext(), facetId, _teeBuffer));
     }
 }
 
@@ -107,6 +206,17 @@ vector<pair<string, vector<BSONObj>>> extractRawPipelines(const BSONElement& ele
     return rawFacetPipelines;
 }
 
+/**
+ * Throws if the document constructed by $facet, whose results so far take up 'usedBytes', exceeds
+ * 'maxBytes'.
+ */
+void assertUnderMemoryLimit(size_t usedBytes, size_t maxBytes) {
+    uassert(4031700,
+            str::stream() << "document constructed by $facet is " << usedBytes
+                          << " bytes, which exceeds the limit of " << maxBytes << " bytes",
+            usedBytes <= maxBytes);
+}
+
 }  // namespace
 
 std::unique_ptr<DocumentSourceFacet::LiteParsed> DocumentSourceFacet::LiteParsed::parse(
@@ -151,16 +261,30 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
         return GetNextResult::makeEOF();
     }
 
+    vector<vector<Value>> results(_facets.size());
+    if (canRunFacetsInParallel() && reserveFacetThreads(_facets.size())) {
+        ON_BLOCK_EXIT([&] { releaseFacetThreads(_facets.size()); });
+        runFacetsInParallel(&results);
+    } else {
+        runFacets(&results);
+    }
+
+    MutableDocument resultDoc;
+    for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+        resultDoc[_facets[facetId].name] = Value(std::move(results[facetId]));
+    }
+
+    _done = true;  // We will only ever produce one result.
+    return resultDoc.freeze();
+}
+
+void DocumentSourceFacet::runFacets(vector<vector<Value>>* results) {
     const size_t maxBytes = _maxOutputDocSizeBytes;
     auto ensureUnderMemoryLimit = [usedBytes = 0ul, &maxBytes](long long additional) mutable {
         usedBytes += additional;
-        uassert(4031700,
-                str::stream() << "document constructed by $facet is " << usedBytes
-                              << " bytes, which exceeds the limit of " << maxBytes << " bytes",
-                usedBytes <= maxBytes);
+        assertUnderMemoryLimit(usedBytes, maxBytes);
     };
 
-    vector<vector<Value>> results(_facets.size());
     bool allPipelinesEOF = false;
     while (!allPipelinesEOF) {
         allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
@@ -169,19 +293,128 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
             auto next = pipeline->getSources().back()->getNext();
             for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
                 ensureUnderMemoryLimit(next.getDocument().getApproximateSize());
-                results[facetId].emplace_back(next.releaseDocument());
+                (*results)[facetId].emplace_back(next.releaseDocument());
             }
             allPipelinesEOF = allPipelinesEOF && next.isEOF();
         }
     }
+}
 
-    MutableDocument resultDoc;
-    for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
-        resultDoc[_facets[facetId].name] = Value(std::move(results[facetId]));
+bool DocumentSourceFacet::canRunFacetsInParallel() const {
+    // The variables and the operation context of an ExpressionContext cannot be shared between
+    // threads, so only facets which were each parsed with their own ExpressionContext can run
+    // concurrently. See createFromBson().
+    if (_facets.size() < 2 || std::any_of(_facets.begin(), _facets.end(), [&](const auto& facet) {
+            return facet.pipeline->getContext() == pExpCtx;
+        })) {
+        return false;
     }
 
-    _done = true;  // We will only ever produce one result.
-    return resultDoc.freeze();
+    // Every facet runs on an operation context of its own, outside of the locks, storage snapshot
+    // and transaction of this operation. That is only safe if no facet reads any collection
+    // besides the input it gets from the TeeBuffer, which this thread reads.
+    if (pExpCtx->opCtx->inMultiDocumentTransaction()) {
+        return false;
+    }
+    stdx::unordered_set<NamespaceString> involvedCollections;
+    addInvolvedCollections(&involvedCollections);
+    return involvedCollections.empty();
+}
+
+void DocumentSourceFacet::runFacetsInParallel(vector<vector<Value>>* results) {
+    AtomicWord<long long> usedBytes{0};
+    FacetWorkers facetWorkers;
+    auto parentOpCtx = pExpCtx->opCtx;
+
+    // Each facet has an ExpressionContext of its own, which must see the same $$NOW, $$CLUSTER_TIME
+    // and other runtime constants as this stage, however late they were set on it.
+    if (pExpCtx->variables.hasValue(Variables::kNowId)) {
+        const auto runtimeConstants = pExpCtx->variables.transitionalExtractRuntimeConstants();
+        for (auto&& facet : _facets) {
+            facet.pipeline->getContext()->variables.setLegacyRuntimeConstants(runtimeConstants);
+        }
+    }
+
+    // This thread loads every batch into '_teeBuffer', then waits for the facets which are not
+    // EOF yet to consume it, each on a thread and an operation context of its own.
+    _teeBuffer->setConcurrentConsumers(true);
+    ON_BLOCK_EXIT([&] { _teeBuffer->setConcurrentConsumers(false); });
+
+    vector<size_t> runningFacetIds(_facets.size());
+    std::iota(runningFacetIds.begin(), runningFacetIds.end(), 0);
+    while (!runningFacetIds.empty()) {
+        _teeBuffer->loadNextBatchForConcurrentConsumers();
+
+        vector<Future<bool>> workers;
+        {
+            // Make sure the workers are done with the facets before they are handed back to this
+            // operation, even if it is interrupted or one of the workers fails.
+            ON_BLOCK_EXIT([&] {
+                for (auto&& worker : workers) {
+                    worker.waitNoThrow().ignore();
+                }
+                for (auto facetId : runningFacetIds) {
+                    _facets[facetId].pipeline->reattachToOperationContext(parentOpCtx);
+                }
+            });
+
+            for (auto facetId : runningFacetIds) {
+                const auto& pipeline = _facets[facetId].pipeline;
+                pipeline->detachFromOperationContext();
+
+                // Returns whether the facet is EOF, rather than just done with this batch.
+                auto runWorker = [&, facetId] {
+                    auto opCtx = cc().makeOperationContext();
+                    opCtx->setDeadlineByDate(parentOpCtx->getDeadline(),
+                                             parentOpCtx->getTimeoutError());
+                    facetWorkers.registerWorker(opCtx.get());
+                    ON_BLOCK_EXIT([&] { facetWorkers.unregisterWorker(opCtx.get()); });
+
+                    pipeline->reattachToOperationContext(opCtx.get());
+                    ON_BLOCK_EXIT([&] { pipeline->detachFromOperationContext(); });
+
+                    auto next = pipeline->getSources().back()->getNext();
+                    for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+                        const auto size = next.getDocument().getApproximateSize();
+                        assertUnderMemoryLimit(usedBytes.addAndFetch(size),
+                                               _maxOutputDocSizeBytes);
+                        (*results)[facetId].emplace_back(next.releaseDocument());
+                    }
+                    return next.isEOF();
+                };
+
+                auto pf = makePromiseFuture<bool>();
+                facetThreadPool->schedule([runWorker = std::move(runWorker),
+                                           promise = std::move(pf.promise)](auto status) mutable {
+                    if (!status.isOK()) {
+                        promise.setError(status);
+                        return;
+                    }
+                    promise.setWith(runWorker);
+                });
+                workers.push_back(std::move(pf.future));
+            }
+
+            try {
+                for (auto&& worker : workers) {
+                    worker.wait(parentOpCtx);
+                }
+            } catch (const ExceptionForCat<ErrorCategory::Interruption>& ex) {
+                // Stop the workers before waiting for them to be done with the facets.
+                facetWorkers.interruptWorkers(ex.code());
+                throw;
+            }
+        }
+
+        // Rethrow the failure of any worker, and carry on with the facets which are not EOF.
+        vector<size_t> notEOFFacetIds;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            if (!workers[i].get()) {
+                notEOFFacetIds.push_back(runningFacetIds[i]);
+            }
+        }
+        runningFacetIds = std::move(notEOFFacetIds);
+    }
 }
 
 Value DocumentSourceFacet::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
@@ -305,11 +538,18 @@ intrusive_ptr<DocumentSource> DocumentSourceFacet::createFromBson(
     boost::optional<std::string> needsMongoS;
     boost::optional<std::string> needsShard;
 
+    // Facets which may run concurrently each get their own ExpressionContext. This is limited to
+    // top-level pipelines: a sub-pipeline may have its variables set on 'expCtx' between
+    // executions, e.g. by $lookup, which copies of it would not see.
+    const bool parallel =
+        internalQueryFacetEnableParallelExecution.load() && expCtx->subPipelineDepth == 0;
+
     std::vector<FacetPipeline> facetPipelines;
     for (auto&& rawFacet : extractRawPipelines(elem)) {
         const auto facetName = rawFacet.first;
 
-        auto pipeline = Pipeline::parse(rawFacet.second, expCtx, [](const Pipeline& pipeline) {
+        auto facetExpCtx = parallel ? expCtx->copyWith(expCtx->ns) : expCtx;
+        auto pipeline = Pipeline::parse(rawFacet.second, facetExpCtx, [](const Pipeline& pipeline) {
             auto sources = pipeline.getSources();
             std::for_each(sources.begin(), sources.end(), [](auto& stage) {
                 auto stageConstraints = stage->constraints();
@@ -157,6 +157,23 @@ private:
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
 
+    /**
+     * Runs the facets one after another on this thread, consuming all input, and appends the
+     * results of each facet to the corresponding vector of 'results'.
+     */
+    void runFacets(std::vector<std::vector<Value>>* results);
+
+    /**
+     * Like runFacets(), but has each facet consume every batch of input on its own thread.
+     */
+    void runFacetsInParallel(std::vector<std::vector<Value>>* results);
+
+    /**
+     * Returns whether the facets can run concurrently, see
+     * internalQueryFacetEnableParallelExecution.
+     */
+    bool canRunFacetsInParallel() const;
+
     boost::intrusive_ptr<TeeBuffer> _teeBuffer;
     std::vector<FacetPipeline> _facets;
 
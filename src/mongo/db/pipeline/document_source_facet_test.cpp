@@ -46,6 +46,7 @@
 #include "mongo/db/pipeline/document_source_skip.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 using std::deque;
@@ -434,6 +435,81 @@ TEST_F(DocumentSourceFacetTest,
     ASSERT(facetStage->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceFacetTest, ShouldProduceTheSameResultsWhenFacetsRunInParallel) {
+    auto ctx = getExpCtx();
+
+    const bool enableParallelExecution = internalQueryFacetEnableParallelExecution.load();
+    const int bufferSizeBytes = internalQueryFacetBufferSizeBytes.load();
+    ON_BLOCK_EXIT([&] {
+        internalQueryFacetEnableParallelExecution.store(enableParallelExecution);
+        internalQueryFacetBufferSizeBytes.store(bufferSizeBytes);
+    });
+    internalQueryFacetEnableParallelExecution.store(true);
+    // Have the facets consume their input one document at a time.
+    internalQueryFacetBufferSizeBytes.store(1);
+
+    deque<DocumentSource::GetNextResult> inputs = {Document{{"_id", 0}},
+                                                   Document{{"_id", 1}},
+                                                   Document{{"_id", 2}},
+                                                   Document{{"_id", 3}},
+                                                   Document{{"_id", 4}}};
+    auto mock = DocumentSourceMock::createForTest(inputs, ctx);
+
+    auto spec = fromjson(
+        "{$facet: {all: [], first: [{$limit: 2}], skipped: [{$skip: 3}], count: [{$count: 'n'}]}}");
+    auto facetStage = DocumentSourceFacet::createFromBson(spec.firstElement(), ctx);
+    facetStage->setSource(mock.get());
+
+    // Each facet was parsed with an ExpressionContext of its own, so it can run on its own thread.
+    for (auto&& facet : static_cast<DocumentSourceFacet*>(facetStage.get())->getFacetPipelines()) {
+        ASSERT(facet.pipeline->getContext() != ctx);
+    }
+
+    auto output = facetStage->getNext();
+    ASSERT(output.isAdvanced());
+    auto expected = fromjson(
+        "{all: [{_id: 0}, {_id: 1}, {_id: 2}, {_id: 3}, {_id: 4}], first: [{_id: 0}, {_id: 1}], "
+        "skipped: [{_id: 3}, {_id: 4}], count: [{n: 5}]}");
+    ASSERT_DOCUMENT_EQ(output.getDocument(), Document(expected));
+    ASSERT(facetStage->getNext().isEOF());
+    ASSERT(facetStage->getNext().isEOF());
+
+    // The facets are handed back to this operation once they are done.
+    for (auto&& facet : static_cast<DocumentSourceFacet*>(facetStage.get())->getFacetPipelines()) {
+        ASSERT_EQ(facet.pipeline->getContext()->opCtx, getOpCtx());
+    }
+}
+
+TEST_F(DocumentSourceFacetTest, ShouldShareRuntimeConstantsWithFacetsRunningInParallel) {
+    auto ctx = getExpCtx();
+
+    const bool enableParallelExecution = internalQueryFacetEnableParallelExecution.load();
+    ON_BLOCK_EXIT(
+        [&] { internalQueryFacetEnableParallelExecution.store(enableParallelExecution); });
+    internalQueryFacetEnableParallelExecution.store(true);
+
+    deque<DocumentSource::GetNextResult> inputs = {Document{{"_id", 0}}};
+    auto mock = DocumentSourceMock::createForTest(inputs, ctx);
+
+    auto spec = fromjson(
+        "{$facet: {a: [{$project: {now: '$$NOW', clusterTime: '$$CLUSTER_TIME'}}], "
+        "b: [{$project: {now: '$$NOW', clusterTime: '$$CLUSTER_TIME'}}]}}");
+    auto facetStage = DocumentSourceFacet::createFromBson(spec.firstElement(), ctx);
+    facetStage->setSource(mock.get());
+
+    // The runtime constants of the query may only be set once its pipeline is parsed.
+    const auto now = Date_t::fromMillisSinceEpoch(1234);
+    const Timestamp clusterTime(5, 6);
+    ctx->variables.setLegacyRuntimeConstants({now, clusterTime});
+
+    auto output = facetStage->getNext();
+    ASSERT(output.isAdvanced());
+    const Document expectedFacet{{"_id", 0}, {"now", now}, {"clusterTime", clusterTime}};
+    ASSERT_DOCUMENT_EQ(output.getDocument(),
+                       (Document{{"a", vector<Value>{Value(expectedFacet)}},
+                                 {"b", vector<Value>{Value(expectedFacet)}}}));
+}
+
 TEST_F(DocumentSourceFacetTest, ShouldBeAbleToEvaluateMultipleStagesWithinOneSubPipeline) {
     auto ctx = getExpCtx();
 
@@ -29,8 +29,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 #include <memory>
+#include <set>
 
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
@@ -167,6 +169,10 @@ void DocumentSourceGroup::freeMemory() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
+    if (_streaming) {
+        return getNextStreaming();
+    }
+
     if (!_initialized) {
         const auto initializationResult = initialize();
         if (initializationResult.isPaused()) {
@@ -244,6 +250,173 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     return out;
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
+    // The input is sorted by the group key, so a change of key means the current group is done.
+    if (_streamingEOF) {
+        return GetNextResult::makeEOF();
+    }
+
+    auto input = pSource->getNext();
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        auto rootDocument = input.releaseDocument();
+        Value id = computeId(rootDocument);
+
+        // The hashing $group takes over when the group in progress grows too large, so that it
+        // is spilled, or the query fails, just like a group which is not streamed.
+        if (!canStreamGroupKey(id) || shouldStopStreamingToSaveMemory()) {
+            stopStreaming(std::move(rootDocument));
+            return doGetNext();
+        }
+
+        if (_currentId.missing()) {
+            startStreamingGroup(std::move(id));
+        } else if (!pExpCtx->getValueComparator().evaluate(_currentId == id)) {
+            Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+            startStreamingGroup(std::move(id));
+            accumulateIntoCurrentGroup(rootDocument);
+            return out;
+        }
+
+        accumulateIntoCurrentGroup(rootDocument);
+    }
+
+    if (input.isPaused()) {
+        return input;
+    }
+
+    invariant(input.isEOF());
+    _streamingEOF = true;
+    if (_currentId.missing()) {
+        return input;
+    }
+    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+}
+
+void DocumentSourceGroup::startStreamingGroup(Value id) {
+    _currentId = std::move(id);
+
+    if (_currentAccumulators.empty()) {
+        _currentAccumulators.reserve(_accumulatedFields.size());
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _currentAccumulators.push_back(accumulatedField.makeAccumulator());
+        }
+    }
+
+    // Only the group in progress is held in memory.
+    _memoryTracker.resetCurrent();
+    _memoryTracker.update(_currentId.getApproximateSize());
+
+    Value expandedId = expandId(_currentId);
+    Document idDoc =
+        expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+    for (size_t i = 0; i < _accumulatedFields.size(); ++i) {
+        _currentAccumulators[i]->reset();
+        Value initializerValue =
+            _accumulatedFields[i].expr.initializer->evaluate(idDoc, &pExpCtx->variables);
+        _currentAccumulators[i]->startNewGroup(initializerValue);
+        _memoryTracker.set(_accumulatedFields[i].fieldName,
+                           _currentAccumulators[i]->getMemUsage());
+    }
+}
+
+void DocumentSourceGroup::accumulateIntoCurrentGroup(const Document& root) {
+    for (size_t i = 0; i < _accumulatedFields.size(); ++i) {
+        _currentAccumulators[i]->process(
+            _accumulatedFields[i].expr.argument->evaluate(root, &pExpCtx->variables),
+            _doingMerge);
+        _memoryTracker.set(_accumulatedFields[i].fieldName,
+                           _currentAccumulators[i]->getMemUsage());
+    }
+}
+
+bool DocumentSourceGroup::shouldStopStreamingToSaveMemory() {
+    if (_memoryTracker.currentMemoryBytes() <= _memoryTracker._maxAllowedMemoryUsageBytes) {
+        return false;
+    }
+
+    if (!_memoryTracker._allowDiskUse) {
+        for (size_t i = 0; i < _currentAccumulators.size(); ++i) {
+            _currentAccumulators[i]->reduceMemoryConsumptionIfAble();
+            _memoryTracker.set(_accumulatedFields[i].fieldName,
+                               _currentAccumulators[i]->getMemUsage());
+        }
+    }
+    return _memoryTracker.currentMemoryBytes() > _memoryTracker._maxAllowedMemoryUsageBytes;
+}
+
+bool DocumentSourceGroup::canStreamGroupKey(const Value& id) const {
+    // A sort orders an array by its smallest or largest element and a missing field as null, so
+    // documents with such a group key may sort equal to documents from another group and be
+    // interleaved with them. A single group key which is missing has already been turned into
+    // null by computeId().
+    auto isStreamable = [](const Value& component) {
+        return !component.missing() && component.getType() != BSONType::Array;
+    };
+
+    if (_idExpressions.size() == 1) {
+        return isStreamable(id);
+    }
+    const auto& components = id.getArray();
+    return std::all_of(components.begin(), components.end(), isStreamable);
+}
+
+void DocumentSourceGroup::stopStreaming(Document unstreamedDocument) {
+    _streaming = false;
+
+    // '_memoryTracker' already accounts for the group in progress.
+    if (!_currentId.missing()) {
+        (*_groups)[_currentId] = std::move(_currentAccumulators);
+        _currentAccumulators.clear();
+        _currentId = Value();
+    }
+
+    _unstreamedDocument = std::move(unstreamedDocument);
+}
+
+bool DocumentSourceGroup::setInputSortPattern(const SortPattern& inputSort) {
+    _streaming = false;
+    if (!internalDocumentSourceGroupEnableStreaming.load()) {
+        return false;
+    }
+
+    std::set<std::string> groupPaths;
+    for (auto&& idExpression : _idExpressions) {
+        auto fieldPathExpr = dynamic_cast<ExpressionFieldPath*>(idExpression.get());
+        if (!fieldPathExpr || fieldPathExpr->isVariableReference()) {
+            return false;
+        }
+
+        // Grouping by $$CURRENT or $$ROOT puts every document in its own group.
+        const auto& fieldPath = fieldPathExpr->getFieldPath();
+        if (fieldPath.getPathLength() == 1) {
+            return false;
+        }
+        groupPaths.insert(fieldPath.tail().fullPath());
+    }
+
+    if (groupPaths.size() > inputSort.size()) {
+        return false;
+    }
+
+    // The group key fields may appear in any order and direction at the front of the sort, but a
+    // $meta sort component says nothing about the order of the group key.
+    std::set<std::string> sortPrefixPaths;
+    for (size_t i = 0; i < groupPaths.size(); ++i) {
+        const auto& part = inputSort[i];
+        if (!part.fieldPath) {
+            return false;
+        }
+        sortPrefixPaths.insert(part.fieldPath->fullPath());
+    }
+
+    if (sortPrefixPaths != groupPaths) {
+        return false;
+    }
+
+    _streaming = true;
+    return true;
+}
+
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
@@ -318,6 +491,10 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
         out["usedDisk"] = Value(_stats.usedDisk);
     }
 
+    if (explain && _streaming) {
+        out["streaming"] = Value(true);
+    }
+
     return Value(out.freezeToValue());
 }
 
@@ -534,8 +711,11 @@ private:
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
-    GetNextResult input = pSource->getNext();
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'. A $group which
+    // stopped streaming starts with the document whose group key it could not stream.
+    GetNextResult input =
+        _unstreamedDocument ? GetNextResult(std::move(*_unstreamedDocument)) : pSource->getNext();
+    _unstreamedDocument.reset();
 
     for (; input.isAdvanced(); input = pSource->getNext()) {
         if (shouldSpillWithAttemptToSaveMemory()) {
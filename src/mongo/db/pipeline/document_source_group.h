@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/memory_usage_tracker.h"
 #include "mongo/db/pipeline/transformer_interface.h"
+#include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -120,6 +121,8 @@ public:
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        // A streaming $group is still reported as blocking, since it falls back to hashing its
+        // entire input when it meets a group key which it cannot stream.
         StageConstraints constraints(StreamType::kBlocking,
                                      PositionRequirement::kNone,
                                      HostTypeRequirement::kNone,
@@ -189,6 +192,21 @@ public:
      */
     size_t getMaxMemoryUsageBytes() const;
 
+    /**
+     * Informs this stage that its input arrives sorted by 'inputSort'. If every component of the
+     * group key is a field path, and together those paths make up a prefix of 'inputSort', this
+     * $group becomes a streaming $group: it returns each group as soon as the group key changes,
+     * rather than hashing all of its input first. Returns true if the stage is now streaming.
+     */
+    bool setInputSortPattern(const SortPattern& inputSort);
+
+    /**
+     * Returns true if this $group emits its groups as it consumes sorted input.
+     */
+    bool isStreaming() const {
+        return _streaming;
+    }
+
 protected:
     GetNextResult doGetNext() final;
     void doDispose() final;
@@ -206,6 +224,35 @@ private:
      */
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
+    GetNextResult getNextStreaming();
+
+    /**
+     * Helpers for a streaming $group. startStreamingGroup() makes 'id' the current group key and
+     * resets '_currentAccumulators' for it, while accumulateIntoCurrentGroup() feeds 'root' to the
+     * accumulators of the current group.
+     */
+    void startStreamingGroup(Value id);
+    void accumulateIntoCurrentGroup(const Document& root);
+
+    /**
+     * Returns true if documents with the group key 'id' are guaranteed to be adjacent in input
+     * which is sorted by the group key fields.
+     */
+    bool canStreamGroupKey(const Value& id) const;
+
+    /**
+     * Returns true if the group in progress of a streaming $group takes up more memory than this
+     * stage may use, even after its accumulators were asked to reduce their memory consumption
+     * when spilling is not allowed.
+     */
+    bool shouldStopStreamingToSaveMemory();
+
+    /**
+     * Turns a streaming $group back into a hashing $group, moving the group in progress into
+     * '_groups', where the memory it takes up remains accounted for. The document
+     * 'unstreamedDocument' is the first input which initialize() consumes.
+     */
+    void stopStreaming(Document unstreamedDocument);
 
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
@@ -293,6 +340,16 @@ private:
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    // Set when the input to this stage is sorted by the group key. While streaming, '_currentId'
+    // and '_currentAccumulators' hold the group in progress, and '_currentId' is missing before the
+    // first input document has been seen.
+    bool _streaming = false;
+    bool _streamingEOF = false;
+
+    // Only used when a streaming $group falls back to hashing. Holds the document whose group key
+    // could not be streamed, until initialize() accumulates it into '_groups'.
+    boost::optional<Document> _unstreamedDocument;
 };
 
 }  // namespace mongo
@@ -50,6 +50,7 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/unordered_set.h"
@@ -245,6 +246,200 @@ TEST_F(DocumentSourceGroupTest, ShouldNotReportDottedGroupKeyAsARename) {
     ASSERT_EQ(modifiedPathsRet.renames.size(), 0UL);
 }
 
+intrusive_ptr<DocumentSourceGroup> makeCountByAGroup(
+    const intrusive_ptr<ExpressionContextForTest>& expCtx) {
+    auto&& parser = AccumulationStatement::getParser("$sum", boost::none);
+    auto accumulatorArg = BSON("" << 1);
+    auto accExpr = parser(expCtx.get(), accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement countStatement{"count", accExpr};
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx.get(), "$a", expCtx->variablesParseState);
+    return DocumentSourceGroup::create(expCtx, groupByExpression, {countStatement});
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldStreamOnlyWhenGroupKeyIsPrefixOfInputSort) {
+    auto expCtx = getExpCtx();
+    VariablesParseState vps = expCtx->variablesParseState;
+    auto x = ExpressionFieldPath::parse(expCtx.get(), "$x", vps);
+    auto yDotZ = ExpressionFieldPath::parse(expCtx.get(), "$y.z", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, ExpressionObject::create(expCtx.get(), {{"x", x}, {"y", yDotZ}}), {});
+
+    ASSERT_TRUE(group->setInputSortPattern(SortPattern(BSON("y.z" << -1 << "x" << 1), expCtx)));
+    ASSERT_TRUE(group->isStreaming());
+    ASSERT_TRUE(
+        group->setInputSortPattern(SortPattern(BSON("x" << 1 << "y.z" << 1 << "w" << 1), expCtx)));
+
+    ASSERT_FALSE(group->setInputSortPattern(SortPattern(BSON("x" << 1), expCtx)));
+    ASSERT_FALSE(group->isStreaming());
+    ASSERT_FALSE(
+        group->setInputSortPattern(SortPattern(BSON("x" << 1 << "w" << 1 << "y.z" << 1), expCtx)));
+    ASSERT_FALSE(group->setInputSortPattern(SortPattern(BSON("x" << 1 << "y" << 1), expCtx)));
+
+    auto computedGroup = DocumentSourceGroup::create(
+        expCtx, ExpressionFieldPath::parse(expCtx.get(), "$$ROOT", vps), {});
+    ASSERT_FALSE(computedGroup->setInputSortPattern(SortPattern(BSON("x" << 1), expCtx)));
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupShouldReturnEachGroupWhenKeyChanges) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+    auto group = makeCountByAGroup(expCtx);
+    ASSERT_TRUE(group->setInputSortPattern(SortPattern(BSON("a" << 1), expCtx)));
+
+    auto mock =
+        DocumentSourceMock::createForTest({Document{{"a", 1}},
+                                           Document{{"a", 1}},
+                                           Document{{"a", 2}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"a", 3}}},
+                                          expCtx);
+    group->setSource(mock.get());
+
+    // The first group is complete as soon as the key changes, ahead of the pause.
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 1}, {"count", 2}}));
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 2}, {"count", 1}}));
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 3}, {"count", 1}}));
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    auto explain = group->serialize(ExplainOptions::Verbosity::kQueryPlanner).getDocument();
+    ASSERT_VALUE_EQ(explain["streaming"], Value(true));
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupShouldFallBackToHashingForArrayGroupKey) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+    auto group = makeCountByAGroup(expCtx);
+    ASSERT_TRUE(group->setInputSortPattern(SortPattern(BSON("a" << 1), expCtx)));
+
+    // A sort on 'a' orders the array by its smallest element, so it ties with the scalar 1.
+    auto mock = DocumentSourceMock::createForTest({Document{{"a", 1}},
+                                                   Document{{"a", BSON_ARRAY(1 << 5)}},
+                                                   Document{{"a", 1}},
+                                                   Document{{"a", 2}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    map<int, int> countsBySmallestElement;
+    size_t numGroups = 0;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        auto id = doc["_id"];
+        if (id.isArray()) {
+            ASSERT_VALUE_EQ(id, Value(BSON_ARRAY(1 << 5)));
+            ASSERT_VALUE_EQ(doc["count"], Value(1));
+        } else {
+            countsBySmallestElement[id.coerceToInt()] = doc["count"].coerceToInt();
+        }
+        ++numGroups;
+    }
+    ASSERT_FALSE(group->isStreaming());
+    ASSERT_EQ(numGroups, 3UL);
+    ASSERT_EQ(countsBySmallestElement[1], 2);
+    ASSERT_EQ(countsBySmallestElement[2], 1);
+}
+
+TEST_F(DocumentSourceGroupTest, SortFollowedByGroupOnSortKeyShouldStream) {
+    auto expCtx = getExpCtx();
+    auto pipeline = Pipeline::parse(
+        {fromjson("{$sort: {a: 1, b: 1}}"), fromjson("{$group: {_id: '$a', n: {$sum: 1}}}")},
+        expCtx);
+    pipeline->optimizePipeline();
+    auto group = dynamic_cast<DocumentSourceGroup*>(pipeline->getSources().back().get());
+    ASSERT(group);
+    ASSERT_TRUE(group->isStreaming());
+
+    auto unsortedPipeline = Pipeline::parse(
+        {fromjson("{$sort: {b: 1, a: 1}}"), fromjson("{$group: {_id: '$a', n: {$sum: 1}}}")},
+        expCtx);
+    unsortedPipeline->optimizePipeline();
+    group = dynamic_cast<DocumentSourceGroup*>(unsortedPipeline->getSources().back().get());
+    ASSERT(group);
+    ASSERT_FALSE(group->isStreaming());
+}
+
+intrusive_ptr<DocumentSourceGroup> makePushLargeStrByAGroup(
+    const intrusive_ptr<ExpressionContextForTest>& expCtx, size_t maxMemoryUsageBytes) {
+    auto&& parser = AccumulationStatement::getParser("$push", boost::none);
+    auto accumulatorArg = BSON(""
+                               << "$largeStr");
+    auto accExpr = parser(expCtx.get(), accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement pushStatement{"spaceHog", accExpr};
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx.get(), "$a", expCtx->variablesParseState);
+    return DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupShouldErrorIfGroupIsTooLargeAndNotAllowedToSpill) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+    const size_t maxMemoryUsageBytes = 1000;
+    auto group = makePushLargeStrByAGroup(expCtx, maxMemoryUsageBytes);
+    ASSERT_TRUE(group->setInputSortPattern(SortPattern(BSON("a" << 1), expCtx)));
+
+    string largeStr(maxMemoryUsageBytes * 2 / 3, 'x');
+    auto mock = DocumentSourceMock::createForTest({Document{{"a", 1}, {"largeStr", largeStr}},
+                                                   Document{{"a", 2}, {"largeStr", largeStr}},
+                                                   Document{{"a", 3}, {"largeStr", largeStr}},
+                                                   Document{{"a", 3}, {"largeStr", largeStr}},
+                                                   Document{{"a", 4}, {"largeStr", largeStr}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    // Only the group in progress counts towards the memory limit.
+    ASSERT_TRUE(group->getNext().isAdvanced());
+    ASSERT_TRUE(group->getNext().isAdvanced());
+    ASSERT_THROWS_CODE(
+        group->getNext(), AssertionException, ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupShouldSpillGroupWhichIsTooLarge) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+    auto group = makePushLargeStrByAGroup(expCtx, maxMemoryUsageBytes);
+    ASSERT_TRUE(group->setInputSortPattern(SortPattern(BSON("a" << 1), expCtx)));
+
+    string largeStr(maxMemoryUsageBytes / 2, 'x');
+    auto mock = DocumentSourceMock::createForTest({Document{{"a", 1}, {"largeStr", largeStr}},
+                                                   Document{{"a", 2}, {"largeStr", largeStr}},
+                                                   Document{{"a", 2}, {"largeStr", largeStr}},
+                                                   Document{{"a", 2}, {"largeStr", largeStr}},
+                                                   Document{{"a", 3}, {"largeStr", largeStr}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_VALUE_EQ(result.releaseDocument()["_id"], Value(1));
+
+    // The group with key 2 does not fit in memory, so the stage falls back to a hashing $group,
+    // which spills it and merges it back.
+    map<int, size_t> groupSizes;
+    for (result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        groupSizes[doc["_id"].coerceToInt()] = doc["spaceHog"].getArrayLength();
+    }
+    ASSERT_TRUE(result.isEOF());
+    ASSERT_FALSE(group->isStreaming());
+    ASSERT_TRUE(group->usedDisk());
+    ASSERT_EQ(groupSizes.size(), 2UL);
+    ASSERT_EQ(groupSizes[2], 3UL);
+    ASSERT_EQ(groupSizes[3], 1UL);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -90,6 +90,20 @@ bool foreignShardedLookupAllowed() {
     return getTestCommandsEnabled() && internalQueryAllowShardedLookup.load();
 }
 
+/**
+ * If lookup on a sharded collection is disallowed and 'ex' shows that the foreign collection is
+ * sharded, throws a custom exception.
+ */
+void uassertForeignCollectionNotSharded(
+    const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
+    if (auto staleInfo = ex.extraInfo<StaleConfigInfo>()) {
+        uassert(51069,
+                "Cannot run $lookup with sharded foreign collection",
+                foreignShardedLookupAllowed() || !staleInfo->getVersionWanted() ||
+                    staleInfo->getVersionWanted() == ChunkVersion::UNSHARDED());
+    }
+}
+
 // Parses $lookup 'from' field. The 'from' field must be a string or one of the following
 // exceptions:
 // {from: {db: "config", coll: "cache.chunks.*"}, ...} or
@@ -332,17 +346,27 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
         return unwindResult();
     }
 
+    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
+    // '_unwindSrc' would be non-null, and we would not have made it here.
+    invariant(!_matchSrc);
+
+    if (!_batchedJoinInitialized) {
+        initializeBatchedJoin();
+    }
+
+    if (_batchedJoin) {
+        return getNextBatched();
+    }
+
     auto nextInput = pSource->getNext();
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
 
-    auto inputDoc = nextInput.releaseDocument();
-
-    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
-    // '_unwindSrc' would be non-null, and we would not have made it here.
-    invariant(!_matchSrc);
+    return lookUpSingleDocument(nextInput.releaseDocument());
+}
 
+Document DocumentSourceLookUp::lookUpSingleDocument(Document inputDoc) {
     if (hasLocalFieldForeignFieldJoin()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -354,14 +378,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     try {
         pipeline = buildPipeline(inputDoc);
     } catch (const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
-        // If lookup on a sharded collection is disallowed and the foreign collection is sharded,
-        // throw a custom exception.
-        if (auto staleInfo = ex.extraInfo<StaleConfigInfo>()) {
-            uassert(51069,
-                    "Cannot run $lookup with sharded foreign collection",
-                    foreignShardedLookupAllowed() || !staleInfo->getVersionWanted() ||
-                        staleInfo->getVersionWanted() == ChunkVersion::UNSHARDED());
-        }
+        uassertForeignCollectionNotSharded(ex);
         throw;
     }
 
@@ -388,6 +405,289 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     return output.freeze();
 }
 
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextBatched() {
+    if (_batchedOutput.empty()) {
+        if (_batchedInputResult) {
+            auto inputResult = std::move(*_batchedInputResult);
+            _batchedInputResult.reset();
+            return inputResult;
+        }
+
+        std::vector<Document> batch;
+        auto nextInput = pSource->getNext();
+        while (nextInput.isAdvanced()) {
+            batch.push_back(nextInput.releaseDocument());
+            if (batch.size() == _batchSize) {
+                break;
+            }
+            nextInput = pSource->getNext();
+        }
+
+        if (batch.empty()) {
+            return nextInput;
+        }
+        if (!nextInput.isAdvanced()) {
+            _batchedInputResult = std::move(nextInput);
+        }
+
+        lookUpBatch(std::move(batch));
+    }
+
+    invariant(!_batchedOutput.empty());
+    auto output = std::move(_batchedOutput.front());
+    _batchedOutput.pop_front();
+    return output;
+}
+
+void DocumentSourceLookUp::lookUpBatch(std::vector<Document> batch) {
+    // Map each distinct join value to the positions in 'batch' of the local documents which join
+    // on it. The foreign query runs with the same collation, so hashing with its comparator pairs
+    // up local and foreign documents exactly as the per-document query would.
+    auto localDocsByValue =
+        _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    std::vector<bool> isBatched(batch.size(), false);
+    BSONArrayBuilder inValues;
+    std::vector<Value> joinValues;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        joinValues.clear();
+        if (!getBatchedJoinValues(batch[i], &joinValues)) {
+            continue;
+        }
+
+        // Keep the $in list of the foreign query well within the maximum BSON size.
+        size_t joinValuesSize = 0;
+        for (auto&& joinValue : joinValues) {
+            joinValuesSize += joinValue.getApproximateSize();
+        }
+        if (inValues.len() + joinValuesSize > BSONObjMaxUserSize / 2) {
+            continue;
+        }
+
+        isBatched[i] = true;
+        for (auto&& joinValue : joinValues) {
+            auto& localDocs = localDocsByValue[joinValue];
+            if (localDocs.empty()) {
+                joinValue.addToBsonArray(&inValues);
+            }
+            if (localDocs.empty() || localDocs.back() != i) {
+                localDocs.push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::vector<Value>> results(batch.size());
+    bool batchFitsInMemory = true;
+    if (!localDocsByValue.empty()) {
+        auto pipeline = buildBatchedPipeline(
+            BSON("$match" << BSON(_batchedJoin->foreignField.fullPath()
+                                  << BSON("$in" << inValues.arr()))));
+
+        // Remembers the last foreign document appended to each local document's results, so that
+        // a foreign document matching several join values of one local document is added once.
+        std::vector<size_t> lastForeignDoc(batch.size(), 0);
+        size_t foreignDocCount = 0;
+        long long batchSizeBytes = 0;
+        const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+
+        while (auto result = pipeline->getNext()) {
+            // The results of a single lookup may be up to 'maxBytes' in size. Rather than holding
+            // on to that much data for every document in the batch, look the documents up one by
+            // one once the batch as a whole has grown that large.
+            batchSizeBytes += result->getApproximateSize();
+            if (batchSizeBytes > maxBytes) {
+                batchFitsInMemory = false;
+                break;
+            }
+
+            ++foreignDocCount;
+            auto appendToMatchingLocalDocs = [&](const Value& foreignValue) {
+                auto it = localDocsByValue.find(foreignValue);
+                if (it == localDocsByValue.end()) {
+                    return;
+                }
+                for (auto&& localDoc : it->second) {
+                    if (lastForeignDoc[localDoc] != foreignDocCount) {
+                        lastForeignDoc[localDoc] = foreignDocCount;
+                        results[localDoc].emplace_back(*result);
+                    }
+                }
+            };
+
+            if (_batchedJoin->foreignValue) {
+                appendToMatchingLocalDocs(
+                    _batchedJoin->foreignValue->evaluate(*result, &_fromExpCtx->variables));
+            } else {
+                document_path_support::visitAllValuesAtPath(
+                    *result, _batchedJoin->foreignField, appendToMatchingLocalDocs);
+            }
+        }
+
+        recordPlanSummaryStats(*pipeline);
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!isBatched[i] || !batchFitsInMemory) {
+            _batchedOutput.push_back(lookUpSingleDocument(std::move(batch[i])));
+            continue;
+        }
+
+        MutableDocument output(std::move(batch[i]));
+        output.setNestedField(_as, Value(std::move(results[i])));
+        _batchedOutput.push_back(output.freeze());
+    }
+}
+
+namespace {
+
+/**
+ * Returns true if 'value' can be looked up in a batch, and its matches found by hashing. Queries
+ * on null also match missing fields, and queries on arrays or regular expressions do not reduce
+ * to comparing a single value.
+ */
+bool isBatchableJoinValue(const Value& value) {
+    switch (value.getType()) {
+        case BSONType::EOO:
+        case BSONType::jstNULL:
+        case BSONType::Undefined:
+        case BSONType::Array:
+        case BSONType::RegEx:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * If 'stage' has the form {$match: {$expr: {$eq: ["$<path>", "$$<variableName>"]}}}, with the
+ * arguments to $eq in either order, returns "$<path>".
+ */
+boost::optional<std::string> getExprEqualityPath(const BSONObj& stage,
+                                                 const std::string& variableName) {
+    auto getOnlyObjectField = [](const BSONObj& obj, StringData fieldName) {
+        return obj.nFields() == 1 && obj.firstElementFieldNameStringData() == fieldName &&
+                obj.firstElement().type() == BSONType::Object
+            ? boost::optional<BSONObj>(obj.firstElement().Obj())
+            : boost::none;
+    };
+
+    auto matchSpec = getOnlyObjectField(stage, "$match");
+    auto exprSpec = matchSpec ? getOnlyObjectField(*matchSpec, "$expr") : boost::none;
+    if (!exprSpec || exprSpec->nFields() != 1 ||
+        exprSpec->firstElementFieldNameStringData() != "$eq" ||
+        exprSpec->firstElement().type() != BSONType::Array) {
+        return boost::none;
+    }
+
+    std::vector<BSONElement> args = exprSpec->firstElement().Array();
+    if (args.size() != 2 || args[0].type() != BSONType::String ||
+        args[1].type() != BSONType::String) {
+        return boost::none;
+    }
+
+    const std::string variableRef = "$$" + variableName;
+    for (size_t i = 0; i < 2; ++i) {
+        auto path = args[i].valueStringData();
+        if (args[1 - i].valueStringData() == variableRef && path.startsWith("$") &&
+            !path.startsWith("$$")) {
+            return path.toString();
+        }
+    }
+    return boost::none;
+}
+
+}  // namespace
+
+void DocumentSourceLookUp::initializeBatchedJoin() {
+    _batchedJoinInitialized = true;
+
+    // The batch size is read once, so that changing the knob cannot switch a running $lookup
+    // between the batched and unbatched paths and strand the documents buffered for a batch.
+    _batchSize = internalDocumentSourceLookupBatchSize.load();
+    if (_batchSize <= 1) {
+        return;
+    }
+
+    if (hasLocalFieldForeignFieldJoin()) {
+        if (hasPipeline()) {
+            return;
+        }
+
+        // The query language treats numeric path components as both field names and array
+        // positions, which does not agree with visitAllValuesAtPath().
+        for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+            if (str::parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+                return;
+            }
+        }
+        _batchedJoin = BatchedJoin{*_foreignField, nullptr};
+        return;
+    }
+
+    if (_userPipeline.size() != 1 || _letVariables.size() != 1) {
+        return;
+    }
+
+    auto path = getExprEqualityPath(_userPipeline.front(), _letVariables.front().name);
+    if (!path) {
+        return;
+    }
+
+    auto foreignValue =
+        ExpressionFieldPath::parse(_fromExpCtx.get(), *path, _fromExpCtx->variablesParseState);
+    _batchedJoin = BatchedJoin{foreignValue->getFieldPathWithoutCurrentPrefix(), foreignValue};
+}
+
+bool DocumentSourceLookUp::getBatchedJoinValues(const Document& localDoc,
+                                                std::vector<Value>* joinValues) {
+    if (_batchedJoin->foreignValue) {
+        auto value = _letVariables.front().expression->evaluate(localDoc, &pExpCtx->variables);
+        if (!isBatchableJoinValue(value)) {
+            return false;
+        }
+        joinValues->push_back(std::move(value));
+        return true;
+    }
+
+    bool allBatchable = true;
+    document_path_support::visitAllValuesAtPath(localDoc, *_localField, [&](const Value& value) {
+        allBatchable = allBatchable && isBatchableJoinValue(value);
+        joinValues->push_back(value);
+    });
+
+    // A document without any value at 'localField' joins on null.
+    return allBatchable && !joinValues->empty();
+}
+
+std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildBatchedPipeline(
+    BSONObj batchMatch) {
+    // Keep any view pipeline prefix, and replace the correlated stages which follow it.
+    const size_t prefixSize = _fieldMatchPipelineIdx
+        ? *_fieldMatchPipelineIdx
+        : _resolvedPipeline.size() - _userPipeline.size();
+    std::vector<BSONObj> stages(_resolvedPipeline.begin(), _resolvedPipeline.begin() + prefixSize);
+    stages.push_back(std::move(batchMatch));
+
+    _variables.copyToExpCtx(_variablesParseState, _fromExpCtx.get());
+
+    if (!foreignShardedLookupAllowed()) {
+        // Enforce that the foreign collection must be unsharded for lookup.
+        _fromExpCtx->mongoProcessInterface->setExpectedShardVersion(
+            _fromExpCtx->opCtx, _fromExpCtx->ns, ChunkVersion::UNSHARDED());
+    }
+
+    MakePipelineOptions pipelineOpts;
+    pipelineOpts.optimize = true;
+    pipelineOpts.attachCursorSource = true;
+    pipelineOpts.validator = lookupPipeValidator;
+    pipelineOpts.allowTargetingShards = internalQueryAllowShardedLookup.load();
+    try {
+        return Pipeline::makePipeline(stages, _fromExpCtx, pipelineOpts);
+    } catch (const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
+        uassertForeignCollectionNotSharded(ex);
+        throw;
+    }
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -606,6 +906,7 @@ bool DocumentSourceLookUp::usedDisk() {
 }
 
 void DocumentSourceLookUp::doDispose() {
+    _batchedOutput.clear();
     if (_pipeline) {
         recordPlanSummaryStats(*_pipeline);
         _pipeline->dispose(pExpCtx->opCtx);
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -253,6 +254,47 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Runs the foreign pipeline for 'inputDoc' alone and returns 'inputDoc' with the results added
+     * to the 'as' field.
+     */
+    Document lookUpSingleDocument(Document inputDoc);
+
+    /**
+     * Returns the next output document of a batched $lookup. When no looked-up documents are
+     * buffered, gathers up to '_batchSize' local documents and looks them up with lookUpBatch().
+     */
+    GetNextResult getNextBatched();
+
+    /**
+     * Looks up all documents in 'batch' with a single foreign query over the union of their join
+     * values, and appends the resulting output documents to '_batchedOutput' in input order.
+     * Documents whose join values cannot be matched up with foreign documents by hashing are
+     * looked up on their own.
+     */
+    void lookUpBatch(std::vector<Document> batch);
+
+    /**
+     * Sets '_batchedJoin' if the join of this $lookup reduces to equality between a value computed
+     * from the local document and a field of the foreign documents. This is the case for the
+     * localField/foreignField syntax, and for a pipeline made up of nothing but
+     * {$match: {$expr: {$eq: ["$<foreignField>", "$$<letVariable>"]}}}. Also latches '_batchSize'
+     * from 'internalDocumentSourceLookupBatchSize'; a batch size of 1 disables batching.
+     */
+    void initializeBatchedJoin();
+
+    /**
+     * Adds the values which 'localDoc' joins on to 'joinValues'. Returns false if any of them
+     * cannot be used for a batched lookup, in which case the document must be looked up alone.
+     */
+    bool getBatchedJoinValues(const Document& localDoc, std::vector<Value>* joinValues);
+
+    /**
+     * Builds the foreign pipeline for a batched lookup, in which 'batchMatch' replaces the
+     * correlated part of '_resolvedPipeline'.
+     */
+    std::unique_ptr<Pipeline, PipelineDeleter> buildBatchedPipeline(BSONObj batchMatch);
+
     /**
      * Resolves let defined variables against 'localDoc' and stores the results in 'variables'.
      */
@@ -342,6 +384,27 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // Describes an equality join which lets this stage look up many local documents with a single
+    // foreign query. Not set if this $lookup must run its pipeline for each document.
+    struct BatchedJoin {
+        // The field of the foreign documents which the join values are compared against.
+        FieldPath foreignField;
+
+        // Set for the pipeline syntax, where $expr compares the whole value of 'foreignField'
+        // against the let variable. Not set for the localField/foreignField syntax, which matches
+        // any element of an array along 'foreignField' as well.
+        boost::intrusive_ptr<Expression> foreignValue;
+    };
+    boost::optional<BatchedJoin> _batchedJoin;
+    bool _batchedJoinInitialized = false;
+    size_t _batchSize = 0;
+
+    // The following members are used to hold onto state across getNext() calls when '_batchedJoin'
+    // is set. A pause or EOF seen while gathering a batch is returned once the output documents
+    // for that batch have been returned.
+    std::deque<Document> _batchedOutput;
+    boost::optional<GetNextResult> _batchedInputResult;
 };
 
 }  // namespace mongo
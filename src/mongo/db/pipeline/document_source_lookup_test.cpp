@@ -50,6 +50,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -783,12 +784,18 @@ public:
 
         pipeline->addInitialSource(
             DocumentSourceMock::createForTest(_mockResults, pipeline->getContext()));
+        ++_numPipelinesAttached;
         return pipeline;
     }
 
+    int numPipelinesAttached() const {
+        return _numPipelinesAttached;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    int _numPipelinesAttached = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -897,6 +904,130 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+TEST_F(DocumentSourceLookUpTest, ShouldLookUpBatchOfLocalDocumentsWithSingleForeignQuery) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto mockLocalSource = DocumentSourceMock::createForTest(
+        {"{a: 1}", "{a: [1, 2]}", "{a: null}", "{a: 3}", "{}"}, expCtx);
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document(fromjson("{_id: 0, b: 1}")),
+        Document(fromjson("{_id: 1, b: [2, 1]}")),
+        Document(fromjson("{_id: 2, b: null}")),
+        Document(fromjson("{_id: 3}")),
+        Document(fromjson("{_id: 4, b: 3}"))};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto lookupSpec =
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'out'}}");
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    lookup->setSource(mockLocalSource.get());
+
+    std::vector<BSONObj> expected{
+        fromjson("{a: 1, out: [{_id: 0, b: 1}, {_id: 1, b: [2, 1]}]}"),
+        fromjson("{a: [1, 2], out: [{_id: 0, b: 1}, {_id: 1, b: [2, 1]}]}"),
+        fromjson("{a: null, out: [{_id: 2, b: null}, {_id: 3}]}"),
+        fromjson("{a: 3, out: [{_id: 4, b: 3}]}"),
+        fromjson("{out: [{_id: 2, b: null}, {_id: 3}]}")};
+    for (auto&& expectedDoc : expected) {
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document(expectedDoc));
+    }
+    ASSERT_TRUE(lookup->getNext().isEOF());
+
+    // One query serves all documents with a non-null join value, while the documents joining on
+    // null are looked up on their own.
+    ASSERT_EQ(mongoInterface->numPipelinesAttached(), 3);
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldLookUpBatchOfLocalDocumentsForExprEqualityPipeline) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto mockLocalSource =
+        DocumentSourceMock::createForTest({"{a: 1}", "{a: 2}", "{a: [2, 1]}"}, expCtx);
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document(fromjson("{_id: 0, b: 1}")),
+        Document(fromjson("{_id: 1, b: [1, 2]}")),
+        Document(fromjson("{_id: 2, b: 2}")),
+        Document(fromjson("{_id: 3, b: [2, 1]}"))};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto lookupSpec = fromjson(
+        "{$lookup: {from: 'foreign', let: {x: '$a'}, pipeline: [{$match: {$expr: {$eq: ['$b', "
+        "'$$x']}}}], as: 'out'}}");
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    lookup->setSource(mockLocalSource.get());
+
+    // Unlike the localField/foreignField syntax, $eq compares the whole value of 'b'.
+    std::vector<BSONObj> expected{fromjson("{a: 1, out: [{_id: 0, b: 1}]}"),
+                                  fromjson("{a: 2, out: [{_id: 2, b: 2}]}"),
+                                  fromjson("{a: [2, 1], out: [{_id: 3, b: [2, 1]}]}")};
+    for (auto&& expectedDoc : expected) {
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document(expectedDoc));
+    }
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_EQ(mongoInterface->numPipelinesAttached(), 2);
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldKeepBatchingIfBatchSizeChangesMidQuery) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto mockLocalSource =
+        DocumentSourceMock::createForTest({"{a: 1}", "{a: 2}", "{a: 3}"}, expCtx);
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document(fromjson("{_id: 0, b: 1}")),
+                                                             Document(fromjson("{_id: 1, b: 2}")),
+                                                             Document(fromjson("{_id: 2, b: 3}"))};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto lookupSpec =
+        fromjson("{$lookup: {from: 'foreign', localField: 'a', foreignField: 'b', as: 'out'}}");
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    lookup->setSource(mockLocalSource.get());
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       Document(fromjson("{a: 1, out: [{_id: 0, b: 1}]}")));
+
+    // Disabling batching once the batch has been gathered must not drop its remaining documents.
+    const auto batchSize = internalDocumentSourceLookupBatchSize.load();
+    internalDocumentSourceLookupBatchSize.store(1);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceLookupBatchSize.store(batchSize); });
+
+    std::vector<BSONObj> expected{fromjson("{a: 2, out: [{_id: 1, b: 2}]}"),
+                                  fromjson("{a: 3, out: [{_id: 2, b: 3}]}")};
+    for (auto&& expectedDoc : expected) {
+        next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document(expectedDoc));
+    }
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_EQ(mongoInterface->numPipelinesAttached(), 1);
+    lookup->dispose();
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
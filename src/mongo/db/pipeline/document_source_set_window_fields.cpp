@@ -314,6 +314,24 @@ void DocumentSourceInternalSetWindowFields::initialize() {
     _init = true;
 }
 
+void DocumentSourceInternalSetWindowFields::updateIteratorMemoryUsage() {
+    auto update = [&] {
+        auto iteratorMemUsage = _iterator.getApproximateSize();
+        _memoryTracker.set(_memoryTracker.currentMemoryBytes() - _iteratorMemUsageBytes +
+                           iteratorMemUsage);
+        _iteratorMemUsageBytes = iteratorMemUsage;
+    };
+
+    update();
+    if (_memoryTracker.currentMemoryBytes() >= _memoryTracker._maxAllowedMemoryUsageBytes &&
+        _memoryTracker._allowDiskUse) {
+        // The documents of the partition held by the iterator stay accessible from disk, so that
+        // windows over a partition larger than the memory limit can still be computed.
+        _iterator.spillToDisk();
+        update();
+    }
+}
+
 DocumentSource::GetNextResult DocumentSourceInternalSetWindowFields::doGetNext() {
     if (!_init) {
         initialize();
@@ -332,14 +350,13 @@ DocumentSource::GetNextResult DocumentSourceInternalSetWindowFields::doGetNext()
     // Populate the output document with the result from each window function.
     MutableDocument addFieldsSpec;
     for (auto&& [fieldName, function] : _executableOutputs) {
-        auto oldIteratorMemUsage = _iterator.getApproximateSize();
         addFieldsSpec.addField(fieldName, function->getNext());
 
         // Update the memory usage for this function after getNext().
         _memoryTracker.set(fieldName, function->getApproximateSize());
-        // Account for the additional memory in the iterator cache.
-        _memoryTracker.set(_memoryTracker.currentMemoryBytes() +
-                           (_iterator.getApproximateSize() - oldIteratorMemUsage));
+        // Account for the memory in the iterator cache, which getNext() may have pulled documents
+        // into, and advance() may have released documents from.
+        updateIteratorMemoryUsage();
 
         uassert(5414201,
                 "Exceeded memory limit in DocumentSourceSetWindowFields",
@@ -354,6 +371,7 @@ DocumentSource::GetNextResult DocumentSourceInternalSetWindowFields::doGetNext()
             // We've advanced to a new partition, reset the state of every function as well as the
             // memory tracker.
             _memoryTracker.resetCurrent();
+            _iteratorMemUsageBytes = 0;
             for (auto&& [fieldName, function] : _executableOutputs) {
                 function->reset();
             }
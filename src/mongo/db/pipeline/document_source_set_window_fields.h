@@ -113,7 +113,7 @@ public:
           _sortBy(std::move(sortBy)),
           _outputFields(std::move(outputFields)),
           _iterator(expCtx.get(), pSource, std::move(partitionBy), _sortBy),
-          _memoryTracker{false /* allowDiskUse */, maxMemoryBytes} {};
+          _memoryTracker{expCtx->allowDiskUse && !expCtx->inMongos, maxMemoryBytes} {};
 
     GetModPathsReturn getModifiedPaths() const final {
         std::set<std::string> outputPaths;
@@ -129,7 +129,9 @@ public:
         StageConstraints constraints(StreamType::kBlocking,
                                      PositionRequirement::kNone,
                                      HostTypeRequirement::kNone,
-                                     DiskUseRequirement::kNoDiskUse,
+                                     _memoryTracker._allowDiskUse
+                                         ? DiskUseRequirement::kWritesTmpData
+                                         : DiskUseRequirement::kNoDiskUse,
                                      FacetRequirement::kAllowed,
                                      TransactionRequirement::kAllowed,
                                      LookupRequirement::kAllowed,
@@ -173,15 +175,27 @@ public:
         _iterator.setSource(source);
     }
 
+    bool usedDisk() final {
+        return _iterator.usedDisk();
+    }
+
 private:
     void initialize();
 
+    /**
+     * Brings the memory usage of '_iterator' in '_memoryTracker' up to date. If the memory limit is
+     * exceeded and using disk is allowed, first spills the documents held by '_iterator' to disk.
+     */
+    void updateIteratorMemoryUsage();
+
     boost::optional<boost::intrusive_ptr<Expression>> _partitionBy;
     boost::optional<SortPattern> _sortBy;
     std::vector<WindowFunctionStatement> _outputFields;
     PartitionIterator _iterator;
     StringMap<std::unique_ptr<WindowFunctionExec>> _executableOutputs;
     MemoryUsageTracker _memoryTracker;
+    // The memory usage of '_iterator' which is currently accounted for in '_memoryTracker'.
+    size_t _iteratorMemUsageBytes = 0;
     bool _init = false;
     bool _eof = false;
 };
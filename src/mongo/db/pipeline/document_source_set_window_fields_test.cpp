@@ -39,6 +39,7 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_set_window_fields.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -212,5 +213,46 @@ TEST_F(DocumentSourceSetWindowFieldsTest, ReportsModifiedFields) {
     ASSERT_EQUALS(modified.paths.count("b"), 1U);
     ASSERT_TRUE(modified.renames.empty());
 }
+
+TEST_F(DocumentSourceSetWindowFieldsTest, SpillsPartitionLargerThanMemoryLimitToDisk) {
+    const auto maxMemoryBytes = internalDocumentSourceSetWindowFieldsMaxMemoryBytes.load();
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceSetWindowFieldsMaxMemoryBytes.store(maxMemoryBytes); });
+    internalDocumentSourceSetWindowFieldsMaxMemoryBytes.store(1024);
+
+    std::deque<DocumentSource::GetNextResult> inputs;
+    const std::string padding(100, 'x');
+    for (int i = 0; i < 20; ++i) {
+        inputs.emplace_back(Document{{"a", i}, {"padding", padding}});
+    }
+    auto spec = fromjson(R"(
+        {$_internalSetWindowFields: {sortBy: {a: 1}, output: {
+            total: {$sum: '$a', window: {documents: ['unbounded', 'unbounded']}},
+            moving: {$sum: '$a', window: {documents: [-1, 0]}}}}})");
+
+    // The whole partition does not fit within the memory limit without spilling.
+    {
+        auto stage =
+            DocumentSourceInternalSetWindowFields::createFromBson(spec.firstElement(), getExpCtx());
+        auto mock = DocumentSourceMock::createForTest(inputs, getExpCtx());
+        stage->setSource(mock.get());
+        ASSERT_THROWS_CODE(stage->getNext(), AssertionException, 5414201);
+    }
+
+    getExpCtx()->allowDiskUse = true;
+    auto stage =
+        DocumentSourceInternalSetWindowFields::createFromBson(spec.firstElement(), getExpCtx());
+    auto mock = DocumentSourceMock::createForTest(inputs, getExpCtx());
+    stage->setSource(mock.get());
+    for (int i = 0; i < 20; ++i) {
+        auto next = stage->getNext();
+        ASSERT(next.isAdvanced());
+        ASSERT_VALUE_EQ(next.getDocument()["a"], Value(i));
+        ASSERT_VALUE_EQ(next.getDocument()["total"], Value(190));
+        ASSERT_VALUE_EQ(next.getDocument()["moving"], Value(i == 0 ? 0 : 2 * i - 1));
+    }
+    ASSERT(stage->getNext().isEOF());
+    ASSERT_TRUE(stage->usedDisk());
+}
 }  // namespace
 }  // namespace mongo
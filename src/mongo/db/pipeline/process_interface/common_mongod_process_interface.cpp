@@ -407,9 +407,32 @@ BackupCursorExtendState CommonMongodProcessInterface::extendBackupCursor(
 
 std::vector<BSONObj> CommonMongodProcessInterface::getMatchingPlanCacheEntryStats(
     OperationContext* opCtx, const NamespaceString& nss, const MatchExpression* matchExp) const {
-    const auto serializer = [](const PlanCacheEntry& entry) {
+    AutoGetCollection collection(opCtx, nss, MODE_IS);
+    uassert(
+        50933, str::stream() << "collection '" << nss.toString() << "' does not exist", collection);
+
+    const auto planCache = CollectionQueryInfo::get(collection.getCollection()).getPlanCache();
+    invariant(planCache);
+
+    // Every entry also reports the size of the whole cache, and how many entries were evicted
+    // from it to stay within its limits.
+    const auto cacheStats = [&] {
+        const auto stats = planCache->getStats();
+        BSONObjBuilder bob;
+        bob.append("numEntries", static_cast<long long>(stats.numEntries));
+        bob.append("estimatedSizeBytes", static_cast<long long>(stats.estimatedSizeBytes));
+        if (stats.maxSizeBytes != std::numeric_limits<size_t>::max()) {
+            bob.append("maxSizeBytes", static_cast<long long>(stats.maxSizeBytes));
+        }
+        bob.append("evictedEntries", static_cast<long long>(stats.numEvictedEntries));
+        bob.append("evictedBytes", static_cast<long long>(stats.evictedBytes));
+        return bob.obj();
+    }();
+
+    const auto serializer = [&cacheStats](const PlanCacheEntry& entry) {
         BSONObjBuilder out;
         Explain::planCacheEntryToBSON(entry, &out);
+        out.append("planCache", cacheStats);
         return out.obj();
     };
 
@@ -417,13 +440,6 @@ std::vector<BSONObj> CommonMongodProcessInterface::getMatchingPlanCacheEntryStat
         return !matchExp ? true : matchExp->matchesBSON(obj);
     };
 
-    AutoGetCollection collection(opCtx, nss, MODE_IS);
-    uassert(
-        50933, str::stream() << "collection '" << nss.toString() << "' does not exist", collection);
-
-    const auto planCache = CollectionQueryInfo::get(collection.getCollection()).getPlanCache();
-    invariant(planCache);
-
     return planCache->getMatchingStats(serializer, predicate);
 }
 
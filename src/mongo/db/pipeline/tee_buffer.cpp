@@ -50,6 +50,21 @@ boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers, int bufferS
 }
 
 DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
+    if (_concurrentConsumers) {
+        // The other consumers may be running concurrently, so only look at this consumer's
+        // progress through the batch, and leave loading the next batch to the owning thread.
+        if (_bufferBson.empty()) {
+            return DocumentSource::GetNextResult::makeEOF();
+        }
+        auto& consumer = _consumers[consumerId];
+        if (consumer.nLeftToReturn == 0) {
+            return DocumentSource::GetNextResult::makePauseExecution();
+        }
+        const size_t bufferIndex = _bufferBson.size() - consumer.nLeftToReturn;
+        --consumer.nLeftToReturn;
+        return Document::fromBsonWithMetaData(_bufferBson[bufferIndex]);
+    }
+
     size_t nConsumersStillProcessingThisBatch =
         std::count_if(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
             return info.nLeftToReturn > 0;
@@ -96,6 +111,14 @@ void TeeBuffer::loadNextBatch() {
     //   - We currently disallow nested $facet stages.
     invariant(!input.isPaused());  // NOLINT(bugprone-use-after-move)
 
+    _bufferBson.clear();
+    if (_concurrentConsumers) {
+        _bufferBson.reserve(_buffer.size());
+        for (auto&& result : _buffer) {
+            _bufferBson.push_back(result.getDocument().toBsonWithMetaData());
+        }
+    }
+
     // Populate the pending returns.
     for (size_t consumerId = 0; consumerId < _consumers.size(); ++consumerId) {
         if (_consumers[consumerId].stillInUse) {
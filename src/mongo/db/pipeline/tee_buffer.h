@@ -66,20 +66,41 @@ public:
     void dispose(size_t consumerId) {
         _consumers[consumerId].stillInUse = false;
         _consumers[consumerId].nLeftToReturn = 0;
-        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
-                return info.stillInUse;
-            })) {
-            _buffer.clear();
-            if (_source) {
-                _source->dispose();
-            }
+        if (!_concurrentConsumers) {
+            disposeIfUnused();
         }
     }
 
+    /**
+     * Switches this buffer between the default mode, in which all consumers run on one thread and
+     * whichever consumer needs the next batch loads it, and a concurrent mode, in which each
+     * consumer may run on its own thread. In the concurrent mode, getNext() and dispose() only
+     * touch the state of the given consumer: the thread which owns the buffer loads every batch
+     * with loadNextBatchForConcurrentConsumers() while no consumer is running, and disposes of the
+     * source once it switches back to the default mode.
+     */
+    void setConcurrentConsumers(bool concurrentConsumers) {
+        _concurrentConsumers = concurrentConsumers;
+        if (!_concurrentConsumers) {
+            _bufferBson.clear();
+            disposeIfUnused();
+        }
+    }
+
+    /**
+     * Loads the next batch for consumers running in the concurrent mode. Must not be called while
+     * any of the consumers is running.
+     */
+    void loadNextBatchForConcurrentConsumers() {
+        invariant(_concurrentConsumers);
+        loadNextBatch();
+    }
+
     /**
      * Retrieves the next document meant to be consumed by the pipeline given by 'consumerId'.
      * Returns GetNextState::ResultState::kPauseExecution if this pipeline has consumed the whole
-     * buffer, but other consumers are still using it.
+     * buffer, but other consumers are still using it. In the concurrent mode, returns
+     * kPauseExecution as soon as this consumer has consumed the current batch.
      */
     DocumentSource::GetNextResult getNext(size_t consumerId);
 
@@ -93,11 +114,33 @@ private:
      */
     void loadNextBatch();
 
+    /**
+     * Clears '_buffer' and disposes of '_source' if none of the consumers is still in use.
+     */
+    void disposeIfUnused() {
+        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+                return info.stillInUse;
+            })) {
+            _buffer.clear();
+            if (_source) {
+                _source->dispose();
+            }
+        }
+    }
+
     DocumentSource* _source = nullptr;
 
     const size_t _bufferSizeBytes;
     std::vector<DocumentSource::GetNextResult> _buffer;
 
+    // See setConcurrentConsumers().
+    bool _concurrentConsumers = false;
+
+    // In the concurrent mode, the BSON form of each document in '_buffer'. A Document fills in its
+    // fields lazily as they are read, so one Document cannot be shared between threads; instead
+    // every consumer builds its own Document from this read-only BSON.
+    std::vector<BSONObj> _bufferBson;
+
     struct ConsumerInfo {
         bool stillInUse = true;
         int nLeftToReturn = 0;
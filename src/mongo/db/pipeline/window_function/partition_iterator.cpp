@@ -86,6 +86,7 @@ PartitionIterator::PartitionIterator(ExpressionContext* expCtx,
       _source(source),
       _partitionExpr(std::move(partitionExpr)),
       _sortExpr(exprFromSort(_expCtx, sortPattern)),
+      _cache(expCtx),
       _state(IteratorState::kNotInitialized) {}
 
 optional<Document> PartitionIterator::operator[](int index) {
@@ -500,14 +501,11 @@ void PartitionIterator::getNextDocument() {
             advanceToNextPartition();
         } else if (_expCtx->getValueComparator().compare(curKey, _partitionKey) != 0) {
             _nextPartition = NextPartitionState{std::move(doc), std::move(curKey)};
-            _memUsageBytes += getNextPartitionStateSize();
             _state = IteratorState::kAwaitingAdvanceToNext;
         } else {
-            _memUsageBytes += doc.getApproximateSize();
             _cache.emplace_back(std::move(doc));
         }
     } else {
-        _memUsageBytes += doc.getApproximateSize();
         _cache.emplace_back(std::move(doc));
         _state = IteratorState::kIntraPartition;
     }
@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/window_function/spillable_cache.h"
 #include "mongo/db/pipeline/window_function/window_bounds.h"
 #include "mongo/db/query/sort_pattern.h"
 
@@ -100,12 +101,25 @@ public:
     }
 
     /**
-     * Returns the value in bytes of the data being stored by this partition iterator. Does not
-     * include the size of the constant size objects being held or the overhead of the data
+     * Returns the value in bytes of the data being held in memory by this partition iterator. Does
+     * not include the size of the constant size objects being held or the overhead of the data
      * structures.
      */
     auto getApproximateSize() const {
-        return _memUsageBytes;
+        return _cache.getApproximateSize() + getNextPartitionStateSize();
+    }
+
+    /**
+     * Writes the documents of the current partition which are held in memory to disk. They remain
+     * accessible, at the cost of reading them back from disk, until the iterator moves past them or
+     * on to the next partition.
+     */
+    void spillToDisk() {
+        _cache.spill();
+    }
+
+    bool usedDisk() const {
+        return _cache.usedDisk();
     }
 
 private:
@@ -199,7 +213,6 @@ private:
     void resetCache() {
         _cache.clear();
         // Everything should be empty at this point.
-        _memUsageBytes = 0;
         _currentCacheIndex = 0;
         _currentPartitionIndex = 0;
         for (size_t slot = 0; slot < _slots.size(); slot++) {
@@ -215,8 +228,6 @@ private:
                 "Invalid call to PartitionIterator::advanceToNextPartition",
                 _nextPartition != boost::none);
         resetCache();
-        // Cache is cleared, and we are moving the _nextPartition value to different positions.
-        _memUsageBytes = getNextPartitionStateSize();
         _cache.emplace_back(std::move(_nextPartition->_doc));
         _partitionKey = std::move(_nextPartition->_partitionKey);
         _nextPartition.reset();
@@ -239,7 +250,9 @@ private:
     // the value of the "$ts" field. This _sortExpr is used in getEndpoints().
     boost::optional<boost::intrusive_ptr<ExpressionFieldPath>> _sortExpr;
 
-    std::deque<Document> _cache;
+    // Holds the documents of the current partition which may still be accessed, in memory or on
+    // disk once spillToDisk() was called.
+    SpillableCache _cache;
     // '_cache[_currentCacheIndex]' is the current document, which '(*this)[0]' returns.
     int _currentCacheIndex = 0;
     int _currentPartitionIndex = 0;
@@ -253,7 +266,7 @@ private:
         Value _partitionKey;
     };
     boost::optional<NextPartitionState> _nextPartition;
-    size_t getNextPartitionStateSize() {
+    size_t getNextPartitionStateSize() const {
         if (_nextPartition) {
             return _nextPartition->_doc.getApproximateSize() +
                 _nextPartition->_partitionKey.getApproximateSize();
@@ -261,10 +274,6 @@ private:
         return 0;
     }
 
-    // The value in bytes of the data being held. Does not include the size of the constant size
-    // data members or overhead of data structures.
-    size_t _memUsageBytes = 0;
-
     enum class IteratorState {
         // Default state, no documents have been pulled into the cache.
         kNotInitialized,
@@ -57,6 +57,16 @@ public:
         return _iter->advance();
     }
 
+    void spillToDisk() {
+        invariant(_iter);
+        _iter->spillToDisk();
+    }
+
+    auto getIterator() {
+        invariant(_iter);
+        return _iter.get();
+    }
+
 private:
     std::unique_ptr<PartitionIterator> _iter;
 };
@@ -84,6 +94,40 @@ TEST_F(PartitionIteratorTest, MultipleConsumer) {
     ASSERT_DOCUMENT_EQ(docs[0].getDocument(), *partIter[0]);
 }
 
+TEST_F(PartitionIteratorTest, SpilledDocumentsRemainAccessible) {
+    getExpCtx()->allowDiskUse = true;
+    const auto docs = std::deque<DocumentSource::GetNextResult>{Document{{"a", 0}},
+                                                                Document{{"a", 1}},
+                                                                Document{{"a", 2}},
+                                                                Document{{"a", 3}},
+                                                                Document{{"a", 4}},
+                                                                Document{{"a", 5}}};
+    const auto mock = DocumentSourceMock::createForTest(docs, getExpCtx());
+    auto partIter = makeDefaultAccessor(mock);
+
+    // Spill the first three documents, then pull the remaining ones into memory.
+    ASSERT_DOCUMENT_EQ(docs[2].getDocument(), *partIter[2]);
+    spillToDisk();
+    ASSERT_TRUE(getIterator()->usedDisk());
+    ASSERT_EQ(getIterator()->getApproximateSize(), 0U);
+    ASSERT_DOCUMENT_EQ(docs[5].getDocument(), *partIter[5]);
+    ASSERT_GT(getIterator()->getApproximateSize(), 0U);
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_DOCUMENT_EQ(docs[i].getDocument(), *partIter[i]);
+    }
+
+    // Documents are released from disk and memory alike as the iterator moves past them.
+    ASSERT_ADVANCE_RESULT(PartitionIterator::AdvanceResult::kAdvanced, advance());
+    ASSERT_DOCUMENT_EQ(docs[1].getDocument(), *partIter[0]);
+    ASSERT_DOCUMENT_EQ(docs[5].getDocument(), *partIter[4]);
+    ASSERT_FALSE(partIter[5]);
+    for (int i = 2; i < 6; ++i) {
+        ASSERT_ADVANCE_RESULT(PartitionIterator::AdvanceResult::kAdvanced, advance());
+    }
+    ASSERT_DOCUMENT_EQ(docs[5].getDocument(), *partIter[0]);
+    ASSERT_ADVANCE_RESULT(PartitionIterator::AdvanceResult::kEOF, advance());
+}
+
 TEST_F(PartitionIteratorTest, LookaheadOutOfRangeAccessEOF) {
     const auto docs = std::deque<DocumentSource::GetNextResult>{Document{{"key", 1}}};
     const auto mock = DocumentSourceMock::createForTest(docs, getExpCtx());
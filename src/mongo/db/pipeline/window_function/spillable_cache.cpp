@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/window_function/spillable_cache.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+
+namespace {
+std::string nextFileName() {
+    static AtomicWord<unsigned> setWindowFieldsFileCounter;
+    return "set-window-fields." + std::to_string(setWindowFieldsFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+SpillableCache::~SpillableCache() {
+    if (!_fileName.empty()) {
+        _file.close();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_fileName));
+    }
+}
+
+void SpillableCache::pop_front() {
+    if (!_spilled.empty()) {
+        _spilled.pop_front();
+        return;
+    }
+    _memUsageBytes -= _inMemory.front().second;
+    _inMemory.pop_front();
+}
+
+Document SpillableCache::operator[](size_t index) {
+    if (index >= _spilled.size()) {
+        return _inMemory[index - _spilled.size()].first;
+    }
+
+    const auto& spilled = _spilled[index];
+    auto buffer = SharedBuffer::allocate(spilled.size);
+    _file.seekg(spilled.offset);
+    _file.read(buffer.get(), spilled.size);
+    uassert(5999107,
+            str::stream() << "error reading file \"" << _fileName
+                          << "\": " << errnoWithDescription(),
+            _file.good());
+    return Document::fromBsonWithMetaData(BSONObj(std::move(buffer)));
+}
+
+void SpillableCache::clear() {
+    _spilled.clear();
+    _inMemory.clear();
+    _memUsageBytes = 0;
+    _fileEndOffset = 0;
+}
+
+void SpillableCache::spill() {
+    tassert(5999108, "Unexpected spill of a cache which cannot use disk", canSpill());
+    if (_inMemory.empty()) {
+        return;
+    }
+
+    if (_fileName.empty()) {
+        boost::filesystem::create_directories(_expCtx->tempDir);
+        _fileName = _expCtx->tempDir + "/" + nextFileName();
+        _file.open(_fileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        uassert(5999105,
+                str::stream() << "error opening file \"" << _fileName
+                              << "\": " << errnoWithDescription(),
+                _file.good());
+    }
+
+    _file.seekp(_fileEndOffset);
+    for (auto&& [doc, size] : _inMemory) {
+        auto bson = doc.toBsonWithMetaData();
+        _file.write(bson.objdata(), bson.objsize());
+        _spilled.push_back({_fileEndOffset, bson.objsize()});
+        _fileEndOffset += bson.objsize();
+    }
+    _file.flush();
+    uassert(5999106,
+            str::stream() << "error writing file \"" << _fileName
+                          << "\": " << errnoWithDescription(),
+            _file.good());
+
+    _inMemory.clear();
+    _memUsageBytes = 0;
+    _usedDisk = true;
+}
+
+}  // namespace mongo
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/pipeline/expression_context.h"
+
+namespace mongo {
+
+/**
+ * Holds the documents of a partition for a PartitionIterator, with the interface of a deque: index
+ * 0 refers to the oldest document which has not been popped yet. spill() writes the documents held
+ * in memory to a temporary file in the 'tempDir' of the ExpressionContext, from which they are read
+ * back on every access until they are popped or the cache is cleared. Documents added afterwards
+ * are held in memory again, so that the cache keeps a window of the most recent documents in
+ * memory over the spilled part of the partition.
+ */
+class SpillableCache {
+public:
+    explicit SpillableCache(ExpressionContext* expCtx) : _expCtx(expCtx) {}
+    ~SpillableCache();
+
+    void emplace_back(Document doc) {
+        auto size = doc.getApproximateSize();
+        _memUsageBytes += size;
+        _inMemory.emplace_back(std::move(doc), size);
+    }
+
+    void pop_front();
+
+    /**
+     * Returns the document at 'index', reading it from disk if it was spilled.
+     */
+    Document operator[](size_t index);
+
+    void clear();
+
+    size_t size() const {
+        return _spilled.size() + _inMemory.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * Writes the documents held in memory to disk, and releases them from memory.
+     */
+    void spill();
+
+    /**
+     * Returns whether this cache can spill, i.e. the operation allows using disk and runs on a
+     * mongod.
+     */
+    bool canSpill() const {
+        return _expCtx->allowDiskUse && !_expCtx->inMongos;
+    }
+
+    bool usedDisk() const {
+        return _usedDisk;
+    }
+
+    /**
+     * Returns the approximate size in bytes of the documents held in memory.
+     */
+    size_t getApproximateSize() const {
+        return _memUsageBytes;
+    }
+
+private:
+    // The location of a spilled document in '_file'.
+    struct SpilledDocument {
+        std::streamoff offset;
+        int size;
+    };
+
+    ExpressionContext* _expCtx;
+
+    // The spilled documents, followed by the documents held in memory along with their size when
+    // they were added.
+    std::deque<SpilledDocument> _spilled;
+    std::deque<std::pair<Document, size_t>> _inMemory;
+    size_t _memUsageBytes = 0;
+
+    // Opened on the first spill. Every spill appends to the file until the cache is cleared, at
+    // which point the file is written again from the start.
+    std::string _fileName;
+    std::fstream _file;
+    std::streamoff _fileEndOffset = 0;
+    bool _usedDisk = false;
+};
+
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/commands/test_commands_enabled.h"
 #include "mongo/db/cst/cst_parser.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
@@ -206,6 +207,12 @@ Status CanonicalQuery::init(OperationContext* opCtx,
     }
     auto unavailableMetadata = validStatus.getValue();
 
+    // Plans built by the classic engine do not read input parameters.
+    if (internalQueryEnableAutoParameterization.load() && !_forceClassicEngine) {
+        _inputParams = expression::parameterize(_root.get());
+        _isParameterized = true;
+    }
+
     // Validate the projection if there is one.
     if (!_findCommand->getProjection().isEmpty()) {
         try {
@@ -224,6 +224,21 @@ public:
         return _forceClassicEngine;
     }
 
+    /**
+     * Returns true if the constants of the filter have been turned into input parameters, see
+     * expression::parameterize().
+     */
+    bool isParameterized() const {
+        return _isParameterized;
+    }
+
+    /**
+     * Returns the parameterized predicates of the filter, indexed by their input parameter id.
+     */
+    const std::vector<const MatchExpression*>& getInputParams() const {
+        return _inputParams;
+    }
+
     void setExplain(bool explain) {
         _explain = explain;
     }
@@ -271,6 +286,9 @@ private:
 
     // Determines whether the classic engine must be used.
     bool _forceClassicEngine = false;
+
+    bool _isParameterized = false;
+    std::vector<const MatchExpression*> _inputParams;
 };
 
 }  // namespace mongo
@@ -0,0 +1,358 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/bson/bsonelement_comparator_interface.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/util/str.h"
+#include <third_party/murmurhash3/MurmurHash3.h>
+
+namespace mongo {
+namespace {
+const BSONObj kNullValue = BSON("" << BSONNULL);
+
+int compareValues(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, false);
+}
+
+/**
+ * Hashes the value of 'elem' consistently with compareValues(): numbers which compare equal hash
+ * to the same value whatever their type, and field names are ignored.
+ */
+uint64_t hashValue(const BSONElement& elem) {
+    uint64_t hash[2];
+    if (elem.isNumber()) {
+        // Adding zero turns -0.0 into 0.0.
+        const double number = elem.numberDouble() + 0.0;
+        MurmurHash3_x64_128(&number, sizeof(number), 0, hash);
+    } else {
+        MurmurHash3_x64_128(
+            elem.value(), elem.valuesize(), canonicalizeBSONType(elem.type()), hash);
+    }
+    return hash[0];
+}
+
+StatusWith<std::vector<double>> parseCounts(const BSONElement& elem, size_t expectedSize) {
+    if (elem.type() != BSONType::Array) {
+        return Status(ErrorCodes::FailedToParse,
+                      str::stream() << "histogram field '" << elem.fieldNameStringData()
+                                    << "' must be an array");
+    }
+    std::vector<double> counts;
+    for (auto&& count : elem.embeddedObject()) {
+        counts.push_back(count.numberDouble());
+    }
+    if (counts.size() != expectedSize) {
+        return Status(ErrorCodes::FailedToParse,
+                      "histogram arrays must have one value per bucket");
+    }
+    return counts;
+}
+}  // namespace
+
+void DistinctValueSketch::add(const BSONElement& value) {
+    const auto hash = hashValue(value);
+    if (_minHashes.size() == _size && hash >= *_minHashes.rbegin()) {
+        return;
+    }
+    _minHashes.insert(hash);
+    if (_minHashes.size() > _size) {
+        _minHashes.erase(std::prev(_minHashes.end()));
+    }
+}
+
+double DistinctValueSketch::estimate() const {
+    if (_minHashes.size() < _size) {
+        return _minHashes.size();
+    }
+    // The k smallest of n uniformly distributed hashes are expected to span k / n of the hash
+    // space.
+    const double span =
+        static_cast<double>(*_minHashes.rbegin()) / std::numeric_limits<uint64_t>::max();
+    return (_size - 1) / span;
+}
+
+EquiDepthHistogram EquiDepthHistogram::build(const std::vector<BSONElement>& values,
+                                             size_t numBuckets) {
+    EquiDepthHistogram histogram;
+    if (values.empty()) {
+        return histogram;
+    }
+
+    const double depth = std::max(1.0, static_cast<double>(values.size()) / numBuckets);
+    BSONArrayBuilder boundsBuilder;
+    Bucket current;
+    for (size_t runStart = 0; runStart < values.size();) {
+        size_t runEnd = runStart + 1;
+        while (runEnd < values.size() && compareValues(values[runEnd], values[runStart]) == 0) {
+            ++runEnd;
+        }
+        const double runLength = runEnd - runStart;
+
+        // A bucket ends with the smallest value, the largest value, and the value which makes it
+        // hold enough values. All the occurrences of a value end up in the same bucket.
+        if (histogram._buckets.empty() || runEnd == values.size() ||
+            current.rangeCount + runLength >= depth) {
+            boundsBuilder.append(values[runStart]);
+            current.equalCount = runLength;
+            histogram._buckets.push_back(current);
+            current = Bucket{};
+        } else {
+            current.rangeCount += runLength;
+            ++current.rangeDistinctCount;
+        }
+        runStart = runEnd;
+    }
+
+    histogram._bounds = boundsBuilder.obj();
+    auto boundIt = histogram._bounds.begin();
+    for (auto&& bucket : histogram._buckets) {
+        bucket.upperBound = *boundIt;
+        ++boundIt;
+    }
+    return histogram;
+}
+
+StatusWith<EquiDepthHistogram> EquiDepthHistogram::parse(const BSONObj& obj) {
+    EquiDepthHistogram histogram;
+    const auto boundsElem = obj["bounds"];
+    if (boundsElem.type() != BSONType::Array) {
+        return Status(ErrorCodes::FailedToParse, "histogram bounds must be an array");
+    }
+    histogram._bounds = boundsElem.embeddedObject().getOwned();
+    for (auto&& bound : histogram._bounds) {
+        histogram._buckets.push_back(Bucket{bound});
+    }
+
+    const auto numBuckets = histogram._buckets.size();
+    auto equalCounts = parseCounts(obj["equalCounts"], numBuckets);
+    auto rangeCounts = parseCounts(obj["rangeCounts"], numBuckets);
+    auto rangeDistinctCounts = parseCounts(obj["rangeDistinctCounts"], numBuckets);
+    for (auto&& counts : {&equalCounts, &rangeCounts, &rangeDistinctCounts}) {
+        if (!counts->isOK()) {
+            return counts->getStatus();
+        }
+    }
+    for (size_t i = 0; i < numBuckets; ++i) {
+        histogram._buckets[i].equalCount = equalCounts.getValue()[i];
+        histogram._buckets[i].rangeCount = rangeCounts.getValue()[i];
+        histogram._buckets[i].rangeDistinctCount = rangeDistinctCounts.getValue()[i];
+    }
+    return histogram;
+}
+
+double EquiDepthHistogram::estimateCount(const Interval& interval) const {
+    BSONElement low = interval.start;
+    BSONElement high = interval.end;
+    bool lowInclusive = interval.startInclusive;
+    bool highInclusive = interval.endInclusive;
+    if (compareValues(low, high) > 0) {
+        std::swap(low, high);
+        std::swap(lowInclusive, highInclusive);
+    }
+    const bool isPoint = compareValues(low, high) == 0;
+
+    double count = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const auto& bucket = _buckets[i];
+
+        // The values strictly between the previous upper bound and this one. Their distribution
+        // within the bucket is unknown, so a range which partially overlaps the bucket is assumed
+        // to hold half of them, and a point an average share of them.
+        if (i > 0 && bucket.rangeCount > 0) {
+            const auto& lower = _buckets[i - 1].upperBound;
+            const bool coversRange = compareValues(low, lower) <= 0 &&
+                compareValues(high, bucket.upperBound) >= 0;
+            const bool overlapsRange =
+                compareValues(high, lower) > 0 && compareValues(low, bucket.upperBound) < 0;
+            if (coversRange) {
+                count += bucket.rangeCount;
+            } else if (overlapsRange && isPoint) {
+                count += bucket.rangeCount / std::max(1.0, bucket.rangeDistinctCount);
+            } else if (overlapsRange) {
+                count += bucket.rangeCount / 2;
+            }
+        }
+
+        const int lowCmp = compareValues(low, bucket.upperBound);
+        const int highCmp = compareValues(high, bucket.upperBound);
+        if ((lowCmp < 0 || (lowCmp == 0 && lowInclusive)) &&
+            (highCmp > 0 || (highCmp == 0 && highInclusive))) {
+            count += bucket.equalCount;
+        }
+    }
+    return count;
+}
+
+BSONObj EquiDepthHistogram::toBSON() const {
+    BSONObjBuilder bob;
+    bob.appendArray("bounds", _bounds);
+    BSONArrayBuilder equalCounts(bob.subarrayStart("equalCounts"));
+    for (auto&& bucket : _buckets) {
+        equalCounts.append(bucket.equalCount);
+    }
+    equalCounts.doneFast();
+    BSONArrayBuilder rangeCounts(bob.subarrayStart("rangeCounts"));
+    for (auto&& bucket : _buckets) {
+        rangeCounts.append(bucket.rangeCount);
+    }
+    rangeCounts.doneFast();
+    BSONArrayBuilder rangeDistinctCounts(bob.subarrayStart("rangeDistinctCounts"));
+    for (auto&& bucket : _buckets) {
+        rangeDistinctCounts.append(bucket.rangeDistinctCount);
+    }
+    rangeDistinctCounts.doneFast();
+    return bob.obj();
+}
+
+CollectionStatistics::Builder::Builder(std::vector<std::string> paths, size_t numBuckets)
+    : _paths(std::move(paths)), _numBuckets(numBuckets) {
+    _values.resize(_paths.size());
+}
+
+void CollectionStatistics::Builder::addDocument(const BSONObj& doc) {
+    ++_numSampledDocs;
+    for (size_t i = 0; i < _paths.size(); ++i) {
+        // Like an index key, an array contributes each of its distinct elements once.
+        BSONElementSet elements;
+        dotted_path_support::extractAllElementsAlongPath(doc, _paths[i], elements);
+        if (elements.empty()) {
+            _values[i].push_back(kNullValue);
+        }
+        for (auto&& elem : elements) {
+            if (elem.size() <= kMaxValueSizeBytes) {
+                _values[i].push_back(elem.wrap(""));
+            }
+        }
+    }
+}
+
+CollectionStatistics CollectionStatistics::Builder::done(long long numDocs, Date_t now) {
+    CollectionStatistics stats;
+    stats._numDocs = numDocs;
+    stats._numSampledDocs = _numSampledDocs;
+    stats._lastUpdated = now;
+
+    for (size_t i = 0; i < _paths.size(); ++i) {
+        std::vector<BSONElement> values;
+        DistinctValueSketch sketch;
+        for (auto&& valueObj : _values[i]) {
+            values.push_back(valueObj.firstElement());
+            sketch.add(values.back());
+        }
+        std::sort(values.begin(), values.end(), [](const auto& lhs, const auto& rhs) {
+            return compareValues(lhs, rhs) < 0;
+        });
+
+        FieldStatistics fieldStats;
+        fieldStats.histogram = EquiDepthHistogram::build(values, _numBuckets);
+        fieldStats.numDistinct = sketch.estimate();
+        stats._fields[_paths[i]] = std::move(fieldStats);
+    }
+    return stats;
+}
+
+StatusWith<CollectionStatistics> CollectionStatistics::parse(const BSONObj& obj) {
+    CollectionStatistics stats;
+    stats._numDocs = obj["numDocs"].safeNumberLong();
+    stats._numSampledDocs = obj["numSampledDocs"].safeNumberLong();
+    if (obj["lastUpdated"].type() == BSONType::Date) {
+        stats._lastUpdated = obj["lastUpdated"].date();
+    }
+
+    const auto fieldsElem = obj["fields"];
+    if (fieldsElem.type() != BSONType::Array) {
+        return Status(ErrorCodes::FailedToParse, "collection statistics fields must be an array");
+    }
+    for (auto&& fieldElem : fieldsElem.embeddedObject()) {
+        if (fieldElem.type() != BSONType::Object ||
+            fieldElem["histogram"].type() != BSONType::Object) {
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << "malformed field statistics: " << fieldElem);
+        }
+        auto swHistogram = EquiDepthHistogram::parse(fieldElem["histogram"].embeddedObject());
+        if (!swHistogram.isOK()) {
+            return swHistogram.getStatus();
+        }
+
+        FieldStatistics fieldStats;
+        fieldStats.histogram = std::move(swHistogram.getValue());
+        fieldStats.numDistinct = fieldElem["numDistinct"].numberDouble();
+        stats._fields[fieldElem["path"].str()] = std::move(fieldStats);
+    }
+    return stats;
+}
+
+const FieldStatistics* CollectionStatistics::getField(StringData path) const {
+    auto it = _fields.find(path);
+    return it == _fields.end() ? nullptr : &it->second;
+}
+
+boost::optional<double> CollectionStatistics::estimateSelectivity(
+    StringData path, const OrderedIntervalList& oil) const {
+    const auto fieldStats = getField(path);
+    if (!fieldStats || _numSampledDocs == 0) {
+        return boost::none;
+    }
+
+    double count = 0;
+    for (auto&& interval : oil.intervals) {
+        count += fieldStats->histogram.estimateCount(interval);
+    }
+    if (count > 0) {
+        return std::min(1.0, count / _numSampledDocs);
+    }
+
+    // A value which is not in the sample is at most as frequent as a value seen once, and on
+    // average as frequent as any distinct value.
+    return std::min(1.0 / _numSampledDocs, 1.0 / std::max(1.0, fieldStats->numDistinct));
+}
+
+BSONObj CollectionStatistics::toBSON() const {
+    BSONObjBuilder bob;
+    bob.append("numDocs", _numDocs);
+    bob.append("numSampledDocs", _numSampledDocs);
+    bob.append("lastUpdated", _lastUpdated);
+    BSONArrayBuilder fieldsBuilder(bob.subarrayStart("fields"));
+    for (auto&& [path, fieldStats] : _fields) {
+        BSONObjBuilder fieldBuilder(fieldsBuilder.subobjStart());
+        fieldBuilder.append("path", path);
+        fieldBuilder.append("numDistinct", fieldStats.numDistinct);
+        fieldBuilder.append("histogram", fieldStats.histogram.toBSON());
+    }
+    fieldsBuilder.doneFast();
+    return bob.obj();
+}
+}  // namespace mongo
@@ -0,0 +1,194 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/interval.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Estimates the number of distinct values added to it, by keeping the k smallest distinct hashes
+ * of the values (a "k minimum values" sketch). The estimate is exact while fewer than k distinct
+ * values have been added.
+ */
+class DistinctValueSketch {
+public:
+    static constexpr size_t kDefaultSize = 1024;
+
+    explicit DistinctValueSketch(size_t size = kDefaultSize) : _size(size) {}
+
+    void add(const BSONElement& value);
+
+    double estimate() const;
+
+private:
+    const size_t _size;
+    std::set<uint64_t> _minHashes;
+};
+
+/**
+ * A histogram of the values of a field, whose buckets each hold about the same number of values.
+ * Bucket 'i' holds the values in the range ('upperBound' of bucket 'i - 1', 'upperBound'], and
+ * counts separately the values equal to its upper bound, so that frequent values are estimated
+ * precisely. The first bucket only holds the smallest value. Values are ordered as by
+ * BSONElement::woCompare(), so that the histogram can be matched against index bounds.
+ */
+class EquiDepthHistogram {
+public:
+    struct Bucket {
+        BSONElement upperBound;
+
+        // The number of values equal to 'upperBound'.
+        double equalCount = 0;
+
+        // The number and the number of distinct values strictly between the upper bound of the
+        // previous bucket and 'upperBound'.
+        double rangeCount = 0;
+        double rangeDistinctCount = 0;
+    };
+
+    /**
+     * Builds a histogram from 'values', which must be sorted. Besides the first bucket, the
+     * histogram has at most 'numBuckets' buckets.
+     */
+    static EquiDepthHistogram build(const std::vector<BSONElement>& values, size_t numBuckets);
+
+    static StatusWith<EquiDepthHistogram> parse(const BSONObj& obj);
+
+    /**
+     * Estimates the number of values of the histogram within 'interval', whose bounds may be in
+     * either order.
+     */
+    double estimateCount(const Interval& interval) const;
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+    BSONObj toBSON() const;
+
+private:
+    // Holds the upper bounds of the buckets, in order. Copies of the histogram share it, so the
+    // buckets of a copy can keep pointing into it.
+    BSONObj _bounds;
+    std::vector<Bucket> _buckets;
+};
+
+/**
+ * Statistics about the values of one field, built from a sample of the documents of a collection.
+ * A document in which the field is missing counts as a null value, as in an index.
+ */
+struct FieldStatistics {
+    EquiDepthHistogram histogram;
+    double numDistinct = 0;
+};
+
+/**
+ * Statistics about a collection, built from a random sample of its documents by the 'analyze'
+ * command, and used by the planner to estimate the cost of candidate plans.
+ */
+class CollectionStatistics {
+public:
+    static constexpr size_t kDefaultNumBuckets = 100;
+
+    // Values larger than this are left out of the statistics, so that the bucket bounds of a
+    // histogram cannot make the statistics too large to store.
+    static constexpr int kMaxValueSizeBytes = 1024;
+
+    /**
+     * Accumulates the values of the fields 'paths' in the sampled documents, which need not be
+     * kept alive.
+     */
+    class Builder {
+    public:
+        Builder(std::vector<std::string> paths, size_t numBuckets);
+
+        void addDocument(const BSONObj& doc);
+
+        /**
+         * Builds statistics for a collection of 'numDocs' documents from the sampled documents.
+         */
+        CollectionStatistics done(long long numDocs, Date_t now);
+
+    private:
+        const std::vector<std::string> _paths;
+        const size_t _numBuckets;
+        long long _numSampledDocs = 0;
+
+        // The values of each field in the sample, each held by a single-field object. A sample can
+        // hold more values than would fit in one object.
+        std::vector<std::vector<BSONObj>> _values;
+    };
+
+    static StatusWith<CollectionStatistics> parse(const BSONObj& obj);
+
+    long long getNumDocs() const {
+        return _numDocs;
+    }
+
+    long long getNumSampledDocs() const {
+        return _numSampledDocs;
+    }
+
+    Date_t getLastUpdated() const {
+        return _lastUpdated;
+    }
+
+    /**
+     * Returns the statistics of the field 'path', or nullptr if it was not analyzed.
+     */
+    const FieldStatistics* getField(StringData path) const;
+
+    /**
+     * Estimates the fraction of the documents of the collection whose field 'path' has a value
+     * within 'oil'. Returns boost::none if the field was not analyzed.
+     */
+    boost::optional<double> estimateSelectivity(StringData path,
+                                                const OrderedIntervalList& oil) const;
+
+    BSONObj toBSON() const;
+
+private:
+    long long _numDocs = 0;
+    long long _numSampledDocs = 0;
+    Date_t _lastUpdated;
+    std::map<std::string, FieldStatistics, std::less<>> _fields;
+};
+}  // namespace mongo
@@ -0,0 +1,215 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics_store.h"
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/ops/write_ops.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo::collection_statistics_store {
+namespace {
+/**
+ * The statistics of a collection, shared by all the Collection instances of the collection.
+ */
+struct CollectionStatisticsDecoration {
+    Mutex mutex = MONGO_MAKE_LATCH("CollectionStatisticsDecoration::mutex");
+    std::shared_ptr<const CollectionStatistics> stats;
+    bool loadScheduled = false;
+};
+
+const auto getCollectionStatisticsDecoration =
+    SharedCollectionDecorations::declareDecoration<CollectionStatisticsDecoration>();
+
+// Statistics are loaded on a single background thread, so that the queries which trigger the loads
+// do not wait for them.
+std::unique_ptr<ThreadPool> loadThreadPool;
+MONGO_INITIALIZER(CollectionStatisticsLoadThreadPool)(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "CollectionStatisticsLoadThreadPool";
+    options.threadNamePrefix = "CollStatsLoad";
+    options.minThreads = 0;
+    options.maxThreads = 1;
+    options.onCreateThread = [](const std::string& name) {
+        Client::initThread(name);
+        AuthorizationSession::get(cc())->grantInternalAuthorization(&cc());
+    };
+    loadThreadPool = std::make_unique<ThreadPool>(options);
+    loadThreadPool->startup();
+}
+
+void publish(OperationContext* opCtx,
+             const NamespaceStringOrUUID& nssOrUUID,
+             const UUID& collectionUUID,
+             std::shared_ptr<const CollectionStatistics> stats) {
+    AutoGetCollectionForRead autoColl(opCtx, nssOrUUID);
+    const auto& collection = autoColl.getCollection();
+    if (!collection || collection->uuid() != collectionUUID) {
+        return;
+    }
+    auto& decoration = getCollectionStatisticsDecoration(collection->getSharedDecorations());
+    stdx::lock_guard<Latch> lk(decoration.mutex);
+    decoration.stats = std::move(stats);
+}
+}  // namespace
+
+std::shared_ptr<const CollectionStatistics> get(const CollectionPtr& collection) {
+    auto& decoration = getCollectionStatisticsDecoration(collection->getSharedDecorations());
+    stdx::lock_guard<Latch> lk(decoration.mutex);
+    if (decoration.loadScheduled) {
+        return decoration.stats;
+    }
+    decoration.loadScheduled = true;
+
+    loadThreadPool->schedule([uuid = collection->uuid()](auto status) {
+        if (!status.isOK()) {
+            return;
+        }
+
+        auto opCtx = cc().makeOperationContext();
+        try {
+            if (load(opCtx.get(), uuid)) {
+                LOGV2_DEBUG(
+                    5999205, 1, "Loaded collection statistics", "collectionUUID"_attr = uuid);
+            }
+        } catch (const DBException& ex) {
+            // The planner does without statistics it cannot load.
+            LOGV2_WARNING(5999206,
+                          "Failed to load collection statistics",
+                          "collectionUUID"_attr = uuid,
+                          "error"_attr = redact(ex.toStatus()));
+        }
+    });
+    return nullptr;
+}
+
+CollectionStatistics analyze(OperationContext* opCtx,
+                             const NamespaceString& nss,
+                             std::vector<std::string> paths,
+                             long long sampleSize,
+                             size_t numBuckets) {
+    // The sample is taken under a read lock of the collection, which must be released before the
+    // statistics are written.
+    CollectionStatistics::Builder builder(std::move(paths), numBuckets);
+    long long numDocs = 0;
+    boost::optional<UUID> collectionUUID;
+    {
+        AutoGetCollectionForRead autoColl(opCtx, nss);
+        const auto& collection = autoColl.getCollection();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "collection " << nss << " does not exist",
+                collection);
+        collectionUUID = collection->uuid();
+
+        const auto recordStore = collection->getRecordStore();
+        numDocs = recordStore->numRecords(opCtx);
+        auto randomCursor = recordStore->getRandomCursor(opCtx);
+        if (numDocs > sampleSize && randomCursor) {
+            // The random cursor samples with replacement, which makes no difference to the
+            // statistics of a collection much larger than the sample.
+            for (long long i = 0; i < sampleSize; ++i) {
+                auto record = randomCursor->next();
+                if (!record) {
+                    break;
+                }
+                builder.addDocument(record->data.toBson());
+                if (i % 1024 == 0) {
+                    opCtx->checkForInterrupt();
+                }
+            }
+        } else {
+            // Without a random cursor, every n-th document is sampled. This reads the whole
+            // collection, so the scan yields like any other query.
+            const long long step = std::max(1LL, (numDocs + sampleSize - 1) / sampleSize);
+            auto exec = InternalPlanner::collectionScan(
+                opCtx, &collection, PlanYieldPolicy::YieldPolicy::YIELD_AUTO);
+            BSONObj obj;
+            long long i = 0;
+            while (exec->getNext(&obj, nullptr) == PlanExecutor::ADVANCED) {
+                if (i++ % step == 0) {
+                    builder.addDocument(obj);
+                }
+            }
+        }
+    }
+
+    const auto now = opCtx->getServiceContext()->getFastClockSource()->now();
+    auto stats = builder.done(numDocs, now);
+
+    BSONObjBuilder docBuilder;
+    collectionUUID->appendToBuilder(&docBuilder, "_id");
+    docBuilder.append("ns", nss.ns());
+    docBuilder.appendElements(stats.toBSON());
+    const auto doc = docBuilder.obj();
+
+    DBDirectClient client(opCtx);
+    auto commandResponse = client.runCommand([&] {
+        write_ops::UpdateCommandRequest updateOp(NamespaceString::kCollectionStatisticsNamespace);
+        write_ops::UpdateOpEntry updateEntry(
+            BSON("_id" << doc["_id"]), write_ops::UpdateModification::parseFromClassicUpdate(doc));
+        updateEntry.setUpsert(true);
+        updateOp.setUpdates({updateEntry});
+        return updateOp.serialize({});
+    }());
+    uassertStatusOK(getStatusFromWriteCommandReply(commandResponse->getCommandReply()));
+
+    publish(opCtx, nss, *collectionUUID, std::make_shared<const CollectionStatistics>(stats));
+    return stats;
+}
+
+bool load(OperationContext* opCtx, const UUID& collectionUUID) {
+    DBDirectClient client(opCtx);
+    const auto doc = client.findOne(NamespaceString::kCollectionStatisticsNamespace.ns(),
+                                    BSON("_id" << collectionUUID),
+                                    nullptr,
+                                    QueryOption_SecondaryOk);
+    if (doc.isEmpty()) {
+        return false;
+    }
+
+    auto stats = uassertStatusOK(CollectionStatistics::parse(doc));
+    const NamespaceString nss(doc["ns"].str());
+    publish(opCtx,
+            {nss.db().toString(), collectionUUID},
+            collectionUUID,
+            std::make_shared<const CollectionStatistics>(std::move(stats)));
+    return true;
+}
+}  // namespace mongo::collection_statistics_store
@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/collection_statistics.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Storage of the statistics built by the 'analyze' command. The statistics of a collection are
+ * stored in one document of 'config.collectionStatistics' keyed by the collection UUID, so that
+ * they survive restarts and are replicated to secondaries, and are cached on the collection for
+ * the planner.
+ */
+namespace collection_statistics_store {
+/**
+ * Returns the statistics of 'collection', or nullptr if it has none. The first call for a
+ * collection loads its statistics in the background, so they are only returned to later calls.
+ */
+std::shared_ptr<const CollectionStatistics> get(const CollectionPtr& collection);
+
+/**
+ * Builds statistics of the fields 'paths' of the collection 'nss' from a random sample of about
+ * 'sampleSize' of its documents, stores them and makes them visible to the planner. Replaces any
+ * statistics the collection had. Must not be called with any lock held.
+ */
+CollectionStatistics analyze(OperationContext* opCtx,
+                             const NamespaceString& nss,
+                             std::vector<std::string> paths,
+                             long long sampleSize,
+                             size_t numBuckets);
+
+/**
+ * Loads the stored statistics of the collection with the given UUID into its cache. Returns
+ * whether the collection had statistics. Must not be called with any lock held.
+ */
+bool load(OperationContext* opCtx, const UUID& collectionUUID);
+}  // namespace collection_statistics_store
+}  // namespace mongo
@@ -0,0 +1,257 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/query/plan_cost_estimator.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_planner_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+CollectionStatistics buildStatistics(const std::vector<BSONObj>& docs,
+                                     std::vector<std::string> paths,
+                                     size_t numBuckets = CollectionStatistics::kDefaultNumBuckets) {
+    CollectionStatistics::Builder builder(std::move(paths), numBuckets);
+    for (auto&& doc : docs) {
+        builder.addDocument(doc);
+    }
+    return builder.done(docs.size(), Date_t::fromMillisSinceEpoch(1000));
+}
+
+double estimateCount(const CollectionStatistics& stats,
+                     StringData path,
+                     const BSONObj& bounds,
+                     bool startIncluded = true,
+                     bool endIncluded = true) {
+    const auto fieldStats = stats.getField(path);
+    ASSERT(fieldStats);
+    return fieldStats->histogram.estimateCount(Interval(bounds, startIncluded, endIncluded));
+}
+
+std::vector<BSONObj> makeDocs(const std::vector<int>& values) {
+    std::vector<BSONObj> docs;
+    for (auto value : values) {
+        docs.push_back(BSON("a" << value));
+    }
+    return docs;
+}
+
+TEST(EquiDepthHistogramTest, BucketsHoldAboutTheSameNumberOfValues) {
+    std::vector<int> values;
+    for (int i = 1; i <= 100; ++i) {
+        values.push_back(i);
+    }
+    const auto stats = buildStatistics(makeDocs(values), {"a"}, 10);
+    const auto& buckets = stats.getField("a")->histogram.getBuckets();
+
+    // The first bucket only holds the smallest value, and the last one the values after the last
+    // full bucket.
+    ASSERT_EQ(buckets.size(), 11U);
+    ASSERT_EQ(buckets.front().upperBound.numberInt(), 1);
+    ASSERT_EQ(buckets.front().rangeCount, 0);
+    ASSERT_EQ(buckets[1].upperBound.numberInt(), 11);
+    ASSERT_EQ(buckets[1].rangeCount, 9);
+    ASSERT_EQ(buckets[1].rangeDistinctCount, 9);
+    ASSERT_EQ(buckets.back().upperBound.numberInt(), 100);
+}
+
+TEST(EquiDepthHistogramTest, EstimatesPointsAndRanges) {
+    std::vector<int> values;
+    for (int i = 1; i <= 100; ++i) {
+        values.push_back(i);
+    }
+    const auto stats = buildStatistics(makeDocs(values), {"a"}, 10);
+
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 11 << "" << 11)), 1);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 5 << "" << 5)), 1);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 1 << "" << 100)), 100);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 1 << "" << 41)), 41);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 11 << "" << 21), false, false), 9);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 1 << "" << 50)), 41 + 9 / 2.0);
+
+    // Bounds of a descending index scan.
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 41 << "" << 1)), 41);
+
+    // Values out of the range of the histogram.
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 200 << "" << 300)), 0);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << MINKEY << "" << MAXKEY)), 100);
+}
+
+TEST(EquiDepthHistogramTest, EstimatesFrequentValuesPrecisely) {
+    std::vector<int> values(90, 5);
+    for (int i = 1; i <= 10; ++i) {
+        values.push_back(i);
+    }
+    const auto stats = buildStatistics(makeDocs(values), {"a"}, 10);
+
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 5 << "" << 5)), 91);
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 7 << "" << 7)), 1);
+}
+
+TEST(EquiDepthHistogramTest, NumbersOfDifferentTypesCompareEqual) {
+    const auto stats = buildStatistics(
+        {BSON("a" << 1), BSON("a" << 1LL), BSON("a" << 1.0), BSON("a" << 2)}, {"a"}, 10);
+
+    ASSERT_EQ(estimateCount(stats, "a", BSON("" << 1 << "" << 1)), 3);
+    ASSERT_EQ(stats.getField("a")->numDistinct, 2);
+}
+
+TEST(DistinctValueSketchTest, IsExactForFewValues) {
+    DistinctValueSketch sketch;
+    for (int i = 0; i < 100; ++i) {
+        const auto value = BSON("" << i);
+        sketch.add(value.firstElement());
+        sketch.add(value.firstElement());
+    }
+    ASSERT_EQ(sketch.estimate(), 100);
+}
+
+TEST(DistinctValueSketchTest, EstimatesManyValues) {
+    DistinctValueSketch sketch;
+    for (int i = 0; i < 100 * 1000; ++i) {
+        sketch.add(BSON("" << i).firstElement());
+    }
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 100 * 1000, 20 * 1000);
+}
+
+TEST(CollectionStatisticsTest, MissingFieldsCountAsNullAndArraysAsTheirElements) {
+    const auto stats = buildStatistics(
+        {fromjson("{a: 1}"), fromjson("{a: [2, 3, 3]}"), fromjson("{b: 1}")}, {"a"});
+
+    OrderedIntervalList nullPoint("a");
+    nullPoint.intervals.push_back(Interval(BSON("" << BSONNULL << "" << BSONNULL), true, true));
+    ASSERT_APPROX_EQUAL(*stats.estimateSelectivity("a", nullPoint), 1.0 / 3, 1e-9);
+
+    OrderedIntervalList threePoint("a");
+    threePoint.intervals.push_back(Interval(BSON("" << 3 << "" << 3), true, true));
+    ASSERT_APPROX_EQUAL(*stats.estimateSelectivity("a", threePoint), 1.0 / 3, 1e-9);
+
+    ASSERT_FALSE(stats.estimateSelectivity("b", threePoint));
+}
+
+TEST(CollectionStatisticsTest, ValueMissingFromSampleIsRare) {
+    std::vector<int> values;
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(i % 10);
+    }
+    const auto stats = buildStatistics(makeDocs(values), {"a"});
+
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(Interval(BSON("" << 5.5 << "" << 5.5), true, true));
+    ASSERT_APPROX_EQUAL(*stats.estimateSelectivity("a", oil), 1.0 / 100, 1e-9);
+}
+
+TEST(CollectionStatisticsTest, RoundTripsThroughBSON) {
+    const auto stats = buildStatistics(
+        {fromjson("{a: 1, b: 'x'}"), fromjson("{a: [2, 3], b: {c: 1}}"), fromjson("{b: null}")},
+        {"a", "b", "c"});
+
+    auto parsed = CollectionStatistics::parse(stats.toBSON());
+    ASSERT_OK(parsed.getStatus());
+    ASSERT_BSONOBJ_EQ(parsed.getValue().toBSON(), stats.toBSON());
+    ASSERT_EQ(parsed.getValue().getNumDocs(), 3);
+    ASSERT_EQ(parsed.getValue().getLastUpdated(), Date_t::fromMillisSinceEpoch(1000));
+    ASSERT_EQ(estimateCount(parsed.getValue(), "b", BSON("" << "x" << "" << "x")), 1);
+}
+
+TEST(CollectionStatisticsTest, ParseRejectsMalformedHistograms) {
+    ASSERT_NOT_OK(CollectionStatistics::parse(fromjson("{numDocs: 1, fields: 1}")).getStatus());
+    ASSERT_NOT_OK(CollectionStatistics::parse(
+                      fromjson("{numDocs: 1, fields: [{path: 'a', numDistinct: 1, histogram: "
+                               "{bounds: [1, 2], equalCounts: [1], rangeCounts: [0, 0], "
+                               "rangeDistinctCounts: [0, 0]}}]}"))
+                      .getStatus());
+}
+
+class CollectionStatisticsPruningTest : public QueryPlannerTest {
+protected:
+    void setUp() override {
+        QueryPlannerTest::setUp();
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1));
+
+        // 'a' is unique, while 'b' is 0 in nine documents out of ten.
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < 1000; ++i) {
+            docs.push_back(BSON("a" << i << "b" << (i % 10 == 0 ? i : 0)));
+        }
+        stats = buildStatistics(docs, {"a", "b"});
+    }
+
+    CollectionStatistics stats;
+};
+
+TEST_F(CollectionStatisticsPruningTest, PrunesPlansMuchMoreExpensiveThanTheBest) {
+    runQuery(fromjson("{a: 5, b: 0}"));
+    assertNumSolutions(3U);
+
+    plan_cost_estimator::pruneSolutions(*cq, stats, &solns);
+    assertNumSolutions(1U);
+    assertSolutionExists("{fetch: {filter: {b: 0}, node: {ixscan: {pattern: {a: 1}}}}}");
+}
+
+TEST_F(CollectionStatisticsPruningTest, KeepsPlansOfComparableCost) {
+    runQuery(fromjson("{a: {$lt: 500}, b: 0}"));
+    assertNumSolutions(3U);
+
+    // Every candidate reads a large part of the collection.
+    plan_cost_estimator::pruneSolutions(*cq, stats, &solns);
+    assertNumSolutions(3U);
+}
+
+TEST_F(CollectionStatisticsPruningTest, DoesNotPruneSortedOrUnanalyzedQueries) {
+    runQuerySortProj(fromjson("{a: 5, b: 0}"), fromjson("{b: 1}"), BSONObj());
+    const auto numSolutions = getNumSolutions();
+    plan_cost_estimator::pruneSolutions(*cq, stats, &solns);
+    assertNumSolutions(numSolutions);
+
+    runQuery(fromjson("{a: 5, b: 0}"));
+    plan_cost_estimator::pruneSolutions(*cq, CollectionStatistics(), &solns);
+    assertNumSolutions(3U);
+}
+
+TEST_F(CollectionStatisticsPruningTest, PruningCanBeDisabled) {
+    const auto pruneRatio = internalQueryCollectionStatisticsPruneRatio.load();
+    ON_BLOCK_EXIT([&] { internalQueryCollectionStatisticsPruneRatio.store(pruneRatio); });
+    internalQueryCollectionStatisticsPruneRatio.store(0);
+
+    runQuery(fromjson("{a: 5, b: 0}"));
+    plan_cost_estimator::pruneSolutions(*cq, stats, &solns);
+    assertNumSolutions(3U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -377,6 +377,9 @@ void Explain::planCacheEntryToBSON(const PlanCacheEntry& entry, BSONObjBuilder*
     out->append("isActive", entry.isActive);
     out->append("works", static_cast<long long>(entry.works));
     out->append("timeOfCreation", entry.timeOfCreation);
+    out->append("executablePlanHits", static_cast<long long>(entry.executablePlanHits));
+    out->append("executablePlanTimeSavedMicros",
+                durationCount<Microseconds>(entry.executablePlanTimeSaved));
 
     if (entry.debugInfo) {
         const auto& debugInfo = *entry.debugInfo;
@@ -68,10 +68,13 @@
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/collection_statistics_store.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cache_snapshot.h"
+#include "mongo/db/query/plan_cost_estimator.h"
 #include "mongo/db/query/plan_executor_factory.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -84,6 +87,7 @@
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/query/query_settings_decoration.h"
+#include "mongo/db/query/sbe_cached_executable_plan.h"
 #include "mongo/db/query/sbe_cached_solution_planner.h"
 #include "mongo/db/query/sbe_multi_planner.h"
 #include "mongo/db/query/sbe_sub_planner.h"
@@ -101,6 +105,7 @@
 #include "mongo/logv2/log.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -360,6 +365,12 @@ void fillOutPlannerParams(OperationContext* opCtx,
     if (collection->isClustered()) {
         plannerParams->allowRIDRange = true;
     }
+
+    // Internal collections are never analyzed.
+    if (internalQueryMaxSkipScanPrefixCardinality.load() > 0 &&
+        !collection->ns().isOnInternalDb()) {
+        plannerParams->collectionStats = collection_statistics_store::get(collection);
+    }
 }
 
 bool shouldWaitForOplogVisibility(OperationContext* opCtx,
@@ -612,6 +623,13 @@ public:
 
         // Check that the query should be cached.
         if (CollectionQueryInfo::get(_collection).getPlanCache()->shouldCacheQuery(*_cq)) {
+            // Warm up the cache from its snapshot on the first query which consults it. The restore
+            // runs in the background, so this query plans without the restored entries.
+            if (internalQueryPlanCacheRestoreFromSnapshot.load() &&
+                CollectionQueryInfo::get(_collection).getPlanCache()->claimSnapshotRestore()) {
+                plan_cache_snapshot::scheduleRestore(_collection);
+            }
+
             // Fill in opDebug information.
             const auto planCacheKey =
                 CollectionQueryInfo::get(_collection).getPlanCache()->computeKey(*_cq);
@@ -638,7 +656,7 @@ public:
                     }
 
                     return buildCachedPlan(
-                        std::move(querySolution), plannerParams, cs->decisionWorks);
+                        std::move(querySolution), plannerParams, planCacheKey, *cs);
                 }
             }
         }
@@ -681,6 +699,14 @@ public:
             }
         }
 
+        // If the collection was analyzed, leave out of multi-planning the candidates which are
+        // estimated to be much more expensive than the best one.
+        if (solutions.size() > 1 && internalQueryCollectionStatisticsPruneRatio.load() > 0) {
+            if (auto stats = collection_statistics_store::get(_collection)) {
+                plan_cost_estimator::pruneSolutions(*_cq, *stats, &solutions);
+            }
+        }
+
         if (1 == solutions.size()) {
             auto result = makeResult();
             // Only one possible plan. Run it. Build the stages from the solution.
@@ -728,10 +754,14 @@ protected:
      *       deactivated and we use multi-planning to select an entirely new  winning plan.
      *     * Or stores additional information in the result object, in case runtime planning is
      *       implemented as a standalone component, rather than as part of the execution tree.
+     *
+     * The 'cachedSolution' is the plan cache entry for 'planCacheKey' from which the 'solution'
+     * was created.
      */
     virtual std::unique_ptr<ResultType> buildCachedPlan(std::unique_ptr<QuerySolution> solution,
                                                         const QueryPlannerParams& plannerParams,
-                                                        size_t decisionWorks) = 0;
+                                                        const PlanCacheKey& planCacheKey,
+                                                        const CachedSolution& cachedSolution) = 0;
 
     /**
      * Constructs a special PlanStage tree for rooted $or queries. Each clause of the $or is planned
@@ -849,7 +879,8 @@ protected:
     std::unique_ptr<ClassicPrepareExecutionResult> buildCachedPlan(
         std::unique_ptr<QuerySolution> solution,
         const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution) final {
         auto result = makeResult();
         auto&& root = buildExecutableTree(*solution);
 
@@ -862,7 +893,7 @@ protected:
                                                           _ws,
                                                           _cq,
                                                           plannerParams,
-                                                          decisionWorks,
+                                                          cachedSolution.decisionWorks,
                                                           std::move(root)),
                         std::move(solution));
         return result;
@@ -987,11 +1018,13 @@ protected:
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildCachedPlan(
         std::unique_ptr<QuerySolution> solution,
         const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution) final {
         auto result = makeResult();
-        auto execTree = buildExecutableTree(*solution);
+        auto execTree =
+            buildCachedExecutableTree(*solution, plannerParams, planCacheKey, cachedSolution);
         result->emplace(std::move(execTree), std::move(solution));
-        result->setDecisionWorks(decisionWorks);
+        result->setDecisionWorks(cachedSolution.decisionWorks);
         return result;
     }
 
@@ -1017,6 +1050,57 @@ protected:
         }
         return result;
     }
+
+private:
+    /**
+     * Builds a PlanStage tree from the given cached 'solution', or clones the tree attached to the
+     * 'cachedSolution' if it was built for a query with the same parameters, or the same shape if
+     * the tree is parameterized. A newly built tree is attached to the plan cache entry for
+     * 'planCacheKey' to be reused by later queries.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
+    buildCachedExecutableTree(const QuerySolution& solution,
+                              const QueryPlannerParams& plannerParams,
+                              const PlanCacheKey& planCacheKey,
+                              const CachedSolution& cachedSolution) const {
+        if (!internalQuerySlotBasedExecutionCacheExecutablePlans.load()) {
+            return buildExecutableTree(solution);
+        }
+
+        auto planCache = CollectionQueryInfo::get(_collection).getPlanCache();
+        if (auto cachedPlan = dynamic_cast<const sbe::CachedExecutablePlanSBE*>(
+                cachedSolution.executablePlan.get());
+            cachedPlan &&
+            cachedPlan->getKey() ==
+                sbe::CachedExecutablePlanSBE::makeKey(
+                    *_cq, plannerParams.options, solution, cachedPlan->isParameterized())) {
+            Timer timer;
+            if (auto execTree =
+                    cachedPlan->clone(_opCtx, _collection, *_cq, solution, _yieldPolicy)) {
+                planCache->recordExecutablePlanHit(
+                    planCacheKey,
+                    std::max(cachedPlan->getBuildTime() - Microseconds{timer.micros()},
+                             Microseconds{0}));
+                return std::move(*execTree);
+            }
+        }
+
+        // The tree is built to be stored with the plan cache entry, so it is parameterized if
+        // possible, to be shared by all queries of the same shape.
+        Timer timer;
+        auto execTree = stage_builder::buildSlotBasedExecutableTree(
+            _opCtx, _collection, *_cq, solution, _yieldPolicy, true /* parameterize */);
+        auto buildTime = Microseconds{timer.micros()};
+        if (sbe::CachedExecutablePlanSBE::canCache(*_cq, plannerParams.options, *execTree.first)) {
+            auto key = sbe::CachedExecutablePlanSBE::makeKey(
+                *_cq, plannerParams.options, solution, execTree.second.isParameterized);
+            planCache->setExecutablePlan(
+                planCacheKey,
+                std::make_shared<sbe::CachedExecutablePlanSBE>(
+                    std::move(key), *execTree.first, execTree.second, buildTime));
+        }
+        return execTree;
+    }
 };
 
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getClassicExecutor(
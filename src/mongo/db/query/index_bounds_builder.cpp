@@ -954,6 +954,7 @@ void IndexBoundsBuilder::_translatePredicate(const MatchExpression* expr,
 
         IndexBoundsBuilder::BoundsTightness tightness;
         bool arrayOrNullPresent = false;
+        oilOut->intervals.reserve(ime->getEqualities().size());
         for (auto&& equality : ime->getEqualities()) {
             translateEquality(equality, index, isHashed, oilOut, &tightness);
             // The ordering invariant of oil has been violated by the call to translateEquality.
@@ -29,8 +29,10 @@
 
 #pragma once
 
+#include <limits>
 #include <list>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/stdx/unordered_map.h"
@@ -38,10 +40,24 @@
 
 namespace mongo {
 
+/**
+ * The default budget estimator of LRUKeyValue, which does not charge anything for an entry, so that
+ * the kv-store is only limited by its number of entries.
+ */
+template <class K, class V>
+struct LRUNullBudgetEstimator {
+    size_t operator()(const K& key, const V& value) const {
+        return 0;
+    }
+};
+
 /**
  * A key-value store structure with a least recently used (LRU) replacement
- * policy. The number of entries allowed in the kv-store is set as a constant
- * upon construction.
+ * policy. The number of entries allowed in the kv-store, and optionally the total budget of its
+ * entries, are set as constants upon construction.
+ *
+ * The budget of an entry is computed by 'BudgetEstimator', e.g. as an estimate of its size in
+ * bytes. It must return the same value for an entry for as long as the entry is in the kv-store.
  *
  * Caveat:
  * This kv-store is NOT thread safe! The client to this utility is responsible
@@ -57,10 +73,14 @@ namespace mongo {
  * TODO: We could move this into the util/ directory and do any cleanup necessary to make it
  * fully general.
  */
-template <class K, class V, class KeyHasher = std::hash<K>>
+template <class K,
+          class V,
+          class KeyHasher = std::hash<K>,
+          class BudgetEstimator = LRUNullBudgetEstimator<K, V>>
 class LRUKeyValue {
 public:
-    LRUKeyValue(size_t maxSize) : _maxSize(maxSize), _currentSize(0){};
+    LRUKeyValue(size_t maxSize, size_t maxBudget = std::numeric_limits<size_t>::max())
+        : _maxSize(maxSize), _maxBudget(maxBudget), _currentSize(0), _currentBudget(0){};
 
     ~LRUKeyValue() {
         clear();
@@ -84,17 +104,20 @@ public:
      * If 'key' already exists in the kv-store, 'entry' will
      * simply replace what is already there.
      *
-     * The least recently used entry is evicted if the
-     * kv-store is full prior to the add() operation.
+     * The least recently used entries are evicted until the
+     * kv-store is within both its maximum number of entries
+     * and its maximum budget. This may evict 'entry' itself if
+     * its budget alone exceeds the maximum.
      *
-     * If an entry is evicted, it will be returned in
-     * an unique_ptr for the caller to use before disposing.
+     * The evicted entries are returned, least recently used
+     * first, for the caller to use before disposing.
      */
-    std::unique_ptr<V> add(const K& key, V* entry) {
+    std::vector<std::unique_ptr<V>> add(const K& key, V* entry) {
         // If the key already exists, delete it first.
         KVMapConstIt i = _kvMap.find(key);
         if (i != _kvMap.end()) {
             KVListIt found = i->second;
+            _currentBudget -= _budgetEstimator(found->first, *found->second);
             delete found->second;
             _kvMap.erase(i);
             _kvList.erase(found);
@@ -104,24 +127,35 @@ public:
         _kvList.push_front(std::make_pair(key, entry));
         _kvMap[key] = _kvList.begin();
         _currentSize++;
+        _currentBudget += _budgetEstimator(key, *entry);
 
-        // If the store has grown beyond its allowed size,
-        // evict the least recently used entry.
-        if (_currentSize > _maxSize) {
-            V* evictedEntry = _kvList.back().second;
-            invariant(evictedEntry);
+        // If the store has grown beyond its allowed size or budget,
+        // evict the least recently used entries.
+        std::vector<std::unique_ptr<V>> evictedEntries;
+        while (_currentSize > _maxSize || _currentBudget > _maxBudget) {
+            evictedEntries.push_back(evictLeastRecentlyUsed());
+        }
+        return evictedEntries;
+    }
 
-            _kvMap.erase(_kvList.back().first);
-            _kvList.pop_back();
-            _currentSize--;
-            invariant(_currentSize == _maxSize);
+    /**
+     * Removes the least recently used entry from the kv-store,
+     * which must not be empty, and passes its ownership to the
+     * caller.
+     */
+    std::unique_ptr<V> evictLeastRecentlyUsed() {
+        invariant(_currentSize > 0);
+        V* evictedEntry = _kvList.back().second;
+        invariant(evictedEntry);
 
-            // Pass ownership of evicted entry to caller.
-            // If caller chooses to ignore this unique_ptr,
-            // the evicted entry will be deleted automatically.
-            return std::unique_ptr<V>(evictedEntry);
-        }
-        return std::unique_ptr<V>();
+        _currentBudget -= _budgetEstimator(_kvList.back().first, *evictedEntry);
+        _kvMap.erase(_kvList.back().first);
+        _kvList.pop_back();
+        _currentSize--;
+
+        // If caller chooses to ignore this unique_ptr,
+        // the evicted entry will be deleted automatically.
+        return std::unique_ptr<V>(evictedEntry);
     }
 
     /**
@@ -163,6 +197,7 @@ public:
             return Status(ErrorCodes::NoSuchKey, "no such key in LRU key-value store");
         }
         KVListIt found = i->second;
+        _currentBudget -= _budgetEstimator(found->first, *found->second);
         delete found->second;
         _kvMap.erase(i);
         _kvList.erase(found);
@@ -180,6 +215,7 @@ public:
         _kvList.clear();
         _kvMap.clear();
         _currentSize = 0;
+        _currentBudget = 0;
     }
 
     /**
@@ -196,6 +232,17 @@ public:
         return _currentSize;
     }
 
+    /**
+     * Returns the total budget of the entries currently in the kv-store.
+     */
+    size_t budget() const {
+        return _currentBudget;
+    }
+
+    size_t maxBudget() const {
+        return _maxBudget;
+    }
+
     /**
      * TODO: The kv-store should implement its own iterator. Calling through to the underlying
      * iterator exposes the internals, and forces the caller to make a horrible type
@@ -213,9 +260,17 @@ private:
     // The maximum allowable number of entries in the kv-store.
     const size_t _maxSize;
 
+    // The maximum allowable total budget of the entries in the kv-store.
+    const size_t _maxBudget;
+
     // The number of entries currently in the kv-store.
     size_t _currentSize;
 
+    // The total budget of the entries currently in the kv-store.
+    size_t _currentBudget;
+
+    BudgetEstimator _budgetEstimator;
+
     // (K, V*) pairs are stored in this std::list. They are sorted in order
     // of use, where the front is the most recently used and the back is the
     // least recently used.
@@ -40,7 +40,8 @@ namespace {
 // Convenience functions
 //
 
-void assertInKVStore(LRUKeyValue<int, int>& cache, int key, int value) {
+template <class Cache>
+void assertInKVStore(Cache& cache, int key, int value) {
     int* cachedValue = nullptr;
     ASSERT_TRUE(cache.hasKey(key));
     Status s = cache.get(key, &cachedValue);
@@ -48,7 +49,8 @@ void assertInKVStore(LRUKeyValue<int, int>& cache, int key, int value) {
     ASSERT_EQUALS(*cachedValue, value);
 }
 
-void assertNotInKVStore(LRUKeyValue<int, int>& cache, int key) {
+template <class Cache>
+void assertNotInKVStore(Cache& cache, int key) {
     int* cachedValue = nullptr;
     ASSERT_FALSE(cache.hasKey(key));
     Status s = cache.get(key, &cachedValue);
@@ -98,8 +100,8 @@ TEST(LRUKeyValueTest, EvictionTest) {
     int maxSize = 10;
     LRUKeyValue<int, int> cache(maxSize);
     for (int i = 0; i < maxSize; ++i) {
-        std::unique_ptr<int> evicted = cache.add(i, new int(i));
-        ASSERT(nullptr == evicted.get());
+        auto evicted = cache.add(i, new int(i));
+        ASSERT(evicted.empty());
     }
     ASSERT_EQUALS(cache.size(), (size_t)maxSize);
 
@@ -113,10 +115,10 @@ TEST(LRUKeyValueTest, EvictionTest) {
     }
 
     // Adding another entry causes an eviction.
-    std::unique_ptr<int> evicted = cache.add(maxSize + 1, new int(maxSize + 1));
+    auto evicted = cache.add(maxSize + 1, new int(maxSize + 1));
     ASSERT_EQUALS(cache.size(), (size_t)maxSize);
-    ASSERT(nullptr != evicted.get());
-    ASSERT_EQUALS(*evicted, evictKey);
+    ASSERT_EQUALS(evicted.size(), 1U);
+    ASSERT_EQUALS(*evicted[0], evictKey);
 
     // Check that the least recently accessed has been evicted.
     for (int i = 0; i < maxSize; ++i) {
@@ -138,8 +140,8 @@ TEST(LRUKeyValueTest, PromotionTest) {
     int maxSize = 10;
     LRUKeyValue<int, int> cache(maxSize);
     for (int i = 0; i < maxSize; ++i) {
-        std::unique_ptr<int> evicted = cache.add(i, new int(i));
-        ASSERT(nullptr == evicted.get());
+        auto evicted = cache.add(i, new int(i));
+        ASSERT(evicted.empty());
     }
     ASSERT_EQUALS(cache.size(), (size_t)maxSize);
 
@@ -149,8 +151,8 @@ TEST(LRUKeyValueTest, PromotionTest) {
 
     // Evict all but one of the original entries.
     for (int i = maxSize; i < (maxSize + maxSize - 1); ++i) {
-        std::unique_ptr<int> evicted = cache.add(i, new int(i));
-        ASSERT(nullptr != evicted.get());
+        auto evicted = cache.add(i, new int(i));
+        ASSERT_EQUALS(evicted.size(), 1U);
     }
     ASSERT_EQUALS(cache.size(), (size_t)maxSize);
 
@@ -164,6 +166,51 @@ TEST(LRUKeyValueTest, PromotionTest) {
     }
 }
 
+/**
+ * Charges each entry its value, so that the budget of the kv-store is the sum of its values.
+ */
+struct ValueBudgetEstimator {
+    size_t operator()(int key, int value) const {
+        return value;
+    }
+};
+
+/**
+ * Fill up a kv-store with a budget of 10 with entries whose budgets add up to 10. Then check that
+ * adding another entry evicts as many of the least recently used entries as needed to stay within
+ * the budget, and that an entry exceeding the whole budget is not kept.
+ */
+TEST(LRUKeyValueTest, BudgetEvictionTest) {
+    LRUKeyValue<int, int, std::hash<int>, ValueBudgetEstimator> cache(100, 10);
+    for (int i = 1; i <= 4; ++i) {
+        ASSERT(cache.add(i, new int(i)).empty());
+    }
+    ASSERT_EQUALS(cache.budget(), 10U);
+
+    // Promote key 1 so that keys 2 and 3 are the least recently used.
+    assertInKVStore(cache, 1, 1);
+    auto evicted = cache.add(5, new int(5));
+    ASSERT_EQUALS(evicted.size(), 2U);
+    ASSERT_EQUALS(*evicted[0], 2);
+    ASSERT_EQUALS(*evicted[1], 3);
+    ASSERT_EQUALS(cache.budget(), 10U);
+    assertInKVStore(cache, 1, 1);
+    assertInKVStore(cache, 4, 4);
+    assertInKVStore(cache, 5, 5);
+
+    // Replacing an entry releases its budget.
+    ASSERT(cache.add(5, new int(2)).empty());
+    ASSERT_EQUALS(cache.budget(), 7U);
+    ASSERT_OK(cache.remove(4));
+    ASSERT_EQUALS(cache.budget(), 3U);
+
+    evicted = cache.add(6, new int(11));
+    ASSERT_EQUALS(evicted.size(), 3U);
+    ASSERT_EQUALS(*evicted.back(), 11);
+    ASSERT_EQUALS(cache.size(), 0U);
+    ASSERT_EQUALS(cache.budget(), 0U);
+}
+
 /**
  * Test that calling add() with a key that already exists
  * in the kv-store deletes the existing entry.
@@ -42,6 +42,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/string_data_comparator_interface.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
@@ -62,6 +63,15 @@ namespace {
 
 ServerStatusMetricField<Counter64> totalPlanCacheSizeEstimateBytesMetric(
     "query.planCacheTotalSizeEstimateBytes", &PlanCacheEntry::planCacheTotalSizeEstimateBytes);
+ServerStatusMetricField<Counter64> totalPlanCacheEvictedEntriesMetric(
+    "query.planCacheTotalEvictedEntries", &PlanCache::planCacheTotalEvictedEntries);
+ServerStatusMetricField<Counter64> totalPlanCacheEvictedBytesMetric(
+    "query.planCacheTotalEvictedBytes", &PlanCache::planCacheTotalEvictedBytes);
+
+size_t getMaxSizeBytesPerCollection() {
+    const auto maxSizeBytes = internalQueryCacheMaxSizeBytesPerCollection.load();
+    return maxSizeBytes > 0 ? maxSizeBytes : std::numeric_limits<size_t>::max();
+}
 
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
@@ -165,7 +175,9 @@ bool PlanCache::shouldCacheQuery(const CanonicalQuery& query) {
 }
 
 CachedSolution::CachedSolution(const PlanCacheEntry& entry)
-    : plannerData(entry.plannerData->clone()), decisionWorks(entry.works) {}
+    : plannerData(entry.plannerData->clone()),
+      decisionWorks(entry.works),
+      executablePlan(entry.executablePlan) {}
 
 //
 // PlanCacheEntry
@@ -230,6 +242,22 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::create(
                                                               std::move(debugInfo)));
 }
 
+std::unique_ptr<PlanCacheEntry> PlanCacheEntry::createFromSnapshot(
+    std::unique_ptr<const SolutionCacheData> plannerData,
+    uint32_t queryHash,
+    uint32_t planCacheKey,
+    Date_t timeOfCreation,
+    bool isActive,
+    size_t works) {
+    return std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(std::move(plannerData),
+                                                              timeOfCreation,
+                                                              queryHash,
+                                                              planCacheKey,
+                                                              isActive,
+                                                              works,
+                                                              boost::none));
+}
+
 PlanCacheEntry::PlanCacheEntry(std::unique_ptr<const SolutionCacheData> plannerData,
                                const Date_t timeOfCreation,
                                const uint32_t queryHash,
@@ -261,13 +289,17 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::clone() const {
         debugInfoCopy.emplace(*debugInfo);
     }
 
-    return std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(plannerData->clone(),
-                                                              timeOfCreation,
-                                                              queryHash,
-                                                              planCacheKey,
-                                                              isActive,
-                                                              works,
-                                                              std::move(debugInfoCopy)));
+    auto entry = std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(plannerData->clone(),
+                                                                    timeOfCreation,
+                                                                    queryHash,
+                                                                    planCacheKey,
+                                                                    isActive,
+                                                                    works,
+                                                                    std::move(debugInfoCopy)));
+    entry->executablePlan = executablePlan;
+    entry->executablePlanHits = executablePlanHits;
+    entry->executablePlanTimeSaved = executablePlanTimeSaved;
+    return entry;
 }
 
 uint64_t PlanCacheEntry::CreatedFromQuery::estimateObjectSizeInBytes() const {
@@ -393,6 +425,148 @@ std::string PlanCacheIndexTree::toString(int indents) const {
     return result.str();
 }
 
+namespace {
+const auto kIndexNameField = "name"_sd;
+const auto kIndexDisambiguatorField = "disambiguator"_sd;
+const auto kIndexKeyPatternField = "keyPattern"_sd;
+
+BSONObj serializeIndexIdentifier(const IndexEntry::Identifier& identifier,
+                                 const BSONObj& keyPattern) {
+    BSONObjBuilder bob;
+    bob.append(kIndexNameField, identifier.catalogName);
+    if (!identifier.disambiguator.empty()) {
+        bob.append(kIndexDisambiguatorField, identifier.disambiguator);
+    }
+    bob.append(kIndexKeyPatternField, keyPattern);
+    return bob.obj();
+}
+
+/**
+ * Looks up the index serialized by serializeIndexIdentifier() in 'indexes'. A $** index is matched
+ * by name only, since the key pattern which was serialized is the one of the expanded IndexEntry
+ * the plan used, and the returned entry is expanded the same way.
+ */
+StatusWith<IndexEntry> parseIndexIdentifier(const BSONElement& elem,
+                                            const std::vector<IndexEntry>& indexes) {
+    if (elem.type() != BSONType::Object) {
+        return Status(ErrorCodes::FailedToParse, "index in plan cache snapshot must be an object");
+    }
+    const auto obj = elem.embeddedObject();
+    const auto name = obj[kIndexNameField];
+    const auto keyPattern = obj[kIndexKeyPatternField];
+    if (name.type() != BSONType::String || keyPattern.type() != BSONType::Object) {
+        return Status(ErrorCodes::FailedToParse,
+                      str::stream() << "malformed index in plan cache snapshot: " << obj);
+    }
+
+    auto it = std::find_if(indexes.begin(), indexes.end(), [&](const IndexEntry& index) {
+        return index.identifier.catalogName == name.valueStringData();
+    });
+    if (it == indexes.end()) {
+        return Status(ErrorCodes::IndexNotFound,
+                      str::stream() << "index " << name.valueStringData() << " no longer exists");
+    }
+
+    IndexEntry index = *it;
+    if (index.type == IndexType::INDEX_WILDCARD) {
+        index.identifier.disambiguator = obj[kIndexDisambiguatorField].str();
+        index.keyPattern = keyPattern.embeddedObject().getOwned();
+    } else if (SimpleBSONObjComparator::kInstance.evaluate(index.keyPattern !=
+                                                           keyPattern.embeddedObject())) {
+        return Status(ErrorCodes::IndexKeySpecsConflict,
+                      str::stream() << "index " << name.valueStringData()
+                                    << " has a different key pattern than when the plan was "
+                                       "cached");
+    }
+    return index;
+}
+
+BSONObj arrayOrEmpty(const BSONElement& elem) {
+    return elem.type() == BSONType::Array ? elem.embeddedObject() : BSONObj();
+}
+}  // namespace
+
+BSONObj PlanCacheIndexTree::toBSON() const {
+    BSONObjBuilder bob;
+    if (entry) {
+        bob.append("index", serializeIndexIdentifier(entry->identifier, entry->keyPattern));
+        bob.append("pos", static_cast<long long>(index_pos));
+    }
+    bob.append("canCombineBounds", canCombineBounds);
+
+    if (!orPushdowns.empty()) {
+        BSONArrayBuilder pushdownsBuilder(bob.subarrayStart("orPushdowns"));
+        for (auto&& orPushdown : orPushdowns) {
+            BSONObjBuilder pushdownBuilder(pushdownsBuilder.subobjStart());
+            // Only the identifier of the index is known here, which is all the tag needs.
+            pushdownBuilder.append("name", orPushdown.indexEntryId.catalogName);
+            if (!orPushdown.indexEntryId.disambiguator.empty()) {
+                pushdownBuilder.append("disambiguator", orPushdown.indexEntryId.disambiguator);
+            }
+            pushdownBuilder.append("pos", static_cast<long long>(orPushdown.position));
+            pushdownBuilder.append("canCombineBounds", orPushdown.canCombineBounds);
+            BSONArrayBuilder routeBuilder(pushdownBuilder.subarrayStart("route"));
+            for (auto position : orPushdown.route) {
+                routeBuilder.append(static_cast<long long>(position));
+            }
+        }
+    }
+
+    if (!children.empty()) {
+        BSONArrayBuilder childrenBuilder(bob.subarrayStart("children"));
+        for (auto&& child : children) {
+            childrenBuilder.append(child->toBSON());
+        }
+    }
+    return bob.obj();
+}
+
+StatusWith<std::unique_ptr<PlanCacheIndexTree>> PlanCacheIndexTree::parse(
+    const BSONObj& obj, const std::vector<IndexEntry>& indexes) {
+    auto tree = std::make_unique<PlanCacheIndexTree>();
+
+    if (auto indexElem = obj["index"]; !indexElem.eoo()) {
+        auto swIndex = parseIndexIdentifier(indexElem, indexes);
+        if (!swIndex.isOK()) {
+            return swIndex.getStatus();
+        }
+        tree->setIndexEntry(swIndex.getValue());
+        tree->index_pos = obj["pos"].safeNumberLong();
+    }
+    tree->canCombineBounds = obj["canCombineBounds"].trueValue();
+
+    for (auto&& pushdownElem : arrayOrEmpty(obj["orPushdowns"])) {
+        const auto pushdownObj = pushdownElem.Obj();
+        const auto name = pushdownObj["name"].str();
+        const bool indexExists =
+            std::any_of(indexes.begin(), indexes.end(), [&](const IndexEntry& index) {
+                return index.identifier.catalogName == name;
+            });
+        if (!indexExists) {
+            return Status(ErrorCodes::IndexNotFound,
+                          str::stream() << "index " << name << " no longer exists");
+        }
+
+        OrPushdown orPushdown{IndexEntry::Identifier{name, pushdownObj["disambiguator"].str()},
+                              static_cast<size_t>(pushdownObj["pos"].safeNumberLong()),
+                              pushdownObj["canCombineBounds"].trueValue(),
+                              {}};
+        for (auto&& position : arrayOrEmpty(pushdownObj["route"])) {
+            orPushdown.route.push_back(position.safeNumberLong());
+        }
+        tree->orPushdowns.push_back(std::move(orPushdown));
+    }
+
+    for (auto&& childElem : arrayOrEmpty(obj["children"])) {
+        auto swChild = parse(childElem.Obj(), indexes);
+        if (!swChild.isOK()) {
+            return swChild.getStatus();
+        }
+        tree->children.push_back(swChild.getValue().release());
+    }
+    return {std::move(tree)};
+}
+
 //
 // SolutionCacheData
 //
@@ -423,17 +597,64 @@ std::string SolutionCacheData::toString() const {
             verify(this->tree.get());
             return str::stream() << "(index-tagged expression tree: "
                                  << "tree=" << this->tree->toString() << ")";
+        case SKIP_SCAN_SOLN:
+            verify(this->tree.get());
+            return str::stream() << "(skip scan solution: "
+                                 << "tree=" << this->tree->toString() << ")";
     }
     MONGO_UNREACHABLE;
 }
 
+BSONObj SolutionCacheData::toBSON() const {
+    BSONObjBuilder bob;
+    bob.append("solnType", static_cast<int>(solnType));
+    bob.append("wholeIXSolnDir", wholeIXSolnDir);
+    bob.append("indexFilterApplied", indexFilterApplied);
+    if (tree) {
+        bob.append("tree", tree->toBSON());
+    }
+    return bob.obj();
+}
+
+StatusWith<std::unique_ptr<SolutionCacheData>> SolutionCacheData::parse(
+    const BSONObj& obj, const std::vector<IndexEntry>& indexes) {
+    auto data = std::make_unique<SolutionCacheData>();
+
+    const auto solnType = obj["solnType"].safeNumberInt();
+    switch (solnType) {
+        case WHOLE_IXSCAN_SOLN:
+        case COLLSCAN_SOLN:
+        case USE_INDEX_TAGS_SOLN:
+        case SKIP_SCAN_SOLN:
+            data->solnType = static_cast<SolutionType>(solnType);
+            break;
+        default:
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << "unknown cached solution type " << solnType);
+    }
+    data->wholeIXSolnDir = obj["wholeIXSolnDir"].safeNumberInt();
+    data->indexFilterApplied = obj["indexFilterApplied"].trueValue();
+
+    if (auto treeElem = obj["tree"]; treeElem.type() == BSONType::Object) {
+        auto swTree = PlanCacheIndexTree::parse(treeElem.embeddedObject(), indexes);
+        if (!swTree.isOK()) {
+            return swTree.getStatus();
+        }
+        data->tree = std::move(swTree.getValue());
+    } else if (data->solnType != COLLSCAN_SOLN) {
+        return Status(ErrorCodes::FailedToParse, "cached index solution is missing its tree");
+    }
+    return {std::move(data)};
+}
+
 //
 // PlanCache
 //
 
-PlanCache::PlanCache() : PlanCache(internalQueryCacheMaxEntriesPerCollection.load()) {}
+PlanCache::PlanCache()
+    : PlanCache(internalQueryCacheMaxEntriesPerCollection.load(), getMaxSizeBytesPerCollection()) {}
 
-PlanCache::PlanCache(size_t size) : _cache(size) {}
+PlanCache::PlanCache(size_t size, size_t maxSizeBytes) : _cache(size, maxSizeBytes) {}
 
 PlanCache::~PlanCache() {}
 
@@ -624,15 +845,32 @@ Status PlanCache::set(const CanonicalQuery& query,
     auto newEntry(PlanCacheEntry::create(
         solns, std::move(why), query, queryHash, planCacheKey, now, isNewEntryActive, newWorks));
 
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(key, newEntry.release());
+    auto evictedEntries = _cache.add(key, newEntry.release());
+
+    // Make room for the new entry in this cache if all the plan caches together are too large.
+    // The new entry itself is kept, so that a collection can always cache at least one plan. The
+    // evicted entries are only destroyed once they have been logged, so their sizes are not yet
+    // released from the global estimate and must be discounted here.
+    const auto maxTotalSizeBytes = internalQueryCacheMaxTotalSizeBytes.load();
+    if (maxTotalSizeBytes > 0) {
+        long long totalSizeBytes = PlanCacheEntry::planCacheTotalSizeEstimateBytes.get();
+        for (auto&& evictedEntry : evictedEntries) {
+            totalSizeBytes -= evictedEntry->estimateObjectSizeInBytes();
+        }
+        while (_cache.size() > 1 && totalSizeBytes > maxTotalSizeBytes) {
+            evictedEntries.push_back(_cache.evictLeastRecentlyUsed());
+            totalSizeBytes -= evictedEntries.back()->estimateObjectSizeInBytes();
+        }
+    }
 
-    if (nullptr != evictedEntry.get()) {
+    for (auto&& evictedEntry : evictedEntries) {
         LOGV2_DEBUG(20942,
                     1,
                     "Plan cache maximum size exceeded - removed least recently used entry",
                     "namespace"_attr = query.nss(),
                     "evictedEntry"_attr = redact(evictedEntry->debugString()));
     }
+    recordEvictions(evictedEntries);
 
     return Status::OK();
 }
@@ -675,6 +913,24 @@ PlanCache::GetResult PlanCache::get(const PlanCacheKey& key) const {
     return {state, std::make_unique<CachedSolution>(*entry)};
 }
 
+void PlanCache::setExecutablePlan(const PlanCacheKey& key,
+                                  std::shared_ptr<const CachedExecutablePlan> plan) {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry = nullptr;
+    if (_cache.get(key, &entry).isOK()) {
+        entry->executablePlan = std::move(plan);
+    }
+}
+
+void PlanCache::recordExecutablePlanHit(const PlanCacheKey& key, Microseconds timeSaved) {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry = nullptr;
+    if (_cache.get(key, &entry).isOK()) {
+        ++entry->executablePlanHits;
+        entry->executablePlanTimeSaved += timeSaved;
+    }
+}
+
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
     stdx::lock_guard<Latch> cacheLock(_cacheMutex);
     return _cache.remove(computeKey(canonicalQuery));
@@ -720,11 +976,96 @@ std::vector<std::unique_ptr<PlanCacheEntry>> PlanCache::getAllEntries() const {
     return entries;
 }
 
+std::vector<BSONObj> PlanCache::serializeEntries() const {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    std::vector<BSONObj> entries;
+
+    for (auto&& [key, entry] : _cache) {
+        const auto stableKey = key.getStableKeyStringData();
+        const auto indexability = key.getIndexabilityDiscriminators();
+
+        BSONObjBuilder bob;
+        bob.appendBinData("stableKey", stableKey.size(), BinDataGeneral, stableKey.rawData());
+        bob.appendBinData(
+            "indexability", indexability.size(), BinDataGeneral, indexability.rawData());
+        bob.append("forceClassicEngine", key.forceClassicQueryEngine());
+        bob.append("isActive", entry->isActive);
+        bob.append("works", static_cast<long long>(entry->works));
+        bob.append("plannerData", entry->plannerData->toBSON());
+        entries.push_back(bob.obj());
+    }
+
+    return entries;
+}
+
+Status PlanCache::restoreEntry(const BSONObj& serializedEntry,
+                               const std::vector<IndexEntry>& indexes,
+                               Date_t now) {
+    const auto stableKey = serializedEntry["stableKey"];
+    const auto indexability = serializedEntry["indexability"];
+    const auto plannerDataElem = serializedEntry["plannerData"];
+    if (stableKey.type() != BSONType::BinData || indexability.type() != BSONType::BinData ||
+        plannerDataElem.type() != BSONType::Object) {
+        return Status(ErrorCodes::FailedToParse, "malformed plan cache snapshot entry");
+    }
+
+    auto swPlannerData = SolutionCacheData::parse(plannerDataElem.embeddedObject(), indexes);
+    if (!swPlannerData.isOK()) {
+        return swPlannerData.getStatus();
+    }
+
+    int len;
+    const char* data = stableKey.binData(len);
+    CanonicalQuery::QueryShapeString shapeString(data, len);
+    data = indexability.binData(len);
+    PlanCacheKey key(std::move(shapeString),
+                     std::string(data, len),
+                     serializedEntry["forceClassicEngine"].trueValue());
+
+    auto newEntry = PlanCacheEntry::createFromSnapshot(
+        std::move(swPlannerData.getValue()),
+        canonical_query_encoder::computeHash(key.getStableKeyStringData()),
+        canonical_query_encoder::computeHash(key.stringData()),
+        now,
+        serializedEntry["isActive"].trueValue(),
+        serializedEntry["works"].safeNumberLong());
+
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    PlanCacheEntry* existingEntry = nullptr;
+    if (_cache.get(key, &existingEntry).isOK()) {
+        // An entry planned since startup is more accurate than the restored one.
+        return Status::OK();
+    }
+    recordEvictions(_cache.add(key, newEntry.release()));
+    return Status::OK();
+}
+
 size_t PlanCache::size() const {
     stdx::lock_guard<Latch> cacheLock(_cacheMutex);
     return _cache.size();
 }
 
+PlanCache::Stats PlanCache::getStats() const {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    Stats stats;
+    stats.numEntries = _cache.size();
+    stats.estimatedSizeBytes = _cache.budget();
+    stats.maxSizeBytes = _cache.maxBudget();
+    stats.numEvictedEntries = _numEvictedEntries;
+    stats.evictedBytes = _evictedBytes;
+    return stats;
+}
+
+void PlanCache::recordEvictions(
+    const std::vector<std::unique_ptr<PlanCacheEntry>>& evictedEntries) {
+    for (auto&& evictedEntry : evictedEntries) {
+        ++_numEvictedEntries;
+        _evictedBytes += evictedEntry->estimateObjectSizeInBytes();
+        planCacheTotalEvictedEntries.increment();
+        planCacheTotalEvictedBytes.increment(evictedEntry->estimateObjectSizeInBytes());
+    }
+}
+
 void PlanCache::notifyOfIndexUpdates(const std::vector<CoreIndexInfo>& indexCores) {
     _indexabilityState.updateDiscriminators(indexCores);
 }
@@ -51,7 +51,8 @@ class PlanCacheKey {
 public:
     PlanCacheKey(CanonicalQuery::QueryShapeString shapeString,
                  std::string indexabilityString,
-                 bool forceClassicQueryEngine) {
+                 bool forceClassicQueryEngine)
+        : _forceClassicQueryEngine(forceClassicQueryEngine) {
         _lengthOfStablePart = shapeString.size();
         _key = std::move(shapeString);
         _key += indexabilityString;
@@ -82,6 +83,13 @@ public:
         return StringData(_key.c_str() + _lengthOfStablePart, _key.size() - _lengthOfStablePart);
     }
 
+    /**
+     * Returns true if this key belongs to a query which must run in the classic engine.
+     */
+    bool forceClassicQueryEngine() const {
+        return _forceClassicQueryEngine;
+    }
+
     StringData stringData() const {
         return _key;
     }
@@ -90,6 +98,13 @@ public:
         return _key;
     }
 
+    /**
+     * Returns an estimate of the size of this key, including the memory it owns, in bytes.
+     */
+    uint64_t estimateObjectSizeInBytes() const {
+        return sizeof(*this) + _key.size();
+    }
+
     bool operator==(const PlanCacheKey& other) const {
         return other._key == _key && other._lengthOfStablePart == _lengthOfStablePart;
     }
@@ -108,6 +123,9 @@ private:
 
     // How long the "stable key" is.
     size_t _lengthOfStablePart;
+
+    // The third part of the key.
+    bool _forceClassicQueryEngine;
 };
 
 std::ostream& operator<<(std::ostream& stream, const PlanCacheKey& key);
@@ -191,6 +209,20 @@ struct PlanCacheIndexTree {
      */
     std::string toString(int indents = 0) const;
 
+    /**
+     * Serializes this tree for a plan cache snapshot. Indexes are identified by their name and key
+     * pattern.
+     */
+    BSONObj toBSON() const;
+
+    /**
+     * Parses a tree serialized by toBSON(). The indexes it refers to are looked up by name in
+     * 'indexes', which describes the current indexes of the collection. Fails if one of them no
+     * longer exists or has a different key pattern.
+     */
+    static StatusWith<std::unique_ptr<PlanCacheIndexTree>> parse(
+        const BSONObj& obj, const std::vector<IndexEntry>& indexes);
+
     uint64_t estimateObjectSizeInBytes() const {
         return  // Recursively add size of each element in 'children' vector.
             container_size_helper::estimateObjectSizeInBytes(
@@ -241,6 +273,13 @@ struct SolutionCacheData {
     // For debugging.
     std::string toString() const;
 
+    /**
+     * Serializes and parses the cache data for a plan cache snapshot, see PlanCacheIndexTree.
+     */
+    BSONObj toBSON() const;
+    static StatusWith<std::unique_ptr<SolutionCacheData>> parse(
+        const BSONObj& obj, const std::vector<IndexEntry>& indexes);
+
     uint64_t estimateObjectSizeInBytes() const {
         return (tree ? tree->estimateObjectSizeInBytes() : 0) + sizeof(*this);
     }
@@ -262,7 +301,11 @@ struct SolutionCacheData {
 
         // Build the solution by using 'tree'
         // to tag the match expression.
-        USE_INDEX_TAGS_SOLN
+        USE_INDEX_TAGS_SOLN,
+
+        // The cached plan is a skip scan of the
+        // index stored in 'tree'.
+        SKIP_SCAN_SOLN
     } solnType;
 
     // The direction of the index scan used as
@@ -276,6 +319,16 @@ struct SolutionCacheData {
 
 class PlanCacheEntry;
 
+/**
+ * An executable plan tree built from the solution held by a plan cache entry. Later queries with
+ * the same shape may copy it instead of building a new tree. The plan cache does not interpret the
+ * contents, which are owned by the execution engine that built the tree.
+ */
+class CachedExecutablePlan {
+public:
+    virtual ~CachedExecutablePlan() = default;
+};
+
 /**
  * Information returned from a get(...) query.
  */
@@ -293,6 +346,9 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     const size_t decisionWorks;
+
+    // The executable plan tree attached to the cache entry, if any.
+    const std::shared_ptr<const CachedExecutablePlan> executablePlan;
 };
 
 /**
@@ -368,6 +424,18 @@ public:
         bool isActive,
         size_t works);
 
+    /**
+     * Create a PlanCacheEntry from the planner data of an entry restored from a snapshot. Such an
+     * entry has no debug info.
+     */
+    static std::unique_ptr<PlanCacheEntry> createFromSnapshot(
+        std::unique_ptr<const SolutionCacheData> plannerData,
+        uint32_t queryHash,
+        uint32_t planCacheKey,
+        Date_t timeOfCreation,
+        bool isActive,
+        size_t works);
+
     ~PlanCacheEntry();
 
     /**
@@ -377,6 +445,14 @@ public:
 
     std::string debugString() const;
 
+    /**
+     * Returns the estimate of the size of this entry computed when it was created, see
+     * 'estimatedEntrySizeBytes'.
+     */
+    uint64_t estimateObjectSizeInBytes() const {
+        return estimatedEntrySizeBytes;
+    }
+
     // Data provided to the planner to allow it to recreate the solution this entry represents. In
     // order to return it from the cache for consumption by the 'QueryPlanner', a deep copy is made
     // and returned inside 'CachedSolution'.
@@ -409,6 +485,14 @@ public:
     // debug info is omitted from new plan cache entries.
     const boost::optional<DebugInfo> debugInfo;
 
+    // The executable plan tree most recently built from this entry's solution, if any.
+    std::shared_ptr<const CachedExecutablePlan> executablePlan;
+
+    // The number of times 'executablePlan' was copied instead of building a new plan tree, and the
+    // total time this is estimated to have saved.
+    size_t executablePlanHits = 0;
+    Microseconds executablePlanTimeSaved{0};
+
     // An estimate of the size in bytes of this plan cache entry. This is the "deep size",
     // calculated by recursively incorporating the size of owned objects, the objects that they in
     // turn own, and so on.
@@ -438,6 +522,16 @@ private:
     uint64_t _estimateObjectSizeInBytes() const;
 };
 
+/**
+ * Charges each plan cache entry its estimated size in bytes, including both copies of its key
+ * held by the LRU store.
+ */
+struct PlanCacheBudgetEstimator {
+    size_t operator()(const PlanCacheKey& key, const PlanCacheEntry& entry) const {
+        return 2 * key.estimateObjectSizeInBytes() + entry.estimateObjectSizeInBytes();
+    }
+};
+
 /**
  * Caches the best solution to a query.  Aside from the (CanonicalQuery -> QuerySolution)
  * mapping, the cache contains information on why that mapping was made and statistics on the
@@ -476,6 +570,23 @@ public:
         std::unique_ptr<CachedSolution> cachedSolution;
     };
 
+    /**
+     * The size of the cache and the entries it has evicted, see getStats().
+     */
+    struct Stats {
+        size_t numEntries = 0;
+        size_t estimatedSizeBytes = 0;
+        size_t maxSizeBytes = 0;
+        size_t numEvictedEntries = 0;
+        size_t evictedBytes = 0;
+    };
+
+    /**
+     * Track the number and the estimated size of the entries evicted from all the plan caches.
+     */
+    inline static Counter64 planCacheTotalEvictedEntries;
+    inline static Counter64 planCacheTotalEvictedBytes;
+
     /**
      * We don't want to cache every possible query. This function
      * encapsulates the criteria for what makes a canonical query
@@ -488,7 +599,10 @@ public:
      */
     PlanCache();
 
-    PlanCache(size_t size);
+    /**
+     * Creates a cache of at most 'size' entries, whose estimated size is at most 'maxSizeBytes'.
+     */
+    PlanCache(size_t size, size_t maxSizeBytes = std::numeric_limits<size_t>::max());
 
     ~PlanCache();
 
@@ -504,7 +618,10 @@ public:
      * an inactive cache entry.  If boost::none is provided, the function will use
      * 'internalQueryCacheWorksGrowthCoefficient'.
      *
-     * If the mapping was set successfully, returns Status::OK(), even if it evicted another entry.
+     * Least recently used entries are evicted to keep this cache within its maximum number of
+     * entries and size, and to keep the estimated size of all the plan caches of the server within
+     * 'internalQueryCacheMaxTotalSizeBytes'. If the mapping was set successfully, returns
+     * Status::OK(), even if it evicted other entries.
      */
     Status set(const CanonicalQuery& query,
                const std::vector<QuerySolution*>& solns,
@@ -543,6 +660,20 @@ public:
      */
     std::unique_ptr<CachedSolution> getCacheEntryIfActive(const PlanCacheKey& key) const;
 
+    /**
+     * Attaches 'plan', an executable plan tree built from the cached solution for 'key', to the
+     * corresponding cache entry, replacing any plan attached to it earlier. Does nothing if there
+     * is no entry for 'key'.
+     */
+    void setExecutablePlan(const PlanCacheKey& key,
+                           std::shared_ptr<const CachedExecutablePlan> plan);
+
+    /**
+     * Records that the executable plan attached to the cache entry for 'key' was copied instead of
+     * building a new plan tree, which is estimated to have saved 'timeSaved'.
+     */
+    void recordExecutablePlanHit(const PlanCacheKey& key, Microseconds timeSaved);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -584,6 +715,12 @@ public:
      */
     size_t size() const;
 
+    /**
+     * Returns the number of entries and the estimated size of this cache, and the number and size
+     * of the entries it has evicted since it was created.
+     */
+    Stats getStats() const;
+
     /**
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
@@ -592,6 +729,29 @@ public:
      */
     void notifyOfIndexUpdates(const std::vector<CoreIndexInfo>& indexCores);
 
+    /**
+     * Serializes every entry of the cache for a snapshot, see restoreEntry(). Only the data needed
+     * to plan from an entry is kept: its key, its SolutionCacheData and its 'works' value.
+     */
+    std::vector<BSONObj> serializeEntries() const;
+
+    /**
+     * Adds an entry serialized by serializeEntries() to the cache, unless the cache already has an
+     * entry for its key. 'indexes' describes the current indexes of the collection, and the entry
+     * is rejected if any index it refers to no longer matches.
+     */
+    Status restoreEntry(const BSONObj& serializedEntry,
+                        const std::vector<IndexEntry>& indexes,
+                        Date_t now);
+
+    /**
+     * Returns true the first time it is called on this cache, false afterwards. Used to restore
+     * the cache from its snapshot at most once.
+     */
+    bool claimSnapshotRestore() {
+        return !_snapshotRestoreClaimed.swap(true);
+    }
+
     /**
      * Iterates over the plan cache. For each entry, serializes the PlanCacheEntry according to
      * 'serializationFunc'. Returns a vector of all serialized entries which match 'filterFunc'.
@@ -613,16 +773,26 @@ private:
                                    size_t newWorks,
                                    double growthCoefficient);
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher> _cache;
+    /**
+     * Accounts for entries evicted from '_cache'. Must be called with '_cacheMutex' held.
+     */
+    void recordEvictions(const std::vector<std::unique_ptr<PlanCacheEntry>>& evictedEntries);
+
+    LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher, PlanCacheBudgetEstimator> _cache;
 
-    // Protects _cache.
+    // Protects _cache and the eviction counters.
     mutable Mutex _cacheMutex = MONGO_MAKE_LATCH("PlanCache::_cacheMutex");
 
+    size_t _numEvictedEntries = 0;
+    size_t _evictedBytes = 0;
+
     // Holds computed information about the collection's indexes.  Used for generating plan
     // cache keys.
     //
     // Concurrent access is synchronized by the collection lock.  Multiple concurrent readers
     // are allowed.
     PlanCacheIndexabilityState _indexabilityState;
+
+    AtomicWord<bool> _snapshotRestoreClaimed{false};
 };
 }  // namespace mongo
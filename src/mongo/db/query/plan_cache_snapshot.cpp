@@ -0,0 +1,216 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/ops/write_ops.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/logv2/log.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/version.h"
+
+namespace mongo::plan_cache_snapshot {
+namespace {
+// Leaves room for the other fields of the snapshot document and for the update command wrapping
+// it.
+constexpr int kMaxSnapshotEntriesBytes = BSONObjMaxUserSize - 16 * 1024;
+
+// The version of the layout of the snapshot entries. A snapshot is only restored by a server of the
+// same version which wrote it, since the encoding of the plan cache keys may change between server
+// versions too.
+constexpr int kSnapshotVersion = 1;
+
+// Restores run on a single background thread, so that the queries which trigger them do not wait
+// for them, and a burst of first queries after startup does not read many snapshots at once.
+std::unique_ptr<ThreadPool> restoreThreadPool;
+MONGO_INITIALIZER(PlanCacheSnapshotRestoreThreadPool)(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "PlanCacheSnapshotRestoreThreadPool";
+    options.threadNamePrefix = "PlanCacheRestore";
+    options.minThreads = 0;
+    options.maxThreads = 1;
+    options.onCreateThread = [](const std::string& name) {
+        Client::initThread(name);
+        AuthorizationSession::get(cc())->grantInternalAuthorization(&cc());
+    };
+    restoreThreadPool = std::make_unique<ThreadPool>(options);
+    restoreThreadPool->startup();
+}
+}  // namespace
+
+size_t save(OperationContext* opCtx, const NamespaceString& nss) {
+    // The snapshot is built under a read lock of the collection, which must be released before
+    // the snapshot is written.
+    BSONObj snapshot;
+    size_t numEntries = 0;
+    {
+        AutoGetCollectionForRead autoColl(opCtx, nss);
+        const auto& collection = autoColl.getCollection();
+        if (!collection) {
+            return 0;
+        }
+        const auto entries =
+            CollectionQueryInfo::get(collection).getPlanCache()->serializeEntries();
+
+        // The entries come in most recently used order, so it is the coldest ones which are left
+        // out of a snapshot which would not fit in a document.
+        BSONObjBuilder snapshotBuilder;
+        collection->uuid().appendToBuilder(&snapshotBuilder, "_id");
+        snapshotBuilder.append("ns", nss.ns());
+        snapshotBuilder.append("version", kSnapshotVersion);
+        snapshotBuilder.append("serverVersion", VersionInfoInterface::instance().version());
+        BSONArrayBuilder entriesBuilder(snapshotBuilder.subarrayStart("entries"));
+        int entriesBytes = 0;
+        for (auto&& entry : entries) {
+            entriesBytes += entry.objsize();
+            if (entriesBytes > kMaxSnapshotEntriesBytes) {
+                break;
+            }
+            entriesBuilder.append(entry);
+            ++numEntries;
+        }
+        entriesBuilder.doneFast();
+        snapshot = snapshotBuilder.obj();
+    }
+
+    DBDirectClient client(opCtx);
+    auto commandResponse = client.runCommand([&] {
+        write_ops::UpdateCommandRequest updateOp(NamespaceString::kPlanCacheSnapshotsNamespace);
+        write_ops::UpdateOpEntry updateEntry(
+            BSON("_id" << snapshot["_id"]),
+            write_ops::UpdateModification::parseFromClassicUpdate(snapshot));
+        updateEntry.setUpsert(true);
+        updateOp.setUpdates({updateEntry});
+        return updateOp.serialize({});
+    }());
+    uassertStatusOK(getStatusFromWriteCommandReply(commandResponse->getCommandReply()));
+
+    LOGV2_DEBUG(5999200,
+                1,
+                "Saved plan cache snapshot",
+                "namespace"_attr = nss,
+                "numEntries"_attr = numEntries);
+    return numEntries;
+}
+
+void scheduleRestore(const CollectionPtr& collection) {
+    restoreThreadPool->schedule([uuid = collection->uuid()](auto status) {
+        if (!status.isOK()) {
+            return;
+        }
+
+        auto opCtx = cc().makeOperationContext();
+        try {
+            const auto numRestored = restore(opCtx.get(), uuid);
+            LOGV2_DEBUG(5999201,
+                        1,
+                        "Restored plan cache from snapshot",
+                        "collectionUUID"_attr = uuid,
+                        "numEntries"_attr = numRestored);
+        } catch (const DBException& ex) {
+            // The cache is only warmed up on a best-effort basis; queries plan as usual without
+            // it.
+            LOGV2_WARNING(5999202,
+                          "Failed to restore plan cache from snapshot",
+                          "collectionUUID"_attr = uuid,
+                          "error"_attr = redact(ex.toStatus()));
+        }
+    });
+}
+
+size_t restore(OperationContext* opCtx, const UUID& collectionUUID) {
+    DBDirectClient client(opCtx);
+    const auto snapshot = client.findOne(NamespaceString::kPlanCacheSnapshotsNamespace.ns(),
+                                         BSON("_id" << collectionUUID),
+                                         nullptr,
+                                         QueryOption_SecondaryOk);
+    if (snapshot.isEmpty()) {
+        return 0;
+    }
+
+    if (snapshot["version"].numberInt() != kSnapshotVersion ||
+        snapshot["serverVersion"].str() != VersionInfoInterface::instance().version()) {
+        LOGV2_DEBUG(5999210,
+                    1,
+                    "Skipping plan cache snapshot written by another version",
+                    "collectionUUID"_attr = collectionUUID,
+                    "version"_attr = snapshot["version"],
+                    "serverVersion"_attr = snapshot["serverVersion"]);
+        return 0;
+    }
+
+    const NamespaceString nss(snapshot["ns"].str());
+    AutoGetCollectionForRead autoColl(opCtx, {nss.db().toString(), collectionUUID});
+    const auto& collection = autoColl.getCollection();
+    if (!collection) {
+        return 0;
+    }
+
+    // Entries are checked against the indexes the planner could use now. A plan referring to an
+    // index which was dropped, hidden or rebuilt with another key pattern is not restored.
+    std::vector<IndexEntry> indexes;
+    auto ii = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (ii->more()) {
+        const IndexCatalogEntry* ice = ii->next();
+        if (ice->descriptor()->hidden()) {
+            continue;
+        }
+        indexes.push_back(indexEntryFromIndexCatalogEntry(opCtx, *ice));
+    }
+
+    auto planCache = CollectionQueryInfo::get(collection).getPlanCache();
+    const auto now = opCtx->getServiceContext()->getPreciseClockSource()->now();
+    size_t numRestored = 0;
+    for (auto&& entry : snapshot["entries"].Obj()) {
+        auto status = planCache->restoreEntry(entry.Obj(), indexes, now);
+        if (!status.isOK()) {
+            LOGV2_DEBUG(5999203,
+                        2,
+                        "Skipping plan cache snapshot entry",
+                        logAttrs(*collection.get()),
+                        "error"_attr = status);
+            continue;
+        }
+        ++numRestored;
+    }
+    return numRestored;
+}
+}  // namespace mongo::plan_cache_snapshot
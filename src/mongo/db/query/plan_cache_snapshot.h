@@ -0,0 +1,68 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/catalog/collection.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Snapshots of plan caches, so that a node does not start with an empty plan cache after a restart
+ * or a failover. A snapshot holds what is needed to plan from each cache entry of a collection,
+ * see PlanCache::serializeEntries(), and is stored in one document of
+ * 'config.planCacheSnapshots' keyed by the collection UUID. That collection is replicated, so a
+ * secondary can warm its cache from the snapshot of its primary. Each snapshot records the format
+ * and server version which wrote it, and a snapshot written by another version is never restored.
+ */
+namespace plan_cache_snapshot {
+/**
+ * Replaces the snapshot of the plan cache of the collection 'nss' with its current contents, and
+ * returns the number of entries saved. If the cache is too large for one document, only its most
+ * recently used entries are kept. Must not be called with any lock held.
+ */
+size_t save(OperationContext* opCtx, const NamespaceString& nss);
+
+/**
+ * Restores the plan cache of 'collection' from its snapshot in the background. Entries which
+ * refer to indexes which no longer exist or have changed are dropped, and entries already planned
+ * since startup are kept. Called on the first query of the collection which consults its plan
+ * cache when 'internalQueryPlanCacheRestoreFromSnapshot' is enabled.
+ */
+void scheduleRestore(const CollectionPtr& collection);
+
+/**
+ * Restores the plan cache of the collection with the given UUID from its snapshot. Returns the
+ * number of entries restored. Must not be called with any lock held.
+ */
+size_t restore(OperationContext* opCtx, const UUID& collectionUUID);
+}  // namespace plan_cache_snapshot
+}  // namespace mongo
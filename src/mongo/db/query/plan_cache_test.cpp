@@ -600,6 +600,89 @@ TEST(PlanCacheTest, PlanCacheLRUPolicyRemovesInactiveEntries) {
     ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
 }
 
+TEST(PlanCacheTest, PlanCacheLRUPolicyEvictsEntriesOverSizeBudget) {
+    QueryTestServiceContext serviceContext;
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+
+    // Measure an entry, then allow a cache of many entries to hold only two of them.
+    size_t entrySizeBytes;
+    {
+        PlanCache planCache;
+        addCacheEntryForShape(*cqA, &planCache);
+        entrySizeBytes = planCache.getStats().estimatedSizeBytes;
+        ASSERT_GT(entrySizeBytes, 0U);
+    }
+    PlanCache planCache(5000, 2 * entrySizeBytes + entrySizeBytes / 2);
+
+    addCacheEntryForShape(*cqA, &planCache);
+    addCacheEntryForShape(*cqB, &planCache);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_EQ(planCache.getStats().numEvictedEntries, 0U);
+
+    // The {b: 1} entry is the least recently used, so it is evicted to make room for {c: 1}.
+    addCacheEntryForShape(*cqC, &planCache);
+    ASSERT_EQ(planCache.get(*cqB).state, PlanCache::CacheEntryState::kNotPresent);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
+
+    auto stats = planCache.getStats();
+    ASSERT_EQ(stats.numEntries, 2U);
+    ASSERT_LTE(stats.estimatedSizeBytes, stats.maxSizeBytes);
+    ASSERT_EQ(stats.numEvictedEntries, 1U);
+    ASSERT_GT(stats.evictedBytes, 0U);
+
+    // Removing entries releases their budget.
+    planCache.clear();
+    ASSERT_EQ(planCache.getStats().estimatedSizeBytes, 0U);
+}
+
+TEST(PlanCacheTest, PlanCacheLRUPolicyEvictsOnlyEnoughEntriesOverTotalSizeBudget) {
+    QueryTestServiceContext serviceContext;
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+    unique_ptr<CanonicalQuery> cqD(canonicalize("{d: 1}"));
+
+    // Measure an entry in the global size estimate, then allow all the plan caches together to
+    // hold only two more entries.
+    const auto baselineSizeBytes = PlanCacheEntry::planCacheTotalSizeEstimateBytes.get();
+    long long entrySizeBytes;
+    {
+        PlanCache planCache;
+        addCacheEntryForShape(*cqA, &planCache);
+        entrySizeBytes = PlanCacheEntry::planCacheTotalSizeEstimateBytes.get() - baselineSizeBytes;
+        ASSERT_GT(entrySizeBytes, 0);
+    }
+
+    RAIIServerParameterControllerForTest controller{
+        "internalQueryCacheMaxTotalSizeBytes",
+        baselineSizeBytes + 2 * entrySizeBytes + entrySizeBytes / 2};
+
+    PlanCache planCache;
+    addCacheEntryForShape(*cqA, &planCache);
+    addCacheEntryForShape(*cqB, &planCache);
+    ASSERT_EQ(planCache.size(), 2U);
+    ASSERT_EQ(planCache.getStats().numEvictedEntries, 0U);
+
+    // Only the least recently used {a: 1} entry is evicted to make room for {c: 1}.
+    addCacheEntryForShape(*cqC, &planCache);
+    ASSERT_EQ(planCache.size(), 2U);
+    ASSERT_EQ(planCache.getStats().numEvictedEntries, 1U);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kNotPresent);
+    ASSERT_EQ(planCache.get(*cqB).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
+
+    // Looking up {b: 1} made {c: 1} the least recently used entry.
+    addCacheEntryForShape(*cqD, &planCache);
+    ASSERT_EQ(planCache.size(), 2U);
+    ASSERT_EQ(planCache.getStats().numEvictedEntries, 2U);
+    ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kNotPresent);
+    ASSERT_EQ(planCache.get(*cqB).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_EQ(planCache.get(*cqD).state, PlanCache::CacheEntryState::kPresentInactive);
+}
+
 TEST(PlanCacheTest, PlanCacheRemoveDeletesInactiveEntries) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -858,6 +941,36 @@ TEST(PlanCacheTest, DeactivateCacheEntry) {
     ASSERT_EQ(entry->works, 20U);
 }
 
+TEST(PlanCacheTest, ExecutablePlanIsReturnedWithCachedSolutionAndTracksHits) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U), Date_t{}));
+
+    auto key = planCache.computeKey(*cq);
+    ASSERT_FALSE(planCache.get(key).cachedSolution->executablePlan);
+
+    auto plan = std::make_shared<CachedExecutablePlan>();
+    planCache.setExecutablePlan(key, plan);
+    ASSERT_EQ(planCache.get(key).cachedSolution->executablePlan, plan);
+
+    planCache.recordExecutablePlanHit(key, Microseconds{10});
+    planCache.recordExecutablePlanHit(key, Microseconds{5});
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->executablePlan, plan);
+    ASSERT_EQ(entry->executablePlanHits, 2U);
+    ASSERT_EQ(entry->executablePlanTimeSaved, Microseconds{15});
+
+    // Removing the entry drops the executable plan along with it.
+    ASSERT_OK(planCache.remove(*cq));
+    planCache.setExecutablePlan(key, plan);
+    planCache.recordExecutablePlanHit(key, Microseconds{10});
+    ASSERT_EQ(planCache.get(key).state, PlanCache::CacheEntryState::kNotPresent);
+    ASSERT_EQ(plan.use_count(), 1);
+}
+
 TEST(PlanCacheTest, GetMatchingStatsMatchesAndSerializesCorrectly) {
     PlanCache planCache;
 
@@ -1470,6 +1583,51 @@ TEST_F(CachePlanSelectionTest, AndWithOrWithOneIndex) {
                                     "node: {ixscan: {filter: null, pattern: {a: 1}}}}}");
 }
 
+TEST_F(CachePlanSelectionTest, CacheDataSurvivesSnapshotRoundTrip) {
+    addIndex(BSON("a" << 1), "a_1");
+    addIndex(BSON("b" << 1), "b_1");
+    BSONObj query = fromjson("{$or: [{a: 1}, {b: 1}]}");
+    runQuery(query);
+
+    const std::string solnJson =
+        "{fetch: {filter: null, node: {or: {nodes: ["
+        "{ixscan: {filter: null, pattern: {a: 1}}}, {ixscan: {filter: null, pattern: {b: 1}}}]}}}}";
+    const auto serialized = firstMatchingSolution(solnJson)->cacheData->toBSON();
+
+    QuerySolution restoredSoln{QueryPlannerParams::Options::DEFAULT};
+    auto swCacheData = SolutionCacheData::parse(serialized, params.indices);
+    ASSERT_OK(swCacheData.getStatus());
+    restoredSoln.cacheData = std::move(swCacheData.getValue());
+    auto planSoln = planQueryFromCache(query, BSONObj(), BSONObj(), BSONObj(), restoredSoln);
+    assertSolutionMatches(planSoln.get(), solnJson);
+
+    // The cache data is rejected once one of its indexes is dropped or changes.
+    std::vector<IndexEntry> indexes = params.indices;
+    indexes.pop_back();
+    ASSERT_EQ(SolutionCacheData::parse(serialized, indexes).getStatus(),
+              ErrorCodes::IndexNotFound);
+    indexes.push_back(params.indices.back());
+    indexes.back().keyPattern = BSON("b" << -1);
+    ASSERT_EQ(SolutionCacheData::parse(serialized, indexes).getStatus(),
+              ErrorCodes::IndexKeySpecsConflict);
+}
+
+TEST_F(CachePlanSelectionTest, SkipScan) {
+    CollectionStatistics::Builder builder({"a"}, CollectionStatistics::kDefaultNumBuckets);
+    for (int i = 0; i < 10; ++i) {
+        builder.addDocument(BSON("a" << i % 2));
+    }
+    params.collectionStats = std::make_shared<const CollectionStatistics>(builder.done(10, {}));
+    addIndex(BSON("a" << 1 << "b" << 1), "a_1_b_1");
+
+    BSONObj query = fromjson("{b: {$in: [1, 2]}}");
+    runQuery(query);
+    assertPlanCacheRecoversSolution(
+        query,
+        "{fetch: {filter: {b: {$in: [1, 2]}}, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[1,1,true,true], [2,2,true,true]]}}}}}");
+}
+
 //
 // Sort orders
 //
@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo::plan_cost_estimator {
+namespace {
+bool isAllValues(const OrderedIntervalList& oil) {
+    return oil.intervals.size() == 1 &&
+        (oil.intervals[0].isMinToMax() || oil.intervals[0].isMaxToMin());
+}
+
+boost::optional<Estimate> estimateIndexScan(const IndexScanNode& node,
+                                            const CollectionStatistics& stats) {
+    // Histograms hold values as they are in documents, which cannot be compared with the bounds
+    // of special or collated indexes.
+    if (node.index.type != INDEX_BTREE || node.index.collator || node.bounds.isSimpleRange) {
+        return boost::none;
+    }
+
+    // The fields of the key pattern are assumed to be independent. A field after a range only
+    // narrows the keys which are returned, not the keys which are examined, so it is left out.
+    // Unconstrained leading fields make a skip scan, which seeks to the bounds of the following
+    // fields once for each distinct value of the leading fields.
+    double selectivity = 1;
+    double numSeeks = 1;
+    size_t fieldNo = 0;
+    BSONObjIterator it(node.index.keyPattern);
+    for (; it.more() && isAllValues(node.bounds.fields[fieldNo]); ++fieldNo) {
+        const auto fieldStats = stats.getField(it.next().fieldNameStringData());
+        if (!fieldStats) {
+            return boost::none;
+        }
+        numSeeks *= std::max(1.0, fieldStats->numDistinct);
+    }
+    if (!it.more()) {
+        const double numKeys = stats.getNumDocs();
+        return Estimate{numKeys, numKeys};
+    }
+
+    const size_t firstConstrainedFieldNo = fieldNo;
+    while (it.more()) {
+        const auto elem = it.next();
+        const auto& oil = node.bounds.fields[fieldNo];
+        const auto fieldSelectivity = stats.estimateSelectivity(elem.fieldNameStringData(), oil);
+        if (!fieldSelectivity) {
+            if (fieldNo == firstConstrainedFieldNo) {
+                return boost::none;
+            }
+            break;
+        }
+        selectivity *= *fieldSelectivity;
+
+        const bool allPoints =
+            std::all_of(oil.intervals.begin(), oil.intervals.end(), [](const Interval& interval) {
+                return interval.isPoint();
+            });
+        if (!allPoints) {
+            break;
+        }
+        ++fieldNo;
+    }
+
+    const double numKeys = stats.getNumDocs() * selectivity;
+    const double skipScanSeeks = firstConstrainedFieldNo > 0 ? 2 * numSeeks : 0;
+    return Estimate{numKeys + skipScanSeeks, numKeys};
+}
+
+boost::optional<Estimate> estimateNode(const QuerySolutionNode* node,
+                                       const CollectionStatistics& stats) {
+    std::vector<Estimate> children;
+    for (auto&& child : node->children) {
+        auto childEstimate = estimateNode(child, stats);
+        if (!childEstimate) {
+            return boost::none;
+        }
+        children.push_back(*childEstimate);
+    }
+
+    switch (node->getType()) {
+        case STAGE_COLLSCAN:
+            return Estimate{static_cast<double>(stats.getNumDocs()),
+                            static_cast<double>(stats.getNumDocs())};
+        case STAGE_IXSCAN:
+            return estimateIndexScan(*static_cast<const IndexScanNode*>(node), stats);
+        case STAGE_FETCH:
+            // Each key of the child costs a document fetch.
+            return Estimate{children[0].cost + children[0].output, children[0].output};
+        case STAGE_OR:
+        case STAGE_SORT_MERGE: {
+            Estimate estimate;
+            for (auto&& child : children) {
+                estimate.cost += child.cost;
+                estimate.output += child.output;
+            }
+            return estimate;
+        }
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED: {
+            Estimate estimate;
+            estimate.output = children[0].output;
+            for (auto&& child : children) {
+                estimate.cost += child.cost;
+                estimate.output = std::min(estimate.output, child.output);
+            }
+            return estimate;
+        }
+        default:
+            // Other stages only filter, reshape or reorder the results of their child, which
+            // costs about the same for every candidate plan.
+            if (children.size() == 1) {
+                return children[0];
+            }
+            return boost::none;
+    }
+}
+}  // namespace
+
+boost::optional<Estimate> estimate(const QuerySolutionNode* root,
+                                   const CollectionStatistics& stats) {
+    return estimateNode(root, stats);
+}
+
+void pruneSolutions(const CanonicalQuery& cq,
+                    const CollectionStatistics& stats,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    const double pruneRatio = internalQueryCollectionStatisticsPruneRatio.load();
+    const auto& findCommand = cq.getFindCommandRequest();
+    if (pruneRatio == 0 || !findCommand.getSort().isEmpty() || findCommand.getLimit() ||
+        findCommand.getSkip() || solutions->size() < 2) {
+        return;
+    }
+
+    std::vector<boost::optional<Estimate>> estimates;
+    boost::optional<double> minCost;
+    for (auto&& solution : *solutions) {
+        estimates.push_back(estimate(solution->root(), stats));
+        if (estimates.back() && (!minCost || estimates.back()->cost < *minCost)) {
+            minCost = estimates.back()->cost;
+        }
+    }
+    if (!minCost) {
+        return;
+    }
+
+    // A plan examining nothing is estimated to cost one, so that the ratio stays meaningful.
+    const double maxCost = std::max(1.0, *minCost) * pruneRatio;
+    size_t numKept = 0;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (estimates[i] && estimates[i]->cost > maxCost) {
+            LOGV2_DEBUG(5999204,
+                        2,
+                        "Pruning candidate plan by estimated cost",
+                        "query"_attr = redact(cq.toStringShort()),
+                        "solution"_attr = redact((*solutions)[i]->toString()),
+                        "estimatedCost"_attr = estimates[i]->cost,
+                        "minEstimatedCost"_attr = *minCost);
+            continue;
+        }
+        (*solutions)[numKept++] = std::move((*solutions)[i]);
+    }
+    solutions->resize(numKept);
+}
+}  // namespace mongo::plan_cost_estimator
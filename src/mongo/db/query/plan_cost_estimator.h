@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+/**
+ * A cost model of query solutions based on the statistics built by the 'analyze' command. The
+ * cost of a plan is the number of index keys and documents it is estimated to examine, so it is
+ * only meaningful relative to the cost of other plans for the same query.
+ */
+namespace plan_cost_estimator {
+struct Estimate {
+    // The estimated number of keys and documents examined by the plan.
+    double cost = 0;
+
+    // The estimated number of results of the plan.
+    double output = 0;
+};
+
+/**
+ * Estimates the cost of 'root' from 'stats'. Returns boost::none if the plan has a leaf which
+ * cannot be estimated, for instance an index scan whose leading field was not analyzed.
+ */
+boost::optional<Estimate> estimate(const QuerySolutionNode* root,
+                                   const CollectionStatistics& stats);
+
+/**
+ * Removes from 'solutions' the candidates whose estimated cost is more than
+ * 'internalQueryCollectionStatisticsPruneRatio' times the cost of the cheapest candidate, so that
+ * multi-planning only has to choose between plausible plans. Candidates which cannot be estimated
+ * are kept. Nothing is pruned when the query has a sort, a limit or a skip, since the cost of such
+ * plans depends on how early they can stop rather than on how much they examine.
+ */
+void pruneSolutions(const CanonicalQuery& cq,
+                    const CollectionStatistics& stats,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions);
+}  // namespace plan_cost_estimator
+}  // namespace mongo
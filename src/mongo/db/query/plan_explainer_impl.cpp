@@ -253,6 +253,17 @@ void statsToBSON(const PlanStageStats& stats,
                                   static_cast<long long>(spec->failedAnd[i]));
             }
         }
+    } else if (STAGE_CACHED_PLAN == stats.stageType) {
+        CachedPlanStats* spec = static_cast<CachedPlanStats*>(stats.specific.get());
+
+        if (verbosity >= ExplainOptions::Verbosity::kExecStats && spec->replanReason) {
+            bob->appendBool("replanned", true);
+            bob->append("replanReason", *spec->replanReason);
+            bob->appendBool("replannedMidExecution", spec->replannedMidExecution);
+            if (spec->replannedMidExecution) {
+                bob->appendNumber("dupsDropped", static_cast<long long>(spec->dupsDropped));
+            }
+        }
     } else if (STAGE_COLLSCAN == stats.stageType) {
         CollectionScanStats* spec = static_cast<CollectionScanStats*>(stats.specific.get());
         bob->append("direction", spec->direction > 0 ? "forward" : "backward");
@@ -401,6 +412,9 @@ void statsToBSON(const PlanStageStats& stats,
             bob->appendNumber("seeks", static_cast<long long>(spec->seeks));
             bob->appendNumber("dupsTested", static_cast<long long>(spec->dupsTested));
             bob->appendNumber("dupsDropped", static_cast<long long>(spec->dupsDropped));
+            if (spec->pointLookup) {
+                bob->appendBool("pointLookup", true);
+            }
         }
     } else if (STAGE_OR == stats.stageType) {
         OrStats* spec = static_cast<OrStats*>(stats.specific.get());
@@ -222,6 +222,12 @@ void statsToBSON(const sbe::PlanStageStats* stats,
     bob->appendNumber("restoreState", static_cast<long long>(stats->common.unyields));
     bob->appendNumber("isEOF", stats->common.isEOF);
 
+    // Include the VM profile if it was recorded.
+    if (stats->common.vmProfile) {
+        BSONObjBuilder vmProfileBob(bob->subobjStart("vmProfile"));
+        stats->common.vmProfile->appendToBSON(&vmProfileBob);
+    }
+
     // Include any extra debug info if present.
     bob->appendElements(stats->debugInfo);
 
@@ -138,6 +138,21 @@ std::vector<bool> canProvideSortWithMergeSort(
     return shouldReverseScan;
 }
 
+/**
+ * Returns true if a predicate over the field at position 'pos' of 'index' gives the same result
+ * when evaluated against the index keys as against the document. This holds unless the field has
+ * multikey components, in which case each key only holds one of the field's values. Indexes other
+ * than btrees, and multikey indexes without path-level multikey metadata, are assumed to be
+ * multikey on every field.
+ */
+bool canUseCoveredFilterOnField(const IndexEntry& index, size_t pos) {
+    if (!index.multikey) {
+        return true;
+    }
+    return index.type == INDEX_BTREE && pos < index.multikeyPaths.size() &&
+        index.multikeyPaths[pos].empty();
+}
+
 }  // namespace
 
 namespace mongo {
@@ -797,9 +812,10 @@ bool QueryPlannerAccess::orNeedsFetch(const ScanBuildingState* scanState) {
     } else if (scanState->loosestBounds == IndexBoundsBuilder::INEXACT_FETCH) {
         return true;
     } else {
+        // Predicates which cannot be covered by a multikey index were counted as INEXACT_FETCH by
+        // handleFilterOr().
         invariant(scanState->loosestBounds == IndexBoundsBuilder::INEXACT_COVERED);
-        const IndexEntry& index = scanState->indices[scanState->currentIndexNumber];
-        return index.multikey;
+        return false;
     }
 }
 
@@ -1542,7 +1558,7 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::_buildIndexedDataAccess(
                 isCoveredNullQuery(query, root, tag, indices, params)) {
                 return soln;
             } else if (tightness == IndexBoundsBuilder::INEXACT_COVERED &&
-                       !indices[tag->index].multikey) {
+                       canUseCoveredFilterOnField(indices[tag->index], tag->pos)) {
                 verify(nullptr == soln->filter.get());
                 soln->filter = std::move(ownedRoot);
                 return soln;
@@ -1617,6 +1633,104 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::scanWholeIndex(
     return solnRoot;
 }
 
+namespace {
+/**
+ * Returns whether 'expr' is a comparison which can bound a field of a skip scan.
+ */
+bool isSkipScanPredicate(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::MATCH_IN:
+            return true;
+        default:
+            return false;
+    }
+}
+}  // namespace
+
+std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeSkipScan(
+    const IndexEntry& index,
+    const CanonicalQuery& query,
+    const QueryPlannerParams& params,
+    size_t* prefixLengthOut) {
+    // A sparse or partial index may not hold the keys of all the matching documents, and the
+    // bounds of a collated index cannot be built for a query with another collation.
+    if (index.type != INDEX_BTREE || index.sparse || index.filterExpr ||
+        !CollatorInterface::collatorsMatch(index.collator, query.getCollator())) {
+        return nullptr;
+    }
+
+    std::vector<const MatchExpression*> predicates;
+    const MatchExpression* root = query.root();
+    if (MatchExpression::AND == root->matchType()) {
+        for (size_t i = 0; i < root->numChildren(); ++i) {
+            predicates.push_back(root->getChild(i));
+        }
+    } else {
+        predicates.push_back(root);
+    }
+
+    auto isn = std::make_unique<IndexScanNode>(index);
+    isn->addKeyMetadata = query.metadataDeps()[DocumentMetadataFields::kIndexKey];
+    isn->queryCollator = query.getCollator();
+    isn->bounds.fields.resize(index.keyPattern.nFields());
+
+    size_t prefixLength = 0;
+    bool constrained = false;
+    size_t fieldNo = 0;
+    for (auto&& elt : index.keyPattern) {
+        OrderedIntervalList* oil = &isn->bounds.fields[fieldNo++];
+        oil->name = elt.fieldName();
+
+        // The bounds of different predicates on a multikey index may hold for different elements
+        // of an array, so they can neither be intersected nor compounded. Only the first
+        // constrained field of a multikey index is bounded, by a single predicate.
+        bool fieldConstrained = false;
+        for (auto&& predicate : predicates) {
+            if (index.multikey && (constrained || fieldConstrained)) {
+                break;
+            }
+            if (!isSkipScanPredicate(predicate) ||
+                predicate->path() != elt.fieldNameStringData()) {
+                continue;
+            }
+            IndexBoundsBuilder::BoundsTightness tightness;
+            if (fieldConstrained) {
+                IndexBoundsBuilder::translateAndIntersect(predicate, elt, index, oil, &tightness);
+            } else {
+                IndexBoundsBuilder::translate(predicate, elt, index, oil, &tightness);
+            }
+            fieldConstrained = true;
+        }
+
+        if (!fieldConstrained) {
+            IndexBoundsBuilder::allValuesForField(elt, oil);
+            if (!constrained) {
+                ++prefixLength;
+            }
+        }
+        constrained = constrained || fieldConstrained;
+    }
+
+    // An index whose leading field is constrained is planned as usual.
+    if (!constrained || prefixLength == 0) {
+        return nullptr;
+    }
+    IndexBoundsBuilder::alignBounds(&isn->bounds, index.keyPattern);
+    *prefixLengthOut = prefixLength;
+
+    // The bounds only narrow the keys to examine, so the whole query is applied to the fetched
+    // documents.
+    auto fetch = std::make_unique<FetchNode>();
+    fetch->filter = query.root()->shallowClone();
+    fetch->children.push_back(isn.release());
+    return fetch;
+}
+
 void QueryPlannerAccess::addFilterToSolutionNode(QuerySolutionNode* node,
                                                  std::unique_ptr<MatchExpression> match,
                                                  MatchExpression::MatchType type) {
@@ -1665,8 +1779,17 @@ void QueryPlannerAccess::handleFilterOr(ScanBuildingState* scanState) {
         // for affixing later.
         ++scanState->curChild;
     } else {
-        if (scanState->tightness < scanState->loosestBounds) {
-            scanState->loosestBounds = scanState->tightness;
+        // A covered predicate over a field with multikey components must be applied to the fetched
+        // documents, see handleFilterAnd().
+        const IndexEntry& index = scanState->indices[scanState->currentIndexNumber];
+        auto tightness = scanState->tightness;
+        if (tightness == IndexBoundsBuilder::INEXACT_COVERED &&
+            !canUseCoveredFilterOnField(index, scanState->ixtag->pos)) {
+            tightness = IndexBoundsBuilder::INEXACT_FETCH;
+        }
+
+        if (tightness < scanState->loosestBounds) {
+            scanState->loosestBounds = tightness;
         }
 
         // Detach 'child' and add it to 'curOr'.
@@ -1691,18 +1814,20 @@ void QueryPlannerAccess::handleFilterAnd(ScanBuildingState* scanState) {
         // we know that we don't need it to create a FETCH stage.
         root->getChildVector()->erase(root->getChildVector()->begin() + scanState->curChild);
     } else if (scanState->tightness == IndexBoundsBuilder::INEXACT_COVERED &&
-               (INDEX_TEXT == index.type || !index.multikey)) {
+               (INDEX_TEXT == index.type ||
+                canUseCoveredFilterOnField(index, scanState->ixtag->pos))) {
         // The bounds are not exact, but the information needed to
         // evaluate the predicate is in the index key. Remove the
         // MatchExpression from its parent and attach it to the filter
         // of the index scan we're building.
         //
-        // We can only use this optimization if the index is NOT multikey.
-        // Suppose that we had the multikey index {x: 1} and a document
-        // {x: ["a", "b"]}. Now if we query for {x: /b/} the filter might
-        // ever only be applied to the index key "a". We'd incorrectly
-        // conclude that the document does not match the query :( so we
-        // gotta stick to non-multikey indices.
+        // We can only use this optimization if the predicate's field has no
+        // multikey components. Suppose that we had the multikey index {x: 1}
+        // and a document {x: ["a", "b"]}. Now if we query for {x: /b/} the
+        // filter might ever only be applied to the index key "a". We'd
+        // incorrectly conclude that the document does not match the query :(
+        // A field of a multikey index which path-level multikey metadata shows
+        // is never an array holds its whole value in every key, though.
         auto child = std::move((*root->getChildVector())[scanState->curChild]);
         root->getChildVector()->erase(root->getChildVector()->begin() + scanState->curChild);
 
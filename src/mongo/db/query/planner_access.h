@@ -112,6 +112,22 @@ public:
                                                              const QueryPlannerParams& params,
                                                              int direction = 1);
 
+    /**
+     * Return a plan that skip scans the provided index: the leading fields of the index which
+     * 'query' does not constrain are scanned in full, and the following fields are bounded by the
+     * top-level comparisons of 'query' on them. The index scan seeks past the keys of each
+     * distinct value of the unconstrained prefix which are out of bounds, so it is efficient when
+     * the prefix has few distinct values.
+     *
+     * Returns nullptr if 'index' cannot be skip scanned for 'query', for instance if its leading
+     * field is constrained. Otherwise sets 'prefixLengthOut' to the number of leading fields which
+     * are scanned in full.
+     */
+    static std::unique_ptr<QuerySolutionNode> makeSkipScan(const IndexEntry& index,
+                                                           const CanonicalQuery& query,
+                                                           const QueryPlannerParams& params,
+                                                           size_t* prefixLengthOut);
+
     /**
      * Return a plan that scans the provided index from [startKey to endKey).
      */
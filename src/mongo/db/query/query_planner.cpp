@@ -340,6 +340,36 @@ std::unique_ptr<QuerySolution> buildWholeIXSoln(const IndexEntry& index,
     return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
 }
 
+std::unique_ptr<QuerySolution> buildSkipScanSoln(const IndexEntry& index,
+                                                 const CanonicalQuery& query,
+                                                 const QueryPlannerParams& params,
+                                                 size_t* prefixLengthOut) {
+    auto solnRoot = QueryPlannerAccess::makeSkipScan(index, query, params, prefixLengthOut);
+    if (!solnRoot) {
+        return nullptr;
+    }
+    return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
+}
+
+/**
+ * Estimates the number of distinct values of the first 'prefixLength' fields of 'keyPattern' from
+ * 'stats', assuming the fields are independent. Returns boost::none if a field was not analyzed.
+ */
+boost::optional<double> estimatePrefixCardinality(const BSONObj& keyPattern,
+                                                  size_t prefixLength,
+                                                  const CollectionStatistics& stats) {
+    double cardinality = 1;
+    BSONObjIterator it(keyPattern);
+    for (size_t i = 0; i < prefixLength && it.more(); ++i) {
+        const auto fieldStats = stats.getField(it.next().fieldNameStringData());
+        if (!fieldStats) {
+            return boost::none;
+        }
+        cardinality *= std::max(1.0, fieldStats->numDistinct);
+    }
+    return cardinality;
+}
+
 bool providesSort(const CanonicalQuery& query, const BSONObj& kp) {
     return query.getFindCommandRequest().getSort().isPrefixOf(
         kp, SimpleBSONElementComparator::kInstance);
@@ -507,6 +537,16 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
         } else {
             return {std::move(soln)};
         }
+    } else if (SolutionCacheData::SKIP_SCAN_SOLN == winnerCacheData.solnType) {
+        size_t prefixLength;
+        auto soln =
+            buildSkipScanSoln(*winnerCacheData.tree->entry, query, params, &prefixLength);
+        if (!soln) {
+            return Status(ErrorCodes::NoQueryExecutionPlans,
+                          "plan cache error: soln that skip scans an index");
+        } else {
+            return {std::move(soln)};
+        }
     } else if (SolutionCacheData::COLLSCAN_SOLN == winnerCacheData.solnType) {
         // The cached solution is a collection scan. We don't cache collscans
         // with tailable==true, hence the false below.
@@ -968,6 +1008,45 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         return {std::move(out)};
     }
 
+    // If the query does not constrain the leading fields of a compound index but constrains the
+    // following ones, the index can be skip scanned when its unconstrained prefix has few distinct
+    // values. Skip scans compete with a collection scan if there is no other indexed solution.
+    bool onlySkipScans = false;
+    const auto maxPrefixCardinality = internalQueryMaxSkipScanPrefixCardinality.load();
+    if (params.collectionStats && maxPrefixCardinality > 0 && hintedIndex.isEmpty() &&
+        query.getFindCommandRequest().getMin().isEmpty() &&
+        query.getFindCommandRequest().getMax().isEmpty() && !isTailable &&
+        !QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR) &&
+        !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+        const bool hadIndexedSolutions = !out.empty();
+        for (auto&& index : fullIndexList) {
+            size_t prefixLength = 0;
+            auto soln = buildSkipScanSoln(index, query, params, &prefixLength);
+            if (!soln) {
+                continue;
+            }
+            const auto prefixCardinality =
+                estimatePrefixCardinality(index.keyPattern, prefixLength, *params.collectionStats);
+            if (!prefixCardinality || *prefixCardinality > maxPrefixCardinality) {
+                continue;
+            }
+
+            LOGV2_DEBUG(5999207,
+                        5,
+                        "Planner: outputting soln that skip scans an index",
+                        "index"_attr = index.toString(),
+                        "prefixCardinality"_attr = *prefixCardinality);
+            PlanCacheIndexTree* indexTree = new PlanCacheIndexTree();
+            indexTree->setIndexEntry(index);
+            SolutionCacheData* scd = new SolutionCacheData();
+            scd->tree.reset(indexTree);
+            scd->solnType = SolutionCacheData::SKIP_SCAN_SOLN;
+            soln->cacheData.reset(scd);
+            out.push_back(std::move(soln));
+        }
+        onlySkipScans = !hadIndexedSolutions && !out.empty();
+    }
+
     // If a sort order is requested, there may be an index that provides it, even if that
     // index is not over any predicates in the query.
     //
@@ -1112,7 +1191,8 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         return Status(ErrorCodes::NoQueryExecutionPlans, "No query solutions");
     }
 
-    if (possibleToCollscan && (collscanRequested || collScanRequired)) {
+    if (possibleToCollscan &&
+        (collscanRequested || collScanRequired || (onlySkipScans && canTableScan))) {
         auto collscan = buildCollscanSoln(query, isTailable, params);
         if (!collscan && collScanRequired) {
             return Status(ErrorCodes::NoQueryExecutionPlans,
@@ -34,10 +34,22 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
 
+/**
+ * Returns statistics of a collection in which 'a' has 3 distinct values and 'b' has 100.
+ */
+std::shared_ptr<const CollectionStatistics> makeSkipScanStatistics() {
+    CollectionStatistics::Builder builder({"a", "b"}, CollectionStatistics::kDefaultNumBuckets);
+    for (int i = 0; i < 100; ++i) {
+        builder.addDocument(BSON("a" << i % 3 << "b" << i));
+    }
+    return std::make_shared<const CollectionStatistics>(builder.done(100, Date_t()));
+}
+
 
 TEST_F(QueryPlannerTest, PlannerUsesCoveredIxscanForCountWhenIndexSatisfiesQuery) {
     params.options = QueryPlannerParams::IS_COUNT;
@@ -1504,5 +1516,93 @@ TEST_F(QueryPlannerTest, PlansForWholeIndexScanWithSortAreGenerated) {
         "{proj: {spec: {'b': 1, _id: 0}, node: {fetch: {node: {ixscan: {pattern: {a: 1}}}}}}}");
 }
 
+//
+// Skip scans
+//
+
+TEST_F(QueryPlannerTest, SkipScansIndexWithLowCardinalityPrefix) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    params.collectionStats = makeSkipScanStatistics();
+
+    runQuery(fromjson("{b: {$gte: 5, $lt: 10}}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: {$gte: 5, $lt: 10}}, node: {ixscan: {pattern: {a: 1, b: 1}, "
+        "bounds: {a: [['MinKey','MaxKey',true,true]], b: [[5,10,true,false]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanBoundsAllFieldsAfterThePrefix) {
+    addIndex(BSON("a" << 1 << "b" << -1 << "c" << 1));
+    params.collectionStats = makeSkipScanStatistics();
+
+    runQuery(fromjson("{b: 5, c: {$gt: 2}}"));
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5, c: {$gt: 2}}, node: {ixscan: {pattern: {a: 1, b: -1, c: 1}, "
+        "bounds: {a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]], "
+        "c: [[2,Infinity,false,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanBoundsOnlyOneFieldOfMultikeyIndex) {
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1), true);
+    params.collectionStats = makeSkipScanStatistics();
+
+    runQuery(fromjson("{b: 5, c: 2}"));
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5, c: 2}, node: {ixscan: {pattern: {a: 1, b: 1, c: 1}, "
+        "bounds: {a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]], "
+        "c: [['MinKey','MaxKey',true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanCompetesWithCollectionScan) {
+    params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    params.collectionStats = makeSkipScanStatistics();
+
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists("{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1, b: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSkipScanWithoutStatisticsOfThePrefix) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    addIndex(BSON("c" << 1 << "b" << 1));
+
+    runQuery(fromjson("{b: 5}"));
+    assertHasOnlyCollscan();
+
+    // 'c' was not analyzed.
+    params.collectionStats = makeSkipScanStatistics();
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1, b: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSkipScanWithHighCardinalityPrefix) {
+    const auto maxPrefixCardinality = internalQueryMaxSkipScanPrefixCardinality.load();
+    ON_BLOCK_EXIT(
+        [&] { internalQueryMaxSkipScanPrefixCardinality.store(maxPrefixCardinality); });
+    internalQueryMaxSkipScanPrefixCardinality.store(10);
+
+    addIndex(BSON("a" << 1 << "c" << 1));
+    addIndex(BSON("b" << 1 << "c" << 1));
+    params.collectionStats = makeSkipScanStatistics();
+
+    runQuery(fromjson("{c: 5}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {filter: {c: 5}, node: {ixscan: {pattern: {a: 1, c: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSkipScanOfSparseIndex) {
+    addIndex(BSON("a" << 1 << "b" << 1), false, true);
+    params.collectionStats = makeSkipScanStatistics();
+
+    runQuery(fromjson("{b: 5}"));
+    assertHasOnlyCollscan();
+}
+
 }  // namespace
 }  // namespace mongo
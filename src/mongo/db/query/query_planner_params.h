@@ -32,6 +32,7 @@
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/index_entry.h"
 #include "mongo/db/query/query_knobs_gen.h"
 
@@ -154,6 +155,10 @@ struct QueryPlannerParams {
     // Set if we allow optimization which converts "_id" predicates into range collection scan using
     // minRecord and maxRecord.
     bool allowRIDRange;
+
+    // The statistics of the collection built by the analyze command, if any. Skip scans are only
+    // considered for indexes whose unconstrained prefix is known to have few distinct values.
+    std::shared_ptr<const CollectionStatistics> collectionStats;
 };
 
 }  // namespace mongo
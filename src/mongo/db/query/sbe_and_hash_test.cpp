@@ -29,6 +29,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <regex>
+
+#include "mongo/db/exec/sbe/util/debug_print.h"
 #include "mongo/db/exec/shard_filterer_mock.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/sbe_stage_builder_test_fixture.h"
@@ -189,4 +192,33 @@ TEST_F(SbeAndHashTest, TestTwoIndexArrays) {
     runTest(docs, expected);
 }
 
+TEST_F(SbeAndHashTest, TestIntersectionOnlyJoinsRecordIdsWhenNoResultIsNeeded) {
+    auto docs = std::vector<std::vector<BSONArray>>{
+        {BSON_ARRAY(1 << BSON("_id" << 1 << "a" << 1)),
+         BSON_ARRAY(2 << BSON("_id" << 2 << "a" << 2)),
+         BSON_ARRAY(3 << BSON("_id" << 3 << "a" << 3))},
+        {BSON_ARRAY(2 << BSON("_id" << 2 << "a" << 2)),
+         BSON_ARRAY(3 << BSON("_id" << 3 << "a" << 3)),
+         BSON_ARRAY(4 << BSON("_id" << 4 << "a" << 4))},
+        {BSON_ARRAY(2 << BSON("_id" << 2 << "a" << 2)),
+         BSON_ARRAY(3 << BSON("_id" << 3 << "a" << 3))}};
+    auto querySolution = makeQuerySolution(makeHashAndTree(docs));
+    auto [recordIdSlot, stage, data] = buildRecordIdPlanStage(std::move(querySolution));
+
+    // Each hash join only carries the RecordIds it joins on, rather than the result objects of
+    // its children.
+    const auto plan = sbe::DebugPrinter{}.print(*stage);
+    ASSERT_TRUE(std::regex_search(plan, std::regex{"hj"})) << plan;
+    const std::regex nonEmptyProjects{"(left|right)\\s*\\[\\s*s\\d+\\s*\\]\\s*\\[\\s*s"};
+    ASSERT_FALSE(std::regex_search(plan, nonEmptyProjects)) << plan;
+
+    auto accessors = prepareTree(&data.ctx, stage.get(), sbe::makeSV(recordIdSlot));
+    auto [resultsTag, resultsVal] = getAllResults(stage.get(), accessors[0]);
+    sbe::value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSON_ARRAY(2 << 3));
+    sbe::value::ValueGuard expectedGuard{expectedTag, expectedVal};
+    ASSERT_TRUE(valueEquals(resultsTag, resultsVal, expectedTag, expectedVal));
+}
+
 }  // namespace mongo
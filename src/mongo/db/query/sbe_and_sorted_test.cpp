@@ -29,6 +29,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <regex>
+
+#include "mongo/db/exec/sbe/util/debug_print.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/sbe_stage_builder_test_fixture.h"
 #include "mongo/unittest/unittest.h"
@@ -151,4 +154,33 @@ TEST_F(SbeAndSortedTest, TestNoIndexIntersection) {
                                                      BSON_ARRAY(6 << BSON("a" << 1 << "b" << 3))}};
     runTest(docs, BSONArray());
 }
+
+TEST_F(SbeAndSortedTest, TestIntersectionOnlyJoinsRecordIdsWhenNoResultIsNeeded) {
+    auto docs = std::vector<std::vector<BSONArray>>{{BSON_ARRAY(1 << BSON("a" << 1 << "b" << 1)),
+                                                     BSON_ARRAY(2 << BSON("a" << 1 << "b" << 2)),
+                                                     BSON_ARRAY(3 << BSON("a" << 1 << "b" << 3))},
+                                                    {BSON_ARRAY(2 << BSON("a" << 1 << "b" << 2)),
+                                                     BSON_ARRAY(3 << BSON("a" << 1 << "b" << 3)),
+                                                     BSON_ARRAY(4 << BSON("a" << 1 << "b" << 4))},
+                                                    {BSON_ARRAY(1 << BSON("a" << 1 << "b" << 1)),
+                                                     BSON_ARRAY(3 << BSON("a" << 1 << "b" << 3))}};
+    auto querySolution = makeQuerySolution(makeAndSortedTree(docs));
+    auto [recordIdSlot, stage, data] = buildRecordIdPlanStage(std::move(querySolution));
+
+    // Each merge join only carries the RecordIds it joins on, rather than the result objects of
+    // its children.
+    const auto plan = sbe::DebugPrinter{}.print(*stage);
+    ASSERT_TRUE(std::regex_search(plan, std::regex{"mj"})) << plan;
+    const std::regex nonEmptyProjects{
+        "(outer\\s*\\[[^\\]]*\\]|inner)\\s*\\[\\s*s\\d+\\s*\\]\\s*\\[\\s*s"};
+    ASSERT_FALSE(std::regex_search(plan, nonEmptyProjects)) << plan;
+
+    auto accessors = prepareTree(&data.ctx, stage.get(), sbe::makeSV(recordIdSlot));
+    auto [resultsTag, resultsVal] = getAllResults(stage.get(), accessors[0]);
+    sbe::value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSON_ARRAY(3));
+    sbe::value::ValueGuard expectedGuard{expectedTag, expectedVal};
+    ASSERT_TRUE(valueEquals(resultsTag, resultsVal, expectedTag, expectedVal));
+}
 }  // namespace mongo
@@ -0,0 +1,212 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_cached_executable_plan.h"
+
+#include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_planner_params.h"
+
+namespace mongo::sbe {
+namespace {
+bool hasStage(const PlanStageStats& stats, StringData stageType) {
+    if (stats.common.stageType == stageType) {
+        return true;
+    }
+    return std::any_of(stats.children.begin(), stats.children.end(), [&](auto&& child) {
+        return hasStage(*child, stageType);
+    });
+}
+
+/**
+ * Appends the shape of the filter 'expr' to 'sb'. Parameterized predicates are described by their
+ * path and the canonical type of their constant, which determines the plan built for them, while
+ * all other predicates are described by their serialized form.
+ */
+void encodeFilterShape(const MatchExpression* expr, StringBuilder* sb) {
+    *sb << static_cast<int>(expr->matchType());
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+            *sb << '(';
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                encodeFilterShape(expr->getChild(i), sb);
+                *sb << ',';
+            }
+            *sb << ')';
+            return;
+        default:
+            break;
+    }
+
+    if (!expression::getInputParamId(expr)) {
+        BSONObjBuilder bob;
+        expr->serialize(&bob, true /* includePath */);
+        auto obj = bob.done();
+        *sb << '{' << StringData{obj.objdata(), static_cast<size_t>(obj.objsize())} << '}';
+        return;
+    }
+
+    *sb << '{' << expr->path() << '?';
+    if (expr->matchType() == MatchExpression::MATCH_IN) {
+        *sb << "in";
+    } else {
+        auto cmp = static_cast<const ComparisonMatchExpressionBase*>(expr);
+        *sb << canonicalizeBSONType(cmp->getData().type());
+    }
+    *sb << '}';
+}
+
+/**
+ * Appends the structure of the solution tree 'node' to 'sb'. Index bounds are rebound when a
+ * parameterized tree is copied, but the index, the direction and the form of the bounds of each
+ * scan are compiled in. The filter of each node is included too, since whether a predicate is
+ * left in a filter or absorbed by the bounds depends on whether its bounds were exact.
+ */
+void encodeSolutionShape(const QuerySolutionNode* node, StringBuilder* sb) {
+    *sb << static_cast<int>(node->getType());
+    if (node->getType() == STAGE_IXSCAN) {
+        auto ixn = static_cast<const IndexScanNode*>(node);
+        *sb << '[' << ixn->index.identifier.catalogName << ':' << ixn->direction << ':'
+            << (ixn->bounds.isSimpleRange ? 's' : 'o') << ixn->bounds.size() << ']';
+    }
+    if (node->filter) {
+        *sb << '<';
+        encodeFilterShape(node->filter.get(), sb);
+        *sb << '>';
+    }
+    *sb << '(';
+    for (auto&& child : node->children) {
+        encodeSolutionShape(child, sb);
+        *sb << ',';
+    }
+    *sb << ')';
+}
+
+/**
+ * Copies 'data', using 'env' in place of its runtime environment.
+ */
+stage_builder::PlanStageData copyPlanStageData(const stage_builder::PlanStageData& data,
+                                               std::unique_ptr<RuntimeEnvironment> env) {
+    stage_builder::PlanStageData copy{std::move(env)};
+    copy.outputs = data.outputs;
+    copy.iamMap = data.iamMap;
+    copy.shouldTrackLatestOplogTimestamp = data.shouldTrackLatestOplogTimestamp;
+    copy.shouldTrackResumeToken = data.shouldTrackResumeToken;
+    copy.shouldUseTailableScan = data.shouldUseTailableScan;
+    copy.isParameterized = data.isParameterized;
+    return copy;
+}
+}  // namespace
+
+bool CachedExecutablePlanSBE::canCache(const CanonicalQuery& cq,
+                                       size_t plannerOptions,
+                                       const PlanStage& root) {
+    if (cq.getCollator() || (plannerOptions & QueryPlannerParams::INCLUDE_SHARD_FILTER)) {
+        return false;
+    }
+
+    // Clones of an exchange share its state, so a cached copy could not run concurrently with the
+    // tree it was cloned from.
+    return !hasStage(*root.getStats(false /* includeDebugInfo */), "exchange"_sd);
+}
+
+std::string CachedExecutablePlanSBE::makeKey(const CanonicalQuery& cq,
+                                             size_t plannerOptions,
+                                             const QuerySolution& solution,
+                                             bool parameterized) {
+    // The parameters are compared in their BSON form, rather than their string representation, so
+    // that values of different numeric types are told apart.
+    auto cmd = cq.getFindCommandRequest().toBSON(BSONObj{});
+    StringBuilder sb;
+    sb << plannerOptions << ':';
+    if (!parameterized) {
+        sb << StringData{cmd.objdata(), static_cast<size_t>(cmd.objsize())};
+        return sb.str();
+    }
+
+    cmd = cmd.removeField(FindCommandRequest::kFilterFieldName);
+    sb << 'p' << StringData{cmd.objdata(), static_cast<size_t>(cmd.objsize())} << ':';
+    encodeFilterShape(cq.root(), &sb);
+    sb << ':';
+    encodeSolutionShape(solution.root(), &sb);
+    return sb.str();
+}
+
+CachedExecutablePlanSBE::CachedExecutablePlanSBE(std::string key,
+                                                 const PlanStage& root,
+                                                 const stage_builder::PlanStageData& data,
+                                                 Microseconds buildTime)
+    : _key{std::move(key)},
+      _root{root.clone()},
+      _data{copyPlanStageData(data, data.env->makeDeepCopy())},
+      _buildTime{buildTime} {}
+
+boost::optional<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>>
+CachedExecutablePlanSBE::clone(OperationContext* opCtx,
+                               const CollectionPtr& collection,
+                               const CanonicalQuery& cq,
+                               const QuerySolution& solution,
+                               PlanYieldPolicy* yieldPolicy) const {
+    auto sbeYieldPolicy = dynamic_cast<PlanYieldPolicySBE*>(yieldPolicy);
+    invariant(sbeYieldPolicy);
+
+    auto env = _data.env->makeDeepCopy();
+    if (!stage_builder::resetRuntimeEnvironment(cq, opCtx, env.get())) {
+        return boost::none;
+    }
+    if (_data.isParameterized &&
+        !stage_builder::bindInputParams(opCtx, collection, cq, solution, env.get())) {
+        return boost::none;
+    }
+
+    auto data = copyPlanStageData(_data, std::move(env));
+
+    auto root = _root->clone();
+    root->rebindYieldPolicy(sbeYieldPolicy);
+    root->attachToOperationContext(opCtx);
+
+    auto expCtx = cq.getExpCtxRaw();
+    if (expCtx->explain || expCtx->mayDbProfile) {
+        root->markShouldCollectTimingInfo();
+    }
+    if (expCtx->explain && internalQuerySlotBasedExecutionProfileVM.load()) {
+        root->markShouldCollectVmProfile();
+    }
+
+    sbeYieldPolicy->registerPlan(root.get());
+
+    return {{std::move(root), std::move(data)}};
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+#include "mongo/util/duration.h"
+
+namespace mongo::sbe {
+/**
+ * An SBE plan tree built from the solution of a plan cache entry, stored with the entry so that
+ * later queries can clone it instead of running the stage builder again.
+ *
+ * Unless the tree was built for a parameterized query, constants from the query are compiled into
+ * the tree, so a copy can only be used by a query with exactly the same parameters as the one the
+ * tree was built for, which is identified by the key returned from 'makeKey()'. The only per-query
+ * state which is rebound when a copy is made is the yield policy and the global values held in the
+ * runtime environment. A parameterized tree reads the constants and index bounds from the runtime
+ * environment instead, so it is shared by all queries of the same shape and those values are
+ * rebound as well.
+ */
+class CachedExecutablePlanSBE final : public CachedExecutablePlan {
+public:
+    /**
+     * Returns true if the plan tree 'root' built for the given query 'cq' can be stored in the
+     * plan cache. Trees which depend on per-query state that cannot be rebound, such as a collator,
+     * a sharding filter or the shared buffers of a parallel exchange, are not cacheable.
+     */
+    static bool canCache(const CanonicalQuery& cq, size_t plannerOptions, const PlanStage& root);
+
+    /**
+     * Returns the key identifying the queries which can use a tree built for 'cq' from 'solution'.
+     * If 'parameterized' is true, the key only captures the shape of the filter rather than its
+     * constants.
+     */
+    static std::string makeKey(const CanonicalQuery& cq,
+                               size_t plannerOptions,
+                               const QuerySolution& solution,
+                               bool parameterized);
+
+    /**
+     * Stores a copy of the given tree, which took 'buildTime' to build for the query 'key'. The
+     * tree must not have been prepared for execution.
+     */
+    CachedExecutablePlanSBE(std::string key,
+                            const PlanStage& root,
+                            const stage_builder::PlanStageData& data,
+                            Microseconds buildTime);
+
+    const std::string& getKey() const {
+        return _key;
+    }
+
+    Microseconds getBuildTime() const {
+        return _buildTime;
+    }
+
+    bool isParameterized() const {
+        return _data.isParameterized;
+    }
+
+    /**
+     * Makes a copy of the stored tree for the query 'cq' and its 'solution', attached to 'opCtx'
+     * and registered with 'yieldPolicy'. Returns boost::none if the global values or the input
+     * parameters of 'cq' cannot be bound to the copy.
+     */
+    boost::optional<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>> clone(
+        OperationContext* opCtx,
+        const CollectionPtr& collection,
+        const CanonicalQuery& cq,
+        const QuerySolution& solution,
+        PlanYieldPolicy* yieldPolicy) const;
+
+private:
+    const std::string _key;
+    const std::unique_ptr<PlanStage> _root;
+    stage_builder::PlanStageData _data;
+    const Microseconds _buildTime;
+};
+}  // namespace mongo::sbe
@@ -30,14 +30,202 @@
 
 #include "mongo/db/query/sbe_runtime_planner.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/trial_period_utils.h"
 #include "mongo/db/exec/trial_run_tracker.h"
 #include "mongo/db/query/plan_executor_sbe.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/yield_policy_callbacks_impl.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/fail_point.h"
+#include "mongo/util/future.h"
 
 namespace mongo::sbe {
 namespace {
+MONGO_FAIL_POINT_DEFINE(hangInSBETrialWorker);
+
+// Runs the trial periods of candidate plans in parallel. The pool is capped by
+// 'internalQueryPlanEvaluationMaxTrialThreads', see reserveTrialThreads().
+std::unique_ptr<ThreadPool> trialThreadPool;
+AtomicWord<int> reservedTrialThreads{0};
+MONGO_INITIALIZER_WITH_PREREQUISITES(SBETrialThreadPool, ("EndStartupOptionStorage"))
+(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "SBETrialThreadPool";
+    options.threadNamePrefix = "SBETrial";
+    options.minThreads = 0;
+    options.maxThreads = internalQueryPlanEvaluationMaxTrialThreads.load();
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    trialThreadPool = std::make_unique<ThreadPool>(options);
+    trialThreadPool->startup();
+}
+
+/**
+ * Reserves 'numThreads' threads of 'trialThreadPool' for the workers of a trial period. Every
+ * worker waits for the others at the end of each round, so a worker left waiting for a free thread
+ * would hold up all the others. Returns false if the pool cannot run all of them at once, in which
+ * case the trial period must run on the calling thread instead.
+ */
+bool reserveTrialThreads(int numThreads) {
+    const auto maxThreads = internalQueryPlanEvaluationMaxTrialThreads.load();
+    auto reserved = reservedTrialThreads.load();
+    do {
+        if (reserved + numThreads > maxThreads) {
+            return false;
+        }
+    } while (!reservedTrialThreads.compareAndSwap(&reserved, reserved + numThreads));
+    return true;
+}
+
+void releaseTrialThreads(int numThreads) {
+    reservedTrialThreads.subtractAndFetch(numThreads);
+}
+
+/**
+ * Synchronizes the rounds of a trial period run by several workers. The planner starts each round
+ * and waits for every worker to complete it before deciding whether to start the next one. This
+ * keeps the workers in lockstep, so the trial period ends after the same round, and each candidate
+ * has done the same amount of work, as if all of them had been run by a single thread.
+ */
+class TrialRoundCoordinator {
+public:
+    explicit TrialRoundCoordinator(size_t numWorkers) : _numWorkers(numWorkers) {}
+
+    /**
+     * Called by the planner to run the next round. Returns true if the trial period is over,
+     * either because a candidate finished its trial period during the round or because a worker
+     * failed. Throws if 'opCtx' is interrupted while waiting for the workers.
+     */
+    bool runRound(OperationContext* opCtx) {
+        stdx::unique_lock lk(_mutex);
+        _finished = false;
+        _pending = _numWorkers;
+        ++_round;
+        _cv.notify_all();
+
+        opCtx->waitForConditionOrInterrupt(_cv, lk, [&] { return _pending == 0 || _failed; });
+        return _finished || _failed;
+    }
+
+    /**
+     * Called by the planner once no more rounds are needed, or when it gives up on the trial.
+     */
+    void stop() {
+        stdx::lock_guard lk(_mutex);
+        _stopped = true;
+        _cv.notify_all();
+    }
+
+    /**
+     * Called by a worker to wait for round 'round' to start. Returns false if the trial period is
+     * over instead.
+     */
+    bool waitForRound(size_t round) {
+        stdx::unique_lock lk(_mutex);
+        _cv.wait(lk, [&] { return _round >= round || _stopped; });
+        return !_stopped;
+    }
+
+    /**
+     * Called by a worker once it completed the current round. 'finished' tells whether any of its
+     * candidates finished the trial period during the round.
+     */
+    void completeRound(bool finished) {
+        stdx::lock_guard lk(_mutex);
+        _finished |= finished;
+        if (--_pending == 0) {
+            _cv.notify_all();
+        }
+    }
+
+    /**
+     * Called by a worker which failed, in which case no further round will run. The other workers
+     * are interrupted, and the first failure is reported by failure().
+     */
+    void fail(Status status) {
+        stdx::lock_guard lk(_mutex);
+        if (!_failed) {
+            _failed = true;
+            _failure = std::move(status);
+            _interruptWorkers(lk, ErrorCodes::Interrupted);
+        }
+        _cv.notify_all();
+    }
+
+    Status failure() {
+        stdx::lock_guard lk(_mutex);
+        return _failure;
+    }
+
+    /**
+     * Called by a worker to let the planner interrupt its operation context. If the workers have
+     * already been interrupted, 'opCtx' is killed right away.
+     */
+    void registerWorker(OperationContext* opCtx) {
+        stdx::lock_guard lk(_mutex);
+        _workerOpCtxs.push_back(opCtx);
+        if (_interruptCode) {
+            _kill(opCtx, *_interruptCode);
+        }
+    }
+
+    void unregisterWorker(OperationContext* opCtx) {
+        stdx::lock_guard lk(_mutex);
+        _workerOpCtxs.erase(std::find(_workerOpCtxs.begin(), _workerOpCtxs.end(), opCtx));
+    }
+
+    /**
+     * Called by the planner when its own operation is interrupted. Kills the operation contexts of
+     * all workers with 'code', so that workers waiting for a lock or yielding return promptly.
+     */
+    void interruptWorkers(ErrorCodes::Error code) {
+        stdx::lock_guard lk(_mutex);
+        _interruptWorkers(lk, code);
+    }
+
+private:
+    void _interruptWorkers(WithLock, ErrorCodes::Error code) {
+        if (_interruptCode) {
+            return;
+        }
+
+        _interruptCode = code;
+        for (auto opCtx : _workerOpCtxs) {
+            _kill(opCtx, code);
+        }
+    }
+
+    static void _kill(OperationContext* opCtx, ErrorCodes::Error code) {
+        stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+        opCtx->getServiceContext()->killOperation(clientLock, opCtx, code);
+    }
+
+    Mutex _mutex = MONGO_MAKE_LATCH("TrialRoundCoordinator::_mutex");
+    stdx::condition_variable _cv;
+
+    const size_t _numWorkers;
+    // The number of rounds started so far, so round numbers start at one.
+    size_t _round{0};
+    // The number of workers which have not completed the current round yet.
+    size_t _pending{0};
+    bool _finished{false};
+    bool _stopped{false};
+    bool _failed{false};
+    Status _failure = Status::OK();
+
+    // The operation contexts of the running workers, and the code they were killed with, if any.
+    std::vector<OperationContext*> _workerOpCtxs;
+    boost::optional<ErrorCodes::Error> _interruptCode;
+};
+
 /**
  * Fetches a next document form the given plan stage tree and returns 'true' if the plan stage
  * returns EOF, or throws 'TrialRunTracker::EarlyExitException' exception. Otherwise, the
@@ -113,6 +301,32 @@ BaseRuntimePlanner::prepareExecutionPlan(PlanStage* root,
     return std::make_tuple(resultSlot, recordIdSlot, exitedEarly);
 }
 
+namespace {
+/**
+ * Fetches the next document from each of the candidates in 'indices' which is still running its
+ * trial period. Returns true if any of them finished the trial period.
+ */
+bool runTrialRound(std::vector<plan_ranker::CandidatePlan>& candidates,
+                   const std::vector<std::pair<value::SlotAccessor*, value::SlotAccessor*>>& slots,
+                   const std::vector<size_t>& indices) {
+    auto done{false};
+    for (auto ix : indices) {
+        // Even if we had a candidate plan that exited early, we still want continue the trial run
+        // as the early exited plan may not be the best. E.g., it could be blocked in a SORT stage
+        // until one of the trial period metrics was reached, causing the plan to raise an early
+        // exit exception and return control back to the runtime planner. If that happens, we need
+        // to continue and complete the trial period for all candidates, as some of them may have a
+        // better cost.
+        if (!candidates[ix].status.isOK() || candidates[ix].exitedEarly) {
+            continue;
+        }
+
+        done |= fetchNextDocument(&candidates[ix], slots[ix]);
+    }
+    return done;
+}
+}  // namespace
+
 std::vector<plan_ranker::CandidatePlan> BaseRuntimePlanner::collectExecutionStats(
     std::vector<std::unique_ptr<QuerySolution>> solutions,
     std::vector<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>> roots,
@@ -141,42 +355,191 @@ std::vector<plan_ranker::CandidatePlan> BaseRuntimePlanner::collectExecutionStat
         root->attachToTrialRunTracker(tracker.get());
         trialRunTrackers.emplace_back(root.get(), std::move(tracker));
 
-        auto status = prepareExecutionPlan(root.get(), &data);
-        auto [resultSlot, recordIdSlot, exitedEarly] =
-            [&]() -> std::tuple<value::SlotAccessor*, value::SlotAccessor*, bool> {
-            if (status.isOK()) {
-                return status.getValue();
-            }
-            // The candidate plan returned a failure that is not fatal to the execution of the
-            // query, as long as we have other candidates that haven't failed. We will mark the
-            // candidate as failed and keep preparing any remaining candidate plans.
-            return {};
-        }();
-        candidates.push_back({std::move(solutions[ix]),
-                              std::move(root),
-                              std::move(data),
-                              exitedEarly,
-                              status.getStatus()});
-        slots.push_back({resultSlot, recordIdSlot});
+        candidates.push_back(
+            {std::move(solutions[ix]), std::move(root), std::move(data), false, Status::OK()});
+    }
+    slots.resize(candidates.size());
+
+    if (auto numWorkers = getNumTrialWorkers(candidates.size());
+        numWorkers > 1 && reserveTrialThreads(static_cast<int>(numWorkers))) {
+        ON_BLOCK_EXIT([&] { releaseTrialThreads(static_cast<int>(numWorkers)); });
+        runTrialsInParallel(candidates, slots, maxNumResults, numWorkers);
+        return candidates;
+    }
+
+    std::vector<size_t> indices(candidates.size());
+    for (size_t ix = 0; ix < candidates.size(); ++ix) {
+        prepareCandidate(&candidates[ix], &slots[ix]);
+        indices[ix] = ix;
     }
 
     auto done{false};
     for (size_t it = 0; it < maxNumResults && !done; ++it) {
-        for (size_t ix = 0; ix < candidates.size(); ++ix) {
-            // Even if we had a candidate plan that exited early, we still want continue the trial
-            // run as the early exited plan may not be the best. E.g., it could be blocked in a SORT
-            // stage until one of the trial period metrics was reached, causing the plan to raise an
-            // early exit exception and return control back to the runtime planner. If that happens,
-            // we need to continue and complete the trial period for all candidates, as some of them
-            // may have a better cost.
-            if (!candidates[ix].status.isOK() || candidates[ix].exitedEarly) {
-                continue;
+        done = runTrialRound(candidates, slots, indices);
+    }
+
+    return candidates;
+}
+
+void BaseRuntimePlanner::prepareCandidate(
+    plan_ranker::CandidatePlan* candidate,
+    std::pair<value::SlotAccessor*, value::SlotAccessor*>* slots) const {
+    auto status = prepareExecutionPlan(candidate->root.get(), &candidate->data);
+    if (!status.isOK()) {
+        // The candidate plan returned a failure that is not fatal to the execution of the query,
+        // as long as we have other candidates that haven't failed. We will mark the candidate as
+        // failed and keep preparing any remaining candidate plans.
+        candidate->status = status.getStatus();
+        return;
+    }
+
+    auto [resultSlot, recordIdSlot, exitedEarly] = status.getValue();
+    *slots = {resultSlot, recordIdSlot};
+    candidate->exitedEarly = exitedEarly;
+}
+
+size_t BaseRuntimePlanner::getNumTrialWorkers(size_t numCandidates) const {
+    const auto maxWorkers =
+        static_cast<size_t>(internalQueryPlanEvaluationMaxParallelTrials.load());
+    if (maxWorkers <= 1 || numCandidates <= 1) {
+        return 1;
+    }
+
+    // The workers read from their own storage snapshots and yield on their own, so the trial
+    // periods only run in parallel if the query may yield, does not run in a transaction, and
+    // reads with the "local" read concern.
+    if (!_yieldPolicy || !_yieldPolicy->canAutoYield() || _opCtx->inMultiDocumentTransaction() ||
+        repl::ReadConcernArgs::get(_opCtx).getLevel() !=
+            repl::ReadConcernLevel::kLocalReadConcern) {
+        return 1;
+    }
+
+    // This operation keeps its locks while it waits for the workers. With lock-free reads the
+    // workers only take the global intent lock, rather than queueing for collection locks behind a
+    // writer which itself waits for this operation.
+    if (storageGlobalParams.disableLockFreeReads || _opCtx->lockState()->isWriteLocked()) {
+        return 1;
+    }
+
+    // The plans only use values copied from the ExpressionContext into their runtime environments,
+    // with the exception of the collator, which is not safe to use from several threads at once.
+    if (_cq.getCollator()) {
+        return 1;
+    }
+
+    return std::min(maxWorkers, numCandidates);
+}
+
+void BaseRuntimePlanner::runTrialsInParallel(
+    std::vector<plan_ranker::CandidatePlan>& candidates,
+    std::vector<std::pair<value::SlotAccessor*, value::SlotAccessor*>>& slots,
+    size_t maxNumResults,
+    size_t numWorkers) {
+    // The plans are attached to this operation's context when they are built. Each worker attaches
+    // its candidates to its own operation context instead.
+    for (auto&& candidate : candidates) {
+        candidate.root->detachFromOperationContext();
+    }
+
+    TrialRoundCoordinator coordinator{numWorkers};
+    std::vector<Future<void>> workers;
+    for (size_t workerIdx = 0; workerIdx < numWorkers; ++workerIdx) {
+        // Spread the candidates over the workers in a round robin fashion.
+        std::vector<size_t> indices;
+        for (auto ix = workerIdx; ix < candidates.size(); ix += numWorkers) {
+            indices.push_back(ix);
+        }
+
+        auto runWorker = [&, indices = std::move(indices)] {
+            auto opCtx = cc().makeOperationContext();
+            // The worker acts on behalf of this operation: it shares its deadline, and is killed
+            // when this operation is interrupted.
+            opCtx->setDeadlineByDate(_opCtx->getDeadline(), _opCtx->getTimeoutError());
+            coordinator.registerWorker(opCtx.get());
+            ON_BLOCK_EXIT([&] { coordinator.unregisterWorker(opCtx.get()); });
+
+            PlanYieldPolicySBE yieldPolicy{_yieldPolicy->getPolicy(),
+                                           opCtx->getServiceContext()->getFastClockSource(),
+                                           internalQueryExecYieldIterations.load(),
+                                           Milliseconds{internalQueryExecYieldPeriodMS.load()},
+                                           nullptr,
+                                           std::make_unique<YieldPolicyCallbacksImpl>(_cq.nss())};
+            for (auto ix : indices) {
+                auto root = candidates[ix].root.get();
+                root->attachToOperationContext(opCtx.get());
+                root->rebindYieldPolicy(&yieldPolicy);
+                yieldPolicy.registerPlan(root);
+            }
+
+            // Hand the candidates back to the planner, even if the trial period failed.
+            ON_BLOCK_EXIT([&] {
+                for (auto ix : indices) {
+                    auto root = candidates[ix].root.get();
+                    root->saveState();
+                    root->detachFromOperationContext();
+                }
+            });
+
+            try {
+                hangInSBETrialWorker.pauseWhileSet(opCtx.get());
+
+                for (auto ix : indices) {
+                    prepareCandidate(&candidates[ix], &slots[ix]);
+                }
+
+                for (size_t round = 1; coordinator.waitForRound(round); ++round) {
+                    coordinator.completeRound(runTrialRound(candidates, slots, indices));
+                }
+            } catch (...) {
+                coordinator.fail(exceptionToStatus());
+                throw;
+            }
+        };
+
+        auto pf = makePromiseFuture<void>();
+        trialThreadPool->schedule([&coordinator,
+                                   runWorker = std::move(runWorker),
+                                   promise = std::move(pf.promise)](auto status) mutable {
+            if (!status.isOK()) {
+                // The pool is shutting down, so the worker never ran.
+                coordinator.fail(status);
+                promise.setError(status);
+                return;
+            }
+            promise.setWith(runWorker);
+        });
+        workers.push_back(std::move(pf.future));
+    }
+
+    {
+        // Make sure the workers are done with the candidates before they are handed back, even
+        // if this operation is interrupted.
+        ON_BLOCK_EXIT([&] {
+            coordinator.stop();
+            for (auto&& worker : workers) {
+                worker.waitNoThrow().ignore();
             }
+        });
 
-            done |= fetchNextDocument(&candidates[ix], slots[ix]);
+        try {
+            for (size_t it = 0; it < maxNumResults; ++it) {
+                if (coordinator.runRound(_opCtx)) {
+                    break;
+                }
+            }
+        } catch (const DBException& ex) {
+            coordinator.interruptWorkers(ex.code());
+            throw;
         }
     }
 
-    return candidates;
+    // Rethrow the first failure of any worker.
+    uassertStatusOK(coordinator.failure());
+
+    for (auto&& candidate : candidates) {
+        candidate.root->attachToOperationContext(_opCtx);
+        candidate.root->rebindYieldPolicy(_yieldPolicy);
+        candidate.root->restoreState();
+    }
 }
 }  // namespace mongo::sbe
@@ -107,6 +107,9 @@ protected:
      *
      * The number of reads allowed for a trial execution period is bounded by
      * 'maxTrialPeriodNumReads'.
+     *
+     * If 'internalQueryPlanEvaluationMaxParallelTrials' allows it, the rounds of the round robin
+     * are spread over several worker threads, see runTrialsInParallel().
      */
     std::vector<plan_ranker::CandidatePlan> collectExecutionStats(
         std::vector<std::unique_ptr<QuerySolution>> solutions,
@@ -117,5 +120,32 @@ protected:
     const CollectionPtr& _collection;
     const CanonicalQuery& _cq;
     PlanYieldPolicySBE* const _yieldPolicy;
+
+private:
+    /**
+     * Prepares the plan of 'candidate' for the trial period and stores its result and recordId
+     * slots in 'slots'. A failure to prepare the plan is recorded in the candidate's status.
+     */
+    void prepareCandidate(plan_ranker::CandidatePlan* candidate,
+                          std::pair<value::SlotAccessor*, value::SlotAccessor*>* slots) const;
+
+    /**
+     * Returns the number of worker threads the trial periods of 'numCandidates' candidate plans
+     * should run on, or 1 if they should run on the calling thread.
+     */
+    size_t getNumTrialWorkers(size_t numCandidates) const;
+
+    /**
+     * Prepares the 'candidates' and runs their trial periods on 'numWorkers' worker threads, each
+     * with its own operation context. The trial periods end under the same conditions, and after
+     * the same number of rounds, as the round robin in collectExecutionStats(). The workers share
+     * the deadline of '_opCtx' and are killed if '_opCtx' is interrupted or if one of them fails.
+     * Upon return the candidates are attached back to '_opCtx' and to '_yieldPolicy'.
+     */
+    void runTrialsInParallel(
+        std::vector<plan_ranker::CandidatePlan>& candidates,
+        std::vector<std::pair<value::SlotAccessor*, value::SlotAccessor*>>& slots,
+        size_t maxNumResults,
+        size_t numWorkers);
 };
 }  // namespace mongo::sbe
@@ -60,7 +60,9 @@
 #include "mongo/db/query/sbe_stage_builder_helpers.h"
 #include "mongo/db/query/sbe_stage_builder_index_scan.h"
 #include "mongo/db/query/sbe_stage_builder_projection.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/storage/execution_context.h"
 #include "mongo/logv2/log.h"
@@ -244,6 +246,42 @@ std::unique_ptr<sbe::RuntimeEnvironment> makeRuntimeEnvironment(
     return env;
 }
 
+bool resetRuntimeEnvironment(const CanonicalQuery& cq,
+                             OperationContext* opCtx,
+                             sbe::RuntimeEnvironment* env) {
+    env->resetSlot(env->getSlot("timeZoneDB"_sd),
+                   sbe::value::TypeTags::timeZoneDB,
+                   sbe::value::bitcastFrom<const TimeZoneDatabase*>(getTimeZoneDatabase(opCtx)),
+                   false);
+
+    // The collator is compiled into the plan stages which use it, so it cannot be changed here.
+    if (cq.getCollator() || env->getSlotIfExists("collator"_sd)) {
+        return false;
+    }
+
+    for (auto&& [id, name] : Variables::kIdToBuiltinVarName) {
+        if (id == Variables::kRootId || id == Variables::kRemoveId) {
+            continue;
+        }
+
+        auto slot = env->getSlotIfExists(name);
+        if (!cq.getExpCtx()->variables.hasValue(id)) {
+            if (slot) {
+                return false;
+            }
+            continue;
+        }
+        if (!slot) {
+            return false;
+        }
+
+        auto [tag, val] = makeValue(cq.getExpCtx()->variables.getValue(id));
+        env->resetSlot(*slot, tag, val, true);
+    }
+
+    return true;
+}
+
 PlanStageSlots::PlanStageSlots(const PlanStageReqs& reqs,
                                sbe::value::SlotIdGenerator* slotIdGenerator) {
     for (auto&& [slotName, isRequired] : reqs._slots) {
@@ -283,6 +321,58 @@ const QuerySolutionNode* getNodeByType(const QuerySolutionNode* root, StageType
     return nullptr;
 }
 
+void getIndexScanNodes(const QuerySolutionNode* root,
+                       std::vector<const QuerySolutionNode*>* indexScans) {
+    if (root->getType() == STAGE_IXSCAN) {
+        indexScans->push_back(root);
+    }
+
+    for (auto&& child : root->children) {
+        getIndexScanNodes(child, indexScans);
+    }
+}
+
+/**
+ * Returns true if the plan built for the solution tree 'root' depends on the constants of the
+ * query only through its input parameters and index bounds. Some stages compile other values
+ * derived from the filter into the plan, e.g. the record id range of a clustered collection scan.
+ */
+bool canParameterize(const QuerySolutionNode* root) {
+    switch (root->getType()) {
+        case STAGE_COLLSCAN: {
+            auto csn = static_cast<const CollectionScanNode*>(root);
+            if (csn->minRecord || csn->maxRecord || csn->resumeAfterRecordId) {
+                return false;
+            }
+            break;
+        }
+        case STAGE_IXSCAN:
+        case STAGE_FETCH:
+        case STAGE_LIMIT:
+        case STAGE_SKIP:
+        case STAGE_SORT_SIMPLE:
+        case STAGE_SORT_DEFAULT:
+        case STAGE_SORT_KEY_GENERATOR:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_COVERED:
+        case STAGE_OR:
+        case STAGE_RETURN_KEY:
+        case STAGE_EOF:
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED:
+        case STAGE_SORT_MERGE:
+        case STAGE_SHARDING_FILTER:
+            break;
+        default:
+            return false;
+    }
+
+    return std::all_of(root->children.begin(), root->children.end(), [](auto&& child) {
+        return canParameterize(child);
+    });
+}
+
 sbe::LockAcquisitionCallback makeLockAcquisitionCallback(bool checkNodeCanServeReads) {
     if (!checkNodeCanServeReads) {
         return {};
@@ -462,15 +552,47 @@ std::unique_ptr<fts::FTSMatcher> makeFtsMatcher(OperationContext* opCtx,
 }
 }  // namespace
 
+bool bindInputParams(OperationContext* opCtx,
+                     const CollectionPtr& collection,
+                     const CanonicalQuery& cq,
+                     const QuerySolution& solution,
+                     sbe::RuntimeEnvironment* env) {
+    const auto& inputParams = cq.getInputParams();
+    for (size_t paramId = 0; paramId < inputParams.size(); ++paramId) {
+        auto slot = env->getSlotIfExists(
+            makeInputParamSlotName(static_cast<MatchExpression::InputParamId>(paramId)));
+        if (!slot) {
+            return false;
+        }
+        auto [tag, val] = makeInputParamValue(inputParams[paramId]);
+        env->resetSlot(*slot, tag, val, true);
+    }
+
+    std::vector<const QuerySolutionNode*> indexScans;
+    getIndexScanNodes(solution.root(), &indexScans);
+    for (auto&& node : indexScans) {
+        auto slot = env->getSlotIfExists(makeIndexBoundsSlotName(node->nodeId()));
+        auto bounds =
+            makeIndexBoundsParam(opCtx, collection, static_cast<const IndexScanNode*>(node));
+        if (!slot || !bounds) {
+            return false;
+        }
+        env->resetSlot(*slot, bounds->first, bounds->second, true);
+    }
+    return true;
+}
+
 SlotBasedStageBuilder::SlotBasedStageBuilder(OperationContext* opCtx,
                                              const CollectionPtr& collection,
                                              const CanonicalQuery& cq,
                                              const QuerySolution& solution,
                                              PlanYieldPolicySBE* yieldPolicy,
-                                             ShardFiltererFactoryInterface* shardFiltererFactory)
+                                             ShardFiltererFactoryInterface* shardFiltererFactory,
+                                             bool parameterize)
     : StageBuilder(opCtx, collection, cq, solution),
       _yieldPolicy(yieldPolicy),
       _data(makeRuntimeEnvironment(_cq, _opCtx, &_slotIdGenerator)),
+      _parameterize(parameterize && cq.isParameterized()),
       _shardFiltererFactory(shardFiltererFactory),
       _lockAcquisitionCallback(makeLockAcquisitionCallback(solution.shouldCheckCanServeReads())) {
     // SERVER-52803: In the future if we need to gather more information from the QuerySolutionNode
@@ -487,6 +609,23 @@ SlotBasedStageBuilder::SlotBasedStageBuilder(OperationContext* opCtx,
         auto vsn = static_cast<const VirtualScanNode*>(node);
         _shouldProduceRecordIdSlot = vsn->hasRecordId;
     }
+
+    // Register the input parameters of the query, so that the filters read them from the runtime
+    // environment rather than compiling in the constants. Index scans register their bounds.
+    if (_parameterize) {
+        _data.isParameterized = canParameterize(solution.root());
+
+        const auto& inputParams = _cq.getInputParams();
+        for (size_t paramId = 0; paramId < inputParams.size(); ++paramId) {
+            auto [tag, val] = makeInputParamValue(inputParams[paramId]);
+            _data.env->registerSlot(
+                makeInputParamSlotName(static_cast<MatchExpression::InputParamId>(paramId)),
+                tag,
+                val,
+                true,
+                &_slotIdGenerator);
+        }
+    }
 }
 
 std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolutionNode* root) {
@@ -520,6 +659,21 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
 
     auto csn = static_cast<const CollectionScanNode*>(root);
 
+    // Parallel scans return documents in no particular order and read from their own storage
+    // snapshots, so they are not used if the query asked for natural order, runs in a transaction,
+    // or needs a read concern stronger than "local".
+    size_t degreeOfParallelism = 1;
+    if (auto dop = internalQuerySlotBasedExecutionMaxDegreeOfParallelism.load(); dop > 1) {
+        const auto& findCommand = _cq.getFindCommandRequest();
+        const bool requiresNaturalOrder = findCommand.getSort().hasField("$natural") ||
+            findCommand.getHint().hasField("$natural");
+        if (!requiresNaturalOrder && !_opCtx->inMultiDocumentTransaction() &&
+            repl::ReadConcernArgs::get(_opCtx).getLevel() ==
+                repl::ReadConcernLevel::kLocalReadConcern) {
+            degreeOfParallelism = dop;
+        }
+    }
+
     auto [stage, outputs] = generateCollScan(_opCtx,
                                              _collection,
                                              csn,
@@ -528,7 +682,8 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                              _yieldPolicy,
                                              _data.env,
                                              reqs.getIsTailableCollScanResumeBranch(),
-                                             _lockAcquisitionCallback);
+                                             _lockAcquisitionCallback,
+                                             degreeOfParallelism);
 
     if (reqs.has(kReturnKey)) {
         // Assign the 'returnKeySlot' to be the empty object.
@@ -651,7 +806,13 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                               _data.env,
                                               _lockAcquisitionCallback,
                                               iamMap,
-                                              reqs.has(kIndexKeyPattern));
+                                              reqs.has(kIndexKeyPattern),
+                                              _parameterize);
+
+    // Bounds which cannot be decomposed into single intervals are compiled into the plan.
+    if (_parameterize && !_data.env->getSlotIfExists(makeIndexBoundsSlotName(ixn->nodeId()))) {
+        _data.isParameterized = false;
+    }
 
     if (reqs.has(PlanStageSlots::kReturnKey)) {
         std::vector<std::unique_ptr<sbe::EExpression>> mkObjArgs;
@@ -1629,29 +1790,35 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
 
     tassert(5073711, "need at least two children for AND_HASH", andHashNode->children.size() >= 2);
 
-    auto childReqs = reqs.copy().set(kResult).set(kRecordId);
+    // The children are joined on their RecordIds. A result object is only requested from them if
+    // the parent needs one, which is usually not the case as the intersection is typically
+    // followed by a FETCH. This saves the index scans from building an object out of every key.
+    auto childReqs = reqs.copy().set(kRecordId);
 
     auto outerChild = andHashNode->children[0];
     auto innerChild = andHashNode->children[1];
 
     auto [outerStage, outerOutputs] = build(outerChild, childReqs);
     auto outerIdSlot = outerOutputs.get(kRecordId);
-    auto outerResultSlot = outerOutputs.get(kResult);
     auto outerCondSlots = sbe::makeSV(outerIdSlot);
-    auto outerProjectSlots = sbe::makeSV(outerResultSlot);
+    auto outerProjectSlots = sbe::makeSV();
+    if (reqs.has(kResult)) {
+        outerProjectSlots.push_back(outerOutputs.get(kResult));
+    }
 
     auto [innerStage, innerOutputs] = build(innerChild, childReqs);
     tassert(5073712, "innerOutputs must contain kRecordId slot", innerOutputs.has(kRecordId));
-    tassert(5073713, "innerOutputs must contain kResult slot", innerOutputs.has(kResult));
+    tassert(5073713,
+            "innerOutputs must contain kResult slot",
+            !reqs.has(kResult) || innerOutputs.has(kResult));
     auto innerIdSlot = innerOutputs.get(kRecordId);
-    auto innerResultSlot = innerOutputs.get(kResult);
     auto innerSnapshotIdSlot = innerOutputs.getIfExists(kSnapshotId);
     auto innerIndexIdSlot = innerOutputs.getIfExists(kIndexId);
     auto innerIndexKeySlot = innerOutputs.getIfExists(kIndexKey);
     auto innerIndexKeyPatternSlot = innerOutputs.getIfExists(kIndexKeyPattern);
 
     auto innerCondSlots = sbe::makeSV(innerIdSlot);
-    auto innerProjectSlots = sbe::makeSV(innerResultSlot);
+    auto innerProjectSlots = sbe::makeSV();
 
     auto collatorSlot = _data.env->getSlotIfExists("collator"_sd);
 
@@ -1661,6 +1828,8 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
         outputs.set(kRecordId, innerIdSlot);
     }
     if (reqs.has(kResult)) {
+        auto innerResultSlot = innerOutputs.get(kResult);
+        innerProjectSlots.push_back(innerResultSlot);
         outputs.set(kResult, innerResultSlot);
     }
     if (reqs.has(kSnapshotId) && innerSnapshotIdSlot) {
@@ -1692,6 +1861,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                         innerCondSlots,
                                                         innerProjectSlots,
                                                         collatorSlot,
+                                                        _cq.getExpCtx()->allowDiskUse,
                                                         root->nodeId());
 
     // If there are more than 2 children, iterate all remaining children and hash
@@ -1699,11 +1869,15 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
     for (size_t i = 2; i < andHashNode->children.size(); i++) {
         auto [stage, outputs] = build(andHashNode->children[i], childReqs);
         tassert(5073714, "outputs must contain kRecordId slot", outputs.has(kRecordId));
-        tassert(5073715, "outputs must contain kResult slot", outputs.has(kResult));
+        tassert(5073715,
+                "outputs must contain kResult slot",
+                !reqs.has(kResult) || outputs.has(kResult));
         auto idSlot = outputs.get(kRecordId);
-        auto resultSlot = outputs.get(kResult);
         auto condSlots = sbe::makeSV(idSlot);
-        auto projectSlots = sbe::makeSV(resultSlot);
+        auto projectSlots = sbe::makeSV();
+        if (reqs.has(kResult)) {
+            projectSlots.push_back(outputs.get(kResult));
+        }
 
         // The previous HashJoinStage is always set as the inner stage, so that we can reuse the
         // innerIdSlot and innerResultSlot that have been designated as outputs.
@@ -1714,6 +1888,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                        innerCondSlots,
                                                        innerProjectSlots,
                                                        collatorSlot,
+                                                       _cq.getExpCtx()->allowDiskUse,
                                                        root->nodeId());
     }
 
@@ -1728,17 +1903,21 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
     tassert(
         5073706, "need at least two children for AND_SORTED", andSortedNode->children.size() >= 2);
 
-    auto childReqs = reqs.copy().set(kResult).set(kRecordId);
+    // As with AND_HASH, the children only need to produce a result object if the parent asks for
+    // one.
+    auto childReqs = reqs.copy().set(kRecordId);
 
     auto outerChild = andSortedNode->children[0];
     auto innerChild = andSortedNode->children[1];
 
     auto [outerStage, outerOutputs] = build(outerChild, childReqs);
     auto outerIdSlot = outerOutputs.get(kRecordId);
-    auto outerResultSlot = outerOutputs.get(kResult);
 
     auto outerKeySlots = sbe::makeSV(outerIdSlot);
-    auto outerProjectSlots = sbe::makeSV(outerResultSlot);
+    auto outerProjectSlots = sbe::makeSV();
+    if (reqs.has(kResult)) {
+        outerProjectSlots.push_back(outerOutputs.get(kResult));
+    }
     if (outerOutputs.has(kSnapshotId)) {
         outerProjectSlots.push_back(outerOutputs.get(kSnapshotId));
     }
@@ -1757,18 +1936,21 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
 
     auto [innerStage, innerOutputs] = build(innerChild, childReqs);
     tassert(5073707, "innerOutputs must contain kRecordId slot", innerOutputs.has(kRecordId));
-    tassert(5073708, "innerOutputs must contain kResult slot", innerOutputs.has(kResult));
+    tassert(5073708,
+            "innerOutputs must contain kResult slot",
+            !reqs.has(kResult) || innerOutputs.has(kResult));
     auto innerIdSlot = innerOutputs.get(kRecordId);
-    auto innerResultSlot = innerOutputs.get(kResult);
 
     auto innerKeySlots = sbe::makeSV(innerIdSlot);
-    auto innerProjectSlots = sbe::makeSV(innerResultSlot);
+    auto innerProjectSlots = sbe::makeSV();
 
     PlanStageSlots outputs(reqs, &_slotIdGenerator);
     if (reqs.has(kRecordId)) {
         outputs.set(kRecordId, innerIdSlot);
     }
     if (reqs.has(kResult)) {
+        auto innerResultSlot = innerOutputs.get(kResult);
+        innerProjectSlots.push_back(innerResultSlot);
         outputs.set(kResult, innerResultSlot);
     }
     if (reqs.has(kSnapshotId)) {
@@ -1810,11 +1992,15 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
     for (size_t i = 2; i < andSortedNode->children.size(); i++) {
         auto [stage, outputs] = build(andSortedNode->children[i], childReqs);
         tassert(5073709, "outputs must contain kRecordId slot", outputs.has(kRecordId));
-        tassert(5073710, "outputs must contain kResult slot", outputs.has(kResult));
+        tassert(5073710,
+                "outputs must contain kResult slot",
+                !reqs.has(kResult) || outputs.has(kResult));
         auto idSlot = outputs.get(kRecordId);
-        auto resultSlot = outputs.get(kResult);
         auto keySlots = sbe::makeSV(idSlot);
-        auto projectSlots = sbe::makeSV(resultSlot);
+        auto projectSlots = sbe::makeSV();
+        if (reqs.has(kResult)) {
+            projectSlots.push_back(outputs.get(kResult));
+        }
 
         mergeJoinStage = sbe::makeS<sbe::MergeJoinStage>(std::move(stage),
                                                          std::move(mergeJoinStage),
@@ -38,6 +38,10 @@
 #include "mongo/db/query/shard_filterer_factory_interface.h"
 #include "mongo/db/query/stage_builder.h"
 
+namespace mongo {
+class SbeStageBuilderTestFixture;
+}  // namespace mongo
+
 namespace mongo::stage_builder {
 /**
  * Creates a new compilation environment and registers global values within the
@@ -48,6 +52,29 @@ std::unique_ptr<sbe::RuntimeEnvironment> makeRuntimeEnvironment(
     OperationContext* opCtx,
     sbe::value::SlotIdGenerator* slotIdGenerator);
 
+/**
+ * Resets the global values registered by 'makeRuntimeEnvironment()' within 'env' to the values of
+ * the given query 'cq'. The 'env' must be a copy of an environment created for a query with the
+ * same parameters as 'cq'. Returns false if 'env' does not have a slot for one of the global values
+ * of 'cq', or has a slot for a value 'cq' does not define, in which case 'env' cannot be used to
+ * execute 'cq'.
+ */
+bool resetRuntimeEnvironment(const CanonicalQuery& cq,
+                             OperationContext* opCtx,
+                             sbe::RuntimeEnvironment* env);
+
+/**
+ * Binds the input parameters of 'cq' and the index bounds of its 'solution' to the slots of 'env',
+ * which must be a copy of the environment of a parameterized plan (see
+ * 'PlanStageData::isParameterized') built for a query of the same shape. Returns false if a value
+ * cannot be bound, in which case 'env' cannot be used to execute 'cq'.
+ */
+bool bindInputParams(OperationContext* opCtx,
+                     const CollectionPtr& collection,
+                     const CanonicalQuery& cq,
+                     const QuerySolution& solution,
+                     sbe::RuntimeEnvironment* env);
+
 class PlanStageReqs;
 
 /**
@@ -243,6 +270,10 @@ struct PlanStageData {
     bool shouldTrackResumeToken{false};
     bool shouldUseTailableScan{false};
 
+    // True if the plan reads every input parameter of the query and all of its index bounds from
+    // the runtime environment, so that it can be rebound to another query of the same shape.
+    bool isParameterized{false};
+
     // If this execution tree was built as a result of replanning of the cached plan, this string
     // will include the reason for replanning.
     std::optional<std::string> replanReason;
@@ -266,7 +297,8 @@ public:
                           const CanonicalQuery& cq,
                           const QuerySolution& solution,
                           PlanYieldPolicySBE* yieldPolicy,
-                          ShardFiltererFactoryInterface* shardFilterer);
+                          ShardFiltererFactoryInterface* shardFilterer,
+                          bool parameterize = false);
 
     std::unique_ptr<sbe::PlanStage> build(const QuerySolutionNode* root) final;
 
@@ -275,6 +307,9 @@ public:
     }
 
 private:
+    // Builds sub-trees for parents with specific requirements in unit tests.
+    friend class ::mongo::SbeStageBuilderTestFixture;
+
     std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> build(const QuerySolutionNode* node,
                                                                      const PlanStageReqs& reqs);
 
@@ -377,6 +412,10 @@ private:
     bool _buildHasStarted{false};
     bool _shouldProduceRecordIdSlot{true};
 
+    // True if the filter constants and index bounds are read from the runtime environment, see
+    // 'PlanStageData::isParameterized'.
+    const bool _parameterize;
+
     // A factory to construct shard filters.
     ShardFiltererFactoryInterface* _shardFiltererFactory;
 
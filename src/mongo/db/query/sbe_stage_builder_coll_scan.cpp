@@ -42,10 +42,13 @@
 #include "mongo/db/exec/sbe/stages/project.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/union.h"
+#include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/sbe_stage_builder_helpers.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/query/yield_policy_callbacks_impl.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/str.h"
 
@@ -588,6 +591,104 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
 
     return {std::move(stage), std::move(outputs)};
 }
+
+/**
+ * Returns true if 'csn' can be executed as a parallel scan, i.e. it is a forward scan which neither
+ * depends on nor reports its position in the collection.
+ */
+bool canScanInParallel(const CollectionPtr& collection,
+                       const CollectionScanNode* csn,
+                       bool isTailableResumeBranch) {
+    return csn->direction == CollectionScanParams::FORWARD && !csn->tailable &&
+        !isTailableResumeBranch && !csn->resumeAfterRecordId && !csn->requestResumeToken &&
+        !csn->shouldTrackLatestOplogTimestamp && !csn->shouldWaitForOplogVisibility &&
+        !collection->ns().isOplog();
+}
+
+/**
+ * Creates a collection scan sub-tree which is executed by 'degreeOfParallelism' worker threads:
+ *
+ *   exchange [resultSlot, recordIdSlot] degreeOfParallelism round
+ *   filter {...}
+ *   pscan resultSlot recordIdSlot
+ *
+ * The exchange clones the sub-tree below it for every worker. The parallel scan stages of the
+ * clones share the collection's RecordId ranges, so each worker scans and filters a disjoint part
+ * of the collection. The workers run on their own operation contexts, which are interrupted along
+ * with the query's, and yield through their own policies of the same kind as 'yieldPolicy'.
+ */
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateParallelCollScan(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const CollectionScanNode* csn,
+    sbe::value::SlotIdGenerator* slotIdGenerator,
+    sbe::value::FrameIdGenerator* frameIdGenerator,
+    PlanYieldPolicy* yieldPolicy,
+    sbe::RuntimeEnvironment* env,
+    sbe::LockAcquisitionCallback lockAcquisitionCallback,
+    size_t degreeOfParallelism) {
+    auto resultSlot = slotIdGenerator->generate();
+    auto recordIdSlot = slotIdGenerator->generate();
+
+    std::unique_ptr<sbe::PlanStage> stage =
+        sbe::makeS<sbe::ParallelScanStage>(collection->uuid(),
+                                           resultSlot,
+                                           recordIdSlot,
+                                           boost::none /* snapshotIdSlot */,
+                                           boost::none /* indexIdSlot */,
+                                           boost::none /* indexKeySlot */,
+                                           boost::none /* keyPatternSlot */,
+                                           std::vector<std::string>{},
+                                           sbe::makeSV(),
+                                           yieldPolicy,
+                                           csn->nodeId(),
+                                           sbe::ScanCallbacks(std::move(lockAcquisitionCallback)));
+
+    if (csn->filter) {
+        auto relevantSlots = sbe::makeSV(resultSlot, recordIdSlot);
+
+        std::tie(std::ignore, stage) = generateFilter(opCtx,
+                                                      csn->filter.get(),
+                                                      std::move(stage),
+                                                      slotIdGenerator,
+                                                      frameIdGenerator,
+                                                      resultSlot,
+                                                      env,
+                                                      std::move(relevantSlots),
+                                                      csn->nodeId());
+    }
+
+    sbe::ExchangeYieldPolicyFactory yieldPolicyFactory;
+    if (yieldPolicy) {
+        yieldPolicyFactory = [policy = yieldPolicy->getPolicy(), nss = collection->ns()](
+                                 OperationContext* opCtx, sbe::PlanStage* producer) {
+            auto producerYieldPolicy = std::make_unique<PlanYieldPolicySBE>(
+                policy,
+                opCtx->getServiceContext()->getFastClockSource(),
+                internalQueryExecYieldIterations.load(),
+                Milliseconds{internalQueryExecYieldPeriodMS.load()},
+                nullptr,
+                std::make_unique<YieldPolicyCallbacksImpl>(nss));
+            producerYieldPolicy->registerPlan(producer);
+            return producerYieldPolicy;
+        };
+    }
+
+    stage = sbe::makeS<sbe::ExchangeConsumer>(std::move(stage),
+                                              degreeOfParallelism,
+                                              sbe::makeSV(resultSlot, recordIdSlot),
+                                              sbe::ExchangePolicy::roundrobin,
+                                              nullptr /* partition */,
+                                              nullptr /* orderLess */,
+                                              csn->nodeId(),
+                                              std::move(yieldPolicyFactory));
+
+    PlanStageSlots outputs;
+    outputs.set(PlanStageSlots::kResult, resultSlot);
+    outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
+
+    return {std::move(stage), std::move(outputs)};
+}
 }  // namespace
 
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -599,7 +700,8 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     PlanYieldPolicy* yieldPolicy,
     sbe::RuntimeEnvironment* env,
     bool isTailableResumeBranch,
-    sbe::LockAcquisitionCallback lockAcquisitionCallback) {
+    sbe::LockAcquisitionCallback lockAcquisitionCallback,
+    size_t degreeOfParallelism) {
     if (csn->minRecord || csn->maxRecord) {
         return generateOptimizedOplogScan(opCtx,
                                           collection,
@@ -610,6 +712,17 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
                                           env,
                                           isTailableResumeBranch,
                                           std::move(lockAcquisitionCallback));
+    } else if (degreeOfParallelism > 1 &&
+               canScanInParallel(collection, csn, isTailableResumeBranch)) {
+        return generateParallelCollScan(opCtx,
+                                        collection,
+                                        csn,
+                                        slotIdGenerator,
+                                        frameIdGenerator,
+                                        yieldPolicy,
+                                        env,
+                                        std::move(lockAcquisitionCallback),
+                                        degreeOfParallelism);
     } else {
         return generateGenericCollScan(opCtx,
                                        collection,
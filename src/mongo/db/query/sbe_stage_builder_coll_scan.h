@@ -49,6 +49,9 @@ class PlanStageSlots;
  *     were requested to track this data.
  *   * A generated PlanStage sub-tree.
  *
+ * If 'degreeOfParallelism' is greater than one and the scan is a plain forward scan, the scan is
+ * split across that many worker threads and its results are returned in no particular order.
+ *
  * In cases of an error, throws.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -60,6 +63,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     PlanYieldPolicy* yieldPolicy,
     sbe::RuntimeEnvironment* env,
     bool isTailableResumeBranch,
-    sbe::LockAcquisitionCallback lockAcquisitionCallback);
+    sbe::LockAcquisitionCallback lockAcquisitionCallback,
+    size_t degreeOfParallelism);
 
 }  // namespace mongo::stage_builder
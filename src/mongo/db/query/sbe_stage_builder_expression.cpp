@@ -1124,6 +1124,7 @@ public:
 
         // Create a group stage to aggregate elements into a single array.
         auto collatorSlot = _context->runtimeEnvironment->getSlotIfExists("collator"_sd);
+        const bool allowDiskUse = expr->getExpressionContext()->allowDiskUse;
         auto addToArrayExpr =
             makeFunction("addToArray", sbe::makeE<sbe::EVariable>(unionWithNullSlot));
         auto groupSlot = _context->slotIdGenerator->generate();
@@ -1132,6 +1133,7 @@ public:
                                           sbe::makeSV(),
                                           sbe::makeEM(groupSlot, std::move(addToArrayExpr)),
                                           collatorSlot,
+                                          allowDiskUse,
                                           _context->planNodeId);
         EvalStage groupEvalStage = {std::move(groupStage), sbe::makeSV(groupSlot)};
 
@@ -1161,6 +1163,7 @@ public:
             sbe::makeSV(),
             sbe::makeEM(finalGroupSlot, std::move(finalAddToArrayExpr)),
             collatorSlot,
+            allowDiskUse,
             _context->planNodeId);
 
         // Create a branch stage to select between the branch that produces one null if any elements
@@ -41,6 +41,7 @@
 #include "mongo/db/exec/sbe/stages/traverse.h"
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/matcher/expression_always_boolean.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_expr.h"
@@ -701,6 +702,24 @@ void generateArraySize(MatchExpressionVisitorContext* context,
                       LeafTraversalMode::kDoNotTraverseLeaf);
 }
 
+/**
+ * Returns an expression which reads the input parameter of 'expr' from the runtime environment, if
+ * the plan is built with input parameters, or the constant 'tag'/'val' otherwise. Takes ownership
+ * of the constant in both cases.
+ */
+std::unique_ptr<sbe::EExpression> makeInputParamOrConstant(sbe::RuntimeEnvironment* env,
+                                                           const MatchExpression* expr,
+                                                           sbe::value::TypeTags tag,
+                                                           sbe::value::Value val) {
+    if (auto paramId = expression::getInputParamId(expr); paramId && env) {
+        if (auto slot = env->getSlotIfExists(makeInputParamSlotName(*paramId))) {
+            sbe::value::releaseValue(tag, val);
+            return makeVariable(*slot);
+        }
+    }
+    return sbe::makeE<sbe::EConstant>(tag, val);
+}
+
 /**
  * Generates a path traversal SBE plan stage sub-tree which implements the comparison match
  * expression 'expr'. The comparison itself executes using the given 'binaryOp'.
@@ -809,8 +828,11 @@ void generateComparison(MatchExpressionVisitorContext* context,
         return {makeBinaryOp(
                     sbe::EPrimBinary::logicAnd,
                     makeNot(makeFillEmptyFalse(makeFunction("isNaN", makeVariable(inputSlot)))),
-                    makeFillEmptyFalse(makeBinaryOp(
-                        binaryOp, makeVariable(inputSlot), makeConstant(tag, val), context->env))),
+                    makeFillEmptyFalse(
+                        makeBinaryOp(binaryOp,
+                                     makeVariable(inputSlot),
+                                     makeInputParamOrConstant(context->env, expr, tag, val),
+                                     context->env))),
                 std::move(inputStage)};
     };
 
@@ -1445,8 +1467,9 @@ public:
         auto equalities = expr->getEqualities();
 
         // Build an ArraySet for testing membership of the field in the equalities vector of the
-        // InMatchExpression.
-        auto [arrSetTag, arrSetVal] = sbe::value::makeNewArraySet();
+        // InMatchExpression. The set hashes and compares its values with the collator of the
+        // expression, so that 'collIsMember' can probe it rather than scanning it.
+        auto [arrSetTag, arrSetVal] = sbe::value::makeNewArraySet(expr->getCollator());
         sbe::value::ValueGuard arrSetGuard{arrSetTag, arrSetVal};
 
         auto arrSet = sbe::value::getArraySetView(arrSetVal);
@@ -1485,7 +1508,8 @@ public:
 
                 arrSetGuard.reset();
                 return {makeIsMember(std::move(inputExpr),
-                                     sbe::makeE<sbe::EConstant>(arrSetTag, arrSetVal),
+                                     makeInputParamOrConstant(
+                                         _context->env, expr, arrSetTag, arrSetVal),
                                      _context->env),
                         std::move(inputStage)};
             };
@@ -41,6 +41,7 @@
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unwind.h"
 #include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/matcher_type_set.h"
 #include <iterator>
 #include <numeric>
@@ -593,6 +594,36 @@ std::pair<sbe::value::TypeTags, sbe::value::Value> makeValue(const Value& val) {
     return sbe::bson::convertFrom(false, be + 4, end, 0);
 }
 
+std::string makeInputParamSlotName(MatchExpression::InputParamId paramId) {
+    return str::stream() << "inputParam" << paramId;
+}
+
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId) {
+    return str::stream() << "indexBounds" << nodeId;
+}
+
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeInputParamValue(
+    const MatchExpression* expr) {
+    auto copyElement = [](const BSONElement& elem) {
+        auto [tagView, valView] = sbe::bson::convertFrom(
+            true, elem.rawdata(), elem.rawdata() + elem.size(), elem.fieldNameSize() - 1);
+        return sbe::value::copyValue(tagView, valView);
+    };
+
+    if (expr->matchType() != MatchExpression::MATCH_IN) {
+        return copyElement(static_cast<const ComparisonMatchExpressionBase*>(expr)->getData());
+    }
+
+    auto inExpr = static_cast<const InMatchExpression*>(expr);
+    auto [arrSetTag, arrSetVal] = sbe::value::makeNewArraySet(inExpr->getCollator());
+    auto arrSet = sbe::value::getArraySetView(arrSetVal);
+    for (auto&& equality : inExpr->getEqualities()) {
+        auto [tag, val] = copyElement(equality);
+        arrSet->push_back(tag, val);
+    }
+    return {arrSetTag, arrSetVal};
+}
+
 uint32_t dateTypeMask() {
     return (getBSONTypeMask(sbe::value::TypeTags::Date) |
             getBSONTypeMask(sbe::value::TypeTags::Timestamp) |
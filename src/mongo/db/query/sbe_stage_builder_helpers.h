@@ -37,6 +37,7 @@
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/sbe_stage_builder_eval_frame.h"
 #include "mongo/db/query/stage_types.h"
 
@@ -392,6 +393,21 @@ std::pair<sbe::value::TypeTags, sbe::value::Value> makeValue(const BSONArray& ba
  */
 std::pair<sbe::value::TypeTags, sbe::value::Value> makeValue(const Value& val);
 
+/**
+ * Return the names of the runtime environment slots through which a parameterized plan reads the
+ * value of the input parameter 'paramId' and the intervals of the index scan built for the
+ * solution node 'nodeId'.
+ */
+std::string makeInputParamSlotName(MatchExpression::InputParamId paramId);
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId);
+
+/**
+ * Returns the value of the input parameter held by the parameterized predicate 'expr': a copy of
+ * the constant of a comparison, or an ArraySet of the equalities of an $in. Caller owns the SBE
+ * Value returned.
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeInputParamValue(const MatchExpression* expr);
+
 /**
  * Returns a BSON type mask of all data types coercible to date.
  */
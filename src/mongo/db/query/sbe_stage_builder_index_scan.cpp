@@ -251,6 +251,30 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
     return result;
 }
 
+/**
+ * Constructs an array containing objects with the low and high keys for each interval. E.g.,
+ *    [ {l: KS(...), h: KS(...)},
+ *      {l: KS(...), h: KS(...)}, ... ]
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeIntervalsArray(
+    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+        intervals) {
+    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
+    auto arr = sbe::value::getArrayView(boundsVal);
+    for (auto&& [lowKey, highKey] : intervals) {
+        auto [tag, val] = sbe::value::makeNewObject();
+        auto obj = sbe::value::getObjectView(val);
+        obj->push_back("l"_sd,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
+        obj->push_back("h"_sd,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
+        arr->push_back(tag, val);
+    }
+    return {boundsTag, boundsVal};
+}
+
 /**
  * Constructs an optimized version of an index scan for multi-interval index bounds for the case
  * when the bounds can be decomposed in a number of single-interval bounds. In this case, instead
@@ -276,6 +300,8 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  * This subtree is similar to the single-interval subtree with the only difference that instead
  * of projecting a single pair of the low/high keys, we project an array of such pairs and then
  * use the unwind stage to flatten the array and generate multiple input intervals to the ixscan.
+ * The array is computed by 'boundsExpr', which is either a constant built by
+ * 'makeIntervalsArray()' or a runtime environment slot holding one.
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
 generateOptimizedMultiIntervalIndexScan(
@@ -283,8 +309,7 @@ generateOptimizedMultiIntervalIndexScan(
     const std::string& indexName,
     const BSONObj& keyPattern,
     bool forward,
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        intervals,
+    std::unique_ptr<sbe::EExpression> boundsExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     boost::optional<sbe::value::SlotId> snapshotIdSlot,
@@ -301,23 +326,6 @@ generateOptimizedMultiIntervalIndexScan(
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
 
-    // Construct an array containing objects with the low and high keys for each interval. E.g.,
-    //    [ {l: KS(...), h: KS(...)},
-    //      {l: KS(...), h: KS(...)}, ... ]
-    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
-    auto arr = sbe::value::getArrayView(boundsVal);
-    for (auto&& [lowKey, highKey] : intervals) {
-        auto [tag, val] = sbe::value::makeNewObject();
-        auto obj = sbe::value::getObjectView(val);
-        obj->push_back("l"_sd,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
-        obj->push_back("h"_sd,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
-        arr->push_back(tag, val);
-    }
-
     auto boundsSlot = slotIdGenerator->generate();
     auto unwindSlot = slotIdGenerator->generate();
 
@@ -329,7 +337,7 @@ generateOptimizedMultiIntervalIndexScan(
                 sbe::makeS<sbe::CoScanStage>(planNodeId), 1, boost::none, planNodeId),
             planNodeId,
             boundsSlot,
-            sbe::makeE<sbe::EConstant>(boundsTag, boundsVal)),
+            std::move(boundsExpr)),
         boundsSlot,
         unwindSlot,
         slotIdGenerator->generate(), /* We don't need an index slot but must to provide it. */
@@ -903,7 +911,8 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     sbe::RuntimeEnvironment* env,
     sbe::LockAcquisitionCallback lockAcquisitionCallback,
     StringMap<const IndexAccessMethod*>* iamMap,
-    bool needsCorruptionCheck) {
+    bool needsCorruptionCheck,
+    bool parameterizeBounds) {
 
     auto indexName = ixn->index.identifier.catalogName;
     auto descriptor = collection->getIndexCatalog()->findIndexByName(opCtx, indexName);
@@ -970,7 +979,34 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
         relevantSlots.push_back(*indexKeyPatternSlot);
     }
 
-    if (intervals.size() == 1) {
+    if (parameterizeBounds && !intervals.empty()) {
+        // Read the intervals from the runtime environment, so that the plan can be rebound to the
+        // bounds of another query of the same shape even if they consist of a different number of
+        // intervals.
+        auto [boundsTag, boundsVal] = makeIntervalsArray(std::move(intervals));
+        auto boundsSlot = env->registerSlot(
+            makeIndexBoundsSlotName(ixn->nodeId()), boundsTag, boundsVal, true, slotIdGenerator);
+
+        sbe::value::SlotId recordIdSlot;
+        std::tie(recordIdSlot, stage) =
+            generateOptimizedMultiIntervalIndexScan(collection,
+                                                    indexName,
+                                                    keyPattern,
+                                                    ixn->direction == 1,
+                                                    makeVariable(boundsSlot),
+                                                    indexKeyBitset,
+                                                    indexKeySlots,
+                                                    snapshotIdSlot,
+                                                    indexIdSlot,
+                                                    indexKeySlot,
+                                                    indexKeyPatternSlot,
+                                                    slotIdGenerator,
+                                                    yieldPolicy,
+                                                    ixn->nodeId(),
+                                                    std::move(lockAcquisitionCallback));
+
+        outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
+    } else if (intervals.size() == 1) {
         // If we have just a single interval, we can construct a simplified sub-tree.
         auto&& [lowKey, highKey] = intervals[0];
         sbe::value::SlotId recordIdSlot;
@@ -998,12 +1034,13 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
         // If we were able to decompose multi-interval index bounds into a number of single-interval
         // bounds, we can also built an optimized sub-tree to perform an index scan.
         sbe::value::SlotId recordIdSlot;
+        auto [boundsTag, boundsVal] = makeIntervalsArray(std::move(intervals));
         std::tie(recordIdSlot, stage) =
             generateOptimizedMultiIntervalIndexScan(collection,
                                                     indexName,
                                                     keyPattern,
                                                     ixn->direction == 1,
-                                                    std::move(intervals),
+                                                    makeConstant(boundsTag, boundsVal),
                                                     indexKeyBitset,
                                                     indexKeySlots,
                                                     snapshotIdSlot,
@@ -1067,4 +1104,24 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
 
     return {std::move(stage), std::move(outputs)};
 }
+
+boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>> makeIndexBoundsParam(
+    OperationContext* opCtx, const CollectionPtr& collection, const IndexScanNode* ixn) {
+    auto descriptor =
+        collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.identifier.catalogName);
+    if (!descriptor) {
+        return boost::none;
+    }
+
+    auto sdi = collection->getIndexCatalog()
+                   ->getEntry(descriptor)
+                   ->accessMethod()
+                   ->getSortedDataInterface();
+    auto intervals = makeIntervalsFromIndexBounds(
+        ixn->bounds, ixn->direction == 1, sdi->getKeyStringVersion(), sdi->getOrdering());
+    if (intervals.empty()) {
+        return boost::none;
+    }
+    return makeIntervalsArray(std::move(intervals));
+}
 }  // namespace mongo::stage_builder
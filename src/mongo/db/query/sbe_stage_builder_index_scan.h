@@ -49,6 +49,11 @@ class PlanStageSlots;
  *
  * If the caller provides a slot ID for the 'returnKeySlot' parameter, this method will populate
  * the specified slot with the rehydrated index key for each record.
+ *
+ * If 'parameterizeBounds' is true and the bounds can be decomposed into single intervals, the
+ * intervals are read from a runtime environment slot named by 'makeIndexBoundsSlotName()', which
+ * can be rebound through 'makeIndexBoundsParam()'. Otherwise the bounds are compiled into the
+ * plan and no such slot is registered.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     OperationContext* opCtx,
@@ -62,7 +67,16 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     sbe::RuntimeEnvironment* env,
     sbe::LockAcquisitionCallback lockAcquisitionCallback,
     StringMap<const IndexAccessMethod*>* iamMap,
-    bool needsCorruptionCheck);
+    bool needsCorruptionCheck,
+    bool parameterizeBounds = false);
+
+/**
+ * Returns the intervals of the index scan 'ixn' in the form read by an index scan built with
+ * parameterized bounds, or boost::none if the bounds cannot be decomposed into single intervals.
+ * Caller owns the SBE Value returned.
+ */
+boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>> makeIndexBoundsParam(
+    OperationContext* opCtx, const CollectionPtr& collection, const IndexScanNode* ixn);
 
 /**
  * Constructs the most simple version of an index scan from the single interval index bounds. The
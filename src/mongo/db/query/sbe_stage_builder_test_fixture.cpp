@@ -74,4 +74,30 @@ SbeStageBuilderTestFixture::buildPlanStage(
     return {slots, std::move(stage), std::move(data)};
 }
 
+std::tuple<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
+SbeStageBuilderTestFixture::buildRecordIdPlanStage(std::unique_ptr<QuerySolution> querySolution) {
+    auto findCommand = std::make_unique<FindCommandRequest>(_nss);
+    const boost::intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest(_nss));
+    auto statusWithCQ =
+        CanonicalQuery::canonicalize(opCtx(), std::move(findCommand), false, expCtx);
+    ASSERT_OK(statusWithCQ.getStatus());
+
+    stage_builder::SlotBasedStageBuilder builder{opCtx(),
+                                                 CollectionPtr::null,
+                                                 *statusWithCQ.getValue(),
+                                                 *querySolution,
+                                                 nullptr /* YieldPolicy */,
+                                                 nullptr /* ShardFiltererFactoryInterface */};
+
+    stage_builder::PlanStageReqs reqs;
+    reqs.set(stage_builder::PlanStageSlots::kRecordId);
+    auto [stage, outputs] = builder.build(querySolution->root(), reqs);
+    ASSERT_FALSE(outputs.has(stage_builder::PlanStageSlots::kResult));
+
+    auto recordIdSlot = outputs.get(stage_builder::PlanStageSlots::kRecordId);
+    auto data = builder.getPlanStageData();
+    data.outputs = std::move(outputs);
+    return {recordIdSlot, std::move(stage), std::move(data)};
+}
+
 }  // namespace mongo
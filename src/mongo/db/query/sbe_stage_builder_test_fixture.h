@@ -78,6 +78,14 @@ public:
                    bool hasRecordId,
                    std::unique_ptr<ShardFiltererFactoryInterface> shardFiltererFactoryInterface);
 
+    /**
+     * Like buildPlanStage(), but builds the tree as the child of a parent which only needs the
+     * RecordId of each document, such as a FETCH. Returns the slot holding the RecordId, which is
+     * the only output of the tree.
+     */
+    std::tuple<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
+    buildRecordIdPlanStage(std::unique_ptr<QuerySolution> querySolution);
+
 private:
     const NamespaceString _nss = NamespaceString{"testdb.sbe_stage_builder"};
 };
@@ -33,6 +33,7 @@
 
 #include "mongo/db/query/classic_stage_builder.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/shard_filterer_factory_impl.h"
 
@@ -58,7 +59,8 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
                              const CollectionPtr& collection,
                              const CanonicalQuery& cq,
                              const QuerySolution& solution,
-                             PlanYieldPolicy* yieldPolicy) {
+                             PlanYieldPolicy* yieldPolicy,
+                             bool parameterize) {
     // Only QuerySolutions derived from queries parsed with context, or QuerySolutions derived from
     // queries that disallow extensions, can be properly executed. If the query does not have
     // $text/$where context (and $text/$where are allowed), then no attempt should be made to
@@ -72,7 +74,7 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
     auto shardFilterer = std::make_unique<ShardFiltererFactoryImpl>(collection);
 
     auto builder = std::make_unique<SlotBasedStageBuilder>(
-        opCtx, collection, cq, solution, sbeYieldPolicy, shardFilterer.get());
+        opCtx, collection, cq, solution, sbeYieldPolicy, shardFilterer.get(), parameterize);
     auto root = builder->build(solution.root());
     auto data = builder->getPlanStageData();
 
@@ -83,6 +85,9 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
     if (expCtx->explain || expCtx->mayDbProfile) {
         root->markShouldCollectTimingInfo();
     }
+    if (expCtx->explain && internalQuerySlotBasedExecutionProfileVM.load()) {
+        root->markShouldCollectVmProfile();
+    }
 
     // Register this plan to yield according to the configured policy.
     sbeYieldPolicy->registerPlan(root.get());
@@ -50,11 +50,18 @@ std::unique_ptr<PlanStage> buildClassicExecutableTree(OperationContext* opCtx,
                                                       const QuerySolution& solution,
                                                       WorkingSet* ws);
 
+/**
+ * If 'parameterize' is true and 'cq' is parameterized, the constants of the filter and the index
+ * bounds are read from the runtime environment rather than compiled into the tree, so that the tree
+ * can be rebound to other queries of the same shape. This is only worth it for trees which are
+ * stored in the plan cache, as a parameterized index scan is slower to open.
+ */
 std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
 buildSlotBasedExecutableTree(OperationContext* opCtx,
                              const CollectionPtr& collection,
                              const CanonicalQuery& cq,
                              const QuerySolution& solution,
-                             PlanYieldPolicy* yieldPolicy);
+                             PlanYieldPolicy* yieldPolicy,
+                             bool parameterize = false);
 
 }  // namespace mongo::stage_builder
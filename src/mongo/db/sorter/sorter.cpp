@@ -51,16 +51,20 @@
 #include <boost/filesystem/operations.hpp>
 #include <snappy.h>
 #include <vector>
+#include <zstd.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter_thread_pool.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/str.h"
@@ -197,13 +201,15 @@ public:
                  std::streampos fileEndOffset,
                  const Settings& settings,
                  const boost::optional<std::string>& dbName,
-                 const uint32_t checksum)
+                 const uint32_t checksum,
+                 SorterCompressorEnum compressor = SorterCompressorEnum::kSnappy)
         : _settings(settings),
           _done(false),
           _fileFullPath(fileFullPath),
           _fileStartOffset(fileStartOffset),
           _fileEndOffset(fileEndOffset),
           _dbName(dbName),
+          _compressor(compressor),
           _originalChecksum(checksum) {
         uassert(16815,
                 str::stream() << "unexpected empty file: " << _fileFullPath,
@@ -274,7 +280,11 @@ public:
     }
 
     SorterRange getRange() const {
-        return {_fileStartOffset, _fileEndOffset, _originalChecksum};
+        SorterRange range{_fileStartOffset, _fileEndOffset, _originalChecksum};
+        if (_compressor != SorterCompressorEnum::kSnappy) {
+            range.setCompressor(_compressor);
+        }
+        return range;
     }
 
 private:
@@ -328,6 +338,11 @@ private:
             return;
         }
 
+        if (_compressor == SorterCompressorEnum::kZstd) {
+            decompressZstd(blockSize);
+            return;
+        }
+
         dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
 
         size_t uncompressedSize;
@@ -345,6 +360,31 @@ private:
         _bufferReader.reset(new BufReader(_buffer.get(), uncompressedSize));
     }
 
+    /**
+     * Replaces the zstd-compressed block of 'blockSize' bytes held in _buffer by its decompressed
+     * contents.
+     */
+    void decompressZstd(size_t blockSize) {
+        const auto uncompressedSize = ZSTD_getFrameContentSize(_buffer.get(), blockSize);
+        uassert(5999109,
+                "couldn't get uncompressed length",
+                uncompressedSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+                    uncompressedSize != ZSTD_CONTENTSIZE_ERROR);
+
+        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
+        const size_t decompressedSize = ZSTD_decompress(
+            decompressionBuffer.get(), uncompressedSize, _buffer.get(), blockSize);
+        uassert(5999110,
+                str::stream() << "decompression failed: "
+                              << (ZSTD_isError(decompressedSize)
+                                      ? ZSTD_getErrorName(decompressedSize)
+                                      : "unexpected uncompressed length"),
+                !ZSTD_isError(decompressedSize) && decompressedSize == uncompressedSize);
+
+        _buffer.swap(decompressionBuffer);
+        _bufferReader.reset(new BufReader(_buffer.get(), decompressedSize));
+    }
+
     /**
      * Attempts to read data from disk. Sets _done to true when file offset reaches _fileEndOffset.
      *
@@ -383,6 +423,7 @@ private:
     std::streampos _fileEndOffset;    // File offset at which the sorted data range ends.
     std::ifstream _file;
     boost::optional<std::string> _dbName;
+    SorterCompressorEnum _compressor;  // Compressor applied to the compressed blocks of the range.
 
     // Checksum value that is updated with each read of a data object from disk. We can compare
     // this value with _originalChecksum to check for data corruption if and only if the
@@ -542,6 +583,150 @@ private:
     STLComparator _greater;                      // named so calls make sense
 };
 
+// The number of merged batches a BackgroundMergeIterator can get ahead of its consumer.
+constexpr size_t kMaxQueuedMergeBatches = 2;
+
+/**
+ * Merge-sorts a group of sorted ranges on a thread of the sorter background thread pool, which
+ * hands the merged data over in batches. Merging the outputs of several such groups with a
+ * MergeIterator spreads the work of merging many ranges over several threads. The background merge
+ * is started by openSource() and stopped by closeSource(). Any exception it throws is rethrown to
+ * the consumer.
+ */
+template <typename Key, typename Value, typename Comparator>
+class BackgroundMergeIterator : public SortIteratorInterface<Key, Value> {
+public:
+    typedef SortIteratorInterface<Key, Value> Input;
+    typedef std::pair<Key, Value> Data;
+
+    BackgroundMergeIterator(std::vector<std::shared_ptr<Input>> iters,
+                            const SortOptions& opts,
+                            const Comparator& comp,
+                            size_t maxBatchBytes)
+        : _iters(std::move(iters)), _opts(opts), _comp(comp), _maxBatchBytes(maxBatchBytes) {}
+
+    ~BackgroundMergeIterator() {
+        stopMerging();
+    }
+
+    void openSource() {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            invariant(!_started);
+            _started = true;
+        }
+
+        sorter::backgroundThreadPool().schedule([this](Status status) {
+            std::exception_ptr error;
+            try {
+                uassertStatusOK(status);
+                merge();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            stdx::lock_guard<Latch> lk(_mutex);
+            _mergeError = std::move(error);
+            _mergeDone = true;
+            _cv.notify_all();
+        });
+    }
+
+    void closeSource() {
+        stopMerging();
+    }
+
+    bool more() {
+        if (!_batch.empty())
+            return true;
+
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return !_batches.empty() || _mergeDone; });
+        if (_batches.empty()) {
+            if (_mergeError)
+                std::rethrow_exception(_mergeError);
+            return false;
+        }
+
+        _batch = std::move(_batches.front());
+        _batches.pop_front();
+        lk.unlock();
+        _cv.notify_all();
+        return true;
+    }
+
+    Data next() {
+        verify(more());
+        Data data = std::move(_batch.front());
+        _batch.pop_front();
+        return data;
+    }
+
+private:
+    /**
+     * Runs on the background thread. Merges the group's ranges and queues the output in batches
+     * until the merge is exhausted or the iterator is closed.
+     */
+    void merge() {
+        MergeIterator<Key, Value, Comparator> merged(_iters, _opts, _comp);
+        std::deque<Data> batch;
+        size_t batchBytes = 0;
+        while (merged.more()) {
+            auto data = merged.next();
+            batchBytes += data.first.memUsageForSorter() + data.second.memUsageForSorter();
+            batch.emplace_back(data.first.getOwned(), data.second.getOwned());
+            if (batchBytes >= _maxBatchBytes) {
+                if (!queueBatch(std::move(batch)))
+                    return;
+                batch.clear();
+                batchBytes = 0;
+            }
+        }
+        if (!batch.empty())
+            queueBatch(std::move(batch));
+    }
+
+    /**
+     * Waits for room in the queue and hands 'batch' over to the consumer. Returns false if the
+     * iterator was closed instead.
+     */
+    bool queueBatch(std::deque<Data> batch) {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return _closed || _batches.size() < kMaxQueuedMergeBatches; });
+        if (_closed)
+            return false;
+
+        _batches.push_back(std::move(batch));
+        lk.unlock();
+        _cv.notify_all();
+        return true;
+    }
+
+    void stopMerging() {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _closed = true;
+        _cv.notify_all();
+        _cv.wait(lk, [&] { return !_started || _mergeDone; });
+    }
+
+    const std::vector<std::shared_ptr<Input>> _iters;
+    const SortOptions _opts;
+    const Comparator _comp;
+    const size_t _maxBatchBytes;
+
+    std::deque<Data> _batch;  // The batch being returned by next(). Only used by the consumer.
+
+    Mutex _mutex = MONGO_MAKE_LATCH("BackgroundMergeIterator::_mutex");
+    stdx::condition_variable _cv;
+
+    // Protected by _mutex.
+    std::deque<std::deque<Data>> _batches;
+    std::exception_ptr _mergeError;
+    bool _started = false;
+    bool _mergeDone = false;
+    bool _closed = false;
+};
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -580,11 +765,18 @@ public:
                                range.getEndOffset(),
                                this->_settings,
                                this->_opts.dbName,
-                               range.getChecksum());
+                               range.getChecksum(),
+                               range.getCompressor().value_or(SorterCompressorEnum::kSnappy));
                        });
     }
 
     ~NoLimitSorter() {
+        // The background spill writes to the file, so it must finish before the file is removed.
+        if (_backgroundSpillPending) {
+            stdx::unique_lock<Latch> lk(_backgroundSpillMutex);
+            _backgroundSpillCV.wait(lk, [&] { return _backgroundSpillDone; });
+        }
+
         // This Sorter is responsible for file deletion, even if done() was called.
         if (!this->_shouldKeepFilesOnDestruction) {
             DESTRUCTOR_GUARD(boost::filesystem::remove(this->_fileFullPath));
@@ -601,7 +793,7 @@ public:
         this->_totalDataSizeSorted += memUsage;
 
         if (_memUsed > this->_opts.maxMemoryUsageBytes)
-            spill();
+            spillFullRun();
     }
 
     void emplace(Key&& key, Value&& val) override {
@@ -614,12 +806,13 @@ public:
         _data.emplace_back(std::move(key), std::move(val));
 
         if (_memUsed > this->_opts.maxMemoryUsageBytes)
-            spill();
+            spillFullRun();
     }
 
     Iterator* done() {
         invariant(!std::exchange(_done, true));
 
+        waitForBackgroundSpill();
         if (this->_iters.empty()) {
             sort();
             return new InMemIterator<Key, Value>(_data);
@@ -643,16 +836,97 @@ private:
     };
 
     void sort() {
-        STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        sort(_data);
         this->_numSorted += _data.size();
     }
 
+    void sort(std::deque<Data>& data) const {
+        STLComparator less(_comp);
+        std::stable_sort(data.begin(), data.end(), less);
+    }
+
     void spill() {
+        waitForBackgroundSpill();
+
         this->_numSpills++;
         if (_data.empty())
             return;
 
+        checkExtSortAllowed();
+
+        sort();
+
+        this->_iters.push_back(writeRun(_data, _nextSortedFileWriterOffset));
+        _nextSortedFileWriterOffset = _lastRunEndOffset;
+
+        _memUsed = 0;
+    }
+
+    /**
+     * Spills the data once it exceeds the memory limit. With the backgroundSpill option, the data
+     * is handed over to a thread of the sorter background thread pool, which sorts it and writes it
+     * to disk while the sorter keeps accepting data.
+     */
+    void spillFullRun() {
+        if (!this->_opts.backgroundSpill) {
+            spill();
+            return;
+        }
+
+        // Runs are appended to the same file, so the next run can only be written once the
+        // previous one has finished.
+        waitForBackgroundSpill();
+
+        this->_numSpills++;
+        checkExtSortAllowed();
+
+        _backgroundSpillPending = true;
+        _backgroundSpillDone = false;
+        sorter::backgroundThreadPool().schedule(
+            [this, data = std::move(_data), offset = _nextSortedFileWriterOffset](
+                Status status) mutable {
+                std::exception_ptr error;
+                std::shared_ptr<Iterator> run;
+                const size_t numSorted = data.size();
+                try {
+                    uassertStatusOK(status);
+                    sort(data);
+                    run = writeRun(data, offset);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                stdx::lock_guard<Latch> lk(_backgroundSpillMutex);
+                _backgroundSpillError = std::move(error);
+                _backgroundSpillRun = std::move(run);
+                _backgroundSpillNumSorted = numSorted;
+                _backgroundSpillDone = true;
+                _backgroundSpillCV.notify_all();
+            });
+
+        _data.clear();
+        _memUsed = 0;
+    }
+
+    /**
+     * Waits for the run being spilled on the background thread, if any, and records it as spilled.
+     * Throws if the background spill failed.
+     */
+    void waitForBackgroundSpill() {
+        if (!std::exchange(_backgroundSpillPending, false))
+            return;
+
+        stdx::unique_lock<Latch> lk(_backgroundSpillMutex);
+        _backgroundSpillCV.wait(lk, [&] { return _backgroundSpillDone; });
+        if (auto error = std::exchange(_backgroundSpillError, nullptr))
+            std::rethrow_exception(error);
+
+        this->_numSorted += _backgroundSpillNumSorted;
+        this->_iters.push_back(std::move(_backgroundSpillRun));
+        _nextSortedFileWriterOffset = _lastRunEndOffset;
+    }
+
+    void checkExtSortAllowed() const {
         if (!this->_opts.extSortAllowed) {
             // This error message only applies to sorts from user queries made through the find or
             // aggregation commands. Other clients, such as bulk index builds, should suppress this
@@ -663,28 +937,43 @@ private:
                           << "Sort exceeded memory limit of " << this->_opts.maxMemoryUsageBytes
                           << " bytes, but did not opt in to external sorting.");
         }
+    }
 
-        sort();
-
-        SortedFileWriter<Key, Value> writer(
-            this->_opts, this->_fileFullPath, _nextSortedFileWriterOffset, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+    /**
+     * Appends the already sorted 'data' to the file as a new range starting at 'offset', emptying
+     * 'data', and returns an Iterator over the range. The end offset of the range is stored in
+     * _lastRunEndOffset.
+     */
+    std::shared_ptr<Iterator> writeRun(std::deque<Data>& data, std::streampos offset) {
+        SortedFileWriter<Key, Value> writer(this->_opts, this->_fileFullPath, offset, _settings);
+        for (; !data.empty(); data.pop_front()) {
+            writer.addAlreadySorted(data.front().first, data.front().second);
         }
         Iterator* iteratorPtr = writer.done();
-        _nextSortedFileWriterOffset = writer.getFileEndOffset();
-
-        this->_iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
+        _lastRunEndOffset = writer.getFileEndOffset();
 
-        _memUsed = 0;
+        return std::shared_ptr<Iterator>(iteratorPtr);
     }
 
     const Comparator _comp;
     const Settings _settings;
     std::streampos _nextSortedFileWriterOffset = 0;
+    std::streampos _lastRunEndOffset = 0;
     bool _done = false;
     size_t _memUsed = 0;
     std::deque<Data> _data;  // Data that has not been spilled.
+
+    // Whether a run is being sorted and written with the backgroundSpill option and has not been
+    // waited for yet. Only accessed by the thread using the sorter.
+    bool _backgroundSpillPending = false;
+
+    // The outcome of the background spill, set by the pool thread running it.
+    Mutex _backgroundSpillMutex = MONGO_MAKE_LATCH("NoLimitSorter::_backgroundSpillMutex");
+    stdx::condition_variable _backgroundSpillCV;
+    bool _backgroundSpillDone = false;
+    std::exception_ptr _backgroundSpillError;
+    std::shared_ptr<Iterator> _backgroundSpillRun;
+    size_t _backgroundSpillNumSorted = 0;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -1036,7 +1325,8 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
       // _file.tellp() is not initialized on all systems to reflect this. Therefore, we must also
       // pass in the expected offset to this constructor.
       _fileStartOffset(fileStartOffset),
-      _dbName(opts.dbName) {
+      _dbName(opts.dbName),
+      _compressor(opts.compressor) {
 
     // This should be checked by consumers, but if we get here don't allow writes.
     uassert(
@@ -1089,7 +1379,17 @@ void SortedFileWriter<Key, Value>::spill() {
         return;
 
     std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
+    if (_compressor == SorterCompressorEnum::kZstd) {
+        compressed.resize(ZSTD_compressBound(size));
+        const size_t compressedSize = ZSTD_compress(
+            compressed.data(), compressed.size(), outBuffer, size, ZSTD_CLEVEL_DEFAULT);
+        uassert(5999111,
+                str::stream() << "Failed to compress data: " << ZSTD_getErrorName(compressedSize),
+                !ZSTD_isError(compressedSize));
+        compressed.resize(compressedSize);
+    } else {
+        snappy::Compress(outBuffer, size, &compressed);
+    }
     verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
     const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
@@ -1144,8 +1444,13 @@ SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
     _fileEndOffset = currentFileOffset < _fileStartOffset ? _fileStartOffset : currentFileOffset;
     _file.close();
 
-    return new sorter::FileIterator<Key, Value>(
-        _fileFullPath, _fileStartOffset, _fileEndOffset, _settings, _dbName, _checksum);
+    return new sorter::FileIterator<Key, Value>(_fileFullPath,
+                                                _fileStartOffset,
+                                                _fileEndOffset,
+                                                _settings,
+                                                _dbName,
+                                                _checksum,
+                                                _compressor);
 }
 
 //
@@ -1158,7 +1463,27 @@ SortIteratorInterface<Key, Value>* SortIteratorInterface<Key, Value>::merge(
     const std::vector<std::shared_ptr<SortIteratorInterface>>& iters,
     const SortOptions& opts,
     const Comparator& comp) {
-    return new sorter::MergeIterator<Key, Value, Comparator>(iters, opts, comp);
+    // Only merge in the background when every group has at least two ranges to merge.
+    const size_t numGroups = std::min(opts.mergeThreads, iters.size() / 2);
+    if (numGroups < 2) {
+        return new sorter::MergeIterator<Key, Value, Comparator>(iters, opts, comp);
+    }
+
+    // The ranges are split into contiguous groups so that merging the outputs of the groups, which
+    // breaks ties by group, preserves the order in which equal elements were spilled. The batches
+    // queued by the groups are bounded to a fraction of the memory limit.
+    const size_t maxBatchBytes = std::max<size_t>(
+        opts.maxMemoryUsageBytes / (numGroups * (sorter::kMaxQueuedMergeBatches + 1)), 1);
+    std::vector<std::shared_ptr<SortIteratorInterface>> groups;
+    groups.reserve(numGroups);
+    for (size_t i = 0; i < numGroups; ++i) {
+        std::vector<std::shared_ptr<SortIteratorInterface>> group(
+            iters.begin() + i * iters.size() / numGroups,
+            iters.begin() + (i + 1) * iters.size() / numGroups);
+        groups.push_back(std::make_shared<sorter::BackgroundMergeIterator<Key, Value, Comparator>>(
+            std::move(group), opts, comp, maxBatchBytes));
+    }
+    return new sorter::MergeIterator<Key, Value, Comparator>(groups, opts, comp);
 }
 
 template <typename Key, typename Value>
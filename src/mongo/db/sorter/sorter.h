@@ -114,7 +114,30 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The compressor applied to the blocks of data spilled to disk.
+    SorterCompressorEnum compressor;
+
+    // Whether a sorter without a limit sorts and writes a full in-memory run to disk on a
+    // background thread while it keeps accepting data. Only one run is written at a time, so memory
+    // usage can approach twice maxMemoryUsageBytes. Off by default: the comparator is then called
+    // on the background thread while the caller keeps running, so a caller may only opt in if its
+    // comparator does not depend on state the caller modifies.
+    bool backgroundSpill;
+
+    // The number of threads merging the runs spilled to disk. When greater than one, contiguous
+    // groups of runs are each merged on a background thread, and the outputs of the groups are
+    // merged by the thread iterating over the sorted data. Defaults to one; a caller may only opt
+    // in if its comparator can be called from several threads at once.
+    size_t mergeThreads;
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          compressor(gInternalSorterCompressWithZstd.load() ? SorterCompressorEnum::kZstd
+                                                            : SorterCompressorEnum::kSnappy),
+          backgroundSpill(false),
+          mergeThreads(1) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -142,6 +165,21 @@ struct SortOptions {
         dbName = std::move(newDbName);
         return *this;
     }
+
+    SortOptions& Compressor(SorterCompressorEnum newCompressor) {
+        compressor = newCompressor;
+        return *this;
+    }
+
+    SortOptions& BackgroundSpill(bool newBackgroundSpill = true) {
+        backgroundSpill = newBackgroundSpill;
+        return *this;
+    }
+
+    SortOptions& MergeThreads(size_t newMergeThreads) {
+        mergeThreads = newMergeThreads;
+        return *this;
+    }
 };
 
 /**
@@ -363,6 +401,7 @@ private:
     std::streampos _fileEndOffset;
 
     boost::optional<std::string> _dbName;
+    SorterCompressorEnum _compressor;
 };
 }  // namespace mongo
 
@@ -380,6 +419,7 @@ private:
     template class ::mongo::sorter::LimitOneSorter<Key, Value, Comparator>;                    \
     template class ::mongo::sorter::TopKSorter<Key, Value, Comparator>;                        \
     template class ::mongo::sorter::MergeIterator<Key, Value, Comparator>;                     \
+    template class ::mongo::sorter::BackgroundMergeIterator<Key, Value, Comparator>;           \
     template class ::mongo::sorter::InMemIterator<Key, Value>;                                 \
     template class ::mongo::sorter::FileIterator<Key, Value>;                                  \
     /* factory functions */                                                                    \
@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+#include <random>
+
+#include "mongo/base/init.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+std::string nextFileName() {
+    static AtomicWord<unsigned> sorterBenchmarkFileCounter;
+    return "extsort-sorter-bm." + std::to_string(sorterBenchmarkFileCounter.fetchAndAdd(1));
+}
+
+}  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace mongo {
+namespace {
+
+// Background spills and merges run on threads which create a Client of the global ServiceContext.
+MONGO_INITIALIZER(SorterBenchmarkServiceContext)(InitializerContext* context) {
+    setGlobalServiceContext(ServiceContext::make());
+}
+
+class KeyComparator {
+public:
+    int operator()(const std::pair<BSONObj, NullValue>& lhs,
+                   const std::pair<BSONObj, NullValue>& rhs) const {
+        return lhs.first.woCompare(rhs.first);
+    }
+};
+
+using BenchmarkSorter = Sorter<BSONObj, NullValue>;
+
+constexpr size_t kMaxMemoryUsageBytes = 4 * 1024 * 1024;
+
+/**
+ * Sorts 'numDocs' documents which spill to disk many times over, and reads back the sorted output.
+ * The documents carry a repetitive string so that their spilled blocks are compressible.
+ */
+void BM_SorterSpillAndMerge(benchmark::State& state,
+                            SorterCompressorEnum compressor,
+                            bool backgroundSpill,
+                            size_t mergeThreads) {
+    const auto numDocs = state.range(0);
+
+    std::mt19937_64 gen(1234);
+    std::vector<BSONObj> docs;
+    docs.reserve(numDocs);
+    for (int64_t i = 0; i < numDocs; ++i) {
+        docs.push_back(BSON("a" << static_cast<long long>(gen()) << "b"
+                                << "the quick brown fox jumps over the lazy dog"));
+    }
+
+    const auto tempDir =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    const auto opts = SortOptions()
+                          .ExtSortAllowed()
+                          .TempDir(tempDir.string())
+                          .MaxMemoryUsageBytes(kMaxMemoryUsageBytes)
+                          .Compressor(compressor)
+                          .BackgroundSpill(backgroundSpill)
+                          .MergeThreads(mergeThreads);
+
+    for (auto _ : state) {
+        std::unique_ptr<BenchmarkSorter> sorter(BenchmarkSorter::make(opts, KeyComparator()));
+        for (const auto& doc : docs) {
+            sorter->add(doc, NullValue());
+        }
+
+        std::unique_ptr<BenchmarkSorter::Iterator> it(sorter->done());
+        it->openSource();
+        while (it->more()) {
+            benchmark::DoNotOptimize(it->next());
+        }
+        it->closeSource();
+    }
+
+    boost::filesystem::remove_all(tempDir);
+    state.SetItemsProcessed(state.iterations() * numDocs);
+}
+
+BENCHMARK_CAPTURE(BM_SorterSpillAndMerge, Snappy, SorterCompressorEnum::kSnappy, false, 1)
+    ->Arg(1000 * 1000);
+BENCHMARK_CAPTURE(BM_SorterSpillAndMerge, Zstd, SorterCompressorEnum::kZstd, false, 1)
+    ->Arg(1000 * 1000);
+BENCHMARK_CAPTURE(BM_SorterSpillAndMerge, BackgroundSpill, SorterCompressorEnum::kSnappy, true, 1)
+    ->Arg(1000 * 1000);
+BENCHMARK_CAPTURE(BM_SorterSpillAndMerge, MergeThreads4, SorterCompressorEnum::kSnappy, false, 4)
+    ->Arg(1000 * 1000);
+BENCHMARK_CAPTURE(
+    BM_SorterSpillAndMerge, ZstdBackgroundSpillMergeThreads4, SorterCompressorEnum::kZstd, true, 4)
+    ->Arg(1000 * 1000);
+
+}  // namespace
+}  // namespace mongo
@@ -36,8 +36,10 @@
 #include <memory>
 
 #include "mongo/base/data_type_endian.h"
+#include "mongo/base/init.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/sorter/sorter.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/random.h"
@@ -72,6 +74,11 @@ namespace mongo {
 namespace sorter {
 namespace {
 
+// Background spills and merges run on threads which create a Client of the global ServiceContext.
+MONGO_INITIALIZER(SorterTestServiceContext)(InitializerContext* context) {
+    setGlobalServiceContext(ServiceContext::make());
+}
+
 //
 // Sorter framework testing utilities
 //
@@ -623,6 +630,27 @@ public:
     PseudoRandom _random;
 };
 
+template <bool Random = true>
+class LotsOfDataLittleMemoryZstd : public LotsOfDataLittleMemory<Random> {
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return LotsOfDataLittleMemory<Random>::adjustSortOptions(opts).Compressor(
+            SorterCompressorEnum::kZstd);
+    }
+};
+
+template <bool Random = true>
+class LotsOfDataLittleMemoryBackgroundSpill : public LotsOfDataLittleMemory<Random> {
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return LotsOfDataLittleMemory<Random>::adjustSortOptions(opts).BackgroundSpill();
+    }
+};
+
+template <bool Random = true>
+class LotsOfDataLittleMemoryParallelMerge : public LotsOfDataLittleMemory<Random> {
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return LotsOfDataLittleMemory<Random>::adjustSortOptions(opts).MergeThreads(4);
+    }
+};
 
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
@@ -670,6 +698,12 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryZstd</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryZstd</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryBackgroundSpill</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryBackgroundSpill</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallelMerge</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallelMerge</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -697,6 +731,29 @@ public:
 
 mongo::unittest::OldStyleSuiteInitializer<SorterSuite> extSortTests;
 
+TEST(SorterBackgroundSpillTest, RethrowsAnyExceptionThrownByTheSpill) {
+    class ThrowingComparator {
+    public:
+        int operator()(const IWPair& lhs, const IWPair& rhs) const {
+            throw std::runtime_error("comparison failed");
+        }
+    };
+
+    unittest::TempDir tempDir("sorter_background_spill_test");
+    auto opts = SortOptions()
+                    .TempDir(tempDir.path())
+                    .ExtSortAllowed()
+                    .MaxMemoryUsageBytes(1024)
+                    .BackgroundSpill();
+    auto sorter = std::unique_ptr<Sorter<IntWrapper, IntWrapper>>(
+        Sorter<IntWrapper, IntWrapper>::make(opts, ThrowingComparator()));
+    // Only the first run exceeds the memory limit, so the spill fails while done() waits for it.
+    for (int i = 0; i < 200; ++i) {
+        sorter->add(i, -i);
+    }
+    ASSERT_THROWS_WHAT(sorter->done(), std::runtime_error, "comparison failed");
+}
+
 /**
  * This suite includes test cases for resumable index builds where the Sorter is reconstructed from
  * state persisted to disk during a previous clean shutdown.
@@ -867,6 +924,35 @@ TEST_F(SorterMakeFromExistingRangesTest, RoundTrip) {
     }
 }
 
+TEST_F(SorterMakeFromExistingRangesTest, RoundTripZstdCompressedRanges) {
+    unittest::TempDir tempDir(_agent.getSuiteName() + "_" + _agent.getTestName());
+
+    auto opts = SortOptions()
+                    .ExtSortAllowed()
+                    .TempDir(tempDir.path())
+                    .Compressor(SorterCompressorEnum::kZstd);
+
+    IWSorter::PersistedState state;
+    {
+        auto sorterBeforeShutdown =
+            std::unique_ptr<IWSorter>(IWSorter::make(opts, IWComparator(ASC)));
+        for (int i = 999; i >= 0; --i) {
+            sorterBeforeShutdown->add(i, -i);
+        }
+        state = sorterBeforeShutdown->persistDataForShutdown();
+        ASSERT_EQUALS(1U, state.ranges.size()) << state.ranges.size();
+        ASSERT(state.ranges[0].getCompressor() == SorterCompressorEnum::kZstd);
+    }
+
+    // The persisted ranges are decompressed with zstd even though the restored sorter compresses
+    // with snappy.
+    auto restoredOpts = SortOptions(opts).Compressor(SorterCompressorEnum::kSnappy);
+    auto sorter = std::unique_ptr<IWSorter>(IWSorter::makeFromExistingRanges(
+        state.fileName, state.ranges, restoredOpts, IWComparator(ASC)));
+    ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                std::make_shared<IntIterator>(0, 1000));
+}
+
 }  // namespace
 }  // namespace sorter
 }  // namespace mongo
@@ -437,6 +437,83 @@ TEST_F(QueryStageCachedPlan, EntriesAreNotDeactivatedWhenInactiveEntriesDisabled
     ASSERT_EQ(cache->get(*shapeCq).state, PlanCache::CacheEntryState::kPresentActive);
 }
 
+/**
+ * Test that a cached plan which survives its trial period but then falls behind the cached
+ * works-per-result is replaced during execution, and that results it already returned are not
+ * returned again by the new plan.
+ */
+TEST_F(QueryStageCachedPlan, ReplansDuringExecutionAndDropsDuplicates) {
+    const bool oldEnableReplanning = internalQueryEnableMidExecutionReplanning.load();
+    internalQueryEnableMidExecutionReplanning.store(true);
+    ON_BLOCK_EXIT([&] { internalQueryEnableMidExecutionReplanning.store(oldEnableReplanning); });
+
+    // End the trial period after the first result.
+    const int oldMaxResults = internalQueryPlanEvaluationMaxResults.load();
+    internalQueryPlanEvaluationMaxResults.store(1);
+    ON_BLOCK_EXIT([&] { internalQueryPlanEvaluationMaxResults.store(oldMaxResults); });
+
+    AutoGetCollectionForReadCommand collection(&_opCtx, nss);
+    ASSERT(collection);
+
+    // Query can be answered by either index on "a" or index on "b".
+    const auto cq = canonicalQueryFromFilterObj(opCtx(), nss, fromjson("{a: {$gte: 8}, b: 1}"));
+
+    QueryPlannerParams plannerParams;
+    fillOutPlannerParams(&_opCtx, collection.getCollection(), cq.get(), &plannerParams);
+
+    // The cached plan returns the document with _id 8 during its trial period and then spins
+    // without producing anything for a full trial period's worth of works.
+    const BSONObj firstDoc = BSON("_id" << 8 << "a" << 8 << "b" << 1);
+    RecordId firstRecordId;
+    auto cursor = collection->getCursor(&_opCtx);
+    while (auto record = cursor->next()) {
+        if (record->data.toBson().woCompare(firstDoc) == 0) {
+            firstRecordId = record->id;
+        }
+    }
+    ASSERT(firstRecordId.isValid());
+
+    auto mockChild = std::make_unique<MockStage>(_expCtx.get(), &_ws);
+    WorkingSetID id = _ws.allocate();
+    WorkingSetMember* member = _ws.get(id);
+    member->recordId = firstRecordId;
+    member->doc = {SnapshotId(), Document{firstDoc}};
+    _ws.transitionToRecordIdAndObj(id);
+    mockChild->enqueueAdvanced(id);
+
+    const size_t decisionWorks = 10;
+    const size_t mockWorks =
+        1U + static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+    for (size_t i = 0; i < mockWorks; i++) {
+        mockChild->enqueueStateCode(PlanStage::NEED_TIME);
+    }
+
+    CachedPlanStage cachedPlanStage(_expCtx.get(),
+                                    collection.getCollection(),
+                                    &_ws,
+                                    cq.get(),
+                                    plannerParams,
+                                    decisionWorks,
+                                    std::move(mockChild));
+
+    // The trial period succeeds.
+    NoopYieldPolicy yieldPolicy(_opCtx.getServiceContext()->getFastClockSource());
+    ASSERT_OK(cachedPlanStage.pickBestPlan(&yieldPolicy));
+    auto stats = static_cast<const CachedPlanStats*>(cachedPlanStage.getSpecificStats());
+    ASSERT_FALSE(stats->replanReason);
+
+    // The new plan produces both matching documents, but the one returned by the cached plan is
+    // dropped.
+    ASSERT_EQ(getNumResultsForStage(_ws, &cachedPlanStage, cq.get()), 2U);
+    ASSERT(stats->replanReason);
+    ASSERT_TRUE(stats->replannedMidExecution);
+    ASSERT_EQ(stats->dupsDropped, 1U);
+
+    // The winner of the replan is not cached. The next execution of the query multi-plans.
+    PlanCache* cache = CollectionQueryInfo::get(collection.getCollection()).getPlanCache();
+    ASSERT_EQ(cache->get(*cq).state, PlanCache::CacheEntryState::kNotPresent);
+}
+
 TEST_F(QueryStageCachedPlan, ThrowsOnYieldRecoveryWhenIndexIsDroppedBeforePlanSelection) {
     // Create an index which we will drop later on.
     BSONObj keyPattern = BSON("c" << 1);
@@ -37,7 +37,10 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageIxscan {
 namespace {
@@ -136,6 +139,28 @@ public:
         return new IndexScan(_expCtx.get(), _coll, params, &_ws, filter);
     }
 
+    IndexScan* createIndexScanOverPoints(const std::vector<int>& points, int direction = 1) {
+        IndexCatalog* catalog = _coll->getIndexCatalog();
+        std::vector<const IndexDescriptor*> indexes;
+        catalog->findIndexesByKeyPattern(&_opCtx, BSON("x" << 1), false, &indexes);
+        ASSERT_EQ(indexes.size(), 1U);
+
+        IndexScanParams params(&_opCtx, indexes[0]);
+        params.direction = direction;
+
+        OrderedIntervalList oil("x");
+        for (auto&& point : points) {
+            oil.intervals.push_back(IndexBoundsBuilder::makePointInterval(BSON("" << point)));
+        }
+        if (direction == -1) {
+            oil.reverse();
+        }
+        params.bounds.fields.push_back(oil);
+
+        MatchExpression* filter = nullptr;
+        return new IndexScan(_expCtx.get(), _coll, params, &_ws, filter);
+    }
+
     static const char* ns() {
         return "unittest.QueryStageIxscan";
     }
@@ -316,6 +341,50 @@ public:
     }
 };
 
+// A scan over a list of points looks them up in order, only seeking past keys between them.
+class QueryStageIxscanPointLookup : public IndexScanTest {
+public:
+    void run() {
+        setup();
+
+        for (int i = 0; i < 10; ++i) {
+            insert(BSON("_id" << i << "x" << i));
+        }
+        insert(BSON("_id" << 10 << "x" << 3));
+
+        const int oldMinPointLookups = internalQueryIndexScanMinPointLookups.load();
+        ON_BLOCK_EXIT([&] { internalQueryIndexScanMinPointLookups.store(oldMinPointLookups); });
+        internalQueryIndexScanMinPointLookups.store(2);
+
+        for (int direction : {1, -1}) {
+            std::unique_ptr<IndexScan> ixscan(
+                createIndexScanOverPoints({-1, 2, 3, 4, 7, 20}, direction));
+
+            std::vector<int> expected{2, 3, 3, 4, 7};
+            if (direction == -1) {
+                std::reverse(expected.begin(), expected.end());
+            }
+            for (auto&& x : expected) {
+                WorkingSetMember* member = getNext(ixscan.get());
+                ASSERT_BSONOBJ_EQ(member->keyData[0].keyData, BSON("" << x));
+            }
+
+            WorkingSetID id;
+            PlanStage::StageState state = PlanStage::NEED_TIME;
+            while (PlanStage::NEED_TIME == state) {
+                state = ixscan->work(&id);
+            }
+            ASSERT_EQ(PlanStage::IS_EOF, state);
+
+            // The adjacent points 2, 3 and 4 are read without seeking in between.
+            const IndexScanStats* stats =
+                static_cast<const IndexScanStats*>(ixscan->getSpecificStats());
+            ASSERT_TRUE(stats->pointLookup);
+            ASSERT_EQ(stats->seeks, 4U);
+        }
+    }
+};
+
 class All : public OldStyleSuiteSpecification {
 public:
     All() : OldStyleSuiteSpecification("query_stage_ixscan") {}
@@ -326,6 +395,7 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanPointLookup>();
     }
 };
 